@@ -0,0 +1,74 @@
+#include "../include/3s/3s.h"
+#include "../include/3s/art.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define LOOKUPS 1000000
+#define KEY_LENGTH 48
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void bench(size_t n)
+{
+    char *strings = malloc(2 * n * KEY_LENGTH);
+    ts_generic_t *values = malloc(n * sizeof(ts_generic_t));
+    ts_generic_t *keys = malloc(LOOKUPS * sizeof(ts_generic_t));
+    ts_art_t *art = ts_art_new();
+    size_t found_tree = 0, found_art = 0;
+
+    /* Keys sharing a long path, as paths or urls do, half of them stored. */
+    for (size_t i = 0; i < 2 * n; ++i)
+        snprintf(strings + i * KEY_LENGTH, KEY_LENGTH, "/srv/data/users/%09zu/profile", i * 7919 % (2 * n));
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        const char *string = strings + 2 * i * KEY_LENGTH;
+        values[i] = ts_new_string((char *)string);
+        ts_art_add(art, string, strlen(string), ts_new_int(i));
+    }
+
+    for (size_t i = 0; i < LOOKUPS; ++i)
+        keys[i] = ts_new_string(strings + (rand() % (2 * n)) * KEY_LENGTH);
+
+    ts_tree_t *tree = ts_tree_from_unsorted(values, n, TS_TREE_IGNORE);
+
+    double start = now_seconds();
+    for (size_t i = 0; i < LOOKUPS; ++i)
+        found_tree += ts_tree_search(tree, keys[i]) != TS_TREE_VALUE_NOT_ADDED;
+    const double tree_time = now_seconds() - start;
+
+    start = now_seconds();
+    for (size_t i = 0; i < LOOKUPS; ++i)
+        found_art += ts_art_search(art, keys[i]->data.string, strlen(keys[i]->data.string)) != NULL;
+    const double art_time = now_seconds() - start;
+
+    printf("n=%-9zu ts_tree_search %7.1f ns   ts_art_search %7.1f ns   (%zu/%zu found)\n",
+           n, tree_time * 1e9 / LOOKUPS, art_time * 1e9 / LOOKUPS, found_tree, found_art);
+
+    for (size_t i = 0; i < LOOKUPS; ++i)
+        free(keys[i]);
+
+    ts_art_free(&art);
+    ts_tree_free(&tree);
+    free(values);
+    free(keys);
+    free(strings);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t sizes[] = {1000, 100000, 1000000};
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(*sizes); ++i)
+        bench(sizes[i]);
+
+    return EXIT_SUCCESS;
+}
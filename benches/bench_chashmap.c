@@ -0,0 +1,116 @@
+#include "../include/3s/3s.h"
+#include "../include/3s/chashmap.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+
+#define KEY_RANGE 2000000
+#define PREFILL 1000000
+/* The same amount of work is split among the threads. */
+#define TOTAL_OPS 1000000
+
+typedef struct bench_ctx
+{
+    ts_chashmap_t *map;
+    int write_percent;
+    int ops;
+    uint64_t seed;
+} bench_ctx;
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint64_t next_random(uint64_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static void *worker(void *arg)
+{
+    bench_ctx *ctx = (bench_ctx *)arg;
+    struct ts_generic_t key = {.type = TS_TYPE_INTEGER};
+    struct ts_generic_t out;
+
+    for (int i = 0; i < ctx->ops; ++i)
+    {
+        const uint64_t r = next_random(&ctx->seed);
+        key.data.integer = (int32_t)(r % KEY_RANGE);
+
+        if ((int)((r >> 32) % 100) >= ctx->write_percent)
+            ts_chashmap_get(ctx->map, &key, &out);
+        else if (r & (1 << 20))
+            ts_chashmap_remove(ctx->map, &key);
+        else
+            ts_chashmap_get_or_insert(ctx->map, ts_new_int(key.data.integer), ts_new_none(), &out);
+    }
+
+    return NULL;
+}
+
+static double run(bench_ctx *shared, int threads)
+{
+    pthread_t ids[32];
+    bench_ctx ctxs[32];
+
+    const double start = now_seconds();
+    for (int t = 0; t < threads; ++t)
+    {
+        ctxs[t] = *shared;
+        ctxs[t].ops = TOTAL_OPS / threads;
+        ctxs[t].seed = 0x9E3779B97F4A7C15ull * (t + 1);
+        pthread_create(&ids[t], NULL, worker, &ctxs[t]);
+    }
+    for (int t = 0; t < threads; ++t)
+        pthread_join(ids[t], NULL);
+
+    return (double)TOTAL_OPS / (now_seconds() - start) / 1e6;
+}
+
+int main(int argc, char *argv[])
+{
+    int mixes[] = {0, 10};
+    size_t shards[] = {1, 4, 16, 64, 256};
+    int threads[] = {1, 2, 4, 8, 16};
+
+    for (size_t m = 0; m < sizeof(mixes) / sizeof(*mixes); ++m)
+    {
+        printf("writes %2d%%  (Mops/s)   threads:", mixes[m]);
+        for (size_t t = 0; t < sizeof(threads) / sizeof(*threads); ++t)
+            printf(" %7d", threads[t]);
+        putchar('\n');
+
+        for (size_t s = 0; s < sizeof(shards) / sizeof(*shards); ++s)
+        {
+            ts_chashmap_t *map = ts_chashmap_new(shards[s]);
+            uint64_t seed = 42;
+            struct ts_generic_t out;
+
+            for (int i = 0; i < PREFILL; ++i)
+            {
+                const int32_t key = (int32_t)(next_random(&seed) % KEY_RANGE);
+                ts_chashmap_get_or_insert(map, ts_new_int(key), ts_new_none(), &out);
+            }
+
+            bench_ctx shared = {.map = map, .write_percent = mixes[m]};
+
+            printf("  %3zu shards                     ", shards[s]);
+            for (size_t t = 0; t < sizeof(threads) / sizeof(*threads); ++t)
+                printf(" %7.2f", run(&shared, threads[t]));
+            putchar('\n');
+
+            ts_chashmap_free(&map);
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
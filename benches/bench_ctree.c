@@ -0,0 +1,168 @@
+#include "../include/3s/3s.h"
+#include "../include/3s/ctree.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+
+#define KEY_RANGE 2000000
+#define PREFILL 1000000
+/* The same amount of work is split among the threads. */
+#define TOTAL_OPS 400000
+
+typedef struct bench_ctx
+{
+    ts_ctree_t *ctree;
+    ts_tree_t *tree;
+    pthread_rwlock_t *rwlock;
+    int write_percent;
+    int ops;
+    uint64_t seed;
+} bench_ctx;
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint64_t next_random(uint64_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static void *ctree_worker(void *arg)
+{
+    bench_ctx *ctx = (bench_ctx *)arg;
+    struct ts_generic_t key = {.type = TS_TYPE_INTEGER};
+
+    for (int i = 0; i < ctx->ops; ++i)
+    {
+        const uint64_t r = next_random(&ctx->seed);
+        key.data.integer = (int32_t)(r % KEY_RANGE);
+
+        if ((int)((r >> 32) % 100) >= ctx->write_percent)
+            ts_ctree_contains(ctx->ctree, &key);
+        else if (r & (1 << 20))
+            ts_ctree_remove(ctx->ctree, &key);
+        else
+        {
+            ts_generic_t value = ts_new_int(key.data.integer);
+            if (!ts_ctree_add(ctx->ctree, value))
+                free(value);
+        }
+    }
+
+    return NULL;
+}
+
+static void *rwlock_worker(void *arg)
+{
+    bench_ctx *ctx = (bench_ctx *)arg;
+    struct ts_generic_t key = {.type = TS_TYPE_INTEGER};
+
+    for (int i = 0; i < ctx->ops; ++i)
+    {
+        const uint64_t r = next_random(&ctx->seed);
+        key.data.integer = (int32_t)(r % KEY_RANGE);
+
+        if ((int)((r >> 32) % 100) >= ctx->write_percent)
+        {
+            pthread_rwlock_rdlock(ctx->rwlock);
+            ts_tree_search(ctx->tree, &key);
+            pthread_rwlock_unlock(ctx->rwlock);
+        }
+        else if (r & (1 << 20))
+        {
+            pthread_rwlock_wrlock(ctx->rwlock);
+            ts_tree_remove(ctx->tree, &key);
+            pthread_rwlock_unlock(ctx->rwlock);
+        }
+        else
+        {
+            ts_generic_t value = ts_new_int(key.data.integer);
+            pthread_rwlock_wrlock(ctx->rwlock);
+            if (ts_tree_add(ctx->tree, value) == TS_TREE_VALUE_NOT_ADDED)
+                free(value);
+            pthread_rwlock_unlock(ctx->rwlock);
+        }
+    }
+
+    return NULL;
+}
+
+static double run(void *(*worker)(void *), bench_ctx *shared, int threads)
+{
+    pthread_t ids[32];
+    bench_ctx ctxs[32];
+
+    const double start = now_seconds();
+    for (int t = 0; t < threads; ++t)
+    {
+        ctxs[t] = *shared;
+        ctxs[t].ops = TOTAL_OPS / threads;
+        ctxs[t].seed = 0x9E3779B97F4A7C15ull * (t + 1);
+        pthread_create(&ids[t], NULL, worker, &ctxs[t]);
+    }
+    for (int t = 0; t < threads; ++t)
+        pthread_join(ids[t], NULL);
+
+    return (double)TOTAL_OPS / (now_seconds() - start) / 1e6;
+}
+
+int main(int argc, char *argv[])
+{
+    int mixes[] = {0, 10, 50};
+    int threads[] = {1, 2, 4, 8, 16, 32};
+    pthread_rwlock_t rwlock;
+    uint64_t seed = 42;
+
+    pthread_rwlock_init(&rwlock, NULL);
+
+    for (size_t m = 0; m < sizeof(mixes) / sizeof(*mixes); ++m)
+    {
+        printf("writes %2d%%  (Mops/s)   threads:", mixes[m]);
+        for (size_t t = 0; t < sizeof(threads) / sizeof(*threads); ++t)
+            printf(" %7d", threads[t]);
+        putchar('\n');
+
+        ts_ctree_t *ctree = ts_ctree_new();
+        ts_tree_t *tree = ts_tree_new(TS_TREE_IGNORE);
+
+        for (int i = 0; i < PREFILL; ++i)
+        {
+            const int32_t key = (int32_t)(next_random(&seed) % KEY_RANGE);
+            ts_generic_t value = ts_new_int(key);
+
+            if (!ts_ctree_add(ctree, value))
+                free(value);
+            value = ts_new_int(key);
+            if (ts_tree_add(tree, value) == TS_TREE_VALUE_NOT_ADDED)
+                free(value);
+        }
+
+        bench_ctx shared = {.ctree = ctree, .tree = tree, .rwlock = &rwlock, .write_percent = mixes[m]};
+
+        printf("  ts_ctree_t                     ");
+        for (size_t t = 0; t < sizeof(threads) / sizeof(*threads); ++t)
+            printf(" %7.2f", run(&ctree_worker, &shared, threads[t]));
+        putchar('\n');
+
+        printf("  ts_tree_t + pthread_rwlock_t   ");
+        for (size_t t = 0; t < sizeof(threads) / sizeof(*threads); ++t)
+            printf(" %7.2f", run(&rwlock_worker, &shared, threads[t]));
+        putchar('\n');
+
+        ts_ctree_free(&ctree);
+        ts_tree_free(&tree);
+    }
+
+    pthread_rwlock_destroy(&rwlock);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,66 @@
+#include "../include/3s/3s.h"
+#include "../include/3s/frozen_tree.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define LOOKUPS 1000000
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void bench(size_t n, ts_types type)
+{
+    ts_generic_t *values = malloc(n * sizeof(ts_generic_t));
+    ts_generic_t *keys = malloc(LOOKUPS * sizeof(ts_generic_t));
+    size_t found_tree = 0, found_frozen = 0;
+
+    for (size_t i = 0; i < n; ++i)
+        values[i] = type == TS_TYPE_INTEGER ? ts_new_int(2 * i) : ts_new_float64(2.0 * i);
+
+    for (size_t i = 0; i < LOOKUPS; ++i)
+        keys[i] = ts_new_int(rand() % (2 * n));
+
+    ts_tree_t *tree = ts_tree_from_sorted(values, n, TS_TREE_IGNORE);
+    ts_frozen_tree_t *frozen = ts_tree_freeze(tree);
+
+    double start = now_seconds();
+    for (size_t i = 0; i < LOOKUPS; ++i)
+        found_tree += ts_tree_search(tree, keys[i]) != TS_TREE_VALUE_NOT_ADDED;
+    const double tree_time = now_seconds() - start;
+
+    start = now_seconds();
+    for (size_t i = 0; i < LOOKUPS; ++i)
+        found_frozen += ts_frozen_tree_contains(frozen, keys[i]);
+    const double frozen_time = now_seconds() - start;
+
+    printf("%-8s n=%-9zu ts_tree_search %7.1f ns   ts_frozen_tree_contains %7.1f ns   (%zu/%zu found)\n",
+           type == TS_TYPE_INTEGER ? "int32" : "float64", n,
+           tree_time * 1e9 / LOOKUPS, frozen_time * 1e9 / LOOKUPS, found_tree, found_frozen);
+
+    for (size_t i = 0; i < LOOKUPS; ++i)
+        free(keys[i]);
+
+    ts_frozen_tree_free(&frozen);
+    ts_tree_free(&tree);
+    free(values);
+    free(keys);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t sizes[] = {1000, 100000, 1000000, 10000000};
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(*sizes); ++i)
+    {
+        bench(sizes[i], TS_TYPE_INTEGER);
+        bench(sizes[i], TS_TYPE_FLOAT64);
+    }
+
+    return EXIT_SUCCESS;
+}
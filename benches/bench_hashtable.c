@@ -0,0 +1,85 @@
+#include "../include/3s/3s.h"
+#include "../include/3s/hashtable.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define LOOKUPS 1000000
+
+/* The list is scanned on every lookup, so it is only measured up to here. */
+#define LIST_MAX_LENGTH 10000
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void bench(size_t n)
+{
+    ts_generic_t *keys = malloc(LOOKUPS * sizeof(ts_generic_t));
+    ts_list_t *list = ts_new_list();
+    ts_tree_t *tree = ts_tree_new(TS_TREE_IGNORE);
+    ts_hashtable_t *table = ts_hashtable_new(TS_HASHTABLE_DEFAULT_LOAD, true);
+    size_t found_list = 0, found_tree = 0, found_table = 0;
+    const size_t list_lookups = n <= LIST_MAX_LENGTH ? LOOKUPS / (n / 100 + 1) : 0;
+    double list_time = 0;
+
+    /* Values are stored in random order, half of the lookups miss. */
+    for (size_t i = 0; i < n; ++i)
+    {
+        const int32_t value = (int32_t)(2 * ((i * 2654435761u) % n));
+
+        if (n <= LIST_MAX_LENGTH)
+            ts_list_append_back(list, ts_new_int(value));
+        tree->add(tree, ts_new_int(value));
+        table->put(table, ts_new_int(value), ts_new_none());
+    }
+
+    for (size_t i = 0; i < LOOKUPS; ++i)
+        keys[i] = ts_new_int(rand() % (2 * n));
+
+    double start = now_seconds();
+    for (size_t i = 0; i < list_lookups; ++i)
+        found_list += ts_list_get_first_index(list, keys[i]) != TS_NOT_FOUND;
+    if (list_lookups != 0)
+        list_time = (now_seconds() - start) / list_lookups;
+
+    start = now_seconds();
+    for (size_t i = 0; i < LOOKUPS; ++i)
+        found_tree += ts_tree_search(tree, keys[i]) != TS_TREE_VALUE_NOT_ADDED;
+    const double tree_time = (now_seconds() - start) / LOOKUPS;
+
+    start = now_seconds();
+    for (size_t i = 0; i < LOOKUPS; ++i)
+        found_table += ts_hashtable_contains(table, keys[i]);
+    const double table_time = (now_seconds() - start) / LOOKUPS;
+
+    if (list_lookups != 0)
+        printf("n=%-9zu ts_list_get_first_index %9.1f ns", n, list_time * 1e9);
+    else
+        printf("n=%-9zu ts_list_get_first_index %9s   ", n, "-");
+    printf("   ts_tree_search %7.1f ns   ts_hashtable_contains %6.1f ns   (%zu/%zu found)\n",
+           tree_time * 1e9, table_time * 1e9, found_tree, found_table);
+    (void)found_list;
+
+    for (size_t i = 0; i < LOOKUPS; ++i)
+        free(keys[i]);
+
+    ts_hashtable_free(&table);
+    ts_tree_free(&tree);
+    ts_list_free(&list);
+    free(keys);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t sizes[] = {100, 10000, 1000000};
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(*sizes); ++i)
+        bench(sizes[i]);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,69 @@
+#include "../include/3s/3s.h"
+#include "../include/3s/hashtable.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define INSERTS 4000000
+
+static uint64_t now_nanoseconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static int cmp_latency(const void *a, const void *b)
+{
+    const uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void bench(const char *name, ts_hashtable_t *table, struct ts_generic_t *keys)
+{
+    uint64_t *latencies = malloc(INSERTS * sizeof(uint64_t));
+    const uint64_t begin = now_nanoseconds();
+
+    /* The table does not own the keys, so only the table itself is timed. */
+    for (size_t i = 0; i < INSERTS; ++i)
+    {
+        const uint64_t start = now_nanoseconds();
+        ts_hashtable_put(table, &keys[i], &keys[i]);
+        latencies[i] = now_nanoseconds() - start;
+    }
+
+    const uint64_t total = now_nanoseconds() - begin;
+    qsort(latencies, INSERTS, sizeof(uint64_t), cmp_latency);
+
+    printf("%-12s total %6.1f ms   p50 %5lu ns   p99 %6lu ns   p999 %7lu ns   max %9lu ns\n",
+           name, total / 1e6,
+           (unsigned long)latencies[INSERTS / 2],
+           (unsigned long)latencies[INSERTS / 100 * 99],
+           (unsigned long)latencies[INSERTS / 1000 * 999],
+           (unsigned long)latencies[INSERTS - 1]);
+
+    free(latencies);
+}
+
+int main(int argc, char *argv[])
+{
+    struct ts_generic_t *keys = malloc(INSERTS * sizeof(struct ts_generic_t));
+
+    for (size_t i = 0; i < INSERTS; ++i)
+    {
+        keys[i].type = TS_TYPE_INTEGER;
+        keys[i].data.integer = (int32_t)(i * 2654435761u);
+    }
+
+    ts_hashtable_t *table = ts_hashtable_new(TS_HASHTABLE_DEFAULT_LOAD, false);
+    bench("stop-world", table, keys);
+    ts_hashtable_free(&table);
+
+    table = ts_hashtable_new_incremental(TS_HASHTABLE_DEFAULT_LOAD, false);
+    bench("incremental", table, keys);
+    ts_hashtable_free(&table);
+
+    free(keys);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,132 @@
+#include "../include/3s/3s.h"
+#include "../include/3s/sort.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define RUNS 3
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int cmp_values(const void *value1, const void *value2)
+{
+    return ts_generic_t_class_cmp(*(const ts_generic_t *)value1, *(const ts_generic_t *)value2);
+}
+
+static ts_generic_t new_value(const char *kind, size_t i)
+{
+    const uint32_t r = (uint32_t)(i * 2654435761u);
+    char chars[24];
+
+    if (strcmp(kind, "int") == 0)
+        return ts_new_int((int32_t)r);
+    if (strcmp(kind, "float64") == 0)
+        return ts_new_float64((double)(int32_t)r / 7);
+    if (strcmp(kind, "string") == 0)
+    {
+        snprintf(chars, sizeof(chars), "key-%08x", r);
+        return ts_new_owned_string(chars);
+    }
+
+    // a third of each class
+    return i % 3 == 0 ? new_value("int", i) : i % 3 == 1 ? new_value("float64", i) : new_value("string", i);
+}
+
+static void bench(const char *kind, size_t n)
+{
+    ts_generic_t *values = malloc(n * sizeof(ts_generic_t));
+    ts_generic_t *copy = malloc(n * sizeof(ts_generic_t));
+
+    for (size_t i = 0; i < n; ++i)
+        values[i] = new_value(kind, i);
+
+    /* The best of a few runs, as the first one can pay for the allocator
+     * giving back the memory of the last bench. */
+    double qsort_time = 0, sort_time = 0;
+    for (int run = 0; run < RUNS; ++run)
+    {
+        memcpy(copy, values, n * sizeof(ts_generic_t));
+        double start = now_seconds();
+        qsort(copy, n, sizeof(ts_generic_t), cmp_values);
+        const double qsort_run = (now_seconds() - start) / n;
+
+        memcpy(copy, values, n * sizeof(ts_generic_t));
+        start = now_seconds();
+        ts_sort_values(copy, n);
+        const double sort_run = (now_seconds() - start) / n;
+
+        qsort_time = run == 0 || qsort_run < qsort_time ? qsort_run : qsort_time;
+        sort_time = run == 0 || sort_run < sort_time ? sort_run : sort_time;
+    }
+
+    printf("%-8s n=%-9zu qsort %7.1f ns   ts_sort_values %7.1f ns   (per value)\n",
+           kind, n, qsort_time * 1e9, sort_time * 1e9);
+
+    for (size_t i = 0; i < n; ++i)
+        ts_generic_t_free(values[i]);
+
+    free(copy);
+    free(values);
+}
+
+/* Sorts the same values on more and more threads. */
+static void bench_scaling(const char *kind, size_t n)
+{
+    ts_generic_t *values = malloc(n * sizeof(ts_generic_t));
+    ts_generic_t *copy = malloc(n * sizeof(ts_generic_t));
+    const long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    double single = 0;
+
+    for (size_t i = 0; i < n; ++i)
+        values[i] = new_value(kind, i);
+
+    for (size_t threads = 1; threads <= 2 * (size_t)processors; threads *= 2)
+    {
+        ts_pool_t *pool = ts_pool_new(threads);
+
+        for (int stable = 1; stable >= 0; --stable)
+        {
+            memcpy(copy, values, n * sizeof(ts_generic_t));
+            const double start = now_seconds();
+            ts_sort_values_parallel(pool, copy, n, stable);
+            const double time = now_seconds() - start;
+
+            if (threads == 1 && stable)
+                single = time;
+
+            printf("%-8s n=%-9zu threads=%-3zu %-8s %8.1f ms   speedup %5.2f\n",
+                   kind, n, threads, stable ? "stable" : "unstable", time * 1e3, single / time);
+        }
+
+        ts_pool_free(&pool);
+    }
+
+    for (size_t i = 0; i < n; ++i)
+        ts_generic_t_free(values[i]);
+
+    free(copy);
+    free(values);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *kinds[] = {"int", "float64", "string", "mixed"};
+    size_t sizes[] = {100, 10000, 1000000};
+
+    for (size_t i = 0; i < sizeof(kinds) / sizeof(*kinds); ++i)
+        for (size_t j = 0; j < sizeof(sizes) / sizeof(*sizes); ++j)
+            bench(kinds[i], sizes[j]);
+
+    for (size_t i = 0; i < sizeof(kinds) / sizeof(*kinds); ++i)
+        bench_scaling(kinds[i], 4000000);
+
+    return EXIT_SUCCESS;
+}
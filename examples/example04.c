@@ -0,0 +1,47 @@
+#include "../include/3s/3s.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static void print_visit(ts_generic_t value, void *ctx)
+{
+    value->display(value);
+    putchar(' ');
+}
+
+int main(int argc, char* argv[])
+{
+    ts_tree_t* tree = ts_tree_new(TS_TREE_IGNORE);
+    int values[] = {42, 17, 88, 5, 23, 61, 99, 30};
+
+    for (int i = 0 ; i < 8 ; ++i)
+        tree->add(tree, ts_new_int(values[i]));
+
+    tree->display(tree, TS_TREE_IN_ORDER);
+    putchar('\n');
+
+    puts("\nWalking the tree backwards from the first value not less than 60:\n");
+
+    ts_generic_t key = ts_new_int(60);
+    ts_tree_cursor_t cursor = ts_tree_cursor(tree);
+
+    for (bool found = cursor.seek(&cursor, key) ; found ; found = cursor.prev(&cursor)) {
+        ts_generic_t value = cursor.value(&cursor);
+        value->display(value);
+        putchar(' ');
+    }
+    putchar('\n');
+
+    puts("\nValues between 20 and 70:\n");
+
+    ts_generic_t lo = ts_new_int(20), hi = ts_new_int(70);
+    ts_tree_range(tree, lo, hi, &print_visit, NULL);
+    putchar('\n');
+
+    free(key);
+    free(lo);
+    free(hi);
+    ts_tree_free(&tree);
+
+    return EXIT_SUCCESS;
+}
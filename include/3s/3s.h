@@ -29,5 +29,23 @@
 #include "./llist.h"
 #include "./stack.h"
 #include "./queue.h"
+#include "./tree.h"
+#include "./frozen_tree.h"
+#include "./ctree.h"
+#include "./ptree.h"
+#include "./itree.h"
+#include "./art.h"
+#include "./hashtable.h"
+#include "./chashmap.h"
+#include "./hashset.h"
+#include "./filter.h"
+#include "./lru.h"
+#include "./arena.h"
+#include "./intern.h"
+#include "./pool.h"
+#include "./sort.h"
+#include "./iter.h"
+#include "./vector.h"
+#include "./frame.h"
 
 #endif /* 3S_HEADER */
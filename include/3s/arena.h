@@ -0,0 +1,84 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * MIT License                                                                       *
+ *                                                                                   *
+ * Copyright (c) 2022-2024 Anaxímeno Brito                                           *
+ *                                                                                   *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy      *
+ * of this software and associated documentation files (the "Software"), to deal     *
+ * in the Software without restriction, including without limitation the rights      *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell         *
+ * copies of the Software, and to permit persons to whom the Software is             *
+ * furnished to do so, subject to the following conditions:                          *
+ *                                                                                   *
+ * The above copyright notice and this permission notice shall be included in all    *
+ * copies or substantial portions of the Software.                                   *
+ *                                                                                   *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR        *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,          *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE       *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER            *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,     *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE     *
+ * SOFTWARE.                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#ifndef _3S_ARENA_HEADER
+#define _3S_ARENA_HEADER
+
+#include <stdlib.h>
+#include <stddef.h>
+
+/* The size of the chunks of an arena when none is given. */
+#define TS_ARENA_DEFAULT_CHUNK_SIZE 65536
+
+/* The alignment of the memory given by an arena. */
+#define TS_ARENA_ALIGNMENT 16
+
+typedef struct ts_arena_t ts_arena_t;
+
+/* A block of memory the allocations of an arena are cut from. */
+struct ts_arena_chunk
+{
+    /* The chunk allocated before this one. */
+    struct ts_arena_chunk *next;
+    /* The number of bytes of the chunk. */
+    size_t size;
+    /* The number of bytes already given. */
+    size_t used;
+};
+
+/* Allocator handing out memory from large chunks, by bumping an offset.
+ * Nothing is freed on its own, the whole arena is released at once, so
+ * values living and dying together cost a fraction of a malloc each.
+ * Arenas are not thread-safe.
+ * */
+struct ts_arena_t
+{
+    /* The chunk being cut, linked to the previous ones. */
+    struct ts_arena_chunk *chunks;
+    /* The size of new chunks. */
+    size_t chunk_size;
+    /* The number of bytes given, across all the chunks. */
+    size_t allocated;
+};
+
+/* Returns the given number of bytes, aligned to TS_ARENA_ALIGNMENT, or
+ * NULL if the memory could not be allocated. Requests larger than a
+ * quarter of a chunk get a chunk of their own.
+ * */
+extern void *ts_arena_alloc(ts_arena_t *arena, size_t size);
+
+/* Returns a copy of the given characters, terminated by a null character. */
+extern char *ts_arena_strndup(ts_arena_t *arena, const char *string, size_t length);
+
+/* Releases all the memory given, keeping the current chunk for reuse. */
+extern void ts_arena_reset(ts_arena_t *arena);
+
+/* Returns a pointer new allocated arena cutting chunks of the given size,
+ * or TS_ARENA_DEFAULT_CHUNK_SIZE when zero.
+ * */
+extern ts_arena_t *ts_arena_new(size_t chunk_size);
+
+/* Used to free the allocated memory of an arena and all it gave. */
+extern void ts_arena_free(ts_arena_t **arena);
+
+#endif /* _3S_ARENA_HEADER */
@@ -0,0 +1,138 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * MIT License                                                                       *
+ *                                                                                   *
+ * Copyright (c) 2022-2024 Anaxímeno Brito                                           *
+ *                                                                                   *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy      *
+ * of this software and associated documentation files (the "Software"), to deal     *
+ * in the Software without restriction, including without limitation the rights      *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell         *
+ * copies of the Software, and to permit persons to whom the Software is             *
+ * furnished to do so, subject to the following conditions:                          *
+ *                                                                                   *
+ * The above copyright notice and this permission notice shall be included in all    *
+ * copies or substantial portions of the Software.                                   *
+ *                                                                                   *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR        *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,          *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE       *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER            *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,     *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE     *
+ * SOFTWARE.                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef _3S_ART_HEADER
+#define _3S_ART_HEADER
+
+#include "./core.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/* How many bytes of a compressed path are stored on the node. Longer paths
+ * are skipped optimistically on lookups and checked against the leaf.
+ * */
+#define TS_ART_MAX_PREFIX 10
+
+typedef struct ts_art_t ts_art_t;
+
+/* Function called for each key visited by an iteration. */
+typedef void (*ts_art_visit_fn)(const char *key, size_t length, ts_generic_t value, void *ctx);
+
+/* The kinds of inner node, named after how many children they can hold. */
+typedef enum
+{
+    TS_ART_NODE4,
+    TS_ART_NODE16,
+    TS_ART_NODE48,
+    TS_ART_NODE256,
+} ts_art_node_type;
+
+/* Header shared by all the inner nodes. Children are tagged pointers, the
+ * lowest bit set meaning the child is a leaf.
+ * */
+struct ts_art_node
+{
+    /* The kind of the node, see ts_art_node_type. */
+    uint8_t type;
+    /* The number of children. */
+    uint16_t count;
+    /* The length of the compressed path before the children. */
+    uint32_t prefix_length;
+    /* The first bytes of the compressed path. */
+    uint8_t prefix[TS_ART_MAX_PREFIX];
+    /* The leaf whose key ends right after the compressed path, if any. */
+    struct ts_art_leaf *leaf;
+};
+
+/* Holds a key, copied from the one given, and its value. */
+struct ts_art_leaf
+{
+    /* The value stored under the key. */
+    ts_generic_t value;
+    /* The length of the key. */
+    size_t length;
+    /* The bytes of the key. */
+    uint8_t key[];
+};
+
+/* Adaptive radix tree, mapping byte keys to values. Lookups cost is
+ * proportional to the key length, each level being one byte of the key,
+ * and the keys are kept in lexicographic order of their unsigned bytes,
+ * which is the strcmp order for strings. Keys are copied and values owned
+ * by the tree.
+ * */
+struct ts_art_t
+{
+    /* The tagged pointer to the root. */
+    void *root;
+    /* The number of keys in the tree. */
+    size_t length;
+
+    /* Adds the value under the key, returning false if the key was
+     * already there, in which case the value is freed.
+     * */
+    bool (*add)(ts_art_t *self, const char *key, size_t length, ts_generic_t value);
+
+    /* Returns the value stored under the key, or NULL. */
+    ts_generic_t (*search)(ts_art_t *self, const char *key, size_t length);
+
+    /* Removes and frees the value stored under the key, returning false
+     * if the key was not there.
+     * */
+    bool (*remove)(ts_art_t *self, const char *key, size_t length);
+};
+
+/* Adds the value under the key, returning false if the key was
+ * already there, in which case the value is freed.
+ * */
+extern bool ts_art_add(ts_art_t *art, const char *key, size_t length, ts_generic_t value);
+
+/* Returns the value stored under the key, or NULL. */
+extern ts_generic_t ts_art_search(ts_art_t *art, const char *key, size_t length);
+
+/* Removes and frees the value stored under the key, returning false
+ * if the key was not there.
+ * */
+extern bool ts_art_remove(ts_art_t *art, const char *key, size_t length);
+
+/* Calls the visit function for every key in order, returning how
+ * many were visited.
+ * */
+extern size_t ts_art_iter(ts_art_t *art, ts_art_visit_fn visit, void *ctx);
+
+/* Calls the visit function, in order, for every key starting with
+ * the given prefix, returning how many were visited.
+ * */
+extern size_t ts_art_prefix(ts_art_t *art, const char *prefix, size_t length,
+                            ts_art_visit_fn visit, void *ctx);
+
+/* Returns a pointer new allocated adaptive radix tree. */
+extern ts_art_t *ts_art_new(void);
+
+/* Used to free the allocated memory of an adaptive radix tree. */
+extern void ts_art_free(ts_art_t **art);
+
+#endif /* _3S_ART_HEADER */
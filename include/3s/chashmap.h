@@ -0,0 +1,132 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * MIT License                                                                       *
+ *                                                                                   *
+ * Copyright (c) 2022-2024 Anaxímeno Brito                                           *
+ *                                                                                   *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy      *
+ * of this software and associated documentation files (the "Software"), to deal     *
+ * in the Software without restriction, including without limitation the rights      *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell         *
+ * copies of the Software, and to permit persons to whom the Software is             *
+ * furnished to do so, subject to the following conditions:                          *
+ *                                                                                   *
+ * The above copyright notice and this permission notice shall be included in all    *
+ * copies or substantial portions of the Software.                                   *
+ *                                                                                   *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR        *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,          *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE       *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER            *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,     *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE     *
+ * SOFTWARE.                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef _3S_CONCURRENT_HASHMAP_HEADER
+#define _3S_CONCURRENT_HASHMAP_HEADER
+
+#include "./core.h"
+#include "./hashtable.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+/* The number of shards used when none is given. */
+#define TS_CHASHMAP_DEFAULT_SHARDS 64
+
+typedef struct ts_chashmap_t ts_chashmap_t;
+
+/* Function creating the value of a missing key, see compute_if_absent. */
+typedef ts_generic_t (*ts_chashmap_compute_fn)(ts_generic_t key, void *ctx);
+
+/* A part of the map, with its own lock. Shards fill whole cache lines,
+ * so threads working on different shards never share one.
+ * */
+struct ts_chashmap_shard
+{
+    /* Taken for reading by lookups and for writing by changes. */
+    _Alignas(TS_CACHE_LINE_SIZE) pthread_rwlock_t lock;
+    /* The entries whose hash falls on this shard. */
+    ts_hashtable_t *table;
+};
+
+/* Hash map safe to use from many threads at once. Keys are spread over
+ * the shards by their hash, so threads only contend when they touch the
+ * same shard, and lookups of a shard run in parallel. As the entries may
+ * be changed once the lock is released, values are copied out.
+ * */
+struct ts_chashmap_t
+{
+    /* The shards. */
+    struct ts_chashmap_shard *shards;
+    /* The number of shards, a power of two. */
+    size_t shards_length;
+
+    /* Copies the value of the key into out, returning false if the
+     * key is not in the map or the copy could not be allocated.
+     * */
+    bool (*get)(ts_chashmap_t *self, ts_generic_t key, struct ts_generic_t *out);
+
+    /* Maps the key to the value, returning true if the key is new. */
+    bool (*put)(ts_chashmap_t *self, ts_generic_t key, ts_generic_t value);
+
+    /* Removes the key, returning false if the key was not there. */
+    bool (*remove)(ts_chashmap_t *self, ts_generic_t key);
+};
+
+/* Copies the value of the key into out, returning false if the
+ * key is not in the map. Long owned strings get characters of their
+ * own, freed with ts_generic_t_release; when those can not be allocated
+ * false is returned too, with a TS_TYPE_NONE value left in out.
+ * */
+extern bool ts_chashmap_get(ts_chashmap_t *map, ts_generic_t key, struct ts_generic_t *out);
+
+/* Maps the key to the value, returning true if the key is new. When the
+ * key was already there its value is replaced, and the given key and the
+ * old value are freed. When the shard can not grow for a new key, false
+ * is returned as well and the key and the value are freed.
+ * */
+extern bool ts_chashmap_put(ts_chashmap_t *map, ts_generic_t key, ts_generic_t value);
+
+/* Atomically adds the value under the key if the key is missing. The value
+ * stored under the key, the given one or the one already there, is copied
+ * into out. Returns true if the value was added, otherwise the given key
+ * and value are freed. Nothing is added when the copy can not be
+ * allocated, out then holding a TS_TYPE_NONE value.
+ * */
+extern bool ts_chashmap_get_or_insert(ts_chashmap_t *map, ts_generic_t key, ts_generic_t value,
+                                      struct ts_generic_t *out);
+
+/* Atomically adds the value created by the function if the key is missing.
+ * The function runs with the shard locked, at most once per key, and may
+ * return NULL to add nothing, leaving out unchanged. The value stored under
+ * the key is copied into out. Returns true if a value was created, otherwise
+ * the key is freed. A created value that can not be copied is freed and
+ * not added, out then holding a TS_TYPE_NONE value.
+ * */
+extern bool ts_chashmap_compute_if_absent(ts_chashmap_t *map, ts_generic_t key,
+                                          ts_chashmap_compute_fn compute, void *ctx,
+                                          struct ts_generic_t *out);
+
+/* Removes the key, freeing it and its value. Returns false if the key
+ * was not there.
+ * */
+extern bool ts_chashmap_remove(ts_chashmap_t *map, ts_generic_t key);
+
+/* Returns the number of keys in the map. Shards are counted one after the
+ * other, so the result may be stale when other threads change the map.
+ * */
+extern size_t ts_chashmap_length(ts_chashmap_t *map);
+
+/* Returns a pointer new allocated concurrent hash map with the given number
+ * of shards, rounded up to a power of two, or TS_CHASHMAP_DEFAULT_SHARDS
+ * when zero.
+ * */
+extern ts_chashmap_t *ts_chashmap_new(size_t shards);
+
+/* Used to free the allocated memory of a concurrent hash map. */
+extern void ts_chashmap_free(ts_chashmap_t **map);
+
+#endif /* _3S_CONCURRENT_HASHMAP_HEADER */
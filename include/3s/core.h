@@ -25,7 +25,11 @@
 #ifndef _3S_CORE_HEADER
 #define _3S_CORE_HEADER
 
+#include "./arena.h"
+
+#include <stddef.h>
 #include <stdint.h>
+#include <stdbool.h>
 
 /* Returned if the first value is less than the second one. */
 #define TS_LESS -1
@@ -43,9 +47,15 @@
  * */
 #define _MAKE_ROBUST_CHECK 1
 
+/* Size of the cache lines, used to keep data shared between threads apart. */
+#define TS_CACHE_LINE_SIZE 64
+
 /* Maximum size of the string representation of the ts_generic_t. */
 #define TS_MAX_REPR_STR_BUF_SIZE 30
 
+/* The longest owned strings stored inline, without a heap allocation. */
+#define TS_STRING_INLINE_CAPACITY 14
+
 /* The types of values allowed inside the ts_generic_t wrapper. */
 typedef enum ts_types
 {
@@ -56,9 +66,47 @@ typedef enum ts_types
     TS_TYPE_STRING,
     TS_TYPE_CHARACTER,
     TS_TYPE_POINTER,
+    TS_TYPE_OWNED_STRING,
+    TS_TYPE_INT64,
+    TS_TYPE_UINT64,
+    TS_TYPE_BOOL,
+    TS_TYPE_BYTES,
     TS_TYPE_NONE
 } ts_types;
 
+/* Groups of types whose values can be compared with each other. */
+typedef enum ts_type_class
+{
+    TS_CLASS_NONE,
+    TS_CLASS_NUMERIC,
+    TS_CLASS_TEXT,
+    TS_CLASS_POINTER,
+    TS_CLASS_BOOL,
+    TS_CLASS_BYTES
+} ts_type_class;
+
+/* The characters of an owned string, with their length, also used for the
+ * bytes of byte values. Strings of up to TS_STRING_INLINE_CAPACITY characters
+ * are stored inline, longer ones on the heap or on an arena. The characters
+ * are always null terminated.
+ * */
+struct ts_owned_string
+{
+    union
+    {
+        char inline_chars[TS_STRING_INLINE_CAPACITY + 1];
+        struct __attribute__((packed))
+        {
+            char *chars;
+            uint32_t length;
+        } outline;
+    };
+    /* The length of inline strings, or where the characters of the
+     * others are stored.
+     * */
+    uint8_t storage;
+};
+
 /* Wrapper used to store the actual data inside.
  * It was made so it could allow different types
  * to be stored in a shared space.
@@ -77,6 +125,10 @@ typedef struct ts_generic_t
         char *string;
         char character;
         void *pointer;
+        struct ts_owned_string owned;
+        int64_t integer64;
+        uint64_t uinteger64;
+        bool boolean;
     } data;
 
     /* This represents the type of the
@@ -116,6 +168,68 @@ extern ts_generic_t ts_new_pointer(void *);
 /* Returns a newly allocated ts_generic_t of type POINTER */
 extern ts_generic_t ts_new_none(void);
 
+/* Returns a newly allocated ts_generic_t of type INT64 */
+extern ts_generic_t ts_new_int64(int64_t);
+/* Returns a newly allocated ts_generic_t of type UINT64 */
+extern ts_generic_t ts_new_uint64(uint64_t);
+/* Returns a newly allocated ts_generic_t of type BOOL */
+extern ts_generic_t ts_new_bool(bool);
+
+/* Returns a newly allocated ts_generic_t of type BYTES, holding a copy of
+ * the bytes, stored like the characters of owned strings.
+ * */
+extern ts_generic_t ts_new_bytes(const void *bytes, size_t length);
+
+/* Returns a newly allocated ts_generic_t of type OWNED_STRING, holding a
+ * copy of the string.
+ * */
+extern ts_generic_t ts_new_owned_string(const char *);
+
+/* Returns a newly allocated ts_generic_t of type OWNED_STRING, holding a
+ * copy of the given characters, which may hold null characters. Strings
+ * are limited to UINT32_MAX characters.
+ * */
+extern ts_generic_t ts_new_owned_string_n(const char *chars, size_t length);
+
+/* Like ts_new_owned_string_n, but the characters of long strings are
+ * copied to the arena, living as long as it does.
+ * */
+extern ts_generic_t ts_new_owned_string_in(ts_arena_t *arena, const char *chars, size_t length);
+
+/* Returns a newly allocated ts_generic_t holding the same value. Like
+ * ts_new_string, the copy of a string points to the same characters,
+ * but owned strings are copied, to the heap when long. NULL if the
+ * memory could not be allocated.
+ * */
+extern ts_generic_t ts_generic_t_copy(ts_generic_t value);
+
+/* Copies the value into the given storage, like ts_generic_t_copy.
+ * Returns false if the characters of a long owned string could not be
+ * allocated, leaving an empty one in the storage.
+ * */
+extern bool ts_generic_t_copy_to(struct ts_generic_t *out, ts_generic_t value);
+
+/* Returns the characters of a string value, owned or not, or the bytes
+ * of a byte value. NULL for other values.
+ * */
+extern const char *ts_generic_t_chars(ts_generic_t value);
+
+/* Returns the number of characters of a string value, owned or not,
+ * without counting them for owned strings, or the number of bytes of
+ * a byte value. Zero for other values.
+ * */
+extern size_t ts_generic_t_length(ts_generic_t value);
+
+/* Frees what the value owns, but not the value itself, which is left as
+ * an empty string if it was an owned one. Used for values stored inline.
+ * */
+extern void ts_generic_t_release(ts_generic_t value);
+
+/* Frees the value and what it owns, the characters of owned strings
+ * and byte values stored on the heap. Does nothing for NULL.
+ * */
+extern void ts_generic_t_free(ts_generic_t value);
+
 /* 3s Generic type value factory. */
 typedef struct ts_generic_t_factory
 {
@@ -149,8 +263,45 @@ extern char *ts_generic_t_repr(ts_generic_t value);
 extern void ts_generic_t_display(ts_generic_t value);
 
 /* Compares two values and returns 0 if they are equal, 1 if value1 > value2,
- * and -1 if value2 > value1.
+ * and -1 if value2 > value1. Numbers are compared exactly, whatever their
+ * types, with NaN greater than the other numbers and equal to itself.
  * */
 extern int ts_generic_t_cmp(ts_generic_t value1, ts_generic_t value2);
 
+/* Returns the class of the type of the value. Only values of the
+ * same class can be compared with ts_generic_t_cmp.
+ * */
+extern ts_type_class ts_generic_t_type_class(ts_generic_t value);
+
+/* Compares two values like ts_generic_t_cmp, but values of different type
+ * classes are ordered by their class, so TS_DIFFERENT is never returned.
+ * */
+extern int ts_generic_t_class_cmp(ts_generic_t value1, ts_generic_t value2);
+
+/* Returns a 64 bits hash of the bytes, the one of the string values
+ * holding them.
+ * */
+extern uint64_t ts_hash_bytes(const char *bytes, size_t length);
+
+/* Returns a 64 bits hash of the value, consistent with ts_generic_t_cmp:
+ * values comparing as equal, like the integer 1 and the float 1.0 or the
+ * character 'a' and the string "a", have the same hash.
+ * */
+extern uint64_t ts_generic_t_hash(ts_generic_t value);
+
+/* The size of the keys of numbers, see ts_generic_t_encode_key. */
+#define TS_NUMBER_KEY_SIZE 12
+
+/* Writes to the buffer a key of the value whose memcmp order is the order
+ * of ts_generic_t_class_cmp, a shorter key coming first when it is a prefix
+ * of the other. Values comparing as equal, like 1 and 1.0, have the same
+ * key. Returns the size of the key, only computed when the buffer is NULL.
+ *
+ * Keys start with the type class. Numbers then take TS_NUMBER_KEY_SIZE - 1
+ * bytes: a sign byte, then the binary exponent and the 64 bits mantissa, big
+ * endian and complemented for negative numbers. Strings and bytes have
+ * their null bytes escaped as 00 FF and end with 00 00.
+ * */
+extern size_t ts_generic_t_encode_key(ts_generic_t value, uint8_t *buffer);
+
 #endif /* _3S_CORE_HEADER */
@@ -0,0 +1,149 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * MIT License                                                                       *
+ *                                                                                   *
+ * Copyright (c) 2022-2024 Anaxímeno Brito                                           *
+ *                                                                                   *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy      *
+ * of this software and associated documentation files (the "Software"), to deal     *
+ * in the Software without restriction, including without limitation the rights      *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell         *
+ * copies of the Software, and to permit persons to whom the Software is             *
+ * furnished to do so, subject to the following conditions:                          *
+ *                                                                                   *
+ * The above copyright notice and this permission notice shall be included in all    *
+ * copies or substantial portions of the Software.                                   *
+ *                                                                                   *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR        *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,          *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE       *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER            *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,     *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE     *
+ * SOFTWARE.                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef _3S_CONCURRENT_TREE_HEADER
+#define _3S_CONCURRENT_TREE_HEADER
+
+#include "./core.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+/* The weight balance kept by the tree, as the fraction NUM / DEN: a
+ * subtree is rebuilt when one of its children holds more than that share
+ * of its nodes, as in scapegoat trees.
+ * */
+#define TS_CTREE_BALANCE_NUM 3
+#define TS_CTREE_BALANCE_DEN 4
+
+/* Trees with fewer nodes keep their removed nodes, instead of being
+ * rebuilt without them once they are more than the values.
+ * */
+#define TS_CTREE_MIN_COMPACTION 64
+
+typedef struct ts_ctree_t ts_ctree_t;
+
+/* Represents a unique node of the concurrent binary tree. Links only go
+ * from empty to a node, except when a rebuild replaces a whole subtree,
+ * so readers always see a consistent path without taking any lock.
+ * Removing a value only marks its node, until a rebuild leaves it out.
+ * */
+struct ts_ctree_node
+{
+    /* The left node. */
+    struct ts_ctree_node *_Atomic left;
+    /* The right node. */
+    struct ts_ctree_node *_Atomic right;
+    /* The value stored in this node. */
+    ts_generic_t value;
+    /* True while the value is removed from the tree. */
+    atomic_bool removed;
+    /* Taken by the writers changing this node. */
+    atomic_flag lock;
+};
+
+/* Counts the readers started on one epoch, on a cache line of its own. */
+struct ts_ctree_readers
+{
+    _Alignas(TS_CACHE_LINE_SIZE) atomic_size_t count;
+};
+
+/* Ordered set safe to use from many threads at once. Readers never lock,
+ * they only count themselves in and out, so a rebuild knows when nobody
+ * is still going through the nodes it replaced. Writers search
+ * optimistically, without locks, and then only lock the node they change,
+ * validating that it is still as they saw it.
+ *
+ * When an insertion lands deeper than the balance allows, the subtree of
+ * its most deep unbalanced ancestor is rebuilt, which bounds the depth by
+ * O(log n) even for sorted keys. When the removed nodes outnumber the
+ * values, the whole tree is rebuilt without them. Values of different
+ * type classes are ordered by their class, see ts_generic_t_class_cmp.
+ * */
+struct ts_ctree_t
+{
+    /* Represents the root node of this tree. */
+    struct ts_ctree_node *_Atomic root;
+    /* Taken by the writers linking the root node. */
+    atomic_flag root_lock;
+    /* The number of values stored in this tree. */
+    atomic_size_t length;
+    /* The number of nodes of the tree, the removed ones included. */
+    atomic_size_t nodes;
+    /* Taken for reading by the writers, and for writing by rebuilds. */
+    pthread_rwlock_t rebuild_lock;
+    /* The number of rebuilds made, changed under the rebuild lock. */
+    size_t rebuilds;
+    /* Picks the counter of the readers, switched by rebuilds to wait for
+     * the readers started before them.
+     * */
+    atomic_uint epoch;
+    /* The readers started on even and odd epochs. */
+    struct ts_ctree_readers readers[2];
+
+    /* Adds a new value to the tree, returning false if an equal
+     * value was already there, in which case the value is not owned
+     * by the tree.
+     * */
+    bool (*add)(ts_ctree_t *self, ts_generic_t value);
+
+    /* Returns true if a value equal to the given one is on the tree. */
+    bool (*contains)(ts_ctree_t *self, ts_generic_t value);
+
+    /* Removes the value equal to the given one, returning false if
+     * there was none.
+     * */
+    bool (*remove)(ts_ctree_t *self, ts_generic_t value);
+};
+
+/* Adds a new value to the tree, returning false if an equal value was
+ * already there, in which case the value is not owned by the tree. When
+ * an equal value was removed before, and its node is still there, the
+ * node is brought back, keeping the old value, and the given one is freed.
+ * */
+extern bool ts_ctree_add(ts_ctree_t *tree, ts_generic_t value);
+
+/* Returns true if a value equal to the given one is on the tree. */
+extern bool ts_ctree_contains(ts_ctree_t *tree, ts_generic_t value);
+
+/* Removes the value equal to the given one, returning false if there was
+ * none. The node stays on the tree, so concurrent readers can go through
+ * it, until a rebuild replaces it and the readers are done with it.
+ * */
+extern bool ts_ctree_remove(ts_ctree_t *tree, ts_generic_t value);
+
+/* Returns the number of values stored in the tree. */
+extern size_t ts_ctree_length(ts_ctree_t *tree);
+
+/* Returns a pointer new allocated concurrent tree. */
+extern ts_ctree_t *ts_ctree_new(void);
+
+/* Used to free the allocated memory of a concurrent tree. It must
+ * not be called while other threads are still using the tree.
+ * */
+extern void ts_ctree_free(ts_ctree_t **tree);
+
+#endif /* _3S_CONCURRENT_TREE_HEADER */
@@ -0,0 +1,184 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * MIT License                                                                       *
+ *                                                                                   *
+ * Copyright (c) 2022-2024 Anaxímeno Brito                                           *
+ *                                                                                   *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy      *
+ * of this software and associated documentation files (the "Software"), to deal     *
+ * in the Software without restriction, including without limitation the rights      *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell         *
+ * copies of the Software, and to permit persons to whom the Software is             *
+ * furnished to do so, subject to the following conditions:                          *
+ *                                                                                   *
+ * The above copyright notice and this permission notice shall be included in all    *
+ * copies or substantial portions of the Software.                                   *
+ *                                                                                   *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR        *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,          *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE       *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER            *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,     *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE     *
+ * SOFTWARE.                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef _3S_FILTER_HEADER
+#define _3S_FILTER_HEADER
+
+#include "./core.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/* The size of the blocks, in bytes. A lookup only reads one block. */
+#define TS_BLOOM_BLOCK_SIZE TS_CACHE_LINE_SIZE
+
+/* The bits of a block. */
+#define TS_BLOOM_BLOCK_BITS (TS_BLOOM_BLOCK_SIZE * 8)
+
+/* The most bits set for each value. */
+#define TS_BLOOM_MAX_HASHES 16
+
+/* The size of the header written before the blocks when serialized. */
+#define TS_BLOOM_HEADER_SIZE 16
+
+/* The fingerprints held by each bucket of a cuckoo filter. */
+#define TS_CUCKOO_BUCKET_SIZE 4
+
+/* How many fingerprints an insertion moves before the filter is full. */
+#define TS_CUCKOO_MAX_KICKS 500
+
+/* The size of the header written before the buckets when serialized. */
+#define TS_CUCKOO_HEADER_SIZE 32
+
+typedef struct ts_bloom_t ts_bloom_t;
+typedef struct ts_cuckoo_t ts_cuckoo_t;
+
+/* Blocked Bloom filter. Each value sets its bits in a single block of one
+ * cache line, picked by its hash, so adding or testing a value touches one
+ * line, and the block is tested against the bits of the value with SSE2
+ * when available. Values are hashed with ts_generic_t_hash. Tests never
+ * answer false for a value added, but may answer true for one never added.
+ * */
+struct ts_bloom_t
+{
+    /* The blocks, aligned to the cache lines. Bit i of a block is the
+     * bit i % 8 of its byte i / 8, so the bytes do not depend on the
+     * endianness of the machine.
+     * */
+    uint8_t *blocks;
+    /* The number of blocks. */
+    size_t blocks_length;
+    /* The number of bits set for each value. */
+    uint8_t hashes;
+
+    /* Adds the value to the filter. The value is not owned by the filter. */
+    void (*add)(ts_bloom_t *self, ts_generic_t value);
+
+    /* Returns false if the value was never added to the filter. */
+    bool (*contains)(ts_bloom_t *self, ts_generic_t value);
+};
+
+/* Adds the value to the filter. The value is not owned by the filter. */
+extern void ts_bloom_add(ts_bloom_t *bloom, ts_generic_t value);
+
+/* Returns false if the value was never added to the filter. */
+extern bool ts_bloom_contains(ts_bloom_t *bloom, ts_generic_t value);
+
+/* Returns the number of bytes needed to serialize the filter. */
+extern size_t ts_bloom_serialized_size(ts_bloom_t *bloom);
+
+/* Writes the filter to the buffer, which must hold at least
+ * ts_bloom_serialized_size bytes. Returns the bytes written.
+ * */
+extern size_t ts_bloom_serialize(ts_bloom_t *bloom, uint8_t *buffer);
+
+/* Returns a new filter read from the buffer, or NULL if the buffer
+ * does not hold a serialized filter.
+ * */
+extern ts_bloom_t *ts_bloom_deserialize(const uint8_t *buffer, size_t length);
+
+/* Returns a pointer new allocated Bloom filter, sized to hold the expected
+ * number of values with the given false positive rate.
+ * */
+extern ts_bloom_t *ts_bloom_new(size_t expected, double false_positive_rate);
+
+/* Used to free the allocated memory of a Bloom filter. */
+extern void ts_bloom_free(ts_bloom_t **bloom);
+
+/* Cuckoo filter. Each value leaves a fingerprint of its hash in one of two
+ * buckets, the second one found from the first and the fingerprint alone,
+ * so fingerprints can move between their buckets to make room and values
+ * can be removed. Fingerprints take 16 bits, of which only the ones needed
+ * for the false positive rate are used. Values are hashed with
+ * ts_generic_t_hash.
+ * */
+struct ts_cuckoo_t
+{
+    /* The buckets, fingerprint zero meaning an empty slot. */
+    uint16_t *buckets;
+    /* The number of buckets, a power of two. */
+    size_t buckets_length;
+    /* The number of fingerprints stored, counting the victim. */
+    size_t length;
+    /* The bits kept from the hash for the fingerprints. */
+    uint8_t fingerprint_bits;
+    /* A fingerprint left without a slot once an insertion gave up, which
+     * is still tested, or zero. The filter is full while it is set.
+     * */
+    uint16_t victim;
+    /* The bucket of the victim. */
+    size_t victim_bucket;
+    /* The state of the generator picking the fingerprints to move. */
+    uint64_t seed;
+
+    /* Adds the value to the filter, returning false if the filter is
+     * full. The value is not owned by the filter.
+     * */
+    bool (*add)(ts_cuckoo_t *self, ts_generic_t value);
+
+    /* Returns false if the value is not in the filter. */
+    bool (*contains)(ts_cuckoo_t *self, ts_generic_t value);
+
+    /* Removes the value, returning false if it was not found. Only values
+     * added before may be removed, or other values could be lost.
+     * */
+    bool (*remove)(ts_cuckoo_t *self, ts_generic_t value);
+};
+
+/* Adds the value to the filter, returning false if the filter is
+ * full. The value is not owned by the filter.
+ * */
+extern bool ts_cuckoo_add(ts_cuckoo_t *cuckoo, ts_generic_t value);
+
+/* Returns false if the value is not in the filter. */
+extern bool ts_cuckoo_contains(ts_cuckoo_t *cuckoo, ts_generic_t value);
+
+/* Removes the value, returning false if it was not found. Only values
+ * added before may be removed, or other values could be lost.
+ * */
+extern bool ts_cuckoo_remove(ts_cuckoo_t *cuckoo, ts_generic_t value);
+
+/* Returns the number of bytes needed to serialize the filter. */
+extern size_t ts_cuckoo_serialized_size(ts_cuckoo_t *cuckoo);
+
+/* Writes the filter to the buffer, which must hold at least
+ * ts_cuckoo_serialized_size bytes. Returns the bytes written.
+ * */
+extern size_t ts_cuckoo_serialize(ts_cuckoo_t *cuckoo, uint8_t *buffer);
+
+/* Returns a new filter read from the buffer, or NULL if the buffer
+ * does not hold a serialized filter.
+ * */
+extern ts_cuckoo_t *ts_cuckoo_deserialize(const uint8_t *buffer, size_t length);
+
+/* Returns a pointer new allocated cuckoo filter, sized to hold the expected
+ * number of values with the given false positive rate.
+ * */
+extern ts_cuckoo_t *ts_cuckoo_new(size_t expected, double false_positive_rate);
+
+/* Used to free the allocated memory of a cuckoo filter. */
+extern void ts_cuckoo_free(ts_cuckoo_t **cuckoo);
+
+#endif /* _3S_FILTER_HEADER */
@@ -0,0 +1,142 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * MIT License                                                                       *
+ *                                                                                   *
+ * Copyright (c) 2022-2024 Anaxímeno Brito                                           *
+ *                                                                                   *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy      *
+ * of this software and associated documentation files (the "Software"), to deal     *
+ * in the Software without restriction, including without limitation the rights      *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell         *
+ * copies of the Software, and to permit persons to whom the Software is             *
+ * furnished to do so, subject to the following conditions:                          *
+ *                                                                                   *
+ * The above copyright notice and this permission notice shall be included in all    *
+ * copies or substantial portions of the Software.                                   *
+ *                                                                                   *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR        *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,          *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE       *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER            *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,     *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE     *
+ * SOFTWARE.                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#ifndef _3S_FRAME_HEADER
+#define _3S_FRAME_HEADER
+
+#include "./core.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Returned by ts_frame_find when the value is not in the frame. */
+#define TS_FRAME_NOT_FOUND SIZE_MAX
+
+/* The number of columns, one per type. */
+#define TS_FRAME_COLUMNS (TS_TYPE_NONE + 1)
+
+/* The most values a frame holds, as positions are 32 bits. */
+#define TS_FRAME_MAX_LENGTH UINT32_MAX
+
+typedef struct ts_frame_t ts_frame_t;
+
+/* The values of one type, as a dense array of that type: int32_t for
+ * integers, double for 64 bits floats, and so on. Owned strings and bytes
+ * keep their characters one after the other, the array holding where each
+ * value starts.
+ * */
+struct ts_frame_column
+{
+    /* The values, or the offsets of their characters. */
+    void *data;
+    /* The position of each value in the frame. */
+    uint32_t *positions;
+    /* The number of values. */
+    size_t length;
+    /* The number of values that fit in the allocated memory. */
+    size_t capacity;
+    /* The characters of owned strings and bytes. */
+    char *chars;
+    size_t chars_length;
+    size_t chars_capacity;
+};
+
+/* Columnar container of values. Values are grouped by type into dense
+ * columns, which scans go through without looking at the other types,
+ * with SSE2 on integers and 64 bits floats. The order of the values is
+ * kept by the type and the row of each position.
+ * */
+struct ts_frame_t
+{
+    /* The columns, indexed by type. */
+    struct ts_frame_column columns[TS_FRAME_COLUMNS];
+    /* The type of the value at each position. */
+    uint8_t *types;
+    /* The row of the value at each position, in the column of its type. */
+    uint32_t *rows;
+    /* The number of values. */
+    size_t length;
+    /* The number of positions that fit in the allocated memory. */
+    size_t capacity;
+
+    /* Adds a copy of the value at the end of the frame. Returns false if
+     * the memory could not be allocated.
+     * */
+    bool (*push)(ts_frame_t *self, ts_generic_t value);
+
+    /* Returns a new allocated copy of the value at the given position, or
+     * NULL out of bounds.
+     * */
+    ts_generic_t (*get)(ts_frame_t *self, size_t index);
+};
+
+/* Adds a copy of the value at the end of the frame. Owned strings and
+ * bytes have their characters copied, while strings are pointed at like
+ * in their values. Returns false if the memory could not be allocated.
+ * */
+extern bool ts_frame_push(ts_frame_t *frame, ts_generic_t value);
+
+/* Returns a new allocated copy of the value at the given position, or
+ * NULL out of bounds.
+ * */
+extern ts_generic_t ts_frame_get(ts_frame_t *frame, size_t index);
+
+/* Returns the number of values. */
+extern size_t ts_frame_length(ts_frame_t *frame);
+
+/* Returns the position of the first value of the same type as the key and
+ * equal to it, or TS_FRAME_NOT_FOUND. Only the column of the key's type is
+ * scanned.
+ * */
+extern size_t ts_frame_find(ts_frame_t *frame, ts_generic_t key);
+
+/* Returns the number of values of the same type as the key and equal to
+ * it.
+ * */
+extern size_t ts_frame_count(ts_frame_t *frame, ts_generic_t key);
+
+/* Returns a new allocated copy of the least value of the numeric column of
+ * the type, or NULL if it is empty or not numeric. NaN is the greatest
+ * number, like in ts_generic_t_cmp.
+ * */
+extern ts_generic_t ts_frame_min(ts_frame_t *frame, ts_types type);
+
+/* Returns a new allocated copy of the greatest value of the numeric column
+ * of the type, or NULL if it is empty or not numeric.
+ * */
+extern ts_generic_t ts_frame_max(ts_frame_t *frame, ts_types type);
+
+/* Returns a new allocated sum of the numeric column of the type, or NULL
+ * if it is not numeric. Integers are summed as 64 bits integers, wrapping
+ * around, and floats as 64 bits floats.
+ * */
+extern ts_generic_t ts_frame_sum(ts_frame_t *frame, ts_types type);
+
+/* Returns a pointer to a new allocated empty frame. */
+extern ts_frame_t *ts_frame_new(void);
+
+/* Used to free the allocated memory of a frame. */
+extern void ts_frame_free(ts_frame_t **frame);
+
+#endif /* _3S_FRAME_HEADER */
@@ -0,0 +1,78 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * MIT License                                                                       *
+ *                                                                                   *
+ * Copyright (c) 2022-2024 Anaxímeno Brito                                           *
+ *                                                                                   *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy      *
+ * of this software and associated documentation files (the "Software"), to deal     *
+ * in the Software without restriction, including without limitation the rights      *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell         *
+ * copies of the Software, and to permit persons to whom the Software is             *
+ * furnished to do so, subject to the following conditions:                          *
+ *                                                                                   *
+ * The above copyright notice and this permission notice shall be included in all    *
+ * copies or substantial portions of the Software.                                   *
+ *                                                                                   *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR        *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,          *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE       *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER            *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,     *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE     *
+ * SOFTWARE.                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef _3S_FROZEN_TREE_HEADER
+#define _3S_FROZEN_TREE_HEADER
+
+#include "./core.h"
+#include "./tree.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct ts_frozen_tree_t ts_frozen_tree_t;
+
+/* Immutable search structure made from a ts_tree_t. The values are stored
+ * in one contiguous array, in Eytzinger (breadth first) order, so the
+ * search walks the array from the front with predictable memory accesses.
+ * */
+struct ts_frozen_tree_t
+{
+    /* Copies of the values of the tree, in Eytzinger order. The array begins
+     * on index one, so the children of the value at k are at 2k and 2k + 1.
+     * */
+    struct ts_generic_t *values;
+    /* When every value is an integer, their keys are also kept in this dense
+     * array, in the same order, so the search compares plain integers.
+     * Otherwise it is NULL.
+     * */
+    int64_t *keys;
+    /* The number of values stored. */
+    size_t length;
+    /* Holds the values of the side trees, the ones of other type classes. */
+    ts_frozen_tree_t *next;
+
+    /* Returns the first value not less than the key, or NULL if there's none. */
+    ts_generic_t (*lower_bound)(ts_frozen_tree_t *self, ts_generic_t key);
+
+    /* Returns true if a value equal to the key is stored. */
+    bool (*contains)(ts_frozen_tree_t *self, ts_generic_t key);
+};
+
+/* Returns the first value not less than the key, or NULL if there's none. */
+extern ts_generic_t ts_frozen_tree_lower_bound(ts_frozen_tree_t *frozen, ts_generic_t key);
+
+/* Returns true if a value equal to the key is stored. */
+extern bool ts_frozen_tree_contains(ts_frozen_tree_t *frozen, ts_generic_t key);
+
+/* Creates an immutable copy of the tree, optimized for searching.
+ * Strings are not duplicated, they are shared with the tree.
+ * */
+extern ts_frozen_tree_t *ts_tree_freeze(ts_tree_t *tree);
+
+/* Used to free the allocated memory of a frozen tree. */
+extern void ts_frozen_tree_free(ts_frozen_tree_t **frozen);
+
+#endif /* _3S_FROZEN_TREE_HEADER */
@@ -0,0 +1,122 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * MIT License                                                                       *
+ *                                                                                   *
+ * Copyright (c) 2022-2024 Anaxímeno Brito                                           *
+ *                                                                                   *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy      *
+ * of this software and associated documentation files (the "Software"), to deal     *
+ * in the Software without restriction, including without limitation the rights      *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell         *
+ * copies of the Software, and to permit persons to whom the Software is             *
+ * furnished to do so, subject to the following conditions:                          *
+ *                                                                                   *
+ * The above copyright notice and this permission notice shall be included in all    *
+ * copies or substantial portions of the Software.                                   *
+ *                                                                                   *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR        *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,          *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE       *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER            *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,     *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE     *
+ * SOFTWARE.                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef _3S_HASHSET_HEADER
+#define _3S_HASHSET_HEADER
+
+#include "./core.h"
+#include "./hashtable.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+typedef struct ts_hashset_t ts_hashset_t;
+
+/* Set of values, stored as the keys of a hash table without values. Like
+ * the keys of ts_hashtable_t, values comparing as equal, as 1 and 1.0 do,
+ * are the same member.
+ * */
+struct ts_hashset_t
+{
+    /* The table holding the members as its keys. */
+    ts_hashtable_t *table;
+
+    /* Adds the value, returning false if an equal value was already a
+     * member, in which case the value is freed if the set is the owner.
+     * Also returns false when the value can not be stored, see
+     * ts_hashset_add.
+     * */
+    bool (*add)(ts_hashset_t *self, ts_generic_t value);
+
+    /* Returns true if a value equal to the given one is a member. */
+    bool (*contains)(ts_hashset_t *self, ts_generic_t value);
+
+    /* Removes the member equal to the value, freeing it if the set is
+     * the owner. Returns false if there was none.
+     * */
+    bool (*remove)(ts_hashset_t *self, ts_generic_t value);
+};
+
+/* Adds the value, returning false if an equal value was already a
+ * member, in which case the value is freed if the set is the owner.
+ * False is also returned, with the value freed if the set is the owner,
+ * when the set had to grow and the memory could not be allocated, which
+ * ts_hashset_reserve rules out for the members it counts.
+ * */
+extern bool ts_hashset_add(ts_hashset_t *set, ts_generic_t value);
+
+/* Returns true if a value equal to the given one is a member. */
+extern bool ts_hashset_contains(ts_hashset_t *set, ts_generic_t value);
+
+/* Removes the member equal to the value, freeing it if the set is
+ * the owner. Returns false if there was none.
+ * */
+extern bool ts_hashset_remove(ts_hashset_t *set, ts_generic_t value);
+
+/* Returns the number of members. */
+extern size_t ts_hashset_length(ts_hashset_t *set);
+
+/* Makes room for the given number of members, so adding them does not
+ * resize the set. Returns false if the memory could not be allocated.
+ * */
+extern bool ts_hashset_reserve(ts_hashset_t *set, size_t length);
+
+/* Returns a new set, owning copies of the members of both sets. The
+ * result is sized once, for all the members of both. Returns NULL if the
+ * memory could not be allocated.
+ * */
+extern ts_hashset_t *ts_hashset_union(ts_hashset_t *set1, ts_hashset_t *set2);
+
+/* Returns a new set, owning copies of the members found in both sets.
+ * The smaller set is walked, and the result sized once for all of it.
+ * Returns NULL if the memory could not be allocated.
+ * */
+extern ts_hashset_t *ts_hashset_intersect(ts_hashset_t *set1, ts_hashset_t *set2);
+
+/* Returns a new set, owning copies of the members of the first set not
+ * found in the second. The result is sized once, for the first set.
+ * Returns NULL if the memory could not be allocated.
+ * */
+extern ts_hashset_t *ts_hashset_difference(ts_hashset_t *set1, ts_hashset_t *set2);
+
+/* Returns a cursor placed before the first member of the set, whose
+ * members are found in the key of the cursor. The set must not be
+ * changed while iterated.
+ * */
+extern ts_hashtable_iter_t ts_hashset_iter(ts_hashset_t *set);
+
+/* Moves the cursor to the next member. Returns false when there are
+ * no more members.
+ * */
+extern bool ts_hashset_iter_next(ts_hashtable_iter_t *iter);
+
+/* Returns a pointer new allocated hash set. When owner is set, the set
+ * frees its members.
+ * */
+extern ts_hashset_t *ts_hashset_new(bool owner);
+
+/* Used to free the allocated memory of a hash set. */
+extern void ts_hashset_free(ts_hashset_t **set);
+
+#endif /* _3S_HASHSET_HEADER */
@@ -0,0 +1,182 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * MIT License                                                                       *
+ *                                                                                   *
+ * Copyright (c) 2022-2024 Anaxímeno Brito                                           *
+ *                                                                                   *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy      *
+ * of this software and associated documentation files (the "Software"), to deal     *
+ * in the Software without restriction, including without limitation the rights      *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell         *
+ * copies of the Software, and to permit persons to whom the Software is             *
+ * furnished to do so, subject to the following conditions:                          *
+ *                                                                                   *
+ * The above copyright notice and this permission notice shall be included in all    *
+ * copies or substantial portions of the Software.                                   *
+ *                                                                                   *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR        *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,          *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE       *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER            *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,     *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE     *
+ * SOFTWARE.                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef _3S_HASHTABLE_HEADER
+#define _3S_HASHTABLE_HEADER
+
+#include "./core.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/* The number of slots whose control bytes are probed at once. */
+#define TS_HASHTABLE_GROUP_WIDTH 16
+
+/* The load factor used when none, or an invalid one, is given. */
+#define TS_HASHTABLE_DEFAULT_LOAD 0.875
+
+/* How many slots an incremental resize moves on each change of the table. */
+#define TS_HASHTABLE_MIGRATE_STEP TS_HASHTABLE_GROUP_WIDTH
+
+typedef struct ts_hashtable_t ts_hashtable_t;
+
+/* Holds a key and its value. */
+struct ts_hashtable_slot
+{
+    ts_generic_t key;
+    ts_generic_t value;
+};
+
+/* An array of slots and their control bytes. A control byte tells if the
+ * slot is empty, deleted, or full, in which case it holds the lowest seven
+ * bits of the hash of the key, so most keys are rejected without being
+ * compared. Empty slots have a zero control byte, so new stores come from
+ * calloc without touching their memory.
+ * */
+struct ts_hashtable_store
+{
+    /* The control bytes, one per slot. */
+    uint8_t *ctrl;
+    /* The slots. */
+    struct ts_hashtable_slot *slots;
+    /* The number of slots, a power of two multiple of the group width. */
+    size_t capacity;
+    /* The number of slots marked as deleted. */
+    size_t tombstones;
+};
+
+/* Hash table mapping keys to values, with open addressing. The slots are
+ * probed a group at a time, comparing the group control bytes against the
+ * hash with SSE2 when available. Keys are hashed with ts_generic_t_hash
+ * and compared with ts_generic_t_cmp, so the integer 1 and the float 1.0
+ * are the same key.
+ *
+ * Incremental tables do not move all their entries when they resize. The
+ * old store is kept next to the new one, lookups look into both, and each
+ * put or remove moves TS_HASHTABLE_MIGRATE_STEP slots, so no single change
+ * pays for the whole resize.
+ * */
+struct ts_hashtable_t
+{
+    /* The slots of the table, where new keys go. */
+    struct ts_hashtable_store store;
+    /* The slots being moved out by an incremental resize, if any. */
+    struct ts_hashtable_store old;
+    /* The index of the next slot of the old store to move. */
+    size_t migrated;
+    /* When set, resizes move the entries a few at a time. */
+    bool incremental;
+    /* The number of keys in the table. */
+    size_t length;
+    /* The fraction of slots, full or deleted, that triggers a resize. */
+    double max_load;
+    /* When set, the table frees the keys and values it drops. */
+    bool owner;
+
+    /* Maps the key to the value, returning true if the key is new. When
+     * the key was already there its value is replaced, and the given key
+     * and the old value are freed if the table is the owner. Also returns
+     * false when a new key can not be stored, see ts_hashtable_put.
+     * */
+    bool (*put)(ts_hashtable_t *self, ts_generic_t key, ts_generic_t value);
+
+    /* Returns the value of the key, or NULL. */
+    ts_generic_t (*get)(ts_hashtable_t *self, ts_generic_t key);
+
+    /* Returns true if the key is in the table. */
+    bool (*contains)(ts_hashtable_t *self, ts_generic_t key);
+
+    /* Removes the key, freeing it and its value if the table is the
+     * owner. Returns false if the key was not there.
+     * */
+    bool (*remove)(ts_hashtable_t *self, ts_generic_t key);
+};
+
+/* Cursor over the entries of a hash table, in no particular order. */
+typedef struct ts_hashtable_iter_t
+{
+    /* The table being iterated. */
+    ts_hashtable_t *table;
+    /* The index of the next slot to look at. */
+    size_t index;
+    /* The key of the current entry. */
+    ts_generic_t key;
+    /* The value of the current entry. */
+    ts_generic_t value;
+} ts_hashtable_iter_t;
+
+/* Maps the key to the value, returning true if the key is new. When
+ * the key was already there its value is replaced, and the given key
+ * and the old value are freed if the table is the owner.
+ *
+ * False is also returned when the table has to grow for a new key and
+ * the memory could not be allocated. The key is not stored then, and
+ * the key and the value are freed if the table is the owner. Adding the
+ * keys counted by ts_hashtable_reserve does not grow the table.
+ * */
+extern bool ts_hashtable_put(ts_hashtable_t *table, ts_generic_t key, ts_generic_t value);
+
+/* Returns the value of the key, or NULL. */
+extern ts_generic_t ts_hashtable_get(ts_hashtable_t *table, ts_generic_t key);
+
+/* Returns true if the key is in the table. */
+extern bool ts_hashtable_contains(ts_hashtable_t *table, ts_generic_t key);
+
+/* Removes the key, freeing it and its value if the table is the
+ * owner. Returns false if the key was not there.
+ * */
+extern bool ts_hashtable_remove(ts_hashtable_t *table, ts_generic_t key);
+
+/* Makes room for the given number of keys, so adding them does not
+ * resize the table. This finishes any incremental resize, and resizes
+ * at once. Returns false if the memory could not be allocated.
+ * */
+extern bool ts_hashtable_reserve(ts_hashtable_t *table, size_t length);
+
+/* Returns a cursor placed before the first entry of the table. The table
+ * must not be changed while iterated.
+ * */
+extern ts_hashtable_iter_t ts_hashtable_iter(ts_hashtable_t *table);
+
+/* Moves the cursor to the next entry, filling its key and value.
+ * Returns false when there are no more entries.
+ * */
+extern bool ts_hashtable_iter_next(ts_hashtable_iter_t *iter);
+
+/* Returns a pointer new allocated hash table, resizing once the given
+ * load factor is reached. When owner is set, the table frees its keys
+ * and values.
+ * */
+extern ts_hashtable_t *ts_hashtable_new(double max_load, bool owner);
+
+/* Returns a pointer new allocated hash table which resizes incrementally,
+ * with the same arguments as ts_hashtable_new.
+ * */
+extern ts_hashtable_t *ts_hashtable_new_incremental(double max_load, bool owner);
+
+/* Used to free the allocated memory of a hash table. */
+extern void ts_hashtable_free(ts_hashtable_t **table);
+
+#endif /* _3S_HASHTABLE_HEADER */
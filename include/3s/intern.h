@@ -0,0 +1,124 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * MIT License                                                                       *
+ *                                                                                   *
+ * Copyright (c) 2022-2024 Anaxímeno Brito                                           *
+ *                                                                                   *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy      *
+ * of this software and associated documentation files (the "Software"), to deal     *
+ * in the Software without restriction, including without limitation the rights      *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell         *
+ * copies of the Software, and to permit persons to whom the Software is             *
+ * furnished to do so, subject to the following conditions:                          *
+ *                                                                                   *
+ * The above copyright notice and this permission notice shall be included in all    *
+ * copies or substantial portions of the Software.                                   *
+ *                                                                                   *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR        *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,          *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE       *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER            *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,     *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE     *
+ * SOFTWARE.                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#ifndef _3S_INTERN_HEADER
+#define _3S_INTERN_HEADER
+
+#include "./core.h"
+#include "./arena.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+typedef struct ts_intern_t ts_intern_t;
+
+/* An interned string, its characters following the length and the hash.
+ * Handles point at the characters, so they are plain C strings.
+ * */
+struct ts_intern_string
+{
+    /* The hash of the characters, the one of their string value. */
+    uint64_t hash;
+    /* The number of characters, without the null character. */
+    size_t length;
+    /* The characters, terminated by a null character. */
+    char chars[];
+};
+
+/* Pool of unique strings. Interning a string returns the canonical copy of
+ * its characters, the same pointer for all equal strings, so interned
+ * strings are equal if and only if their pointers are. ts_generic_t_cmp
+ * answers at once for equal handles, but string values do not know they
+ * are interned: unequal ones are still compared with strcmp, and
+ * ts_generic_t_hash still goes through the characters. ts_intern_length
+ * and ts_intern_hash give the cached length and hash. The handles are
+ * immutable and live as long as the pool.
+ *
+ * Pools are thread-safe. Arena-backed pools allocate their strings from
+ * an arena, releasing them all at once when freed.
+ * */
+struct ts_intern_t
+{
+    /* The strings, by open addressing on their hash. */
+    struct ts_intern_string **slots;
+    /* The number of slots, a power of two. */
+    size_t capacity;
+    /* The number of strings. */
+    size_t length;
+    /* The arena holding the strings, or NULL when they are malloc'd. */
+    ts_arena_t *arena;
+    /* Taken by all the operations on the pool. */
+    pthread_mutex_t lock;
+
+    /* Returns the canonical copy of the string, or NULL if the memory
+     * could not be allocated.
+     * */
+    const char *(*intern)(ts_intern_t *self, const char *string);
+};
+
+/* Returns the canonical copy of the string, or NULL if the memory
+ * could not be allocated.
+ * */
+extern const char *ts_intern(ts_intern_t *pool, const char *string);
+
+/* Returns the canonical copy of the given characters, which may hold null
+ * characters and need no terminating one.
+ * */
+extern const char *ts_intern_n(ts_intern_t *pool, const char *chars, size_t length);
+
+/* Interns the strings, writing their handles to out, with the lock taken
+ * once and the pool grown once. Returns false if the memory could not be
+ * allocated, the handles of the strings not interned being NULL.
+ * */
+extern bool ts_intern_many(ts_intern_t *pool, const char **strings, size_t length, const char **out);
+
+/* Returns the interned string equal to the given one without adding it,
+ * or NULL.
+ * */
+extern const char *ts_intern_lookup(ts_intern_t *pool, const char *string);
+
+/* Returns a new string value holding the handle of the interned string. */
+extern ts_generic_t ts_intern_value(ts_intern_t *pool, const char *string);
+
+/* Returns the length of an interned string, without counting it again. */
+extern size_t ts_intern_length(const char *interned);
+
+/* Returns the hash of an interned string, equal to the one given by
+ * ts_generic_t_hash to its string value.
+ * */
+extern uint64_t ts_intern_hash(const char *interned);
+
+/* Returns the number of strings in the pool. */
+extern size_t ts_intern_count(ts_intern_t *pool);
+
+/* Returns a pointer new allocated interning pool, allocating its strings
+ * from an arena of its own when arena is set.
+ * */
+extern ts_intern_t *ts_intern_new(bool arena);
+
+/* Used to free the allocated memory of a pool and all its strings. */
+extern void ts_intern_free(ts_intern_t **pool);
+
+#endif /* _3S_INTERN_HEADER */
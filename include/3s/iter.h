@@ -0,0 +1,172 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * MIT License                                                                       *
+ *                                                                                   *
+ * Copyright (c) 2022-2024 Anaxímeno Brito                                           *
+ *                                                                                   *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy      *
+ * of this software and associated documentation files (the "Software"), to deal     *
+ * in the Software without restriction, including without limitation the rights      *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell         *
+ * copies of the Software, and to permit persons to whom the Software is             *
+ * furnished to do so, subject to the following conditions:                          *
+ *                                                                                   *
+ * The above copyright notice and this permission notice shall be included in all    *
+ * copies or substantial portions of the Software.                                   *
+ *                                                                                   *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR        *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,          *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE       *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER            *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,     *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE     *
+ * SOFTWARE.                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#ifndef _3S_ITER_HEADER
+#define _3S_ITER_HEADER
+
+#include "./core.h"
+#include "./llist.h"
+#include "./stack.h"
+#include "./queue.h"
+#include "./tree.h"
+#include "./hashtable.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+typedef struct ts_iter_t ts_iter_t;
+
+/* Returns the value mapped from the given one. It is either written into
+ * out, which the iterator owns and reuses, or a value living elsewhere.
+ * Only the type and the data of out need to be set, and they must not
+ * point at memory out would own, such as long owned strings.
+ * */
+typedef ts_generic_t (*ts_iter_map_fn)(ts_generic_t value, struct ts_generic_t *out, void *ctx);
+
+/* Returns true for the values to keep. */
+typedef bool (*ts_iter_filter_fn)(ts_generic_t value, void *ctx);
+
+/* Returns the value combined from a value of each zipped iterator, written
+ * into out or living elsewhere, like ts_iter_map_fn.
+ * */
+typedef ts_generic_t (*ts_iter_zip_fn)(ts_generic_t first, ts_generic_t second,
+                                       struct ts_generic_t *out, void *ctx);
+
+/* Function called for each value of ts_iter_foreach. */
+typedef void (*ts_iter_visit_fn)(ts_generic_t value, void *ctx);
+
+/* Lazy iterator, pulling values one at a time from a container or from
+ * other iterators. Adapters point at the iterators they pull from, which
+ * stay with the caller, usually on the stack, so a pipeline is a chain of
+ * calls to next with no container in between and no value allocated. The
+ * values yielded belong to the containers, or to the iterators that map
+ * them, and are only valid until the next call. Containers must not be
+ * changed while iterated.
+ * */
+struct ts_iter_t
+{
+    /* Returns the next value, or NULL once there are no more. */
+    ts_generic_t (*next)(ts_iter_t *self);
+
+    union
+    {
+        /* Lists, stacks and queues, walked by their nodes. */
+        struct
+        {
+            struct ts_linked_node *node;
+        } list;
+
+        /* Trees, walked in order. */
+        struct
+        {
+            ts_tree_cursor_t cursor;
+            bool started;
+        } tree;
+
+        /* Hash tables, yielding their keys or values. */
+        struct
+        {
+            ts_hashtable_iter_t cursor;
+            bool values;
+        } table;
+
+        /* Adapters of another iterator. */
+        struct
+        {
+            ts_iter_t *source;
+            /* The second source of zips. */
+            ts_iter_t *other;
+            union
+            {
+                ts_iter_map_fn map;
+                ts_iter_filter_fn filter;
+                ts_iter_zip_fn zip;
+            } fn;
+            void *ctx;
+            /* The values left to take, or to skip. */
+            size_t count;
+        } adapter;
+    } state;
+
+    /* The value written by map and zip functions. */
+    struct ts_generic_t out;
+};
+
+/* Returns an iterator over the values of the list, from the head. */
+extern ts_iter_t ts_iter_list(ts_list_t *list);
+
+/* Returns an iterator over the values of the stack, from the top. */
+extern ts_iter_t ts_iter_stack(ts_stack_t *stack);
+
+/* Returns an iterator over the values of the queue, from the front. */
+extern ts_iter_t ts_iter_queue(ts_queue_t *queue);
+
+/* Returns an iterator over the values of the tree, in order. */
+extern ts_iter_t ts_iter_tree(ts_tree_t *tree);
+
+/* Returns an iterator over the keys of the hash table, in no particular
+ * order.
+ * */
+extern ts_iter_t ts_iter_keys(ts_hashtable_t *table);
+
+/* Returns an iterator over the values of the hash table, in the order of
+ * ts_iter_keys.
+ * */
+extern ts_iter_t ts_iter_values(ts_hashtable_t *table);
+
+/* Returns an iterator over the values of the source mapped by fn. */
+extern ts_iter_t ts_iter_map(ts_iter_t *source, ts_iter_map_fn fn, void *ctx);
+
+/* Returns an iterator over the values of the source for which fn returns
+ * true.
+ * */
+extern ts_iter_t ts_iter_filter(ts_iter_t *source, ts_iter_filter_fn fn, void *ctx);
+
+/* Returns an iterator over the first count values of the source. */
+extern ts_iter_t ts_iter_take(ts_iter_t *source, size_t count);
+
+/* Returns an iterator over the values of the source after the first count. */
+extern ts_iter_t ts_iter_skip(ts_iter_t *source, size_t count);
+
+/* Returns an iterator combining the values of both sources by fn, pair by
+ * pair, until one of them ends.
+ * */
+extern ts_iter_t ts_iter_zip(ts_iter_t *first, ts_iter_t *second, ts_iter_zip_fn fn, void *ctx);
+
+/* Returns the next value of the iterator, or NULL once there are no more. */
+extern ts_generic_t ts_iter_next(ts_iter_t *iter);
+
+/* Pulls all the values of the iterator, returning how many there were. */
+extern size_t ts_iter_count(ts_iter_t *iter);
+
+/* Calls fn for all the values of the iterator, returning how many there
+ * were.
+ * */
+extern size_t ts_iter_foreach(ts_iter_t *iter, ts_iter_visit_fn fn, void *ctx);
+
+/* Returns a new allocated list holding copies of the values of the
+ * iterator, or NULL if the memory could not be allocated.
+ * */
+extern ts_list_t *ts_iter_collect(ts_iter_t *iter);
+
+#endif /* _3S_ITER_HEADER */
@@ -0,0 +1,130 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * MIT License                                                                       *
+ *                                                                                   *
+ * Copyright (c) 2022-2024 Anaxímeno Brito                                           *
+ *                                                                                   *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy      *
+ * of this software and associated documentation files (the "Software"), to deal     *
+ * in the Software without restriction, including without limitation the rights      *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell         *
+ * copies of the Software, and to permit persons to whom the Software is             *
+ * furnished to do so, subject to the following conditions:                          *
+ *                                                                                   *
+ * The above copyright notice and this permission notice shall be included in all    *
+ * copies or substantial portions of the Software.                                   *
+ *                                                                                   *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR        *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,          *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE       *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER            *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,     *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE     *
+ * SOFTWARE.                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef _3S_INDEX_TREE_HEADER
+#define _3S_INDEX_TREE_HEADER
+
+#include "./core.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Index used for missing nodes, it can never be the index of a node. */
+#define TS_ITREE_NIL UINT32_MAX
+
+/* The most nodes an index tree can hold. */
+#define TS_ITREE_MAX_LENGTH ((size_t)TS_ITREE_NIL)
+
+typedef struct ts_itree_t ts_itree_t;
+
+/* Represents a unique node of the index tree. The links are indexes on the
+ * node array of the tree, and the value is stored inline, without its
+ * ts_generic_t wrapper, making each node 32 bytes long.
+ * */
+struct ts_itree_node
+{
+    /* The index of the parent node. */
+    uint32_t parent;
+    /* The index of the left node. */
+    uint32_t left;
+    /* The index of the right node. */
+    uint32_t right;
+    /* The type of the value stored in this node, see ts_types. */
+    uint8_t type;
+    /* The height of the subtree rooted on this node, one for leaves. */
+    int8_t height;
+    /* The value stored in this node. */
+    union ts_data_type data;
+};
+
+/* Ordered set, balanced with the AVL algorithm, whose nodes all live in
+ * one growable array. Removing a value moves the last node of the array
+ * to the freed slot, so the array is always dense and freeing the tree
+ * is a single free. Values of different type classes are ordered by their
+ * class, see ts_generic_t_class_cmp.
+ * */
+struct ts_itree_t
+{
+    /* The array holding the nodes. */
+    struct ts_itree_node *nodes;
+    /* The number of nodes, and values, in the tree. */
+    size_t length;
+    /* The number of nodes the array can hold before growing. */
+    size_t capacity;
+    /* The index of the root node. */
+    uint32_t root;
+
+    /* Adds the value to the tree, returning false if an equal value
+     * was already there. The given value is freed either way.
+     * */
+    bool (*add)(ts_itree_t *self, ts_generic_t value);
+
+    /* Returns true if a value equal to the given one is on the tree. */
+    bool (*contains)(ts_itree_t *self, ts_generic_t value);
+
+    /* Removes the value equal to the given one, returning false if
+     * there was none.
+     * */
+    bool (*remove)(ts_itree_t *self, ts_generic_t value);
+};
+
+/* Adds the value to the tree, returning false if an equal value
+ * was already there. The given value is freed either way.
+ * */
+extern bool ts_itree_add(ts_itree_t *tree, ts_generic_t value);
+
+/* Returns true if a value equal to the given one is on the tree. */
+extern bool ts_itree_contains(ts_itree_t *tree, ts_generic_t value);
+
+/* Removes the value equal to the given one, returning false if
+ * there was none.
+ * */
+extern bool ts_itree_remove(ts_itree_t *tree, ts_generic_t value);
+
+/* Returns the index of the node holding the least value, or TS_ITREE_NIL
+ * if the tree is empty. Indexes are invalidated by removals.
+ * */
+extern uint32_t ts_itree_first(ts_itree_t *tree);
+
+/* Returns the index of the node holding the next value in order, or
+ * TS_ITREE_NIL after the last one.
+ * */
+extern uint32_t ts_itree_next(ts_itree_t *tree, uint32_t index);
+
+/* Returns a copy of the value stored on the node at the index. */
+extern struct ts_generic_t ts_itree_value_at(ts_itree_t *tree, uint32_t index);
+
+/* Reserves space for the given number of nodes. Returns false
+ * if the memory could not be allocated.
+ * */
+extern bool ts_itree_reserve(ts_itree_t *tree, size_t capacity);
+
+/* Returns a pointer new allocated index tree. */
+extern ts_itree_t *ts_itree_new(void);
+
+/* Used to free the allocated memory of an index tree. */
+extern void ts_itree_free(ts_itree_t **tree);
+
+#endif /* _3S_INDEX_TREE_HEADER */
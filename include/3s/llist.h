@@ -26,6 +26,7 @@
 #define _3S_LINKED_LIST_HEADER
 
 #include "./core.h"
+#include "./pool.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -34,8 +35,25 @@
 /* Returned when searching for values on lists. */
 #define TS_NOT_FOUND -1
 
+/* The fewest values a chunk of a bulk operation takes. */
+#define TS_LIST_MIN_CHUNK 1024
+
+/* The number of chunks per thread of bulk operations, so threads done
+ * early can steal the chunks left.
+ * */
+#define TS_LIST_CHUNKS_PER_THREAD 8
+
 typedef struct ts_list_t ts_list_t;
 
+/* Returns the value replacing the given one, see ts_list_map. */
+typedef ts_generic_t (*ts_list_map_fn)(ts_generic_t value, void *ctx);
+
+/* Returns true for the values to keep, see ts_list_filter. */
+typedef bool (*ts_list_filter_fn)(ts_generic_t value, void *ctx);
+
+/* Accumulates the value into the result, see ts_list_reduce. */
+typedef void (*ts_list_reduce_fn)(ts_generic_t value, void *result, void *ctx);
+
 /* Represents a unique node of the doubly-linked list. */
 struct ts_linked_node
 {
@@ -93,6 +111,35 @@ extern void ts_list_remove_at_index(ts_list_t *list, unsigned index);
 /* Removes all occorences of the value on the list. */
 extern void ts_list_remove_value(ts_list_t *list, ts_generic_t value);
 
+/* Removes the values equal to an earlier one, keeping the first
+ * occurrences in order. Runs in linear time, with a hash set sized for
+ * the whole list up front, and leaves the list as it is when the memory
+ * for the set could not be allocated.
+ * */
+extern void ts_list_dedup(ts_list_t *list);
+
+/* Replaces each value of the list with the one map returns for it, the
+ * replaced values being freed. The list is split in chunks by walking it
+ * once, and the chunks are mapped in parallel on the pool, or on the
+ * calling thread when it is NULL. The map function may run on any thread.
+ * */
+extern void ts_list_map(ts_list_t *list, ts_pool_t *pool, ts_list_map_fn map, void *ctx);
+
+/* Removes and frees the values for which keep returns false, in parallel
+ * like ts_list_map. The nodes kept are linked back together in order,
+ * without being allocated again.
+ * */
+extern void ts_list_filter(ts_list_t *list, ts_pool_t *pool, ts_list_filter_fn keep, void *ctx);
+
+/* Reduces the values of the list into the result, of result_size bytes,
+ * which holds the identity of the reduction on call. Each chunk is reduced
+ * value by value into a copy of the identity, in parallel like ts_list_map,
+ * and the results of the chunks are combined from left to right into the
+ * result.
+ * */
+extern void ts_list_reduce(ts_list_t *list, ts_pool_t *pool, void *result, size_t result_size,
+                           ts_list_reduce_fn reduce, ts_pool_join_fn combine, void *ctx);
+
 /* Returns a pointer new allocated linked list. */
 extern ts_list_t *ts_new_list(void);
 
@@ -115,50 +162,75 @@ extern void ts_list_display(ts_list_t *list);
  * @param SEP - the string that is in between each item shown.
  * @param STRATEGY - The strategy of the list printing algorithm. Must be FORWARD or BACKWARD.
  */
-#define TS_LIST_REPR_ALGORITHM(LIST, PREFIX, POSTFIX, SEP, STRATEGY)           \
-    {                                                                          \
-        const unsigned pfx = strlen(PREFIX);                                   \
-        const unsigned llength = (LIST) != NULL ? LIST->length : 0;            \
-        const unsigned spsize = llength > 0 ? strlen(SEP) * (llength - 1) : 0; \
-        const size_t size = llength * TS_MAX_REPR_STR_BUF_SIZE + pfx + spsize; \
-                                                                               \
-        char *repr = (char *)calloc(size, sizeof(char));                       \
-                                                                               \
-        if (repr != NULL)                                                      \
-        {                                                                      \
-            strcat(repr, (PREFIX));                                            \
-            TS_PRINT_LIST_##STRATEGY(LIST, SEP);                               \
-            strcat(repr, POSTFIX);                                             \
-            repr = realloc(repr, strlen(repr) + 1);                            \
-        }                                                                      \
-                                                                               \
-        return repr;                                                           \
+#define TS_LIST_REPR_ALGORITHM(LIST, PREFIX, POSTFIX, SEP, STRATEGY)               \
+    {                                                                              \
+        const unsigned llength = (LIST) != NULL ? LIST->length : 0;                \
+        const size_t seplen = strlen(SEP);                                         \
+        size_t size = strlen(PREFIX) + strlen(POSTFIX) + 1;                        \
+        unsigned collected = 0;                                                    \
+        char *repr = NULL;                                                         \
+                                                                                   \
+        /* The values are represented first, the buffer being sized from them. */  \
+        char **reprs = (char **)calloc(llength > 0 ? llength : 1, sizeof(char *)); \
+                                                                                   \
+        if (reprs != NULL)                                                         \
+            TS_LIST_REPRS_##STRATEGY(LIST);                                        \
+                                                                                   \
+        if (reprs != NULL && collected == llength)                                 \
+            repr = (char *)malloc(size);                                           \
+                                                                                   \
+        if (repr != NULL)                                                          \
+        {                                                                          \
+            size_t at = strlen(PREFIX);                                            \
+            memcpy(repr, (PREFIX), at);                                            \
+                                                                                   \
+            for (unsigned i = 0; i < llength; ++i)                                 \
+            {                                                                      \
+                const size_t vlen = strlen(reprs[i]);                              \
+                memcpy(repr + at, reprs[i], vlen);                                 \
+                at += vlen;                                                        \
+                                                                                   \
+                if (i + 1 != llength)                                              \
+                {                                                                  \
+                    memcpy(repr + at, (SEP), seplen);                              \
+                    at += seplen;                                                  \
+                }                                                                  \
+            }                                                                      \
+                                                                                   \
+            strcpy(repr + at, (POSTFIX));                                          \
+        }                                                                          \
+                                                                                   \
+        for (unsigned i = 0; i < collected; ++i)                                   \
+            free(reprs[i]);                                                        \
+        free(reprs);                                                               \
+                                                                                   \
+        return repr;                                                               \
     }
 
-#define TS_PRINT_LIST_FORWARD(LIST, SEP)                   \
-    {                                                      \
-        for (unsigned i = 0; i < llength; ++i)             \
-        {                                                  \
-            const ts_generic_t value = LIST->get(LIST, i); \
-            char *value_repr = value->repr(value);         \
-            strcat(repr, value_repr);                      \
-            if (i + 1 != llength)                          \
-                strcat(repr, SEP);                         \
-            free(value_repr);                              \
-        }                                                  \
+/* Stores the representations of the values, in printing order, in reprs,
+ * adding their lengths and the separators to size. Stops at the first
+ * representation that could not be allocated.
+ * */
+#define TS_LIST_REPRS_FORWARD(LIST)                                    \
+    {                                                                  \
+        for (unsigned i = 0; i < llength; ++i)                         \
+        {                                                              \
+            const ts_generic_t value = LIST->get(LIST, i);             \
+            if ((reprs[collected] = value->repr(value)) == NULL)       \
+                break;                                                 \
+            size += strlen(reprs[collected++]) + (i > 0 ? seplen : 0); \
+        }                                                              \
     }
 
-#define TS_PRINT_LIST_BACKWARD(LIST, SEP)                      \
-    {                                                          \
-        for (unsigned i = llength; i > 0; --i)                 \
-        {                                                      \
-            const ts_generic_t value = LIST->get(LIST, i - 1); \
-            char *value_repr = value->repr(value);             \
-            strcat(repr, value_repr);                          \
-            if (i - 1 != 0)                                    \
-                strcat(repr, SEP);                             \
-            free(value_repr);                                  \
-        }                                                      \
+#define TS_LIST_REPRS_BACKWARD(LIST)                                         \
+    {                                                                        \
+        for (unsigned i = llength; i > 0; --i)                               \
+        {                                                                    \
+            const ts_generic_t value = LIST->get(LIST, i - 1);               \
+            if ((reprs[collected] = value->repr(value)) == NULL)             \
+                break;                                                       \
+            size += strlen(reprs[collected++]) + (i < llength ? seplen : 0); \
+        }                                                                    \
     }
 
 #endif /* _3S_LINKED_LIST_HEADER */
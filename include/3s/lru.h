@@ -0,0 +1,176 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * MIT License                                                                       *
+ *                                                                                   *
+ * Copyright (c) 2022-2024 Anaxímeno Brito                                           *
+ *                                                                                   *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy      *
+ * of this software and associated documentation files (the "Software"), to deal     *
+ * in the Software without restriction, including without limitation the rights      *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell         *
+ * copies of the Software, and to permit persons to whom the Software is             *
+ * furnished to do so, subject to the following conditions:                          *
+ *                                                                                   *
+ * The above copyright notice and this permission notice shall be included in all    *
+ * copies or substantial portions of the Software.                                   *
+ *                                                                                   *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR        *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,          *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE       *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER            *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,     *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE     *
+ * SOFTWARE.                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#ifndef _3S_LRU_HEADER
+#define _3S_LRU_HEADER
+
+#include "./core.h"
+#include "./llist.h"
+#include "./hashtable.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+/* The segment holding the entries seen once, the only one of plain caches. */
+#define TS_LRU_PROBATION 0
+
+/* The segment of segmented caches holding the entries seen more than once. */
+#define TS_LRU_PROTECTED 1
+
+/* The share of the capacity of a segmented cache kept for its protected
+ * segment, in fifths.
+ * */
+#define TS_LRU_PROTECTED_FIFTHS 4
+
+typedef struct ts_lru_t ts_lru_t;
+
+/* Returns the weight of an entry, counted against the capacity. */
+typedef size_t (*ts_lru_weigh_fn)(ts_generic_t key, ts_generic_t value);
+
+/* Called with an entry evicted to make room, before it is freed. */
+typedef void (*ts_lru_evict_fn)(ts_generic_t key, ts_generic_t value, void *ctx);
+
+/* A cached entry. It starts with a list node holding the value, so moving
+ * the entry around is relinking that node.
+ * */
+struct ts_lru_entry
+{
+    /* The node linking the entry on its segment, holding its value. */
+    struct ts_linked_node node;
+    /* The key of the entry. */
+    ts_generic_t key;
+    /* The value the table maps the key to, pointing back at the entry. */
+    struct ts_generic_t handle;
+    /* The weight of the entry. */
+    size_t weight;
+    /* The segment holding the entry. */
+    int segment;
+};
+
+/* The entries of a segment, from the most recently used at the head to the
+ * least recently used at the tail.
+ * */
+struct ts_lru_segment
+{
+    struct ts_linked_node *head;
+    struct ts_linked_node *tail;
+    /* The number of entries. */
+    size_t length;
+    /* The sum of the weights of the entries. */
+    size_t weight;
+};
+
+/* Cache of values, evicting the least recently used entries once their
+ * weights exceed the capacity. Entries weigh one by default, so the
+ * capacity is a number of entries, or what the weigh function returns,
+ * such as the bytes of ts_lru_weigh_bytes.
+ *
+ * Segmented caches add new entries on probation, and only protect those
+ * used again. Evictions take from probation first, so a scan of values
+ * used once does not flush the entries used often. Protected entries
+ * are held to TS_LRU_PROTECTED_FIFTHS of the capacity, the oldest going
+ * back on probation.
+ * */
+struct ts_lru_t
+{
+    /* Maps the keys to the handles of their entries. */
+    ts_hashtable_t *table;
+    /* The segments, only the first being used by plain caches. */
+    struct ts_lru_segment segments[2];
+    /* The weight the entries may reach before evictions. */
+    size_t capacity;
+    /* The weight the protected entries may reach. */
+    size_t protected_capacity;
+    /* When set, the cache is segmented. */
+    bool segmented;
+    /* Returns the weight of an entry, or NULL to weigh each one. */
+    ts_lru_weigh_fn weigh;
+    /* Called on evictions, if not NULL. */
+    ts_lru_evict_fn on_evict;
+    /* Passed to the eviction callback. */
+    void *evict_ctx;
+
+    /* Returns the value of the key, marking it as recently used, or NULL
+     * if the key is not cached.
+     * */
+    ts_generic_t (*get)(ts_lru_t *self, ts_generic_t key);
+
+    /* Caches the value under the key, returning true if the key is new.
+     * When the key was already there, the given key and the old value
+     * are freed. May evict other entries. Frees the key and the value
+     * when the entry can not be allocated.
+     * */
+    bool (*put)(ts_lru_t *self, ts_generic_t key, ts_generic_t value);
+
+    /* Removes the key, freeing it and its value without calling the
+     * eviction callback. Returns false if the key was not there.
+     * */
+    bool (*remove)(ts_lru_t *self, ts_generic_t key);
+};
+
+/* Returns the value of the key, marking it as recently used, or NULL
+ * if the key is not cached.
+ * */
+extern ts_generic_t ts_lru_get(ts_lru_t *lru, ts_generic_t key);
+
+/* Returns the value of the key without marking it as used, or NULL. */
+extern ts_generic_t ts_lru_peek(ts_lru_t *lru, ts_generic_t key);
+
+/* Caches the value under the key, returning true if the key is new.
+ * When the key was already there, the given key and the old value are
+ * freed and the entry counts as used. The cache owns its keys and values.
+ * Least recently used entries are evicted until the weights fit in the
+ * capacity, but the entry just put is always kept. When the entry can not
+ * be allocated, the key and the value are freed and false is returned.
+ * */
+extern bool ts_lru_put(ts_lru_t *lru, ts_generic_t key, ts_generic_t value);
+
+/* Removes the key, freeing it and its value without calling the
+ * eviction callback. Returns false if the key was not there.
+ * */
+extern bool ts_lru_remove(ts_lru_t *lru, ts_generic_t key);
+
+/* Returns the number of cached entries. */
+extern size_t ts_lru_length(ts_lru_t *lru);
+
+/* Returns the sum of the weights of the cached entries. */
+extern size_t ts_lru_weight(ts_lru_t *lru);
+
+/* Weighs an entry by the bytes it takes, the values and the characters
+ * of the strings.
+ * */
+extern size_t ts_lru_weigh_bytes(ts_generic_t key, ts_generic_t value);
+
+/* Sets the function called with each evicted entry, before it is freed. */
+extern void ts_lru_on_evict(ts_lru_t *lru, ts_lru_evict_fn on_evict, void *ctx);
+
+/* Returns a pointer new allocated cache holding up to the given weight,
+ * with entries weighed by the function, or one each when NULL. When
+ * segmented is set, the cache resists scans, see ts_lru_t.
+ * */
+extern ts_lru_t *ts_lru_new(size_t capacity, ts_lru_weigh_fn weigh, bool segmented);
+
+/* Used to free the allocated memory of a cache and its entries. */
+extern void ts_lru_free(ts_lru_t **lru);
+
+#endif /* _3S_LRU_HEADER */
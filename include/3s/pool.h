@@ -0,0 +1,159 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * MIT License                                                                       *
+ *                                                                                   *
+ * Copyright (c) 2022-2024 Anaxímeno Brito                                           *
+ *                                                                                   *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy      *
+ * of this software and associated documentation files (the "Software"), to deal     *
+ * in the Software without restriction, including without limitation the rights      *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell         *
+ * copies of the Software, and to permit persons to whom the Software is             *
+ * furnished to do so, subject to the following conditions:                          *
+ *                                                                                   *
+ * The above copyright notice and this permission notice shall be included in all    *
+ * copies or substantial portions of the Software.                                   *
+ *                                                                                   *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR        *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,          *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE       *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER            *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,     *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE     *
+ * SOFTWARE.                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#ifndef _3S_POOL_HEADER
+#define _3S_POOL_HEADER
+
+#include "./core.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+/* The number of tasks a worker can have forked and not yet joined. Forks
+ * beyond it run on the worker itself.
+ * */
+#define TS_POOL_DEQUE_CAPACITY 128
+
+/* Partial results up to this size are kept on the stack. */
+#define TS_POOL_INLINE_RESULT 64
+
+typedef struct ts_pool_t ts_pool_t;
+
+/* Runs the body of a parallel for on the indexes from begin to end. */
+typedef void (*ts_pool_for_fn)(size_t begin, size_t end, void *ctx);
+
+/* Accumulates the indexes from begin to end into the result. */
+typedef void (*ts_pool_map_fn)(size_t begin, size_t end, void *result, void *ctx);
+
+/* Accumulates the other result, of the indexes right after those of the
+ * result, into the result.
+ * */
+typedef void (*ts_pool_join_fn)(void *result, const void *other, void *ctx);
+
+/* A half of a range forked by a worker, which it or a thief runs. */
+struct ts_pool_task
+{
+    size_t begin;
+    size_t end;
+    /* The parallel call the task is part of. */
+    struct ts_pool_job *job;
+    /* Where the task accumulates, NULL for parallel fors. */
+    void *result;
+    /* Set once a thief ran the task. */
+    atomic_bool done;
+};
+
+/* The tasks forked by a worker, which it pushes and pops at the bottom
+ * and other workers steal from the top.
+ * */
+struct ts_pool_deque
+{
+    _Alignas(TS_CACHE_LINE_SIZE) pthread_mutex_t lock;
+    struct ts_pool_task *tasks[TS_POOL_DEQUE_CAPACITY];
+    /* The oldest task, and the slot after the newest. */
+    size_t top;
+    size_t bottom;
+};
+
+/* A thread of the pool, the first being whichever thread calls it. */
+struct ts_pool_worker
+{
+    struct ts_pool_deque deque;
+    ts_pool_t *pool;
+    /* Picks the workers to steal from. */
+    uint64_t seed;
+};
+
+/* Fork/join pool of threads. Parallel calls split their range in halves
+ * until they get to the grain, each worker pushing the right half for
+ * others to steal and going on with the left half. Idle workers steal the
+ * largest halves left, and a worker waiting for a stolen half steals work
+ * meanwhile. The calling thread takes part, and parallel calls can nest.
+ *
+ * The halves only depend on the range and the grain, and results are
+ * joined from left to right, so reductions give the same results whatever
+ * the number of threads. A pool of one thread runs every call on the
+ * calling thread, in order, which makes it deterministic for tests.
+ * */
+struct ts_pool_t
+{
+    /* The workers, with the calling thread. */
+    struct ts_pool_worker *workers;
+    /* The number of workers. */
+    size_t threads;
+    /* The threads started for the workers but the first. */
+    pthread_t *ids;
+    size_t started;
+    /* Guards the sleeping of the workers and the end of the pool. */
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    /* Set while a parallel call is running, for the workers to look for
+     * tasks.
+     * */
+    atomic_bool running;
+    bool stop;
+    /* Taken by threads outside of the pool during their parallel calls. */
+    pthread_mutex_t call;
+
+    /* Runs fn on the range in parallel, in parts of up to grain indexes. */
+    void (*parallel_for)(ts_pool_t *self, size_t begin, size_t end, size_t grain,
+                         ts_pool_for_fn fn, void *ctx);
+
+    /* Reduces the range in parallel, see ts_pool_parallel_reduce. */
+    void (*parallel_reduce)(ts_pool_t *self, size_t begin, size_t end, size_t grain,
+                            void *result, size_t result_size,
+                            ts_pool_map_fn map, ts_pool_join_fn join, void *ctx);
+};
+
+/* Runs fn on the range in parallel, in parts of up to grain indexes, and
+ * returns once all of them ran.
+ * */
+extern void ts_pool_parallel_for(ts_pool_t *pool, size_t begin, size_t end, size_t grain,
+                                 ts_pool_for_fn fn, void *ctx);
+
+/* Reduces the range in parallel. The result holds the identity of the
+ * reduction on call, of result_size bytes. Each part of up to grain
+ * indexes is mapped into a copy of the identity, and the copies are joined
+ * from left to right into the result, so join only needs to be
+ * associative. If the memory for the copies could not be allocated, the
+ * whole range is mapped at once into the result.
+ * */
+extern void ts_pool_parallel_reduce(ts_pool_t *pool, size_t begin, size_t end, size_t grain,
+                                    void *result, size_t result_size,
+                                    ts_pool_map_fn map, ts_pool_join_fn join, void *ctx);
+
+/* Returns the number of threads of the pool, with the calling one. */
+extern size_t ts_pool_threads(ts_pool_t *pool);
+
+/* Returns a pointer to a new allocated pool of the given number of
+ * threads, counting the calling one, or of one thread per processor for 0.
+ * A pool of one thread starts no thread.
+ * */
+extern ts_pool_t *ts_pool_new(size_t threads);
+
+/* Used to stop the threads of a pool and free its allocated memory. */
+extern void ts_pool_free(ts_pool_t **pool);
+
+#endif /* _3S_POOL_HEADER */
@@ -0,0 +1,168 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * MIT License                                                                       *
+ *                                                                                   *
+ * Copyright (c) 2022-2024 Anaxímeno Brito                                           *
+ *                                                                                   *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy      *
+ * of this software and associated documentation files (the "Software"), to deal     *
+ * in the Software without restriction, including without limitation the rights      *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell         *
+ * copies of the Software, and to permit persons to whom the Software is             *
+ * furnished to do so, subject to the following conditions:                          *
+ *                                                                                   *
+ * The above copyright notice and this permission notice shall be included in all    *
+ * copies or substantial portions of the Software.                                   *
+ *                                                                                   *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR        *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,          *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE       *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER            *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,     *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE     *
+ * SOFTWARE.                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef _3S_PERSISTENT_TREE_HEADER
+#define _3S_PERSISTENT_TREE_HEADER
+
+#include "./core.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+/* The most height an AVL tree can reach when holding SIZE_MAX values. */
+#define TS_PTREE_MAX_HEIGHT 96
+
+typedef struct ts_ptree_t ts_ptree_t;
+typedef struct ts_ptree_snapshot_t ts_ptree_snapshot_t;
+typedef struct ts_ptree_iter_t ts_ptree_iter_t;
+
+/* A value shared by all the copies of the node that holds it. */
+struct ts_ptree_value
+{
+    /* The number of nodes holding this value. */
+    atomic_size_t refs;
+    /* The value itself. */
+    struct ts_generic_t value;
+};
+
+/* Represents a unique node of the persistent tree. Nodes are never changed
+ * after being created; an insertion or removal copies the nodes on the
+ * path to the root, and shares every other node with the older versions.
+ * */
+struct ts_ptree_node
+{
+    /* The left node. */
+    struct ts_ptree_node *left;
+    /* The right node. */
+    struct ts_ptree_node *right;
+    /* The value stored in this node. */
+    struct ts_ptree_value *value;
+    /* The number of parents and snapshots referencing this node. */
+    atomic_size_t refs;
+    /* The height of the subtree rooted on this node, one for leaves. */
+    int height;
+};
+
+/* Point in time view of a persistent tree. It is not changed by later
+ * insertions or removals, and can be read without locks while the tree
+ * keeps being changed.
+ * */
+struct ts_ptree_snapshot_t
+{
+    /* The root node of the tree at the moment of the snapshot. */
+    struct ts_ptree_node *root;
+    /* The number of values in the snapshot. */
+    size_t length;
+    /* The number of holders of this snapshot, including the tree itself
+     * while it is its current version.
+     * */
+    atomic_size_t refs;
+};
+
+/* Walks the values of a snapshot in order. */
+struct ts_ptree_iter_t
+{
+    /* The nodes whose values are still to be visited. */
+    struct ts_ptree_node *stack[TS_PTREE_MAX_HEIGHT];
+    /* The number of nodes on the stack. */
+    int depth;
+
+    /* Returns the next value, or NULL after the last one. */
+    ts_generic_t (*next)(ts_ptree_iter_t *self);
+};
+
+/* Ordered set, balanced with the AVL algorithm, that keeps its old versions
+ * alive while they are being read. Writers are serialized with each other,
+ * but never wait for readers. Values of different type classes are ordered
+ * by their class, see ts_generic_t_class_cmp.
+ * */
+struct ts_ptree_t
+{
+    /* The current version of the tree. */
+    ts_ptree_snapshot_t *current;
+    /* Serializes the writers. */
+    pthread_mutex_t writer_lock;
+    /* Held while replacing or taking a reference to the current version. */
+    pthread_mutex_t version_lock;
+
+    /* Adds a copy of the value to the tree, returning false if an
+     * equal value was already there, or if the memory could not be
+     * allocated. The given value is freed either way.
+     * */
+    bool (*add)(ts_ptree_t *self, ts_generic_t value);
+
+    /* Removes the value equal to the given one, returning false if
+     * there was none, or if the memory could not be allocated.
+     * */
+    bool (*remove)(ts_ptree_t *self, ts_generic_t value);
+
+    /* Returns a snapshot of the tree as it is now, in O(1). */
+    ts_ptree_snapshot_t *(*snapshot)(ts_ptree_t *self);
+};
+
+/* Adds a copy of the value to the tree, returning false if an equal
+ * value was already there, or if the memory for the copied path could
+ * not be allocated, in which case the current version is kept. The
+ * given value is freed either way.
+ * */
+extern bool ts_ptree_add(ts_ptree_t *tree, ts_generic_t value);
+
+/* Removes the value equal to the given one, returning false if there
+ * was none, or if the memory for the copied path could not be allocated,
+ * in which case the current version is kept.
+ * */
+extern bool ts_ptree_remove(ts_ptree_t *tree, ts_generic_t value);
+
+/* Returns a snapshot of the tree as it is now, in O(1). It must be
+ * released with ts_ptree_snapshot_release.
+ * */
+extern ts_ptree_snapshot_t *ts_ptree_snapshot(ts_ptree_t *tree);
+
+/* Releases the snapshot, freeing the nodes no longer referenced by
+ * any other snapshot nor by the tree.
+ * */
+extern void ts_ptree_snapshot_release(ts_ptree_snapshot_t **snapshot);
+
+/* Returns the value of the snapshot equal to the given one, or NULL. */
+extern ts_generic_t ts_ptree_snapshot_find(ts_ptree_snapshot_t *snapshot, ts_generic_t value);
+
+/* Returns an iterator positioned before the first value of the snapshot.
+ * The snapshot must outlive the iterator.
+ * */
+extern ts_ptree_iter_t ts_ptree_iter(ts_ptree_snapshot_t *snapshot);
+
+/* Returns the next value of the iterator, or NULL after the last one. */
+extern ts_generic_t ts_ptree_iter_next(ts_ptree_iter_t *iter);
+
+/* Returns a pointer new allocated persistent tree. */
+extern ts_ptree_t *ts_ptree_new(void);
+
+/* Used to free the allocated memory of a persistent tree. Snapshots
+ * taken from it stay valid until they are released.
+ * */
+extern void ts_ptree_free(ts_ptree_t **tree);
+
+#endif /* _3S_PERSISTENT_TREE_HEADER */
@@ -0,0 +1,75 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * MIT License                                                                       *
+ *                                                                                   *
+ * Copyright (c) 2022-2024 Anaxímeno Brito                                           *
+ *                                                                                   *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy      *
+ * of this software and associated documentation files (the "Software"), to deal     *
+ * in the Software without restriction, including without limitation the rights      *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell         *
+ * copies of the Software, and to permit persons to whom the Software is             *
+ * furnished to do so, subject to the following conditions:                          *
+ *                                                                                   *
+ * The above copyright notice and this permission notice shall be included in all    *
+ * copies or substantial portions of the Software.                                   *
+ *                                                                                   *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR        *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,          *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE       *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER            *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,     *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE     *
+ * SOFTWARE.                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#ifndef _3S_SORT_HEADER
+#define _3S_SORT_HEADER
+
+#include "./core.h"
+#include "./pool.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+/* Below this number of values, sorts compare the values instead of
+ * distributing them by radix.
+ * */
+#define TS_SORT_RADIX_THRESHOLD 64
+
+/* Below this number of values, parallel sorts run on the calling thread. */
+#define TS_SORT_PARALLEL_THRESHOLD 65536
+
+/* The number of parts, and of buckets, per thread of parallel sorts, so
+ * threads done early can steal the buckets left.
+ * */
+#define TS_SORT_PARTS_PER_THREAD 4
+
+/* The number of values sampled per bucket to pick the bucket splitters. */
+#define TS_SORT_OVERSAMPLING 32
+
+/* Sorts the values in the order of ts_generic_t_class_cmp, keeping equal
+ * values in their order. The values are first split by type class. Then
+ * numbers go through an LSD radix sort of their keys, strings and bytes
+ * through an MSD radix sort of their bytes, and the other classes, or
+ * fewer values than TS_SORT_RADIX_THRESHOLD, through a merge sort.
+ * Returns false, with the values untouched, if the memory could not be
+ * allocated.
+ * */
+extern bool ts_sort_values(ts_generic_t *values, size_t length);
+
+/* Sorts the values like ts_sort_values, with a merge sort only. */
+extern bool ts_sort_values_merge(ts_generic_t *values, size_t length);
+
+/* Sorts the values like ts_sort_values, on the threads of the pool. The
+ * values are split in TS_SORT_PARTS_PER_THREAD buckets per thread by
+ * splitters sampled from them, and each bucket is then sorted with
+ * ts_sort_values. When stable, values equal to a splitter all go to the
+ * same bucket, which keeps their order but may leave the buckets
+ * unbalanced when the values have many duplicates; when not stable, they
+ * are spread over the buckets of the equal splitters. With a NULL pool, a
+ * pool of one thread or fewer values than TS_SORT_PARALLEL_THRESHOLD, the
+ * values are sorted on the calling thread. Returns false, with the values
+ * untouched, if the memory could not be allocated.
+ * */
+extern bool ts_sort_values_parallel(ts_pool_t *pool, ts_generic_t *values, size_t length, bool stable);
+
+#endif /* _3S_SORT_HEADER */
@@ -60,6 +60,7 @@ typedef enum ts_tree_printing_order
 } ts_tree_printing_order;
 
 typedef struct ts_tree_t ts_tree_t;
+typedef struct ts_tree_cursor_t ts_tree_cursor_t;
 
 /* Represents a unique node of the binary tree. */
 struct ts_tree_node
@@ -82,6 +83,10 @@ struct ts_tree_node
      * to the parent's depth.
      * */
     size_t depth;
+    /* The number of nodes in the subtree rooted on this node. It is only
+     * maintained on trees created with ts_tree_new_order_statistic.
+     * */
+    size_t size;
 };
 
 /* Represents the binary tree as a whole. */
@@ -101,6 +106,26 @@ struct ts_tree_t
     /* This is the full depth of this tree. It stores the depth of the most deep node.
      * */
     size_t full_depth;
+    /* The number of nodes on each depth, which tells when removing the
+     * deepest nodes lowers the full depth.
+     * */
+    size_t *depth_counts;
+    /* The number of depths the depth counts have room for. */
+    size_t depth_counts_capacity;
+    /* The number of values stored in this tree, not counting the ones
+     * stored on the side trees.
+     * */
+    size_t size;
+    /* When true, every node keeps the size of its subtree, so
+     * ts_tree_select and ts_tree_rank run in O(depth).
+     * */
+    bool order_statistics;
+    /* Block of nodes allocated at once by ts_tree_from_sorted. Nodes inside
+     * it are released together with the tree, not one by one.
+     * */
+    struct ts_tree_node *node_block;
+    /* The number of nodes in the node block. */
+    size_t node_block_length;
     /* Represents the type of value that is being stored in this particular instance
      * of this structure.
      * */
@@ -129,10 +154,47 @@ struct ts_tree_t
     /* Prints the binary tree in the order determined by the param ord. */
     void (*display)(ts_tree_t *self, ts_tree_printing_order order);
 
-    /* Balances the binary tree using the AVL tree balancing algorithm. */
+    /* Balances the binary tree using the Day-Stout-Warren algorithm, in
+     * linear time and with rotations only.
+     * */
     void (*balance)(ts_tree_t *self);
 };
 
+/* Walks the values of a tree in order, following the parent pointers of
+ * the nodes, so no recursion or auxiliary stack is needed. When the end of
+ * one tree is reached the walk continues on its side trees.
+ * */
+struct ts_tree_cursor_t
+{
+    /* The tree being walked. */
+    ts_tree_t *tree;
+    /* The tree, from the chain of side trees, holding the current node. */
+    ts_tree_t *current;
+    /* The node the cursor is on, or NULL if it is out of the tree. */
+    struct ts_tree_node *node;
+
+    /* Moves the cursor to the first value that is not less than the key.
+     * Returns false if there's no such value on the tree.
+     * */
+    bool (*seek)(ts_tree_cursor_t *self, ts_generic_t key);
+
+    /* Moves the cursor to the next value in order. Returns false
+     * when the cursor walks past the last value.
+     * */
+    bool (*next)(ts_tree_cursor_t *self);
+
+    /* Moves the cursor to the previous value in order. Returns false
+     * when the cursor walks past the first value.
+     * */
+    bool (*prev)(ts_tree_cursor_t *self);
+
+    /* Returns the value the cursor is on, or NULL if it is out of the tree. */
+    ts_generic_t (*value)(ts_tree_cursor_t *self);
+};
+
+/* Function called for each value visited by ts_tree_range. */
+typedef void (*ts_tree_visit_fn)(ts_generic_t value, void *ctx);
+
 /* Adds a new value to the binary tree. If the value was added successfully
  * it returns the depth of the value, else the constant TS_TREE_VALUE_NOT_ADDED.
  * */
@@ -146,7 +208,9 @@ extern int ts_tree_search(ts_tree_t *tree, ts_generic_t value);
 
 /* Removes the given value completely from the ts_tree_t.
  * If the repetition strategy chosen was APPEND_(LEFT/RIGTH),
- * other repetitions will also be removed.
+ * other repetitions will also be removed. The value may be one held
+ * by the tree, like the value of a node or of a cursor. Only the depths
+ * of the subtree that moves up one level are updated on each removal.
  * */
 extern void ts_tree_remove(ts_tree_t *tree, ts_generic_t value);
 
@@ -156,9 +220,59 @@ extern char *ts_tree_repr(ts_tree_t *tree, ts_tree_printing_order order);
 /* Prints the binary tree in the order determined by the param ord. */
 extern void ts_tree_display(ts_tree_t *tree, ts_tree_printing_order order);
 
-/* Balances the binary tree using the AVL tree balancing algorithm. */
+/* Balances the binary tree using the Day-Stout-Warren algorithm, in
+ * linear time and with rotations only.
+ * */
 extern void ts_tree_balance(ts_tree_t *tree);
 
+/* Returns the value at the k-th position (starting at zero) of the in order
+ * walk of the tree, or NULL if the tree has k or less values. It takes O(depth)
+ * on order statistic trees, else the tree is walked up to the k-th value.
+ * */
+extern ts_generic_t ts_tree_select(ts_tree_t *tree, size_t k);
+
+/* Returns how many values come before the given one on the in order walk of
+ * the tree, that is the position where ts_tree_cursor_seek would put a cursor.
+ * It takes O(depth) on order statistic trees.
+ * */
+extern size_t ts_tree_rank(ts_tree_t *tree, ts_generic_t value);
+
+/* Returns a cursor over the given tree. It is positioned on
+ * the first value of the tree, if there's any.
+ * */
+extern ts_tree_cursor_t ts_tree_cursor(ts_tree_t *tree);
+
+/* Moves the cursor to the first value that is not less than the key.
+ * Returns false if there's no such value on the tree.
+ * */
+extern bool ts_tree_cursor_seek(ts_tree_cursor_t *cursor, ts_generic_t key);
+
+/* Moves the cursor to the first value of the tree. */
+extern bool ts_tree_cursor_first(ts_tree_cursor_t *cursor);
+
+/* Moves the cursor to the last value of the tree. */
+extern bool ts_tree_cursor_last(ts_tree_cursor_t *cursor);
+
+/* Moves the cursor to the next value in order. Returns false
+ * when the cursor walks past the last value.
+ * */
+extern bool ts_tree_cursor_next(ts_tree_cursor_t *cursor);
+
+/* Moves the cursor to the previous value in order. Returns false
+ * when the cursor walks past the first value.
+ * */
+extern bool ts_tree_cursor_prev(ts_tree_cursor_t *cursor);
+
+/* Returns the value the cursor is on, or NULL if it is out of the tree. */
+extern ts_generic_t ts_tree_cursor_value(ts_tree_cursor_t *cursor);
+
+/* Calls the callback, in order, for every value between lo and hi (both
+ * inclusive), only descending into the subtrees that can hold them.
+ * Returns the number of values visited.
+ * */
+extern size_t ts_tree_range(ts_tree_t *tree, ts_generic_t lo, ts_generic_t hi,
+                            ts_tree_visit_fn callback, void *ctx);
+
 /* Returns a pointer new allocated binary tree.
  * The parameter on_dup_value_strat is used to determine
  * what to do when a value is added more than once to the
@@ -166,6 +280,27 @@ extern void ts_tree_balance(ts_tree_t *tree);
  * */
 extern ts_tree_t *ts_tree_new(ts_tree_on_dup_value_strategy on_dup_value_strat);
 
+/* Same as ts_tree_new, but the returned tree keeps the size of every
+ * subtree on its nodes, enabling O(depth) ts_tree_select and ts_tree_rank.
+ * */
+extern ts_tree_t *ts_tree_new_order_statistic(ts_tree_on_dup_value_strategy on_dup_value_strat);
+
+/* Builds a perfectly balanced tree from an array of values sorted in
+ * ascending order, in O(n) and allocating all its nodes in one block.
+ * Values of different type classes must come in separate runs, each one
+ * being stored in its own side tree. The tree takes ownership of the
+ * values, duplicates discarded by the TS_TREE_IGNORE strategy are freed.
+ * If the values are not sorted NULL is returned and they are left untouched.
+ * */
+extern ts_tree_t *ts_tree_from_sorted(ts_generic_t *values, size_t n,
+                                      ts_tree_on_dup_value_strategy on_dup_value_strat);
+
+/* Same as ts_tree_from_sorted, but the values are sorted first, by type
+ * class and then by value. The given array itself is not reordered.
+ * */
+extern ts_tree_t *ts_tree_from_unsorted(ts_generic_t *values, size_t n,
+                                        ts_tree_on_dup_value_strategy on_dup_value_strat);
+
 /* Used to free the allocated memory of a binary tree structure. */
 extern void ts_tree_free(ts_tree_t **tree);
 
@@ -0,0 +1,130 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * MIT License                                                                       *
+ *                                                                                   *
+ * Copyright (c) 2022-2024 Anaxímeno Brito                                           *
+ *                                                                                   *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy      *
+ * of this software and associated documentation files (the "Software"), to deal     *
+ * in the Software without restriction, including without limitation the rights      *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell         *
+ * copies of the Software, and to permit persons to whom the Software is             *
+ * furnished to do so, subject to the following conditions:                          *
+ *                                                                                   *
+ * The above copyright notice and this permission notice shall be included in all    *
+ * copies or substantial portions of the Software.                                   *
+ *                                                                                   *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR        *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,          *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE       *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER            *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,     *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE     *
+ * SOFTWARE.                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#ifndef _3S_VECTOR_HEADER
+#define _3S_VECTOR_HEADER
+
+#include "./core.h"
+#include "./llist.h"
+#include "./pool.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+/* The capacity of the first allocation of a vector. */
+#define TS_VECTOR_INITIAL_CAPACITY 8
+
+typedef struct ts_vector_t ts_vector_t;
+
+/* Growable array of values, stored one after the other rather than
+ * pointed at. The vector owns its values: values added are moved into it,
+ * and values removed are moved out or released. Pointers to the values
+ * are only valid until the vector is changed.
+ * */
+struct ts_vector_t
+{
+    /* The values. */
+    struct ts_generic_t *values;
+    /* The number of values. */
+    size_t length;
+    /* The number of values that fit in the allocated memory. */
+    size_t capacity;
+
+    /* Moves the value to the end of the vector, freeing what is left of it.
+     * Returns false, with the value untouched, if the memory could not be
+     * allocated.
+     * */
+    bool (*push)(ts_vector_t *self, ts_generic_t value);
+
+    /* Moves the last value into out, or releases it for a NULL out.
+     * Returns false if the vector is empty.
+     * */
+    bool (*pop)(ts_vector_t *self, struct ts_generic_t *out);
+
+    /* Returns the value at the given index, or NULL out of bounds. */
+    ts_generic_t (*get)(ts_vector_t *self, size_t index);
+};
+
+/* Moves the value to the end of the vector, freeing what is left of it.
+ * Returns false, with the value untouched, if the memory could not be
+ * allocated.
+ * */
+extern bool ts_vector_push(ts_vector_t *vector, ts_generic_t value);
+
+/* Moves the last value into out, or releases it for a NULL out. Returns
+ * false if the vector is empty.
+ * */
+extern bool ts_vector_pop(ts_vector_t *vector, struct ts_generic_t *out);
+
+/* Returns the value at the given index, or NULL out of bounds. */
+extern ts_generic_t ts_vector_get(ts_vector_t *vector, size_t index);
+
+/* Moves the value to the given index, shifting the values from there,
+ * like ts_vector_push. Indexes past the end add at the end.
+ * */
+extern bool ts_vector_insert(ts_vector_t *vector, size_t index, ts_generic_t value);
+
+/* Releases the value at the given index, shifting the values after it.
+ * Returns false out of bounds.
+ * */
+extern bool ts_vector_erase(ts_vector_t *vector, size_t index);
+
+/* Makes room for the given number of values. Returns false if the memory
+ * could not be allocated.
+ * */
+extern bool ts_vector_reserve(ts_vector_t *vector, size_t capacity);
+
+/* Returns the number of values. */
+extern size_t ts_vector_length(ts_vector_t *vector);
+
+/* Searches the key on a vector sorted like ts_sort_values. Sets index to
+ * the first value not less than the key, and returns true if that value
+ * is equal to it.
+ * */
+extern bool ts_vector_binary_search(ts_vector_t *vector, ts_generic_t key, size_t *index);
+
+/* Sorts the values like ts_sort_values_parallel, with the pool, or on
+ * the calling thread for a NULL pool. Returns false, with the vector
+ * untouched, if the memory could not be allocated.
+ * */
+extern bool ts_vector_sort(ts_vector_t *vector, ts_pool_t *pool, bool stable);
+
+/* Returns a new allocated vector holding copies of the values of the
+ * list, or NULL if the memory could not be allocated.
+ * */
+extern ts_vector_t *ts_vector_from_list(ts_list_t *list);
+
+/* Returns a new allocated list holding copies of the values of the
+ * vector, or NULL if the memory could not be allocated.
+ * */
+extern ts_list_t *ts_vector_to_list(ts_vector_t *vector);
+
+/* Returns a pointer to a new allocated vector, with room for the given
+ * number of values.
+ * */
+extern ts_vector_t *ts_vector_new(size_t capacity);
+
+/* Used to free the allocated memory of a vector and its values. */
+extern void ts_vector_free(ts_vector_t **vector);
+
+#endif /* _3S_VECTOR_HEADER */
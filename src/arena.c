@@ -0,0 +1,162 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * MIT License                                                                       *
+ *                                                                                   *
+ * Copyright (c) 2022-2024 Anaxímeno Brito                                           *
+ *                                                                                   *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy      *
+ * of this software and associated documentation files (the "Software"), to deal     *
+ * in the Software without restriction, including without limitation the rights      *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell         *
+ * copies of the Software, and to permit persons to whom the Software is             *
+ * furnished to do so, subject to the following conditions:                          *
+ *                                                                                   *
+ * The above copyright notice and this permission notice shall be included in all    *
+ * copies or substantial portions of the Software.                                   *
+ *                                                                                   *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR        *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,          *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE       *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER            *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,     *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE     *
+ * SOFTWARE.                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#include "../include/3s/arena.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+/* The bytes of a chunk start after its header, rounded to the alignment. */
+#define CHUNK_HEADER_SIZE \
+    ((sizeof(struct ts_arena_chunk) + TS_ARENA_ALIGNMENT - 1) & ~(size_t)(TS_ARENA_ALIGNMENT - 1))
+
+static unsigned char *chunk_bytes(struct ts_arena_chunk *chunk)
+{
+    return (unsigned char *)chunk + CHUNK_HEADER_SIZE;
+}
+
+static struct ts_arena_chunk *chunk_new(size_t size, struct ts_arena_chunk *next)
+{
+    if (size > SIZE_MAX - CHUNK_HEADER_SIZE)
+        return NULL;
+
+    struct ts_arena_chunk *chunk = (struct ts_arena_chunk *)malloc(CHUNK_HEADER_SIZE + size);
+
+    if (chunk != NULL)
+    {
+        chunk->next = next;
+        chunk->size = size;
+        chunk->used = 0;
+    }
+
+    return chunk;
+}
+
+extern void *ts_arena_alloc(ts_arena_t *arena, size_t size)
+{
+    struct ts_arena_chunk *chunk = arena->chunks;
+
+    if (size > SIZE_MAX - TS_ARENA_ALIGNMENT)
+        return NULL;
+
+    size = (size + TS_ARENA_ALIGNMENT - 1) & ~(size_t)(TS_ARENA_ALIGNMENT - 1);
+
+    if (size > arena->chunk_size / 4)
+    {
+        // kept behind the current chunk, which still has room to give
+        struct ts_arena_chunk *large = chunk_new(size, chunk != NULL ? chunk->next : NULL);
+
+        if (large == NULL)
+            return NULL;
+
+        large->used = size;
+        if (chunk != NULL)
+            chunk->next = large;
+        else
+            arena->chunks = large;
+
+        arena->allocated += size;
+        return chunk_bytes(large);
+    }
+
+    if (chunk == NULL || chunk->size - chunk->used < size)
+    {
+        chunk = chunk_new(arena->chunk_size, chunk);
+
+        if (chunk == NULL)
+            return NULL;
+
+        arena->chunks = chunk;
+    }
+
+    void *memory = chunk_bytes(chunk) + chunk->used;
+    chunk->used += size;
+    arena->allocated += size;
+    return memory;
+}
+
+extern char *ts_arena_strndup(ts_arena_t *arena, const char *string, size_t length)
+{
+    char *copy = (char *)ts_arena_alloc(arena, length + 1);
+
+    if (copy != NULL)
+    {
+        memcpy(copy, string, length);
+        copy[length] = '\0';
+    }
+
+    return copy;
+}
+
+extern void ts_arena_reset(ts_arena_t *arena)
+{
+    struct ts_arena_chunk *chunk = arena->chunks;
+
+    if (chunk != NULL)
+    {
+        struct ts_arena_chunk *next = chunk->next;
+
+        while (next != NULL)
+        {
+            struct ts_arena_chunk *previous = next->next;
+            free(next);
+            next = previous;
+        }
+
+        chunk->next = NULL;
+        chunk->used = 0;
+    }
+
+    arena->allocated = 0;
+}
+
+extern ts_arena_t *ts_arena_new(size_t chunk_size)
+{
+    ts_arena_t *arena = (ts_arena_t *)malloc(sizeof(ts_arena_t));
+
+    if (arena != NULL)
+    {
+        arena->chunks = NULL;
+        arena->chunk_size = chunk_size != 0 ? chunk_size : TS_ARENA_DEFAULT_CHUNK_SIZE;
+        arena->allocated = 0;
+    }
+
+    return arena;
+}
+
+extern void ts_arena_free(ts_arena_t **arena)
+{
+    if (*arena != NULL)
+    {
+        ts_arena_reset(*arena);
+        free((*arena)->chunks);
+        free(*arena);
+        *arena = NULL;
+    }
+
+#ifdef _MAKE_ROBUST_CHECK
+    assert(*arena == NULL);
+#endif
+}
@@ -0,0 +1,920 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * MIT License                                                                       *
+ *                                                                                   *
+ * Copyright (c) 2022-2024 Anaxímeno Brito                                           *
+ *                                                                                   *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy      *
+ * of this software and associated documentation files (the "Software"), to deal     *
+ * in the Software without restriction, including without limitation the rights      *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell         *
+ * copies of the Software, and to permit persons to whom the Software is             *
+ * furnished to do so, subject to the following conditions:                          *
+ *                                                                                   *
+ * The above copyright notice and this permission notice shall be included in all    *
+ * copies or substantial portions of the Software.                                   *
+ *                                                                                   *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR        *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,          *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE       *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER            *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,     *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE     *
+ * SOFTWARE.                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#include "../include/3s/core.h"
+#include "../include/3s/art.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include <assert.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define IS_LEAF(PTR) (((uintptr_t)(PTR)) & 1)
+#define AS_LEAF(PTR) ((struct ts_art_leaf *)((uintptr_t)(PTR) & ~(uintptr_t)1))
+#define TAG_LEAF(LEAF) ((void *)((uintptr_t)(LEAF) | 1))
+#define MIN(A, B) ((A) < (B) ? (A) : (B))
+
+struct node4
+{
+    struct ts_art_node n;
+    uint8_t keys[4];
+    void *children[4];
+};
+
+struct node16
+{
+    struct ts_art_node n;
+    uint8_t keys[16];
+    void *children[16];
+};
+
+struct node48
+{
+    struct ts_art_node n;
+    /* The slot of the child for each byte, plus one, zero meaning no child. */
+    uint8_t index[256];
+    void *children[48];
+};
+
+struct node256
+{
+    struct ts_art_node n;
+    void *children[256];
+};
+
+/* Frame of the explicit stack used to walk the tree in order. */
+struct walk_frame
+{
+    struct ts_art_node *node;
+    /* The next child to visit, -1 while the leaf slot was not visited. */
+    int position;
+};
+
+static struct ts_art_node *node_new(ts_art_node_type type)
+{
+    static const size_t sizes[] = {sizeof(struct node4), sizeof(struct node16),
+                                   sizeof(struct node48), sizeof(struct node256)};
+    struct ts_art_node *node = (struct ts_art_node *)calloc(1, sizes[type]);
+
+    if (node != NULL)
+        node->type = (uint8_t)type;
+
+    return node;
+}
+
+/* Copies everything but the type and the children from one node to another. */
+static void copy_header(struct ts_art_node *dest, const struct ts_art_node *src)
+{
+    dest->count = src->count;
+    dest->prefix_length = src->prefix_length;
+    memcpy(dest->prefix, src->prefix, MIN(src->prefix_length, TS_ART_MAX_PREFIX));
+    dest->leaf = src->leaf;
+}
+
+static struct ts_art_leaf *leaf_new(const uint8_t *key, size_t length, ts_generic_t value)
+{
+    struct ts_art_leaf *leaf = (struct ts_art_leaf *)malloc(sizeof(struct ts_art_leaf) + length);
+
+    if (leaf != NULL)
+    {
+        leaf->value = value;
+        leaf->length = length;
+        memcpy(leaf->key, key, length);
+    }
+
+    return leaf;
+}
+
+static void leaf_free(struct ts_art_leaf *leaf)
+{
+    ts_generic_t_free(leaf->value);
+    free(leaf);
+}
+
+static bool leaf_matches(const struct ts_art_leaf *leaf, const uint8_t *key, size_t length)
+{
+    return leaf->length == length && memcmp(leaf->key, key, length) == 0;
+}
+
+/* Returns a reference to the child for the byte, or NULL. */
+static void **find_child(struct ts_art_node *node, uint8_t byte)
+{
+    switch (node->type)
+    {
+    case TS_ART_NODE4:
+    {
+        struct node4 *n4 = (struct node4 *)node;
+        for (int i = 0; i < node->count; ++i)
+            if (n4->keys[i] == byte)
+                return &n4->children[i];
+        break;
+    }
+    case TS_ART_NODE16:
+    {
+        struct node16 *n16 = (struct node16 *)node;
+#ifdef __SSE2__
+        // compares the byte against the sixteen keys at once
+        const __m128i cmp = _mm_cmpeq_epi8(_mm_set1_epi8((char)byte),
+                                           _mm_loadu_si128((const __m128i *)n16->keys));
+        const int mask = _mm_movemask_epi8(cmp) & ((1 << node->count) - 1);
+
+        if (mask != 0)
+            return &n16->children[__builtin_ctz(mask)];
+#else
+        for (int i = 0; i < node->count; ++i)
+            if (n16->keys[i] == byte)
+                return &n16->children[i];
+#endif
+        break;
+    }
+    case TS_ART_NODE48:
+    {
+        struct node48 *n48 = (struct node48 *)node;
+        if (n48->index[byte] != 0)
+            return &n48->children[n48->index[byte] - 1];
+        break;
+    }
+    case TS_ART_NODE256:
+    {
+        struct node256 *n256 = (struct node256 *)node;
+        if (n256->children[byte] != NULL)
+            return &n256->children[byte];
+        break;
+    }
+    }
+
+    return NULL;
+}
+
+/* Returns the leaf with the least key below the tagged pointer. */
+static struct ts_art_leaf *minimum(void *ptr)
+{
+    while (ptr != NULL && !IS_LEAF(ptr))
+    {
+        struct ts_art_node *node = (struct ts_art_node *)ptr;
+
+        // a key ending on the node is a prefix of all the others below it
+        if (node->leaf != NULL)
+            return node->leaf;
+
+        switch (node->type)
+        {
+        case TS_ART_NODE4:
+            ptr = ((struct node4 *)node)->children[0];
+            break;
+        case TS_ART_NODE16:
+            ptr = ((struct node16 *)node)->children[0];
+            break;
+        case TS_ART_NODE48:
+        {
+            struct node48 *n48 = (struct node48 *)node;
+            int byte = 0;
+            while (n48->index[byte] == 0)
+                byte++;
+            ptr = n48->children[n48->index[byte] - 1];
+            break;
+        }
+        case TS_ART_NODE256:
+        {
+            struct node256 *n256 = (struct node256 *)node;
+            int byte = 0;
+            while (n256->children[byte] == NULL)
+                byte++;
+            ptr = n256->children[byte];
+            break;
+        }
+        }
+    }
+
+    return ptr != NULL ? AS_LEAF(ptr) : NULL;
+}
+
+/* Returns how many bytes of the stored prefix match the key from the
+ * depth. Bytes of the path past TS_ART_MAX_PREFIX are not checked.
+ * */
+static uint32_t check_prefix(const struct ts_art_node *node, const uint8_t *key, size_t length, size_t depth)
+{
+    const size_t max = MIN(MIN(node->prefix_length, TS_ART_MAX_PREFIX), length - depth);
+    uint32_t i = 0;
+
+    while (i < max && node->prefix[i] == key[depth + i])
+        i++;
+
+    return i;
+}
+
+/* Returns the index of the first byte of the compressed path that differs
+ * from the key from the depth. Bytes past the stored prefix are read from
+ * a leaf below the node, all of them sharing the whole path.
+ * */
+static uint32_t prefix_mismatch(struct ts_art_node *node, const uint8_t *key, size_t length, size_t depth)
+{
+    uint32_t i = check_prefix(node, key, length, depth);
+
+    if (i == TS_ART_MAX_PREFIX && node->prefix_length > TS_ART_MAX_PREFIX)
+    {
+        const struct ts_art_leaf *leaf = minimum(node);
+        const size_t max = MIN(node->prefix_length, MIN(leaf->length, length) - depth);
+
+        while (i < max && leaf->key[depth + i] == key[depth + i])
+            i++;
+    }
+
+    return i;
+}
+
+/* Adds the child for the byte, growing the node and updating the
+ * reference to it when it is full.
+ * */
+static bool add_child(void **ref, struct ts_art_node *node, uint8_t byte, void *child)
+{
+    switch (node->type)
+    {
+    case TS_ART_NODE4:
+    case TS_ART_NODE16:
+    {
+        const int capacity = node->type == TS_ART_NODE4 ? 4 : 16;
+        uint8_t *keys = node->type == TS_ART_NODE4 ? ((struct node4 *)node)->keys : ((struct node16 *)node)->keys;
+        void **children = node->type == TS_ART_NODE4 ? ((struct node4 *)node)->children : ((struct node16 *)node)->children;
+
+        if (node->count < capacity)
+        {
+            int position = 0;
+
+            // the keys are kept sorted for the ordered iteration
+            while (position < node->count && keys[position] < byte)
+                position++;
+
+            memmove(keys + position + 1, keys + position, node->count - position);
+            memmove(children + position + 1, children + position, (node->count - position) * sizeof(void *));
+            keys[position] = byte;
+            children[position] = child;
+            node->count++;
+            return true;
+        }
+
+        struct ts_art_node *grown = node_new(node->type == TS_ART_NODE4 ? TS_ART_NODE16 : TS_ART_NODE48);
+
+        if (grown == NULL)
+            return false;
+
+        copy_header(grown, node);
+        if (grown->type == TS_ART_NODE16)
+        {
+            memcpy(((struct node16 *)grown)->keys, keys, capacity);
+            memcpy(((struct node16 *)grown)->children, children, capacity * sizeof(void *));
+        }
+        else
+        {
+            for (int i = 0; i < capacity; ++i)
+            {
+                ((struct node48 *)grown)->index[keys[i]] = (uint8_t)(i + 1);
+                ((struct node48 *)grown)->children[i] = children[i];
+            }
+        }
+
+        free(node);
+        *ref = grown;
+        return add_child(ref, grown, byte, child);
+    }
+    case TS_ART_NODE48:
+    {
+        struct node48 *n48 = (struct node48 *)node;
+
+        if (node->count < 48)
+        {
+            int slot = 0;
+
+            // removals can leave holes anywhere in the slots
+            while (n48->children[slot] != NULL)
+                slot++;
+
+            n48->index[byte] = (uint8_t)(slot + 1);
+            n48->children[slot] = child;
+            node->count++;
+            return true;
+        }
+
+        struct node256 *grown = (struct node256 *)node_new(TS_ART_NODE256);
+
+        if (grown == NULL)
+            return false;
+
+        copy_header(&grown->n, node);
+        for (int i = 0; i < 256; ++i)
+            if (n48->index[i] != 0)
+                grown->children[i] = n48->children[n48->index[i] - 1];
+
+        free(node);
+        *ref = grown;
+        return add_child(ref, &grown->n, byte, child);
+    }
+    case TS_ART_NODE256:
+        ((struct node256 *)node)->children[byte] = child;
+        node->count++;
+        return true;
+    }
+
+    return false;
+}
+
+/* Replaces a node left with a single entry by that entry, a child node
+ * taking over the compressed path of its parent.
+ * */
+static void collapse(void **ref, struct ts_art_node *node)
+{
+    if (node->type != TS_ART_NODE4 || node->count + (node->leaf != NULL) > 1)
+        return;
+
+    struct node4 *n4 = (struct node4 *)node;
+
+    if (node->count == 0)
+        *ref = TAG_LEAF(node->leaf);
+    else if (IS_LEAF(n4->children[0]))
+        *ref = n4->children[0];
+    else
+    {
+        struct ts_art_node *child = (struct ts_art_node *)n4->children[0];
+        uint8_t prefix[TS_ART_MAX_PREFIX];
+        uint32_t length = MIN(node->prefix_length, TS_ART_MAX_PREFIX);
+
+        memcpy(prefix, node->prefix, length);
+        if (length < TS_ART_MAX_PREFIX)
+            prefix[length++] = n4->keys[0];
+        if (length < TS_ART_MAX_PREFIX)
+        {
+            const uint32_t extra = MIN(child->prefix_length, TS_ART_MAX_PREFIX - length);
+            memcpy(prefix + length, child->prefix, extra);
+            length += extra;
+        }
+
+        memcpy(child->prefix, prefix, length);
+        child->prefix_length += node->prefix_length + 1;
+        *ref = child;
+    }
+
+    free(node);
+}
+
+/* Removes the child for the byte, shrinking the node and updating the
+ * reference to it when it gets sparse enough.
+ * */
+static void remove_child(void **ref, struct ts_art_node *node, uint8_t byte, void **child)
+{
+    switch (node->type)
+    {
+    case TS_ART_NODE4:
+    case TS_ART_NODE16:
+    {
+        uint8_t *keys = node->type == TS_ART_NODE4 ? ((struct node4 *)node)->keys : ((struct node16 *)node)->keys;
+        void **children = node->type == TS_ART_NODE4 ? ((struct node4 *)node)->children : ((struct node16 *)node)->children;
+        const int position = (int)(child - children);
+
+        memmove(keys + position, keys + position + 1, node->count - position - 1);
+        memmove(children + position, children + position + 1, (node->count - position - 1) * sizeof(void *));
+        node->count--;
+
+        if (node->type == TS_ART_NODE4)
+            collapse(ref, node);
+        else if (node->count == 3)
+        {
+            struct node4 *shrunk = (struct node4 *)node_new(TS_ART_NODE4);
+
+            if (shrunk != NULL)
+            {
+                copy_header(&shrunk->n, node);
+                memcpy(shrunk->keys, keys, 3);
+                memcpy(shrunk->children, children, 3 * sizeof(void *));
+                free(node);
+                *ref = shrunk;
+            }
+        }
+        break;
+    }
+    case TS_ART_NODE48:
+    {
+        struct node48 *n48 = (struct node48 *)node;
+
+        n48->children[n48->index[byte] - 1] = NULL;
+        n48->index[byte] = 0;
+        node->count--;
+
+        if (node->count == 12)
+        {
+            struct node16 *shrunk = (struct node16 *)node_new(TS_ART_NODE16);
+
+            if (shrunk != NULL)
+            {
+                int position = 0;
+
+                copy_header(&shrunk->n, node);
+                for (int i = 0; i < 256; ++i)
+                {
+                    if (n48->index[i] != 0)
+                    {
+                        shrunk->keys[position] = (uint8_t)i;
+                        shrunk->children[position++] = n48->children[n48->index[i] - 1];
+                    }
+                }
+                free(node);
+                *ref = shrunk;
+            }
+        }
+        break;
+    }
+    case TS_ART_NODE256:
+    {
+        struct node256 *n256 = (struct node256 *)node;
+
+        n256->children[byte] = NULL;
+        node->count--;
+
+        if (node->count == 37)
+        {
+            struct node48 *shrunk = (struct node48 *)node_new(TS_ART_NODE48);
+
+            if (shrunk != NULL)
+            {
+                int slot = 0;
+
+                copy_header(&shrunk->n, node);
+                for (int i = 0; i < 256; ++i)
+                {
+                    if (n256->children[i] != NULL)
+                    {
+                        shrunk->index[i] = (uint8_t)(slot + 1);
+                        shrunk->children[slot++] = n256->children[i];
+                    }
+                }
+                free(node);
+                *ref = shrunk;
+            }
+        }
+        break;
+    }
+    }
+}
+
+/* Returns the next entry of the frame in order, the leaf slot first,
+ * or NULL when all of them were returned.
+ * */
+static void *next_entry(struct walk_frame *frame)
+{
+    struct ts_art_node *node = frame->node;
+
+    if (frame->position == -1)
+    {
+        frame->position = 0;
+        if (node->leaf != NULL)
+            return TAG_LEAF(node->leaf);
+    }
+
+    switch (node->type)
+    {
+    case TS_ART_NODE4:
+        if (frame->position < node->count)
+            return ((struct node4 *)node)->children[frame->position++];
+        break;
+    case TS_ART_NODE16:
+        if (frame->position < node->count)
+            return ((struct node16 *)node)->children[frame->position++];
+        break;
+    case TS_ART_NODE48:
+    {
+        struct node48 *n48 = (struct node48 *)node;
+        while (frame->position < 256)
+        {
+            const int byte = frame->position++;
+            if (n48->index[byte] != 0)
+                return n48->children[n48->index[byte] - 1];
+        }
+        break;
+    }
+    case TS_ART_NODE256:
+    {
+        struct node256 *n256 = (struct node256 *)node;
+        while (frame->position < 256)
+        {
+            void *child = n256->children[frame->position++];
+            if (child != NULL)
+                return child;
+        }
+        break;
+    }
+    }
+
+    return NULL;
+}
+
+/* Visits every leaf below the tagged pointer in order, freeing the nodes
+ * and the leaves behind when release is set. The walk uses an explicit
+ * stack, as the depth of the tree is only bounded by the key lengths.
+ * */
+static size_t walk(void *root, ts_art_visit_fn visit, void *ctx, bool release)
+{
+    size_t visited = 0;
+    size_t depth = 0;
+    size_t capacity = 32;
+    struct walk_frame *frames = NULL;
+    void *entry = root;
+
+    while (true)
+    {
+        if (entry != NULL && IS_LEAF(entry))
+        {
+            struct ts_art_leaf *leaf = AS_LEAF(entry);
+
+            if (visit != NULL)
+                visit((const char *)leaf->key, leaf->length, leaf->value, ctx);
+            if (release)
+                leaf_free(leaf);
+            visited++;
+        }
+        else if (entry != NULL)
+        {
+            if (frames == NULL || depth == capacity)
+            {
+                struct walk_frame *grown;
+
+                capacity = frames == NULL ? capacity : capacity * 2;
+                grown = (struct walk_frame *)realloc(frames, capacity * sizeof(struct walk_frame));
+
+                if (grown == NULL)
+                    break;
+                frames = grown;
+            }
+
+            frames[depth].node = (struct ts_art_node *)entry;
+            frames[depth++].position = -1;
+        }
+
+        entry = NULL;
+        while (depth > 0 && (entry = next_entry(&frames[depth - 1])) == NULL)
+        {
+            if (release)
+                free(frames[depth - 1].node);
+            depth--;
+        }
+
+        if (entry == NULL)
+            break;
+    }
+
+    free(frames);
+    return visited;
+}
+
+extern bool ts_art_add(ts_art_t *art, const char *key, size_t length, ts_generic_t value)
+{
+    const uint8_t *bytes = (const uint8_t *)key;
+    struct ts_art_leaf *leaf = leaf_new(bytes, length, value);
+    void **ref = &art->root;
+    size_t depth = 0;
+
+    if (leaf == NULL)
+    {
+        ts_generic_t_free(value);
+        return false;
+    }
+
+    while (*ref != NULL)
+    {
+        if (IS_LEAF(*ref))
+        {
+            struct ts_art_leaf *other = AS_LEAF(*ref);
+
+            if (leaf_matches(other, bytes, length))
+            {
+                leaf_free(leaf);
+                return false;
+            }
+
+            // both leaves go below a new node holding their common path
+            struct node4 *split = (struct node4 *)node_new(TS_ART_NODE4);
+            const size_t max = MIN(other->length, length);
+            size_t common = depth;
+
+            if (split == NULL)
+            {
+                leaf_free(leaf);
+                return false;
+            }
+
+            while (common < max && other->key[common] == bytes[common])
+                common++;
+
+            split->n.prefix_length = (uint32_t)(common - depth);
+            memcpy(split->n.prefix, bytes + depth, MIN(common - depth, TS_ART_MAX_PREFIX));
+
+            // a node4 with two children never grows, so it keeps its address
+            void *fresh = split;
+
+            if (common == other->length)
+                split->n.leaf = other;
+            else
+                add_child(&fresh, &split->n, other->key[common], *ref);
+
+            if (common == length)
+                split->n.leaf = leaf;
+            else
+                add_child(&fresh, &split->n, bytes[common], TAG_LEAF(leaf));
+
+            *ref = fresh;
+            art->length++;
+            return true;
+        }
+
+        struct ts_art_node *node = (struct ts_art_node *)*ref;
+
+        if (node->prefix_length != 0)
+        {
+            const uint32_t mismatch = prefix_mismatch(node, bytes, length, depth);
+
+            if (mismatch < node->prefix_length)
+            {
+                // the compressed path is split where the key leaves it
+                struct node4 *split = (struct node4 *)node_new(TS_ART_NODE4);
+
+                if (split == NULL)
+                {
+                    leaf_free(leaf);
+                    return false;
+                }
+
+                void *fresh = split;
+
+                split->n.prefix_length = mismatch;
+                memcpy(split->n.prefix, node->prefix, MIN(mismatch, TS_ART_MAX_PREFIX));
+
+                if (node->prefix_length <= TS_ART_MAX_PREFIX)
+                {
+                    add_child(&fresh, &split->n, node->prefix[mismatch], node);
+                    node->prefix_length -= mismatch + 1;
+                    memmove(node->prefix, node->prefix + mismatch + 1, node->prefix_length);
+                }
+                else
+                {
+                    const struct ts_art_leaf *lowest = minimum(node);
+
+                    add_child(&fresh, &split->n, lowest->key[depth + mismatch], node);
+                    node->prefix_length -= mismatch + 1;
+                    memcpy(node->prefix, lowest->key + depth + mismatch + 1,
+                           MIN(node->prefix_length, TS_ART_MAX_PREFIX));
+                }
+
+                if (depth + mismatch == length)
+                    split->n.leaf = leaf;
+                else
+                    add_child(&fresh, &split->n, bytes[depth + mismatch], TAG_LEAF(leaf));
+
+                *ref = fresh;
+                art->length++;
+                return true;
+            }
+
+            depth += node->prefix_length;
+        }
+
+        if (depth == length)
+        {
+            if (node->leaf != NULL)
+            {
+                leaf_free(leaf);
+                return false;
+            }
+
+            node->leaf = leaf;
+            art->length++;
+            return true;
+        }
+
+        void **child = find_child(node, bytes[depth]);
+
+        if (child == NULL)
+        {
+            if (!add_child(ref, node, bytes[depth], TAG_LEAF(leaf)))
+            {
+                leaf_free(leaf);
+                return false;
+            }
+
+            art->length++;
+            return true;
+        }
+
+        ref = child;
+        depth++;
+    }
+
+    *ref = TAG_LEAF(leaf);
+    art->length++;
+    return true;
+}
+
+extern ts_generic_t ts_art_search(ts_art_t *art, const char *key, size_t length)
+{
+    const uint8_t *bytes = (const uint8_t *)key;
+    void *ptr = art->root;
+    size_t depth = 0;
+
+    while (ptr != NULL)
+    {
+        if (IS_LEAF(ptr))
+            return leaf_matches(AS_LEAF(ptr), bytes, length) ? AS_LEAF(ptr)->value : NULL;
+
+        struct ts_art_node *node = (struct ts_art_node *)ptr;
+
+        if (node->prefix_length != 0)
+        {
+            if (check_prefix(node, bytes, length, depth) != MIN(node->prefix_length, TS_ART_MAX_PREFIX))
+                return NULL;
+            depth += node->prefix_length;
+        }
+
+        if (depth >= length)
+        {
+            // skipped bytes of the path are only checked here
+            if (depth == length && node->leaf != NULL && leaf_matches(node->leaf, bytes, length))
+                return node->leaf->value;
+            return NULL;
+        }
+
+        void **child = find_child(node, bytes[depth++]);
+        ptr = child != NULL ? *child : NULL;
+    }
+
+    return NULL;
+}
+
+extern bool ts_art_remove(ts_art_t *art, const char *key, size_t length)
+{
+    const uint8_t *bytes = (const uint8_t *)key;
+    void **ref = &art->root;
+    size_t depth = 0;
+
+    while (*ref != NULL)
+    {
+        if (IS_LEAF(*ref))
+        {
+            // only reached when the root itself is a leaf
+            if (!leaf_matches(AS_LEAF(*ref), bytes, length))
+                return false;
+
+            leaf_free(AS_LEAF(*ref));
+            *ref = NULL;
+            art->length--;
+            return true;
+        }
+
+        struct ts_art_node *node = (struct ts_art_node *)*ref;
+
+        if (node->prefix_length != 0)
+        {
+            if (check_prefix(node, bytes, length, depth) != MIN(node->prefix_length, TS_ART_MAX_PREFIX))
+                return false;
+            depth += node->prefix_length;
+        }
+
+        if (depth >= length)
+        {
+            if (depth > length || node->leaf == NULL || !leaf_matches(node->leaf, bytes, length))
+                return false;
+
+            leaf_free(node->leaf);
+            node->leaf = NULL;
+            collapse(ref, node);
+            art->length--;
+            return true;
+        }
+
+        void **child = find_child(node, bytes[depth]);
+
+        if (child == NULL)
+            return false;
+
+        if (IS_LEAF(*child))
+        {
+            struct ts_art_leaf *leaf = AS_LEAF(*child);
+
+            if (!leaf_matches(leaf, bytes, length))
+                return false;
+
+            remove_child(ref, node, bytes[depth], child);
+            leaf_free(leaf);
+            art->length--;
+            return true;
+        }
+
+        ref = child;
+        depth++;
+    }
+
+    return false;
+}
+
+extern size_t ts_art_iter(ts_art_t *art, ts_art_visit_fn visit, void *ctx)
+{
+    return walk(art->root, visit, ctx, false);
+}
+
+extern size_t ts_art_prefix(ts_art_t *art, const char *prefix, size_t length,
+                            ts_art_visit_fn visit, void *ctx)
+{
+    const uint8_t *bytes = (const uint8_t *)prefix;
+    void *ptr = art->root;
+    size_t depth = 0;
+
+    while (ptr != NULL)
+    {
+        if (IS_LEAF(ptr))
+        {
+            struct ts_art_leaf *leaf = AS_LEAF(ptr);
+
+            if (leaf->length < length || memcmp(leaf->key, bytes, length) != 0)
+                return 0;
+
+            visit((const char *)leaf->key, leaf->length, leaf->value, ctx);
+            return 1;
+        }
+
+        if (depth == length)
+            return walk(ptr, visit, ctx, false);
+
+        struct ts_art_node *node = (struct ts_art_node *)ptr;
+
+        if (node->prefix_length != 0)
+        {
+            // the whole path must match, as it is shared by every key below
+            const uint32_t mismatch = prefix_mismatch(node, bytes, length, depth);
+
+            if (mismatch < MIN(node->prefix_length, length - depth))
+                return 0;
+            if (depth + node->prefix_length >= length)
+                return walk(ptr, visit, ctx, false);
+
+            depth += node->prefix_length;
+        }
+
+        void **child = find_child(node, bytes[depth++]);
+        ptr = child != NULL ? *child : NULL;
+    }
+
+    return 0;
+}
+
+extern ts_art_t *ts_art_new(void)
+{
+    ts_art_t *art = (ts_art_t *)malloc(sizeof(ts_art_t));
+
+    if (art != NULL)
+    {
+        art->root = NULL;
+        art->length = 0;
+
+        /* Associated functions. */
+        art->add = &ts_art_add;
+        art->search = &ts_art_search;
+        art->remove = &ts_art_remove;
+    }
+
+    return art;
+}
+
+extern void ts_art_free(ts_art_t **art)
+{
+    if (*art != NULL)
+    {
+        walk((*art)->root, NULL, NULL, true);
+        free(*art);
+        *art = NULL;
+    }
+
+#ifdef _MAKE_ROBUST_CHECK
+    assert(*art == NULL);
+#endif
+}
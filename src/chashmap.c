@@ -0,0 +1,219 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * MIT License                                                                       *
+ *                                                                                   *
+ * Copyright (c) 2022-2024 Anaxímeno Brito                                           *
+ *                                                                                   *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy      *
+ * of this software and associated documentation files (the "Software"), to deal     *
+ * in the Software without restriction, including without limitation the rights      *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell         *
+ * copies of the Software, and to permit persons to whom the Software is             *
+ * furnished to do so, subject to the following conditions:                          *
+ *                                                                                   *
+ * The above copyright notice and this permission notice shall be included in all    *
+ * copies or substantial portions of the Software.                                   *
+ *                                                                                   *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR        *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,          *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE       *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER            *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,     *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE     *
+ * SOFTWARE.                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#include "../include/3s/core.h"
+#include "../include/3s/hashtable.h"
+#include "../include/3s/chashmap.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <assert.h>
+
+/* Returns the shard of the key. The high half of the hash is used, the
+ * tables of the shards probing with the low one.
+ * */
+static struct ts_chashmap_shard *shard_of(ts_chashmap_t *map, ts_generic_t key)
+{
+    const uint64_t hash = ts_generic_t_hash(key);
+    return &map->shards[(size_t)(hash >> 32) & (map->shards_length - 1)];
+}
+
+/* Copies the value into out, leaving a none value there when the copy
+ * could not be allocated.
+ * */
+static bool copy_out(struct ts_generic_t *out, ts_generic_t value)
+{
+    if (ts_generic_t_copy_to(out, value))
+        return true;
+
+    out->type = TS_TYPE_NONE;
+    return false;
+}
+
+extern bool ts_chashmap_get(ts_chashmap_t *map, ts_generic_t key, struct ts_generic_t *out)
+{
+    struct ts_chashmap_shard *shard = shard_of(map, key);
+
+    pthread_rwlock_rdlock(&shard->lock);
+    ts_generic_t value = ts_hashtable_get(shard->table, key);
+    const bool found = value != NULL && copy_out(out, value);
+    pthread_rwlock_unlock(&shard->lock);
+
+    return found;
+}
+
+extern bool ts_chashmap_put(ts_chashmap_t *map, ts_generic_t key, ts_generic_t value)
+{
+    struct ts_chashmap_shard *shard = shard_of(map, key);
+
+    pthread_rwlock_wrlock(&shard->lock);
+    const bool added = ts_hashtable_put(shard->table, key, value);
+    pthread_rwlock_unlock(&shard->lock);
+
+    return added;
+}
+
+extern bool ts_chashmap_get_or_insert(ts_chashmap_t *map, ts_generic_t key, ts_generic_t value,
+                                      struct ts_generic_t *out)
+{
+    struct ts_chashmap_shard *shard = shard_of(map, key);
+    bool added = false;
+
+    pthread_rwlock_wrlock(&shard->lock);
+    ts_generic_t stored = ts_hashtable_get(shard->table, key);
+
+    // nothing is added when the value can not be copied out
+    if (stored == NULL && copy_out(out, value))
+        added = ts_hashtable_put(shard->table, key, value);
+    else
+    {
+        if (stored != NULL)
+            copy_out(out, stored);
+        ts_generic_t_free(key);
+        ts_generic_t_free(value);
+    }
+    pthread_rwlock_unlock(&shard->lock);
+
+    return added;
+}
+
+extern bool ts_chashmap_compute_if_absent(ts_chashmap_t *map, ts_generic_t key,
+                                          ts_chashmap_compute_fn compute, void *ctx,
+                                          struct ts_generic_t *out)
+{
+    struct ts_chashmap_shard *shard = shard_of(map, key);
+    bool added = false;
+
+    pthread_rwlock_wrlock(&shard->lock);
+    ts_generic_t stored = ts_hashtable_get(shard->table, key);
+
+    if (stored == NULL && (stored = compute(key, ctx)) != NULL)
+    {
+        // the created value is dropped when it can not be copied out
+        if (copy_out(out, stored))
+            added = ts_hashtable_put(shard->table, key, stored);
+        else
+        {
+            ts_generic_t_free(key);
+            ts_generic_t_free(stored);
+        }
+    }
+    else
+    {
+        if (stored != NULL)
+            copy_out(out, stored);
+        ts_generic_t_free(key);
+    }
+    pthread_rwlock_unlock(&shard->lock);
+
+    return added;
+}
+
+extern bool ts_chashmap_remove(ts_chashmap_t *map, ts_generic_t key)
+{
+    struct ts_chashmap_shard *shard = shard_of(map, key);
+
+    pthread_rwlock_wrlock(&shard->lock);
+    const bool removed = ts_hashtable_remove(shard->table, key);
+    pthread_rwlock_unlock(&shard->lock);
+
+    return removed;
+}
+
+extern size_t ts_chashmap_length(ts_chashmap_t *map)
+{
+    size_t length = 0;
+
+    for (size_t i = 0; i < map->shards_length; ++i)
+    {
+        pthread_rwlock_rdlock(&map->shards[i].lock);
+        length += map->shards[i].table->length;
+        pthread_rwlock_unlock(&map->shards[i].lock);
+    }
+
+    return length;
+}
+
+extern ts_chashmap_t *ts_chashmap_new(size_t shards)
+{
+    ts_chashmap_t *map = (ts_chashmap_t *)malloc(sizeof(ts_chashmap_t));
+    size_t length = 1;
+
+    if (map == NULL)
+        return NULL;
+
+    while (length < (shards != 0 ? shards : TS_CHASHMAP_DEFAULT_SHARDS))
+        length *= 2;
+
+    map->shards = (struct ts_chashmap_shard *)aligned_alloc(TS_CACHE_LINE_SIZE,
+                                                           length * sizeof(struct ts_chashmap_shard));
+    map->shards_length = 0;
+
+    if (map->shards == NULL)
+    {
+        free(map);
+        return NULL;
+    }
+
+    for (; map->shards_length < length; ++map->shards_length)
+    {
+        struct ts_chashmap_shard *shard = &map->shards[map->shards_length];
+
+        shard->table = ts_hashtable_new(TS_HASHTABLE_DEFAULT_LOAD, true);
+        if (shard->table == NULL)
+        {
+            ts_chashmap_free(&map);
+            return NULL;
+        }
+        pthread_rwlock_init(&shard->lock, NULL);
+    }
+
+    /* Associated functions. */
+    map->get = &ts_chashmap_get;
+    map->put = &ts_chashmap_put;
+    map->remove = &ts_chashmap_remove;
+
+    return map;
+}
+
+extern void ts_chashmap_free(ts_chashmap_t **map)
+{
+    if (*map != NULL)
+    {
+        for (size_t i = 0; i < (*map)->shards_length; ++i)
+        {
+            ts_hashtable_free(&(*map)->shards[i].table);
+            pthread_rwlock_destroy(&(*map)->shards[i].lock);
+        }
+
+        free((*map)->shards);
+        free(*map);
+        *map = NULL;
+    }
+
+#ifdef _MAKE_ROBUST_CHECK
+    assert(*map == NULL);
+#endif
+}
@@ -27,6 +27,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <assert.h>
 
@@ -39,6 +41,22 @@
      (TS_EQUAL * (a == b)) + \
      (TS_GREATER * (a > b)))
 
+/* Compares two characters as unsigned, like strcmp and memcmp do. */
+#define CHAR_CMP(C1, C2) CMP((unsigned char)(C1), (unsigned char)(C2))
+
+/* Owned strings whose characters are on the heap, or on an arena. */
+#define STORAGE_HEAP 0xFF
+#define STORAGE_ARENA 0xFE
+
+/* Returns true for the types storing their data as an owned string. */
+#define HAS_OWNED_STORAGE(TYPE) ((TYPE) == TS_TYPE_OWNED_STRING || (TYPE) == TS_TYPE_BYTES)
+
+/* 2^64, the first double above all the 64 bits integers. */
+#define TWO_TO_64 18446744073709551616.0
+
+_Static_assert(sizeof(struct ts_owned_string) == TS_STRING_INLINE_CAPACITY + 2,
+               "owned strings should fill the value union, with the storage as their last byte");
+
 /* Wraps the common processes for initializing and assigning value into a new
  * ts generic value.
  * */
@@ -92,12 +110,207 @@ extern ts_generic_t ts_new_pointer(void *value) WRAP({
     wrapped->type = TS_TYPE_POINTER;
 });
 
+extern ts_generic_t ts_new_int64(int64_t value) WRAP({
+    wrapped->data.integer64 = value;
+    wrapped->type = TS_TYPE_INT64;
+});
+
+extern ts_generic_t ts_new_uint64(uint64_t value) WRAP({
+    wrapped->data.uinteger64 = value;
+    wrapped->type = TS_TYPE_UINT64;
+});
+
+extern ts_generic_t ts_new_bool(bool value) WRAP({
+    wrapped->data.boolean = value;
+    wrapped->type = TS_TYPE_BOOL;
+});
+
 extern ts_generic_t ts_new_none(void) WRAP({
     wrapped->type = TS_TYPE_NONE;
 });
 
+/* Stores the characters on the owned string, inline if they fit, otherwise
+ * on the arena if any, or else on the heap. Returns false if the memory
+ * could not be allocated.
+ * */
+static bool owned_string_set(struct ts_owned_string *owned, ts_arena_t *arena, const char *chars, size_t length)
+{
+    if (length <= TS_STRING_INLINE_CAPACITY)
+    {
+        memcpy(owned->inline_chars, chars, length);
+        owned->inline_chars[length] = '\0';
+        owned->storage = (uint8_t)length;
+        return true;
+    }
+
+    if (length > UINT32_MAX)
+        return false;
+
+    char *copy = arena != NULL ? ts_arena_strndup(arena, chars, length) : (char *)malloc(length + 1);
+
+    if (copy == NULL)
+        return false;
+
+    if (arena == NULL)
+    {
+        memcpy(copy, chars, length);
+        copy[length] = '\0';
+    }
+
+    owned->outline.chars = copy;
+    owned->outline.length = (uint32_t)length;
+    owned->storage = arena != NULL ? STORAGE_ARENA : STORAGE_HEAP;
+    return true;
+}
+
+static const char *owned_string_chars(const struct ts_owned_string *owned)
+{
+    return owned->storage <= TS_STRING_INLINE_CAPACITY ? owned->inline_chars : owned->outline.chars;
+}
+
+static size_t owned_string_length(const struct ts_owned_string *owned)
+{
+    return owned->storage <= TS_STRING_INLINE_CAPACITY ? owned->storage : owned->outline.length;
+}
+
+extern ts_generic_t ts_new_owned_string(const char *value)
+{
+    return ts_new_owned_string_n(value, strlen(value));
+}
+
+extern ts_generic_t ts_new_owned_string_n(const char *chars, size_t length)
+{
+    return ts_new_owned_string_in(NULL, chars, length);
+}
+
+extern ts_generic_t ts_new_owned_string_in(ts_arena_t *arena, const char *chars, size_t length) WRAP({
+    wrapped->type = TS_TYPE_OWNED_STRING;
+
+    if (!owned_string_set(&wrapped->data.owned, arena, chars, length))
+    {
+        free(wrapped);
+        return NULL;
+    }
+});
+
+extern ts_generic_t ts_new_bytes(const void *bytes, size_t length) WRAP({
+    wrapped->type = TS_TYPE_BYTES;
+
+    if (!owned_string_set(&wrapped->data.owned, NULL, (const char *)bytes, length))
+    {
+        free(wrapped);
+        return NULL;
+    }
+});
+
+extern bool ts_generic_t_copy_to(struct ts_generic_t *out, ts_generic_t value)
+{
+    *out = *value;
+
+    // long owned strings get characters of their own, the copy is left
+    // empty, and safe to release, when they could not be allocated
+    if (HAS_OWNED_STORAGE(value->type) && value->data.owned.storage > TS_STRING_INLINE_CAPACITY &&
+        !owned_string_set(&out->data.owned, NULL, value->data.owned.outline.chars, value->data.owned.outline.length))
+    {
+        owned_string_set(&out->data.owned, NULL, "", 0);
+        return false;
+    }
+
+    return true;
+}
+
+extern ts_generic_t ts_generic_t_copy(ts_generic_t value) WRAP({
+    if (!ts_generic_t_copy_to(wrapped, value))
+    {
+        free(wrapped);
+        return NULL;
+    }
+});
+
+extern const char *ts_generic_t_chars(ts_generic_t value)
+{
+    switch (value->type)
+    {
+    case TS_TYPE_STRING:
+        return value->data.string;
+    case TS_TYPE_OWNED_STRING:
+    case TS_TYPE_BYTES:
+        return owned_string_chars(&value->data.owned);
+    default:
+        return NULL;
+    }
+}
+
+extern size_t ts_generic_t_length(ts_generic_t value)
+{
+    switch (value->type)
+    {
+    case TS_TYPE_STRING:
+        return strlen(value->data.string);
+    case TS_TYPE_OWNED_STRING:
+    case TS_TYPE_BYTES:
+        return owned_string_length(&value->data.owned);
+    default:
+        return 0;
+    }
+}
+
+extern void ts_generic_t_release(ts_generic_t value)
+{
+    if (HAS_OWNED_STORAGE(value->type))
+    {
+        if (value->data.owned.storage == STORAGE_HEAP)
+            free(value->data.owned.outline.chars);
+        owned_string_set(&value->data.owned, NULL, "", 0);
+    }
+}
+
+extern void ts_generic_t_free(ts_generic_t value)
+{
+    if (value != NULL)
+    {
+        ts_generic_t_release(value);
+        free(value);
+    }
+}
+
 extern char *ts_generic_t_repr(ts_generic_t value)
 {
+    // strings may be longer than the buffer of the other values
+    if (value->type == TS_TYPE_STRING || value->type == TS_TYPE_OWNED_STRING)
+    {
+        const size_t length = ts_generic_t_length(value);
+        char *quoted = (char *)malloc(length + 3);
+
+        if (quoted != NULL)
+        {
+            quoted[0] = '\'';
+            memcpy(quoted + 1, ts_generic_t_chars(value), length);
+            quoted[length + 1] = '\'';
+            quoted[length + 2] = '\0';
+        }
+
+        return quoted;
+    }
+
+    // bytes are shown in hexadecimal, as b'00ff'
+    if (value->type == TS_TYPE_BYTES)
+    {
+        const size_t length = ts_generic_t_length(value);
+        const uint8_t *bytes = (const uint8_t *)ts_generic_t_chars(value);
+        char *hex = (char *)malloc(2 * length + 4);
+
+        if (hex != NULL)
+        {
+            strcpy(hex, "b'");
+            for (size_t i = 0; i < length; ++i)
+                sprintf(hex + 2 + 2 * i, "%02x", bytes[i]);
+            strcpy(hex + 2 + 2 * length, "'");
+        }
+
+        return hex;
+    }
+
     char *buffer = (char *)calloc(TS_MAX_REPR_STR_BUF_SIZE, sizeof(char));
 
     if (buffer != NULL)
@@ -116,8 +329,14 @@ extern char *ts_generic_t_repr(ts_generic_t value)
         case TS_TYPE_FLOAT64:
             sprintf(buffer, "%lf", value->data.float64);
             break;
-        case TS_TYPE_STRING:
-            sprintf(buffer, "'%s'", value->data.string);
+        case TS_TYPE_INT64:
+            sprintf(buffer, "%" PRId64, value->data.integer64);
+            break;
+        case TS_TYPE_UINT64:
+            sprintf(buffer, "%" PRIu64, value->data.uinteger64);
+            break;
+        case TS_TYPE_BOOL:
+            sprintf(buffer, "%s", value->data.boolean ? "true" : "false");
             break;
         case TS_TYPE_CHARACTER:
             sprintf(buffer, "'%c'", value->data.character);
@@ -147,29 +366,134 @@ extern void ts_generic_t_display(ts_generic_t value)
     free(repr);
 }
 
-/* Compares an double precision floating point value with a generic_t value. */
-extern int
-ts_cmp_float64_and_generic_t(const double value1, const ts_generic_t value2)
+/* A number, either an integer by its sign and magnitude, so all the 64 bits
+ * integers fit, or a double. Zero is never negative.
+ * */
+struct number
+{
+    bool is_real;
+    bool negative;
+    uint64_t magnitude;
+    double real;
+};
+
+static struct number integer_number(bool negative, uint64_t magnitude)
+{
+    return (struct number){.is_real = false, .negative = negative && magnitude != 0, .magnitude = magnitude};
+}
+
+static struct number signed_number(int64_t value)
+{
+    // negated as unsigned, as INT64_MIN has no positive counterpart
+    return integer_number(value < 0, value < 0 ? 0 - (uint64_t)value : (uint64_t)value);
+}
+
+static struct number real_number(double value)
+{
+    return (struct number){.is_real = true, .real = value};
+}
+
+/* Reads the number held by the value, returning false for non numbers. */
+static bool number_of(ts_generic_t value, struct number *number)
 {
-    switch (value2->type)
+    switch (value->type)
     {
     case TS_TYPE_INTEGER:
-        return CMP(value1, value2->data.integer);
+        *number = signed_number(value->data.integer);
+        return true;
     case TS_TYPE_UNSIGNED:
-        return CMP(value1, value2->data.uinteger);
+        *number = integer_number(false, value->data.uinteger);
+        return true;
+    case TS_TYPE_INT64:
+        *number = signed_number(value->data.integer64);
+        return true;
+    case TS_TYPE_UINT64:
+        *number = integer_number(false, value->data.uinteger64);
+        return true;
     case TS_TYPE_FLOAT32:
-        return CMP(value1, value2->data.float32);
+        *number = real_number(value->data.float32);
+        return true;
     case TS_TYPE_FLOAT64:
-        return CMP(value1, value2->data.float64);
-    case TS_TYPE_CHARACTER:
-    case TS_TYPE_STRING:
-    case TS_TYPE_POINTER:
-    case TS_TYPE_NONE:
+        *number = real_number(value->data.float64);
+        return true;
     default:
-        return TS_DIFFERENT;
+        return false;
     }
 }
 
+static int cmp_integers(bool negative1, uint64_t magnitude1, bool negative2, uint64_t magnitude2)
+{
+    if (negative1 != negative2)
+        return negative1 ? TS_LESS : TS_GREATER;
+
+    return negative1 ? CMP(magnitude2, magnitude1) : CMP(magnitude1, magnitude2);
+}
+
+/* Compares an integer with a double without rounding either: the whole
+ * part of the double is compared as an integer, and its fraction breaks
+ * the ties.
+ * */
+static int cmp_integer_real(bool negative, uint64_t magnitude, double real)
+{
+    if (real != real)
+        return TS_LESS;
+
+    const bool real_negative = real < 0;
+    const double real_magnitude = real_negative ? -real : real;
+
+    if (real_magnitude >= TWO_TO_64)
+        return real_negative ? TS_GREATER : TS_LESS;
+
+    const uint64_t whole = (uint64_t)real_magnitude;
+    const int cmp = cmp_integers(negative, magnitude, real_negative && whole != 0, whole);
+
+    if (cmp != TS_EQUAL || real_magnitude == (double)whole)
+        return cmp;
+
+    // the fraction takes the double away from zero
+    return real_negative ? TS_GREATER : TS_LESS;
+}
+
+static int cmp_reals(double real1, double real2)
+{
+    if (real1 != real1)
+        return real2 != real2 ? TS_EQUAL : TS_GREATER;
+    if (real2 != real2)
+        return TS_LESS;
+
+    return CMP(real1, real2);
+}
+
+static int cmp_numbers(struct number number1, struct number number2)
+{
+    if (!number1.is_real && !number2.is_real)
+        return cmp_integers(number1.negative, number1.magnitude, number2.negative, number2.magnitude);
+    if (!number1.is_real)
+        return cmp_integer_real(number1.negative, number1.magnitude, number2.real);
+    if (!number2.is_real)
+        return -cmp_integer_real(number2.negative, number2.magnitude, number1.real);
+
+    return cmp_reals(number1.real, number2.real);
+}
+
+/* Compares a number with a generic_t value. */
+static int cmp_number_and_generic_t(struct number number1, const ts_generic_t value2)
+{
+    struct number number2;
+
+    if (!number_of(value2, &number2))
+        return TS_DIFFERENT;
+
+    return cmp_numbers(number1, number2);
+}
+
+/* Compares an double precision floating point value with a generic_t value. */
+extern int
+ts_cmp_float64_and_generic_t(const double value1, const ts_generic_t value2)
+{
+    return cmp_number_and_generic_t(real_number(value1), value2);
+}
+
 /* Compares an simple precision value with a generic_t value. */
 extern int
 ts_cmp_float32_and_generic_t(const float value1, const ts_generic_t value2)
@@ -181,14 +505,42 @@ ts_cmp_float32_and_generic_t(const float value1, const ts_generic_t value2)
 extern int
 ts_cmp_uint_and_generic_t(const uint32_t value1, const ts_generic_t value2)
 {
-    return ts_cmp_float64_and_generic_t((double)value1, value2);
+    return cmp_number_and_generic_t(integer_number(false, value1), value2);
 }
 
 /* Compares an integer with a generic_t value. */
 extern int
 ts_cmp_int_and_generic_t(const int32_t value1, const ts_generic_t value2)
 {
-    return ts_cmp_float64_and_generic_t((double)value1, value2);
+    return cmp_number_and_generic_t(signed_number(value1), value2);
+}
+
+/* Compares a 64 bits integer with a generic_t value. */
+extern int
+ts_cmp_int64_and_generic_t(const int64_t value1, const ts_generic_t value2)
+{
+    return cmp_number_and_generic_t(signed_number(value1), value2);
+}
+
+/* Compares a 64 bits unsigned integer with a generic_t value. */
+extern int
+ts_cmp_uint64_and_generic_t(const uint64_t value1, const ts_generic_t value2)
+{
+    return cmp_number_and_generic_t(integer_number(false, value1), value2);
+}
+
+/* Compares byte values by their bytes and then their lengths. */
+static int bytes_cmp(ts_generic_t value1, ts_generic_t value2)
+{
+    if (value1->type != TS_TYPE_BYTES || value2->type != TS_TYPE_BYTES)
+        return TS_DIFFERENT;
+
+    const size_t length1 = ts_generic_t_length(value1);
+    const size_t length2 = ts_generic_t_length(value2);
+    const int cmp = memcmp(ts_generic_t_chars(value1), ts_generic_t_chars(value2),
+                           length1 < length2 ? length1 : length2);
+
+    return cmp != 0 ? CMP(cmp, 0) : CMP(length1, length2);
 }
 
 /* Compares an char value with a generic_t value. */
@@ -197,7 +549,7 @@ ts_cmp_char_and_generic_t(const char value1, const ts_generic_t value2)
 {
     if (value2->type == TS_TYPE_CHARACTER)
     {
-        return CMP(value1, value2->data.character);
+        return CHAR_CMP(value1, value2->data.character);
     }
     else if (value2->type == TS_TYPE_STRING)
     {
@@ -210,14 +562,14 @@ ts_cmp_char_and_generic_t(const char value1, const ts_generic_t value2)
         else if (strlen(_value2) == 1)
         {
             // the string as just one character, then compare the characters
-            return CMP(value1, *_value2);
+            return CHAR_CMP(value1, *_value2);
         }
         else
         { // strlen(_value2) > 0
             // in this case, if the first character is equal as the character value
             // of value2, then the character value will be considered the lesser, and
             // the string as the greater.
-            const int cmp = CMP(value1, *_value2);
+            const int cmp = CHAR_CMP(value1, *_value2);
             return cmp == 0 ? TS_LESS : cmp;
         }
     }
@@ -241,20 +593,25 @@ ts_cmp_string_and_generic_t(char *value1, const ts_generic_t value2)
         else if (strlen(value1) == 1)
         {
             // the string as just one character, then compare the characters
-            return CMP(*value1, value2->data.character);
+            return CHAR_CMP(*value1, value2->data.character);
         }
         else
         { // strlen(value1) > 0
             // in this case, if the first character is equal as the character value
             // of value2, then the character value will be considered the lesser, and
             // the string as the greater.
-            const int cmp = CMP(*value1, value2->data.character);
+            const int cmp = CHAR_CMP(*value1, value2->data.character);
             return cmp == 0 ? TS_GREATER : cmp;
         }
     }
     else if (value2->type == TS_TYPE_STRING)
     {
-        const int cmp = strcmp(value1, value2->data.string);
+        // the same characters, as interned strings are when equal
+        if (value1 == value2->data.string)
+            return TS_EQUAL;
+
+        // strcmp only guarantees the sign of its result
+        const int cmp = CMP(strcmp(value1, value2->data.string), 0);
 
 #ifdef _MAKE_ROBUST_CHECK
         assert(
@@ -281,11 +638,51 @@ ts_cmp_pointer_and_generic_t(void *value1, const ts_generic_t value2)
     return TS_DIFFERENT;
 }
 
+/* Points at the characters of a text value, returning false for others.
+ * A character is the string of its character, or the empty string for
+ * the null character.
+ * */
+static bool text_of(ts_generic_t value, const char **chars, size_t *length)
+{
+    switch (value->type)
+    {
+    case TS_TYPE_CHARACTER:
+        *chars = &value->data.character;
+        *length = value->data.character != '\0';
+        return true;
+    case TS_TYPE_STRING:
+    case TS_TYPE_OWNED_STRING:
+        *chars = ts_generic_t_chars(value);
+        *length = ts_generic_t_length(value);
+        return true;
+    default:
+        return false;
+    }
+}
+
+/* Compares text values by their characters and then their lengths, as
+ * strcmp would without stopping at null characters.
+ * */
+static int text_cmp(ts_generic_t value1, ts_generic_t value2)
+{
+    const char *chars1, *chars2;
+    size_t length1, length2;
+
+    if (!text_of(value1, &chars1, &length1) || !text_of(value2, &chars2, &length2))
+        return TS_DIFFERENT;
+
+    const int cmp = memcmp(chars1, chars2, length1 < length2 ? length1 : length2);
+    return cmp != 0 ? CMP(cmp, 0) : CMP(length1, length2);
+}
+
 /* Compares two values and returns 0 if they are equal, 1 if value1 > value2,
  * and -1 if value2 > value1.
  * */
 extern int ts_generic_t_cmp(ts_generic_t value1, ts_generic_t value2)
 {
+    if (value1->type == TS_TYPE_OWNED_STRING || value2->type == TS_TYPE_OWNED_STRING)
+        return text_cmp(value1, value2);
+
     switch (value1->type)
     {
     case TS_TYPE_INTEGER:
@@ -296,6 +693,16 @@ extern int ts_generic_t_cmp(ts_generic_t value1, ts_generic_t value2)
         return ts_cmp_float32_and_generic_t(value1->data.float32, value2);
     case TS_TYPE_FLOAT64:
         return ts_cmp_float64_and_generic_t(value1->data.float64, value2);
+    case TS_TYPE_INT64:
+        return ts_cmp_int64_and_generic_t(value1->data.integer64, value2);
+    case TS_TYPE_UINT64:
+        return ts_cmp_uint64_and_generic_t(value1->data.uinteger64, value2);
+    case TS_TYPE_BOOL:
+        if (value2->type == TS_TYPE_BOOL)
+            return CMP(value1->data.boolean, value2->data.boolean);
+        return TS_DIFFERENT;
+    case TS_TYPE_BYTES:
+        return bytes_cmp(value1, value2);
     case TS_TYPE_CHARACTER:
         return ts_cmp_char_and_generic_t(value1->data.character, value2);
     case TS_TYPE_STRING:
@@ -310,3 +717,260 @@ extern int ts_generic_t_cmp(ts_generic_t value1, ts_generic_t value2)
         return TS_DIFFERENT;
     }
 }
+
+/* Returns the class of the type of the value. Only values of the
+ * same class can be compared with ts_generic_t_cmp.
+ * */
+extern ts_type_class ts_generic_t_type_class(ts_generic_t value)
+{
+    switch (value->type)
+    {
+    case TS_TYPE_INTEGER:
+    case TS_TYPE_UNSIGNED:
+    case TS_TYPE_FLOAT32:
+    case TS_TYPE_FLOAT64:
+    case TS_TYPE_INT64:
+    case TS_TYPE_UINT64:
+        return TS_CLASS_NUMERIC;
+    case TS_TYPE_CHARACTER:
+    case TS_TYPE_STRING:
+    case TS_TYPE_OWNED_STRING:
+        return TS_CLASS_TEXT;
+    case TS_TYPE_POINTER:
+        return TS_CLASS_POINTER;
+    case TS_TYPE_BOOL:
+        return TS_CLASS_BOOL;
+    case TS_TYPE_BYTES:
+        return TS_CLASS_BYTES;
+    case TS_TYPE_NONE:
+    default:
+        return TS_CLASS_NONE;
+    }
+}
+
+/* Compares two values like ts_generic_t_cmp, but values of different type
+ * classes are ordered by their class, so TS_DIFFERENT is never returned.
+ * */
+extern int ts_generic_t_class_cmp(ts_generic_t value1, ts_generic_t value2)
+{
+    const ts_type_class class1 = ts_generic_t_type_class(value1);
+    const ts_type_class class2 = ts_generic_t_type_class(value2);
+
+    if (class1 != class2)
+        return CMP(class1, class2);
+
+    return ts_generic_t_cmp(value1, value2);
+}
+
+/* Final mix of murmur3, spreading every input bit over the whole hash. */
+static uint64_t mix64(uint64_t hash)
+{
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+/* Hashes the bytes eight at a time, mixing the length in. */
+extern uint64_t ts_hash_bytes(const char *bytes, size_t length)
+{
+    uint64_t hash = 0x9e3779b97f4a7c15ULL ^ length;
+    uint64_t word;
+    size_t i = 0;
+
+    for (; i + 8 <= length; i += 8)
+    {
+        memcpy(&word, bytes + i, 8);
+        hash = (hash ^ mix64(word)) * 0x100000001b3ULL;
+    }
+
+    word = 0;
+    memcpy(&word, bytes + i, length - i);
+    return mix64(hash ^ word);
+}
+
+/* Hashes a number. Equal numbers are the same integer, or the same double
+ * when they have a fraction, so integral doubles are hashed as integers.
+ * */
+static uint64_t hash_number(struct number number)
+{
+    if (number.is_real)
+    {
+        const double real = number.real;
+        const double real_magnitude = real < 0 ? -real : real;
+        uint64_t bits;
+
+        if (real != real)
+            return mix64(TS_CLASS_NUMERIC) ^ 2;
+
+        if (real_magnitude < TWO_TO_64 && (double)(uint64_t)real_magnitude == real_magnitude)
+            return hash_number(integer_number(real < 0, (uint64_t)real_magnitude));
+
+        memcpy(&bits, &real, sizeof(bits));
+        return mix64(bits ^ TS_CLASS_NUMERIC) ^ 1;
+    }
+
+    return mix64((number.negative ? ~number.magnitude : number.magnitude) ^ TS_CLASS_NUMERIC);
+}
+
+/* Returns a 64 bits hash of the value, consistent with ts_generic_t_cmp:
+ * values comparing as equal, like the integer 1 and the float 1.0 or the
+ * character 'a' and the string "a", have the same hash.
+ * */
+extern uint64_t ts_generic_t_hash(ts_generic_t value)
+{
+    struct number number;
+
+    if (number_of(value, &number))
+        return hash_number(number);
+
+    switch (value->type)
+    {
+    case TS_TYPE_STRING:
+        return ts_hash_bytes(value->data.string, strlen(value->data.string));
+    case TS_TYPE_OWNED_STRING:
+        return ts_hash_bytes(owned_string_chars(&value->data.owned), owned_string_length(&value->data.owned));
+    case TS_TYPE_CHARACTER:
+        // hashed as the string of one character it is equal to
+        return ts_hash_bytes(&value->data.character, value->data.character != '\0');
+    case TS_TYPE_POINTER:
+        return mix64((uint64_t)(uintptr_t)value->data.pointer ^ TS_CLASS_POINTER);
+    case TS_TYPE_BOOL:
+        return mix64(value->data.boolean ^ ((uint64_t)TS_CLASS_BOOL << 32));
+    case TS_TYPE_BYTES:
+        return ts_hash_bytes(owned_string_chars(&value->data.owned), owned_string_length(&value->data.owned)) ^
+               TS_CLASS_BYTES;
+    case TS_TYPE_NONE:
+    default:
+        return mix64(TS_CLASS_NONE);
+    }
+}
+
+/* Writes the value big endian, when there is a buffer. */
+static void put_big_endian(uint8_t *buffer, uint64_t value, int size)
+{
+    for (int i = 0; buffer != NULL && i < size; ++i)
+        buffer[i] = (uint8_t)(value >> (8 * (size - 1 - i)));
+}
+
+/* Writes the key of a nonzero number from its sign, its binary exponent
+ * and its normalized mantissa, whose top bit is set.
+ * */
+static void encode_number(uint8_t *buffer, bool negative, int exponent, uint64_t mantissa)
+{
+    // the exponents of doubles start at -1074, those of integers end at 63
+    const uint16_t biased = (uint16_t)(exponent + 1100);
+
+    buffer[0] = negative ? 0x40 : 0xC0;
+    put_big_endian(buffer + 1, negative ? (uint16_t)~biased : biased, 2);
+    put_big_endian(buffer + 3, negative ? ~mantissa : mantissa, 8);
+}
+
+static void encode_integer(uint8_t *buffer, bool negative, uint64_t magnitude)
+{
+    const int zeros = __builtin_clzll(magnitude);
+    encode_number(buffer, negative, 63 - zeros, magnitude << zeros);
+}
+
+static void encode_real(uint8_t *buffer, double real)
+{
+    uint64_t bits;
+    memcpy(&bits, &real, sizeof(bits));
+
+    const bool negative = bits >> 63;
+    const int biased = (int)((bits >> 52) & 0x7FF);
+    const uint64_t fraction = bits & ((UINT64_C(1) << 52) - 1);
+
+    if (biased == 0x7FF)
+    {
+        // the infinities have the greatest exponent
+        encode_number(buffer, negative, 0xFFFF - 1100, 0);
+        return;
+    }
+
+    if (biased == 0)
+    {
+        // subnormals are normalized like integers
+        const int zeros = __builtin_clzll(fraction);
+        encode_number(buffer, negative, -1074 + 63 - zeros, fraction << zeros);
+        return;
+    }
+
+    encode_number(buffer, negative, biased - 1023, ((UINT64_C(1) << 52) | fraction) << 11);
+}
+
+/* Writes the bytes with their null bytes escaped, and the terminator. */
+static size_t encode_escaped(uint8_t *buffer, const char *bytes, size_t length)
+{
+    size_t size = 0;
+
+    for (size_t i = 0; i < length; ++i)
+    {
+        if (buffer != NULL)
+            buffer[size] = (uint8_t)bytes[i];
+        size++;
+
+        if (bytes[i] == '\0')
+        {
+            if (buffer != NULL)
+                buffer[size] = 0xFF;
+            size++;
+        }
+    }
+
+    if (buffer != NULL)
+        buffer[size] = buffer[size + 1] = 0x00;
+
+    return size + 2;
+}
+
+extern size_t ts_generic_t_encode_key(ts_generic_t value, uint8_t *buffer)
+{
+    const ts_type_class type_class = ts_generic_t_type_class(value);
+    uint8_t *body = buffer != NULL ? buffer + 1 : NULL;
+    struct number number;
+
+    if (buffer != NULL)
+        buffer[0] = (uint8_t)type_class;
+
+    if (number_of(value, &number))
+    {
+        if (buffer == NULL)
+            return TS_NUMBER_KEY_SIZE;
+
+        memset(body, 0, TS_NUMBER_KEY_SIZE - 1);
+
+        if (number.is_real && number.real != number.real)
+            body[0] = 0xFF;
+        else if (number.is_real ? number.real == 0 : number.magnitude == 0)
+            body[0] = 0x80;
+        else if (number.is_real)
+            encode_real(body, number.real);
+        else
+            encode_integer(body, number.negative, number.magnitude);
+
+        return TS_NUMBER_KEY_SIZE;
+    }
+
+    switch (value->type)
+    {
+    case TS_TYPE_CHARACTER:
+        return 1 + encode_escaped(body, &value->data.character, value->data.character != '\0');
+    case TS_TYPE_STRING:
+    case TS_TYPE_OWNED_STRING:
+    case TS_TYPE_BYTES:
+        return 1 + encode_escaped(body, ts_generic_t_chars(value), ts_generic_t_length(value));
+    case TS_TYPE_BOOL:
+        if (body != NULL)
+            body[0] = value->data.boolean;
+        return 2;
+    case TS_TYPE_POINTER:
+        put_big_endian(body, (uint64_t)(uintptr_t)value->data.pointer, 8);
+        return 9;
+    case TS_TYPE_NONE:
+    default:
+        return 1;
+    }
+}
@@ -0,0 +1,551 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * MIT License                                                                       *
+ *                                                                                   *
+ * Copyright (c) 2022-2024 Anaxímeno Brito                                           *
+ *                                                                                   *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy      *
+ * of this software and associated documentation files (the "Software"), to deal     *
+ * in the Software without restriction, including without limitation the rights      *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell         *
+ * copies of the Software, and to permit persons to whom the Software is             *
+ * furnished to do so, subject to the following conditions:                          *
+ *                                                                                   *
+ * The above copyright notice and this permission notice shall be included in all    *
+ * copies or substantial portions of the Software.                                   *
+ *                                                                                   *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR        *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,          *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE       *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER            *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,     *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE     *
+ * SOFTWARE.                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "../include/3s/core.h"
+#include "../include/3s/ctree.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include <assert.h>
+
+typedef struct ts_ctree_node *ts_ctree_node;
+
+#define LOCK(FLAG)                                                        \
+    while (atomic_flag_test_and_set_explicit((FLAG), memory_order_acquire)) \
+        ;
+#define UNLOCK(FLAG) atomic_flag_clear_explicit((FLAG), memory_order_release)
+
+static ts_ctree_node ts_ctree_node_new(ts_generic_t value)
+{
+    ts_ctree_node node = (ts_ctree_node)malloc(sizeof(struct ts_ctree_node));
+
+    if (node != NULL)
+    {
+        atomic_init(&node->left, NULL);
+        atomic_init(&node->right, NULL);
+        atomic_init(&node->removed, false);
+        atomic_flag_clear(&node->lock);
+        node->value = value;
+    }
+
+    return node;
+}
+
+/* Counts a reader in, on the counter of the current epoch, which is
+ * returned to count it out with read_unlock.
+ * */
+static unsigned read_lock(ts_ctree_t *tree)
+{
+    const unsigned epoch = atomic_load_explicit(&tree->epoch, memory_order_relaxed) & 1;
+
+    atomic_fetch_add_explicit(&tree->readers[epoch].count, 1, memory_order_relaxed);
+    /* Orders the count before the loads of the links, see synchronize. */
+    atomic_thread_fence(memory_order_seq_cst);
+
+    return epoch;
+}
+
+static void read_unlock(ts_ctree_t *tree, unsigned epoch)
+{
+    atomic_fetch_sub_explicit(&tree->readers[epoch].count, 1, memory_order_release);
+}
+
+/* Waits until the readers started before the call are done. Each counter
+ * is drained in turn, after switching the epoch so new readers count on
+ * the other one and the wait ends.
+ * */
+static void synchronize(ts_ctree_t *tree)
+{
+    /* Orders the replaced link before the loads of the counters, so a
+     * reader not counted yet will find the new link.
+     * */
+    atomic_thread_fence(memory_order_seq_cst);
+
+    for (int i = 0; i < 2; ++i)
+    {
+        const unsigned epoch = atomic_fetch_add_explicit(&tree->epoch, 1, memory_order_relaxed) & 1;
+
+        while (atomic_load_explicit(&tree->readers[epoch].count, memory_order_acquire) != 0)
+            sched_yield();
+    }
+}
+
+/* Walks down the tree without locks. Returns the node holding a value
+ * equal to the given one, or NULL. In that case, parent is set to the
+ * last node visited and link to its empty child where the value belongs.
+ * The number of links followed is stored on depth.
+ * */
+static ts_ctree_node find_node(ts_ctree_t *tree, ts_generic_t value,
+                               ts_ctree_node *parent, ts_ctree_node _Atomic **link, size_t *depth)
+{
+    ts_ctree_node _Atomic *current = &tree->root;
+    ts_ctree_node node = NULL;
+
+    *parent = NULL;
+    *depth = 0;
+
+    /* Links only go from empty to a node, or to a rebuilt subtree, so an
+     * acquire load is enough to see the node fully initialized.
+     * */
+    while ((node = atomic_load_explicit(current, memory_order_acquire)) != NULL)
+    {
+        const int cmp = ts_generic_t_class_cmp(value, node->value);
+
+        if (cmp == TS_EQUAL)
+            return node;
+
+        *parent = node;
+        *depth += 1;
+        current = cmp == TS_LESS ? &node->left : &node->right;
+    }
+
+    *link = current;
+    return NULL;
+}
+
+/* Returns the most depth allowed for a node on a tree with the given
+ * number of nodes, the logarithm of nodes in base DEN / NUM.
+ * */
+static size_t depth_bound(size_t nodes)
+{
+    const double step = (double)TS_CTREE_BALANCE_DEN / TS_CTREE_BALANCE_NUM;
+    size_t bound = 0;
+
+    for (double weight = step; weight <= (double)nodes; weight *= step)
+        bound += 1;
+
+    return bound;
+}
+
+/* Walks the subtree in order, storing its nodes on nodes when it is not
+ * NULL. Returns their number, or SIZE_MAX if the memory for the walk
+ * could not be allocated. Only called under the rebuild lock, while the
+ * links do not change.
+ * */
+static size_t walk_subtree(ts_ctree_node root, ts_ctree_node *nodes)
+{
+    size_t capacity = 64, top = 0, count = 0;
+    ts_ctree_node *stack = (ts_ctree_node *)malloc(capacity * sizeof(ts_ctree_node));
+    ts_ctree_node node = root;
+
+    if (stack == NULL)
+        return SIZE_MAX;
+
+    while (node != NULL || top > 0)
+    {
+        if (node != NULL)
+        {
+            if (top == capacity)
+            {
+                ts_ctree_node *grown = (ts_ctree_node *)realloc(stack, 2 * capacity * sizeof(ts_ctree_node));
+
+                if (grown == NULL)
+                {
+                    free(stack);
+                    return SIZE_MAX;
+                }
+
+                stack = grown;
+                capacity *= 2;
+            }
+
+            stack[top++] = node;
+            node = atomic_load_explicit(&node->left, memory_order_relaxed);
+            continue;
+        }
+
+        node = stack[--top];
+        if (nodes != NULL)
+            nodes[count] = node;
+        count += 1;
+        node = atomic_load_explicit(&node->right, memory_order_relaxed);
+    }
+
+    free(stack);
+    return count;
+}
+
+/* Links the nodes between lo and hi (exclusive), in order, as a balanced
+ * subtree. The recursion is bounded by the depth of the subtree.
+ * */
+static ts_ctree_node link_balanced(ts_ctree_node *nodes, size_t lo, size_t hi)
+{
+    if (lo >= hi)
+        return NULL;
+
+    const size_t mid = lo + (hi - lo) / 2;
+    ts_ctree_node node = nodes[mid];
+
+    atomic_store_explicit(&node->left, link_balanced(nodes, lo, mid), memory_order_relaxed);
+    atomic_store_explicit(&node->right, link_balanced(nodes, mid + 1, hi), memory_order_relaxed);
+
+    return node;
+}
+
+/* Replaces the subtree on the link by a balanced copy of its values, the
+ * removed ones left out. The old nodes are freed once the readers going
+ * through them are done. Must be called under the rebuild lock. When the
+ * memory can not be allocated, the subtree is kept as it is.
+ * */
+static void rebuild(ts_ctree_t *tree, ts_ctree_node _Atomic *link)
+{
+    ts_ctree_node root = atomic_load_explicit(link, memory_order_relaxed);
+    const size_t count = walk_subtree(root, NULL);
+
+    if (count == SIZE_MAX || count == 0)
+        return;
+
+    ts_ctree_node *old = (ts_ctree_node *)malloc(count * sizeof(ts_ctree_node));
+    ts_ctree_node *created = (ts_ctree_node *)malloc(count * sizeof(ts_ctree_node));
+    size_t live = 0;
+
+    if (old == NULL || created == NULL || walk_subtree(root, old) != count)
+        goto return_error;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (atomic_load_explicit(&old[i]->removed, memory_order_relaxed))
+            continue;
+        if ((created[live] = ts_ctree_node_new(old[i]->value)) == NULL)
+            goto return_error;
+        live += 1;
+    }
+
+    /* The values move to the new nodes, so readers see them either way. */
+    atomic_store_explicit(link, link_balanced(created, 0, live), memory_order_release);
+    atomic_fetch_sub_explicit(&tree->nodes, count - live, memory_order_relaxed);
+    tree->rebuilds += 1;
+
+    synchronize(tree);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (atomic_load_explicit(&old[i]->removed, memory_order_relaxed))
+            ts_generic_t_free(old[i]->value);
+        free(old[i]);
+    }
+
+    free(old);
+    free(created);
+    return;
+
+return_error:
+    for (size_t i = 0; i < live; ++i)
+        free(created[i]);
+    free(old);
+    free(created);
+}
+
+/* Rebuilds the subtree of the most deep ancestor of the node out of
+ * balance, going up the links followed from the root to reach the node.
+ * */
+static void rebuild_scapegoat(ts_ctree_t *tree, ts_ctree_node _Atomic **links, size_t length, ts_ctree_node node)
+{
+    size_t size = walk_subtree(node, NULL);
+
+    for (size_t i = length - 1; i > 0 && size != SIZE_MAX; --i)
+    {
+        ts_ctree_node parent = atomic_load_explicit(links[i - 1], memory_order_relaxed);
+        ts_ctree_node _Atomic *other = links[i] == &parent->left ? &parent->right : &parent->left;
+        const size_t sibling = walk_subtree(atomic_load_explicit(other, memory_order_relaxed), NULL);
+
+        if (sibling == SIZE_MAX)
+            return;
+
+        const size_t parent_size = size + sibling + 1;
+
+        if (size * TS_CTREE_BALANCE_DEN > parent_size * TS_CTREE_BALANCE_NUM)
+        {
+            rebuild(tree, links[i - 1]);
+            return;
+        }
+
+        size = parent_size;
+    }
+}
+
+/* Rebuilds a subtree on the path to the value if the value is still
+ * deeper than the balance allows. Must be called under the rebuild lock.
+ * */
+static void rebalance(ts_ctree_t *tree, ts_generic_t value)
+{
+    size_t capacity = 64, length = 0;
+    ts_ctree_node _Atomic **links = (ts_ctree_node _Atomic **)malloc(capacity * sizeof(ts_ctree_node _Atomic *));
+    ts_ctree_node _Atomic *link = &tree->root;
+    ts_ctree_node node = NULL;
+
+    if (links == NULL)
+        return;
+
+    /* Records the links from the root down to the node of the value. */
+    while ((node = atomic_load_explicit(link, memory_order_relaxed)) != NULL)
+    {
+        if (length == capacity)
+        {
+            ts_ctree_node _Atomic **grown = (ts_ctree_node _Atomic **)realloc(
+                links, 2 * capacity * sizeof(ts_ctree_node _Atomic *));
+
+            if (grown == NULL)
+            {
+                node = NULL;
+                break;
+            }
+
+            links = grown;
+            capacity *= 2;
+        }
+
+        links[length++] = link;
+
+        const int cmp = ts_generic_t_class_cmp(value, node->value);
+
+        if (cmp == TS_EQUAL)
+            break;
+        link = cmp == TS_LESS ? &node->left : &node->right;
+    }
+
+    if (node != NULL && length - 1 > depth_bound(atomic_load_explicit(&tree->nodes, memory_order_relaxed)))
+        rebuild_scapegoat(tree, links, length, node);
+
+    free(links);
+}
+
+/* Returns true when the removed nodes outnumber the values, on a tree
+ * large enough to be worth rebuilding.
+ * */
+static bool is_sparse(ts_ctree_t *tree)
+{
+    const size_t nodes = atomic_load_explicit(&tree->nodes, memory_order_relaxed);
+    const size_t length = atomic_load_explicit(&tree->length, memory_order_relaxed);
+
+    return nodes >= TS_CTREE_MIN_COMPACTION && nodes - length > length;
+}
+
+extern bool ts_ctree_contains(ts_ctree_t *tree, ts_generic_t value)
+{
+    ts_ctree_node parent = NULL;
+    ts_ctree_node _Atomic *link = NULL;
+    size_t depth = 0;
+
+    const unsigned epoch = read_lock(tree);
+    ts_ctree_node node = find_node(tree, value, &parent, &link, &depth);
+    const bool found = node != NULL && !atomic_load_explicit(&node->removed, memory_order_acquire);
+    read_unlock(tree, epoch);
+
+    return found;
+}
+
+extern bool ts_ctree_add(ts_ctree_t *tree, ts_generic_t value)
+{
+    ts_ctree_node created = NULL;
+    bool added = false, deep = false;
+    size_t rebuilds = 0;
+
+    /* Rebuilds are kept out while the tree is changed, so the nodes found
+     * are not freed under the writers.
+     * */
+    pthread_rwlock_rdlock(&tree->rebuild_lock);
+
+    for (;;)
+    {
+        ts_ctree_node parent = NULL;
+        ts_ctree_node _Atomic *link = NULL;
+        size_t depth = 0;
+        ts_ctree_node node = find_node(tree, value, &parent, &link, &depth);
+
+        if (node != NULL)
+        {
+            /* Bring back the node if it was removed. */
+            LOCK(&node->lock);
+            added = atomic_load_explicit(&node->removed, memory_order_relaxed);
+            atomic_store_explicit(&node->removed, false, memory_order_release);
+            UNLOCK(&node->lock);
+
+            free(created);
+
+            if (added)
+            {
+                atomic_fetch_add_explicit(&tree->length, 1, memory_order_relaxed);
+                ts_generic_t_free(value);
+            }
+
+            break;
+        }
+
+        if (created == NULL && (created = ts_ctree_node_new(value)) == NULL)
+            break;
+
+        atomic_flag *lock = parent != NULL ? &parent->lock : &tree->root_lock;
+
+        /* Validate, under the lock, that the link found is still empty. If
+         * another writer took it first, the search starts over.
+         * */
+        LOCK(lock);
+        added = atomic_load_explicit(link, memory_order_relaxed) == NULL;
+        if (added)
+            atomic_store_explicit(link, created, memory_order_release);
+        UNLOCK(lock);
+
+        if (added)
+        {
+            atomic_fetch_add_explicit(&tree->length, 1, memory_order_relaxed);
+            const size_t nodes = atomic_fetch_add_explicit(&tree->nodes, 1, memory_order_relaxed) + 1;
+
+            deep = depth > depth_bound(nodes);
+            rebuilds = tree->rebuilds;
+            break;
+        }
+    }
+
+    pthread_rwlock_unlock(&tree->rebuild_lock);
+
+    /* The value is only looked at again if no rebuild, which could have
+     * freed it, ran in the meantime.
+     * */
+    if (deep)
+    {
+        pthread_rwlock_wrlock(&tree->rebuild_lock);
+        if (tree->rebuilds == rebuilds)
+            rebalance(tree, value);
+        pthread_rwlock_unlock(&tree->rebuild_lock);
+    }
+
+    return added;
+}
+
+extern bool ts_ctree_remove(ts_ctree_t *tree, ts_generic_t value)
+{
+    ts_ctree_node parent = NULL;
+    ts_ctree_node _Atomic *link = NULL;
+    size_t depth = 0;
+    bool removed = false, sparse = false;
+
+    pthread_rwlock_rdlock(&tree->rebuild_lock);
+
+    ts_ctree_node node = find_node(tree, value, &parent, &link, &depth);
+
+    if (node != NULL)
+    {
+        LOCK(&node->lock);
+        removed = !atomic_load_explicit(&node->removed, memory_order_relaxed);
+        atomic_store_explicit(&node->removed, true, memory_order_release);
+        UNLOCK(&node->lock);
+
+        if (removed)
+        {
+            atomic_fetch_sub_explicit(&tree->length, 1, memory_order_relaxed);
+            sparse = is_sparse(tree);
+        }
+    }
+
+    pthread_rwlock_unlock(&tree->rebuild_lock);
+
+    /* Checked again, another writer may have compacted the tree first. */
+    if (sparse)
+    {
+        pthread_rwlock_wrlock(&tree->rebuild_lock);
+        if (is_sparse(tree))
+            rebuild(tree, &tree->root);
+        pthread_rwlock_unlock(&tree->rebuild_lock);
+    }
+
+    return removed;
+}
+
+extern size_t ts_ctree_length(ts_ctree_t *tree)
+{
+    return atomic_load_explicit(&tree->length, memory_order_relaxed);
+}
+
+extern ts_ctree_t *ts_ctree_new(void)
+{
+    ts_ctree_t *tree = (ts_ctree_t *)aligned_alloc(TS_CACHE_LINE_SIZE, sizeof(ts_ctree_t));
+
+    if (tree != NULL)
+    {
+        if (pthread_rwlock_init(&tree->rebuild_lock, NULL) != 0)
+        {
+            free(tree);
+            return NULL;
+        }
+
+        atomic_init(&tree->root, NULL);
+        atomic_init(&tree->length, 0);
+        atomic_init(&tree->nodes, 0);
+        atomic_init(&tree->epoch, 0);
+        atomic_init(&tree->readers[0].count, 0);
+        atomic_init(&tree->readers[1].count, 0);
+        atomic_flag_clear(&tree->root_lock);
+        tree->rebuilds = 0;
+
+        /* Associated functions. */
+        tree->add = &ts_ctree_add;
+        tree->contains = &ts_ctree_contains;
+        tree->remove = &ts_ctree_remove;
+    }
+
+    return tree;
+}
+
+extern void ts_ctree_free(ts_ctree_t **tree)
+{
+    if (*tree != NULL)
+    {
+        /* Frees the nodes iteratively, turning the tree into a right
+         * leaning list while going.
+         * */
+        ts_ctree_node node = atomic_load(&(*tree)->root);
+
+        while (node != NULL)
+        {
+            ts_ctree_node left = atomic_load(&node->left);
+
+            if (left != NULL)
+            {
+                atomic_store(&node->left, atomic_load(&left->right));
+                atomic_store(&left->right, node);
+                node = left;
+            }
+            else
+            {
+                ts_ctree_node right = atomic_load(&node->right);
+                ts_generic_t_free(node->value);
+                free(node);
+                node = right;
+            }
+        }
+
+        pthread_rwlock_destroy(&(*tree)->rebuild_lock);
+        free(*tree);
+        *tree = NULL;
+    }
+
+#ifdef _MAKE_ROBUST_CHECK
+    assert(*tree == NULL);
+#endif
+}
@@ -0,0 +1,527 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * MIT License                                                                       *
+ *                                                                                   *
+ * Copyright (c) 2022-2024 Anaxímeno Brito                                           *
+ *                                                                                   *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy      *
+ * of this software and associated documentation files (the "Software"), to deal     *
+ * in the Software without restriction, including without limitation the rights      *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell         *
+ * copies of the Software, and to permit persons to whom the Software is             *
+ * furnished to do so, subject to the following conditions:                          *
+ *                                                                                   *
+ * The above copyright notice and this permission notice shall be included in all    *
+ * copies or substantial portions of the Software.                                   *
+ *                                                                                   *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR        *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,          *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE       *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER            *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,     *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE     *
+ * SOFTWARE.                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#include "../include/3s/core.h"
+#include "../include/3s/filter.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include <assert.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define FILTER_VERSION 1
+#define DEFAULT_FALSE_POSITIVE_RATE 0.01
+#define LN_2 0.69314718055994530942
+
+/* Returns the base two logarithm of a positive value, bit by bit, so
+ * the library does not need to link with libm.
+ * */
+static double log2_of(double x)
+{
+    double result = 0;
+    double bit = 1;
+
+    while (x < 1)
+    {
+        x *= 2;
+        result -= 1;
+    }
+    while (x >= 2)
+    {
+        x /= 2;
+        result += 1;
+    }
+
+    // squaring the mantissa doubles its logarithm, which gives one bit
+    // of the fraction each time it reaches two
+    for (int i = 0; i < 32; ++i)
+    {
+        x *= x;
+        bit /= 2;
+        if (x >= 2)
+        {
+            x /= 2;
+            result += bit;
+        }
+    }
+
+    return result;
+}
+
+static double valid_rate(double false_positive_rate)
+{
+    return false_positive_rate > 0 && false_positive_rate < 1 ? false_positive_rate : DEFAULT_FALSE_POSITIVE_RATE;
+}
+
+static void write_u64(uint8_t *buffer, uint64_t value)
+{
+    for (int i = 0; i < 8; ++i)
+        buffer[i] = (uint8_t)(value >> (8 * i));
+}
+
+static uint64_t read_u64(const uint8_t *buffer)
+{
+    uint64_t value = 0;
+
+    for (int i = 0; i < 8; ++i)
+        value |= (uint64_t)buffer[i] << (8 * i);
+
+    return value;
+}
+
+/* -- Blocked Bloom filter */
+
+/* Returns the block of the hash, from its high half. */
+static uint8_t *bloom_block(ts_bloom_t *bloom, uint64_t hash)
+{
+    const size_t index = (size_t)(((hash >> 32) * (uint64_t)bloom->blocks_length) >> 32);
+    return bloom->blocks + index * TS_BLOOM_BLOCK_SIZE;
+}
+
+/* Sets on the mask the bits of the hash, picked by double hashing. */
+static void bloom_mask(ts_bloom_t *bloom, uint64_t hash, uint8_t mask[TS_BLOOM_BLOCK_SIZE])
+{
+    const uint32_t h1 = (uint32_t)hash;
+    const uint32_t h2 = (uint32_t)((hash * 0x9e3779b97f4a7c15ULL) >> 32) | 1;
+
+    memset(mask, 0, TS_BLOOM_BLOCK_SIZE);
+
+    for (uint32_t i = 0; i < bloom->hashes; ++i)
+    {
+        const uint32_t bit = (h1 + i * h2) % TS_BLOOM_BLOCK_BITS;
+        mask[bit / 8] |= (uint8_t)(1 << (bit % 8));
+    }
+}
+
+static ts_bloom_t *bloom_alloc(size_t blocks_length, uint8_t hashes)
+{
+    ts_bloom_t *bloom = (ts_bloom_t *)malloc(sizeof(ts_bloom_t));
+
+    if (bloom != NULL)
+    {
+        bloom->blocks = (uint8_t *)aligned_alloc(TS_BLOOM_BLOCK_SIZE, blocks_length * TS_BLOOM_BLOCK_SIZE);
+
+        if (bloom->blocks == NULL)
+        {
+            free(bloom);
+            return NULL;
+        }
+
+        memset(bloom->blocks, 0, blocks_length * TS_BLOOM_BLOCK_SIZE);
+        bloom->blocks_length = blocks_length;
+        bloom->hashes = hashes;
+
+        /* Associated functions. */
+        bloom->add = &ts_bloom_add;
+        bloom->contains = &ts_bloom_contains;
+    }
+
+    return bloom;
+}
+
+extern void ts_bloom_add(ts_bloom_t *bloom, ts_generic_t value)
+{
+    const uint64_t hash = ts_generic_t_hash(value);
+    uint8_t *block = bloom_block(bloom, hash);
+    uint8_t mask[TS_BLOOM_BLOCK_SIZE];
+
+    bloom_mask(bloom, hash, mask);
+
+    for (int i = 0; i < TS_BLOOM_BLOCK_SIZE; ++i)
+        block[i] |= mask[i];
+}
+
+extern bool ts_bloom_contains(ts_bloom_t *bloom, ts_generic_t value)
+{
+    const uint64_t hash = ts_generic_t_hash(value);
+    const uint8_t *block = bloom_block(bloom, hash);
+    uint8_t mask[TS_BLOOM_BLOCK_SIZE];
+
+    bloom_mask(bloom, hash, mask);
+
+#ifdef __SSE2__
+    // all the bits of the mask must be set on the block
+    for (int i = 0; i < TS_BLOOM_BLOCK_SIZE; i += 16)
+    {
+        const __m128i bits = _mm_load_si128((const __m128i *)(block + i));
+        const __m128i wanted = _mm_loadu_si128((const __m128i *)(mask + i));
+
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(bits, wanted), wanted)) != 0xFFFF)
+            return false;
+    }
+#else
+    for (int i = 0; i < TS_BLOOM_BLOCK_SIZE; ++i)
+        if ((block[i] & mask[i]) != mask[i])
+            return false;
+#endif
+
+    return true;
+}
+
+extern size_t ts_bloom_serialized_size(ts_bloom_t *bloom)
+{
+    return TS_BLOOM_HEADER_SIZE + bloom->blocks_length * TS_BLOOM_BLOCK_SIZE;
+}
+
+extern size_t ts_bloom_serialize(ts_bloom_t *bloom, uint8_t *buffer)
+{
+    memset(buffer, 0, TS_BLOOM_HEADER_SIZE);
+    memcpy(buffer, "3SBF", 4);
+    buffer[4] = FILTER_VERSION;
+    buffer[5] = bloom->hashes;
+    write_u64(buffer + 8, bloom->blocks_length);
+    memcpy(buffer + TS_BLOOM_HEADER_SIZE, bloom->blocks, bloom->blocks_length * TS_BLOOM_BLOCK_SIZE);
+
+    return ts_bloom_serialized_size(bloom);
+}
+
+extern ts_bloom_t *ts_bloom_deserialize(const uint8_t *buffer, size_t length)
+{
+    if (length < TS_BLOOM_HEADER_SIZE || memcmp(buffer, "3SBF", 4) != 0 || buffer[4] != FILTER_VERSION)
+        return NULL;
+
+    const uint8_t hashes = buffer[5];
+    const uint64_t blocks_length = read_u64(buffer + 8);
+
+    if (hashes == 0 || hashes > TS_BLOOM_MAX_HASHES || blocks_length == 0 ||
+        blocks_length > UINT32_MAX || blocks_length != (length - TS_BLOOM_HEADER_SIZE) / TS_BLOOM_BLOCK_SIZE ||
+        (length - TS_BLOOM_HEADER_SIZE) % TS_BLOOM_BLOCK_SIZE != 0)
+        return NULL;
+
+    ts_bloom_t *bloom = bloom_alloc((size_t)blocks_length, hashes);
+
+    if (bloom != NULL)
+        memcpy(bloom->blocks, buffer + TS_BLOOM_HEADER_SIZE, bloom->blocks_length * TS_BLOOM_BLOCK_SIZE);
+
+    return bloom;
+}
+
+extern ts_bloom_t *ts_bloom_new(size_t expected, double false_positive_rate)
+{
+    const double bits_per_value = -log2_of(valid_rate(false_positive_rate)) / LN_2;
+    const double bits = (expected != 0 ? expected : 1) * bits_per_value;
+    size_t blocks_length = (size_t)(bits / TS_BLOOM_BLOCK_BITS) + 1;
+    int hashes = (int)(bits_per_value * LN_2 + 0.5);
+
+    if (hashes < 1)
+        hashes = 1;
+    else if (hashes > TS_BLOOM_MAX_HASHES)
+        hashes = TS_BLOOM_MAX_HASHES;
+
+    if (blocks_length > UINT32_MAX)
+        blocks_length = UINT32_MAX;
+
+    return bloom_alloc(blocks_length, (uint8_t)hashes);
+}
+
+extern void ts_bloom_free(ts_bloom_t **bloom)
+{
+    if (*bloom != NULL)
+    {
+        free((*bloom)->blocks);
+        free(*bloom);
+        *bloom = NULL;
+    }
+
+#ifdef _MAKE_ROBUST_CHECK
+    assert(*bloom == NULL);
+#endif
+}
+
+/* -- Cuckoo filter */
+
+#define CUCKOO_LANES 0x0001000100010001ULL
+
+static uint16_t cuckoo_fingerprint(ts_cuckoo_t *cuckoo, uint64_t hash)
+{
+    const uint16_t fingerprint = (uint16_t)(hash & ((1u << cuckoo->fingerprint_bits) - 1));
+    return fingerprint != 0 ? fingerprint : 1;
+}
+
+/* Returns the other bucket of the fingerprint, which only depends on the
+ * fingerprint and the bucket, going back and forth between the two.
+ * */
+static size_t cuckoo_alt(ts_cuckoo_t *cuckoo, size_t bucket, uint16_t fingerprint)
+{
+    return (bucket ^ (size_t)(fingerprint * 0x5bd1e995u)) & (cuckoo->buckets_length - 1);
+}
+
+/* Returns a mask of the slots of the bucket holding the fingerprint, the
+ * four slots being compared at once as the lanes of a 64 bits word.
+ * */
+static uint64_t cuckoo_match(ts_cuckoo_t *cuckoo, size_t bucket, uint16_t fingerprint)
+{
+    uint64_t lanes;
+
+    memcpy(&lanes, cuckoo->buckets + bucket * TS_CUCKOO_BUCKET_SIZE, sizeof(lanes));
+    lanes ^= fingerprint * CUCKOO_LANES;
+
+    return (lanes - CUCKOO_LANES) & ~lanes & (0x8000 * CUCKOO_LANES);
+}
+
+/* Returns the slot of the bucket holding the fingerprint, or -1. */
+static int cuckoo_find(ts_cuckoo_t *cuckoo, size_t bucket, uint16_t fingerprint)
+{
+    uint16_t *slots = cuckoo->buckets + bucket * TS_CUCKOO_BUCKET_SIZE;
+
+    if (cuckoo_match(cuckoo, bucket, fingerprint) == 0)
+        return -1;
+
+    for (int i = 0; i < TS_CUCKOO_BUCKET_SIZE; ++i)
+        if (slots[i] == fingerprint)
+            return i;
+
+    return -1;
+}
+
+/* Stores the fingerprint on an empty slot of the bucket, if any. */
+static bool cuckoo_place(ts_cuckoo_t *cuckoo, size_t bucket, uint16_t fingerprint)
+{
+    const int slot = cuckoo_find(cuckoo, bucket, 0);
+
+    if (slot < 0)
+        return false;
+
+    cuckoo->buckets[bucket * TS_CUCKOO_BUCKET_SIZE + slot] = fingerprint;
+    return true;
+}
+
+static uint64_t cuckoo_random(ts_cuckoo_t *cuckoo)
+{
+    cuckoo->seed ^= cuckoo->seed << 13;
+    cuckoo->seed ^= cuckoo->seed >> 7;
+    cuckoo->seed ^= cuckoo->seed << 17;
+    return cuckoo->seed;
+}
+
+static ts_cuckoo_t *cuckoo_alloc(size_t buckets_length, uint8_t fingerprint_bits)
+{
+    ts_cuckoo_t *cuckoo = (ts_cuckoo_t *)malloc(sizeof(ts_cuckoo_t));
+
+    if (cuckoo != NULL)
+    {
+        cuckoo->buckets = (uint16_t *)calloc(buckets_length * TS_CUCKOO_BUCKET_SIZE, sizeof(uint16_t));
+
+        if (cuckoo->buckets == NULL)
+        {
+            free(cuckoo);
+            return NULL;
+        }
+
+        cuckoo->buckets_length = buckets_length;
+        cuckoo->length = 0;
+        cuckoo->fingerprint_bits = fingerprint_bits;
+        cuckoo->victim = 0;
+        cuckoo->victim_bucket = 0;
+        cuckoo->seed = 0x9e3779b97f4a7c15ULL;
+
+        /* Associated functions. */
+        cuckoo->add = &ts_cuckoo_add;
+        cuckoo->contains = &ts_cuckoo_contains;
+        cuckoo->remove = &ts_cuckoo_remove;
+    }
+
+    return cuckoo;
+}
+
+/* Stores the fingerprint on one of its buckets, kicking random fingerprints
+ * to their other bucket until one fits. When the kicks run out, the last
+ * fingerprint kicked is kept aside as the victim.
+ * */
+static void cuckoo_insert(ts_cuckoo_t *cuckoo, size_t bucket, uint16_t fingerprint)
+{
+    if (cuckoo_place(cuckoo, bucket, fingerprint) ||
+        cuckoo_place(cuckoo, (bucket = cuckoo_alt(cuckoo, bucket, fingerprint)), fingerprint))
+        return;
+
+    for (int kick = 0; kick < TS_CUCKOO_MAX_KICKS; ++kick)
+    {
+        uint16_t *slot = cuckoo->buckets + bucket * TS_CUCKOO_BUCKET_SIZE +
+                         cuckoo_random(cuckoo) % TS_CUCKOO_BUCKET_SIZE;
+        const uint16_t kicked = *slot;
+
+        *slot = fingerprint;
+        fingerprint = kicked;
+        bucket = cuckoo_alt(cuckoo, bucket, fingerprint);
+
+        if (cuckoo_place(cuckoo, bucket, fingerprint))
+            return;
+    }
+
+    cuckoo->victim = fingerprint;
+    cuckoo->victim_bucket = bucket;
+}
+
+extern bool ts_cuckoo_add(ts_cuckoo_t *cuckoo, ts_generic_t value)
+{
+    if (cuckoo->victim != 0)
+        return false;
+
+    const uint64_t hash = ts_generic_t_hash(value);
+
+    cuckoo_insert(cuckoo, (size_t)(hash >> 32) & (cuckoo->buckets_length - 1), cuckoo_fingerprint(cuckoo, hash));
+    cuckoo->length++;
+    return true;
+}
+
+extern bool ts_cuckoo_contains(ts_cuckoo_t *cuckoo, ts_generic_t value)
+{
+    const uint64_t hash = ts_generic_t_hash(value);
+    const uint16_t fingerprint = cuckoo_fingerprint(cuckoo, hash);
+    const size_t bucket1 = (size_t)(hash >> 32) & (cuckoo->buckets_length - 1);
+    const size_t bucket2 = cuckoo_alt(cuckoo, bucket1, fingerprint);
+
+    return cuckoo_match(cuckoo, bucket1, fingerprint) != 0 ||
+           cuckoo_match(cuckoo, bucket2, fingerprint) != 0 ||
+           (cuckoo->victim == fingerprint &&
+            (cuckoo->victim_bucket == bucket1 || cuckoo->victim_bucket == bucket2));
+}
+
+extern bool ts_cuckoo_remove(ts_cuckoo_t *cuckoo, ts_generic_t value)
+{
+    const uint64_t hash = ts_generic_t_hash(value);
+    const uint16_t fingerprint = cuckoo_fingerprint(cuckoo, hash);
+    const size_t bucket1 = (size_t)(hash >> 32) & (cuckoo->buckets_length - 1);
+    const size_t bucket2 = cuckoo_alt(cuckoo, bucket1, fingerprint);
+    int slot;
+
+    if (cuckoo->victim == fingerprint && (cuckoo->victim_bucket == bucket1 || cuckoo->victim_bucket == bucket2))
+        cuckoo->victim = 0;
+    else if ((slot = cuckoo_find(cuckoo, bucket1, fingerprint)) >= 0)
+        cuckoo->buckets[bucket1 * TS_CUCKOO_BUCKET_SIZE + slot] = 0;
+    else if ((slot = cuckoo_find(cuckoo, bucket2, fingerprint)) >= 0)
+        cuckoo->buckets[bucket2 * TS_CUCKOO_BUCKET_SIZE + slot] = 0;
+    else
+        return false;
+
+    cuckoo->length--;
+
+    // the freed slot may make room for the victim, a few kicks away
+    if (cuckoo->victim != 0)
+    {
+        const uint16_t victim = cuckoo->victim;
+
+        cuckoo->victim = 0;
+        cuckoo_insert(cuckoo, cuckoo->victim_bucket, victim);
+    }
+
+    return true;
+}
+
+extern size_t ts_cuckoo_serialized_size(ts_cuckoo_t *cuckoo)
+{
+    return TS_CUCKOO_HEADER_SIZE + cuckoo->buckets_length * TS_CUCKOO_BUCKET_SIZE * sizeof(uint16_t);
+}
+
+extern size_t ts_cuckoo_serialize(ts_cuckoo_t *cuckoo, uint8_t *buffer)
+{
+    const size_t slots = cuckoo->buckets_length * TS_CUCKOO_BUCKET_SIZE;
+
+    memcpy(buffer, "3SCF", 4);
+    buffer[4] = FILTER_VERSION;
+    buffer[5] = cuckoo->fingerprint_bits;
+    buffer[6] = (uint8_t)cuckoo->victim;
+    buffer[7] = (uint8_t)(cuckoo->victim >> 8);
+    write_u64(buffer + 8, cuckoo->buckets_length);
+    write_u64(buffer + 16, cuckoo->length);
+    write_u64(buffer + 24, cuckoo->victim_bucket);
+
+    for (size_t i = 0; i < slots; ++i)
+    {
+        buffer[TS_CUCKOO_HEADER_SIZE + 2 * i] = (uint8_t)cuckoo->buckets[i];
+        buffer[TS_CUCKOO_HEADER_SIZE + 2 * i + 1] = (uint8_t)(cuckoo->buckets[i] >> 8);
+    }
+
+    return ts_cuckoo_serialized_size(cuckoo);
+}
+
+extern ts_cuckoo_t *ts_cuckoo_deserialize(const uint8_t *buffer, size_t length)
+{
+    if (length < TS_CUCKOO_HEADER_SIZE || memcmp(buffer, "3SCF", 4) != 0 || buffer[4] != FILTER_VERSION)
+        return NULL;
+
+    const uint8_t fingerprint_bits = buffer[5];
+    const uint64_t buckets_length = read_u64(buffer + 8);
+    const size_t bucket_bytes = TS_CUCKOO_BUCKET_SIZE * sizeof(uint16_t);
+
+    if (fingerprint_bits == 0 || fingerprint_bits > 16 || buckets_length == 0 ||
+        (buckets_length & (buckets_length - 1)) != 0 ||
+        buckets_length != (length - TS_CUCKOO_HEADER_SIZE) / bucket_bytes ||
+        (length - TS_CUCKOO_HEADER_SIZE) % bucket_bytes != 0 ||
+        read_u64(buffer + 24) >= buckets_length)
+        return NULL;
+
+    ts_cuckoo_t *cuckoo = cuckoo_alloc((size_t)buckets_length, fingerprint_bits);
+
+    if (cuckoo != NULL)
+    {
+        const size_t slots = cuckoo->buckets_length * TS_CUCKOO_BUCKET_SIZE;
+
+        cuckoo->victim = (uint16_t)(buffer[6] | buffer[7] << 8);
+        cuckoo->length = (size_t)read_u64(buffer + 16);
+        cuckoo->victim_bucket = (size_t)read_u64(buffer + 24);
+
+        for (size_t i = 0; i < slots; ++i)
+            cuckoo->buckets[i] = (uint16_t)(buffer[TS_CUCKOO_HEADER_SIZE + 2 * i] |
+                                            buffer[TS_CUCKOO_HEADER_SIZE + 2 * i + 1] << 8);
+    }
+
+    return cuckoo;
+}
+
+extern ts_cuckoo_t *ts_cuckoo_new(size_t expected, double false_positive_rate)
+{
+    // a lookup compares against the two buckets, so eight fingerprints
+    int fingerprint_bits = (int)(log2_of(2 * TS_CUCKOO_BUCKET_SIZE / valid_rate(false_positive_rate)) + 0.999);
+    size_t buckets_length = 1;
+
+    if (fingerprint_bits < 4)
+        fingerprint_bits = 4;
+    else if (fingerprint_bits > 16)
+        fingerprint_bits = 16;
+
+    // the buckets can be filled up to about 95%
+    while (buckets_length * TS_CUCKOO_BUCKET_SIZE * 0.95 < expected)
+        buckets_length *= 2;
+
+    return cuckoo_alloc(buckets_length, (uint8_t)fingerprint_bits);
+}
+
+extern void ts_cuckoo_free(ts_cuckoo_t **cuckoo)
+{
+    if (*cuckoo != NULL)
+    {
+        free((*cuckoo)->buckets);
+        free(*cuckoo);
+        *cuckoo = NULL;
+    }
+
+#ifdef _MAKE_ROBUST_CHECK
+    assert(*cuckoo == NULL);
+#endif
+}
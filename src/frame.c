@@ -0,0 +1,666 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * MIT License                                                                       *
+ *                                                                                   *
+ * Copyright (c) 2022-2024 Anaxímeno Brito                                           *
+ *                                                                                   *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy      *
+ * of this software and associated documentation files (the "Software"), to deal     *
+ * in the Software without restriction, including without limitation the rights      *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell         *
+ * copies of the Software, and to permit persons to whom the Software is             *
+ * furnished to do so, subject to the following conditions:                          *
+ *                                                                                   *
+ * The above copyright notice and this permission notice shall be included in all    *
+ * copies or substantial portions of the Software.                                   *
+ *                                                                                   *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR        *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,          *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE       *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER            *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,     *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE     *
+ * SOFTWARE.                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#include "../include/3s/core.h"
+#include "../include/3s/frame.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include <assert.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/* The first capacity of the frame and of its columns. */
+#define INITIAL_CAPACITY 8
+
+/* Returns true for the columns keeping their characters. */
+#define HAS_CHARS(TYPE) ((TYPE) == TS_TYPE_OWNED_STRING || (TYPE) == TS_TYPE_BYTES)
+
+/* Returns true for the columns of numbers. */
+#define IS_NUMERIC(TYPE)                                                 \
+    ((TYPE) == TS_TYPE_INTEGER || (TYPE) == TS_TYPE_UNSIGNED ||          \
+     (TYPE) == TS_TYPE_FLOAT32 || (TYPE) == TS_TYPE_FLOAT64 ||           \
+     (TYPE) == TS_TYPE_INT64 || (TYPE) == TS_TYPE_UINT64)
+
+/* The size of a value of each column, the offsets of the characters for
+ * owned strings and bytes.
+ * */
+static const size_t widths[TS_FRAME_COLUMNS] = {
+    [TS_TYPE_INTEGER] = sizeof(int32_t),
+    [TS_TYPE_UNSIGNED] = sizeof(uint32_t),
+    [TS_TYPE_FLOAT32] = sizeof(float),
+    [TS_TYPE_FLOAT64] = sizeof(double),
+    [TS_TYPE_STRING] = sizeof(char *),
+    [TS_TYPE_CHARACTER] = sizeof(char),
+    [TS_TYPE_POINTER] = sizeof(void *),
+    [TS_TYPE_OWNED_STRING] = sizeof(size_t),
+    [TS_TYPE_INT64] = sizeof(int64_t),
+    [TS_TYPE_UINT64] = sizeof(uint64_t),
+    [TS_TYPE_BOOL] = sizeof(bool),
+    [TS_TYPE_BYTES] = sizeof(size_t),
+    [TS_TYPE_NONE] = 0,
+};
+
+/* Returns the value at the given row of the column. */
+static void *cell(struct ts_frame_column *column, ts_types type, size_t row)
+{
+    return (char *)column->data + row * widths[type];
+}
+
+/* Returns the characters of the owned string or bytes at the given row. */
+static const char *chars_of(struct ts_frame_column *column, size_t row, size_t *length)
+{
+    const size_t *offsets = (const size_t *)column->data;
+    const size_t end = row + 1 < column->length ? offsets[row + 1] : column->chars_length;
+
+    *length = end - offsets[row];
+    return column->chars + offsets[row];
+}
+
+/* Makes room for one more value in the column. */
+static bool grow_column(struct ts_frame_column *column, ts_types type)
+{
+    if (column->length < column->capacity)
+        return true;
+
+    const size_t capacity = column->capacity != 0 ? 2 * column->capacity : INITIAL_CAPACITY;
+    uint32_t *positions = (uint32_t *)realloc(column->positions, capacity * sizeof(uint32_t));
+
+    if (positions == NULL)
+        return false;
+    column->positions = positions;
+
+    // none values are only counted
+    if (widths[type] != 0)
+    {
+        void *data = realloc(column->data, capacity * widths[type]);
+
+        if (data == NULL)
+            return false;
+        column->data = data;
+    }
+
+    column->capacity = capacity;
+    return true;
+}
+
+/* Makes room for the given number of characters more in the column. */
+static bool grow_chars(struct ts_frame_column *column, size_t length)
+{
+    size_t capacity = column->chars_capacity != 0 ? column->chars_capacity : INITIAL_CAPACITY;
+
+    while (capacity - column->chars_length < length)
+        capacity *= 2;
+
+    if (capacity == column->chars_capacity)
+        return true;
+
+    char *chars = (char *)realloc(column->chars, capacity);
+
+    if (chars == NULL)
+        return false;
+
+    column->chars = chars;
+    column->chars_capacity = capacity;
+    return true;
+}
+
+/* Makes room for one more position in the frame. */
+static bool grow_frame(ts_frame_t *frame)
+{
+    if (frame->length < frame->capacity)
+        return true;
+
+    const size_t capacity = frame->capacity != 0 ? 2 * frame->capacity : INITIAL_CAPACITY;
+    uint8_t *types = (uint8_t *)realloc(frame->types, capacity * sizeof(uint8_t));
+
+    if (types == NULL)
+        return false;
+    frame->types = types;
+
+    uint32_t *rows = (uint32_t *)realloc(frame->rows, capacity * sizeof(uint32_t));
+
+    if (rows == NULL)
+        return false;
+    frame->rows = rows;
+
+    frame->capacity = capacity;
+    return true;
+}
+
+// -- Scans of 32 bits integers
+
+static size_t find_int32(const int32_t *data, size_t length, int32_t key)
+{
+    size_t i = 0;
+
+#ifdef __SSE2__
+    const __m128i wanted = _mm_set1_epi32(key);
+
+    for (; i + 4 <= length; i += 4)
+    {
+        const __m128i equal = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)(data + i)), wanted);
+        const int mask = _mm_movemask_ps(_mm_castsi128_ps(equal));
+
+        if (mask != 0)
+            return i + __builtin_ctz(mask);
+    }
+#endif
+
+    for (; i < length; ++i)
+        if (data[i] == key)
+            return i;
+
+    return length;
+}
+
+static size_t count_int32(const int32_t *data, size_t length, int32_t key)
+{
+    size_t count = 0, i = 0;
+
+#ifdef __SSE2__
+    const __m128i wanted = _mm_set1_epi32(key);
+
+    for (; i + 4 <= length; i += 4)
+    {
+        const __m128i equal = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)(data + i)), wanted);
+        count += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(equal)));
+    }
+#endif
+
+    for (; i < length; ++i)
+        count += data[i] == key;
+
+    return count;
+}
+
+/* Returns the least, or the greatest, of the values, at least one. */
+static int32_t min_max_int32(const int32_t *data, size_t length, bool max)
+{
+    int32_t result = data[0];
+    size_t i = 1;
+
+#ifdef __SSE2__
+    if (length >= 4)
+    {
+        // SSE2 has no 32 bits min and max, so they are blended by masks
+        __m128i best = _mm_loadu_si128((const __m128i *)data);
+        int32_t lanes[4];
+
+        for (i = 4; i + 4 <= length; i += 4)
+        {
+            const __m128i values = _mm_loadu_si128((const __m128i *)(data + i));
+            const __m128i better = max ? _mm_cmpgt_epi32(values, best) : _mm_cmplt_epi32(values, best);
+
+            best = _mm_or_si128(_mm_and_si128(better, values), _mm_andnot_si128(better, best));
+        }
+
+        _mm_storeu_si128((__m128i *)lanes, best);
+        for (int lane = 0; lane < 4; ++lane)
+            if (max ? lanes[lane] > result : lanes[lane] < result)
+                result = lanes[lane];
+    }
+#endif
+
+    for (; i < length; ++i)
+        if (max ? data[i] > result : data[i] < result)
+            result = data[i];
+
+    return result;
+}
+
+static int64_t sum_int32(const int32_t *data, size_t length)
+{
+    uint64_t sum = 0;
+    size_t i = 0;
+
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+    __m128i sums = zero;
+    uint64_t lanes[2];
+
+    // the values are widened to 64 bits by their sign
+    for (; i + 4 <= length; i += 4)
+    {
+        const __m128i values = _mm_loadu_si128((const __m128i *)(data + i));
+        const __m128i signs = _mm_cmpgt_epi32(zero, values);
+
+        sums = _mm_add_epi64(sums, _mm_unpacklo_epi32(values, signs));
+        sums = _mm_add_epi64(sums, _mm_unpackhi_epi32(values, signs));
+    }
+
+    _mm_storeu_si128((__m128i *)lanes, sums);
+    sum = lanes[0] + lanes[1];
+#endif
+
+    for (; i < length; ++i)
+        sum += (uint64_t)(int64_t)data[i];
+
+    return (int64_t)sum;
+}
+
+// -- Scans of 64 bits floats
+
+/* NaN keys find the NaN values, as NaN is equal to itself for values. */
+static size_t find_float64(const double *data, size_t length, double key)
+{
+    const bool nan = isnan(key);
+    size_t i = 0;
+
+#ifdef __SSE2__
+    const __m128d wanted = _mm_set1_pd(key);
+
+    for (; i + 2 <= length; i += 2)
+    {
+        const __m128d values = _mm_loadu_pd(data + i);
+        const int mask = _mm_movemask_pd(nan ? _mm_cmpunord_pd(values, values) : _mm_cmpeq_pd(values, wanted));
+
+        if (mask != 0)
+            return i + __builtin_ctz(mask);
+    }
+#endif
+
+    for (; i < length; ++i)
+        if (nan ? isnan(data[i]) : data[i] == key)
+            return i;
+
+    return length;
+}
+
+static size_t count_float64(const double *data, size_t length, double key)
+{
+    const bool nan = isnan(key);
+    size_t count = 0, i = 0;
+
+#ifdef __SSE2__
+    const __m128d wanted = _mm_set1_pd(key);
+
+    for (; i + 2 <= length; i += 2)
+    {
+        const __m128d values = _mm_loadu_pd(data + i);
+        count += __builtin_popcount(_mm_movemask_pd(nan ? _mm_cmpunord_pd(values, values) : _mm_cmpeq_pd(values, wanted)));
+    }
+#endif
+
+    for (; i < length; ++i)
+        count += nan ? isnan(data[i]) : data[i] == key;
+
+    return count;
+}
+
+/* Returns the least, or the greatest, of the values, at least one. NaN
+ * is the greatest, so it is the maximum of values holding one, and only
+ * the minimum of values all NaN.
+ * */
+static double min_max_float64(const double *data, size_t length, bool max)
+{
+    double result = max ? -INFINITY : INFINITY;
+    bool nan = false, number = false;
+    size_t i = 0;
+
+#ifdef __SSE2__
+    __m128d best = _mm_set1_pd(result);
+    __m128d nans = _mm_setzero_pd();
+    __m128d numbers = _mm_setzero_pd();
+    double lanes[2];
+
+    // MINPD and MAXPD give their second operand when one is NaN, which
+    // skips the NaN values, counted apart
+    for (; i + 2 <= length; i += 2)
+    {
+        const __m128d values = _mm_loadu_pd(data + i);
+
+        best = max ? _mm_max_pd(values, best) : _mm_min_pd(values, best);
+        nans = _mm_or_pd(nans, _mm_cmpunord_pd(values, values));
+        numbers = _mm_or_pd(numbers, _mm_cmpord_pd(values, values));
+    }
+
+    _mm_storeu_pd(lanes, best);
+    result = (max ? lanes[1] > lanes[0] : lanes[1] < lanes[0]) ? lanes[1] : lanes[0];
+    nan = _mm_movemask_pd(nans) != 0;
+    number = _mm_movemask_pd(numbers) != 0;
+#endif
+
+    for (; i < length; ++i)
+    {
+        if (isnan(data[i]))
+        {
+            nan = true;
+            continue;
+        }
+
+        number = true;
+        if (max ? data[i] > result : data[i] < result)
+            result = data[i];
+    }
+
+    return (max ? nan : !number) ? NAN : result;
+}
+
+static double sum_float64(const double *data, size_t length)
+{
+    double sum = 0;
+    size_t i = 0;
+
+#ifdef __SSE2__
+    __m128d sums = _mm_setzero_pd();
+    double lanes[2];
+
+    for (; i + 2 <= length; i += 2)
+        sums = _mm_add_pd(sums, _mm_loadu_pd(data + i));
+
+    _mm_storeu_pd(lanes, sums);
+    sum = lanes[0] + lanes[1];
+#endif
+
+    for (; i < length; ++i)
+        sum += data[i];
+
+    return sum;
+}
+
+// -- Scans of the other columns
+
+/* Returns true if the value at the given row is equal to the key, of the
+ * type of the column.
+ * */
+static bool cell_equal(struct ts_frame_column *column, ts_types type, size_t row, ts_generic_t key)
+{
+    if (HAS_CHARS(type))
+    {
+        size_t length;
+        const char *chars = chars_of(column, row, &length);
+
+        return length == ts_generic_t_length(key) && memcmp(chars, ts_generic_t_chars(key), length) == 0;
+    }
+
+    if (type == TS_TYPE_STRING)
+        return strcmp(*(char **)cell(column, type, row), key->data.string) == 0;
+
+    if (type == TS_TYPE_FLOAT32)
+    {
+        const float value = *(float *)cell(column, type, row);
+        return isnan(key->data.float32) ? isnan(value) : value == key->data.float32;
+    }
+
+    return memcmp(cell(column, type, row), &key->data, widths[type]) == 0;
+}
+
+/* Returns the row of the first value equal to the key, or the length of
+ * the column.
+ * */
+static size_t find_row(struct ts_frame_column *column, ts_types type, ts_generic_t key)
+{
+    switch (type)
+    {
+    case TS_TYPE_INTEGER:
+    case TS_TYPE_UNSIGNED:
+        return find_int32((const int32_t *)column->data, column->length, key->data.integer);
+    case TS_TYPE_FLOAT64:
+        return find_float64((const double *)column->data, column->length, key->data.float64);
+    default:
+        for (size_t row = 0; row < column->length; ++row)
+            if (cell_equal(column, type, row, key))
+                return row;
+        return column->length;
+    }
+}
+
+/* Returns the row of the least, or the greatest, value of a numeric
+ * column, compared as values.
+ * */
+static size_t min_max_row(struct ts_frame_column *column, ts_types type, bool max)
+{
+    struct ts_generic_t best = {.type = type}, value = {.type = type};
+    size_t best_row = 0;
+
+    memcpy(&best.data, cell(column, type, 0), widths[type]);
+
+    for (size_t row = 1; row < column->length; ++row)
+    {
+        memcpy(&value.data, cell(column, type, row), widths[type]);
+
+        if (ts_generic_t_cmp(&value, &best) == (max ? TS_GREATER : TS_LESS))
+        {
+            best = value;
+            best_row = row;
+        }
+    }
+
+    return best_row;
+}
+
+// -- Frames
+
+extern bool ts_frame_push(ts_frame_t *frame, ts_generic_t value)
+{
+    const ts_types type = value->type;
+
+    if (type > TS_TYPE_NONE || frame->length >= TS_FRAME_MAX_LENGTH)
+        return false;
+
+    struct ts_frame_column *column = &frame->columns[type];
+
+    if (!grow_frame(frame) || !grow_column(column, type))
+        return false;
+
+    if (HAS_CHARS(type))
+    {
+        const size_t length = ts_generic_t_length(value);
+
+        if (!grow_chars(column, length))
+            return false;
+
+        memcpy(column->chars + column->chars_length, ts_generic_t_chars(value), length);
+        ((size_t *)column->data)[column->length] = column->chars_length;
+        column->chars_length += length;
+    }
+    else if (type != TS_TYPE_NONE)
+    {
+        // all the members of the data start at its beginning
+        memcpy(cell(column, type, column->length), &value->data, widths[type]);
+    }
+
+    column->positions[column->length] = (uint32_t)frame->length;
+    frame->types[frame->length] = (uint8_t)type;
+    frame->rows[frame->length] = (uint32_t)column->length;
+    column->length += 1;
+    frame->length += 1;
+
+    return true;
+}
+
+extern ts_generic_t ts_frame_get(ts_frame_t *frame, size_t index)
+{
+    if (index >= frame->length)
+        return NULL;
+
+    const ts_types type = (ts_types)frame->types[index];
+    struct ts_frame_column *column = &frame->columns[type];
+    const size_t row = frame->rows[index];
+
+    if (HAS_CHARS(type))
+    {
+        size_t length;
+        const char *chars = chars_of(column, row, &length);
+
+        return type == TS_TYPE_BYTES ? ts_new_bytes(chars, length) : ts_new_owned_string_n(chars, length);
+    }
+
+    ts_generic_t value = ts_new_none();
+
+    if (value != NULL && type != TS_TYPE_NONE)
+    {
+        value->type = type;
+        memcpy(&value->data, cell(column, type, row), widths[type]);
+    }
+
+    return value;
+}
+
+extern size_t ts_frame_length(ts_frame_t *frame)
+{
+    return frame->length;
+}
+
+extern size_t ts_frame_find(ts_frame_t *frame, ts_generic_t key)
+{
+    if (key->type > TS_TYPE_NONE)
+        return TS_FRAME_NOT_FOUND;
+
+    struct ts_frame_column *column = &frame->columns[key->type];
+    const size_t row = find_row(column, key->type, key);
+
+    // the rows of a column are in the order of their positions
+    return row < column->length ? column->positions[row] : TS_FRAME_NOT_FOUND;
+}
+
+extern size_t ts_frame_count(ts_frame_t *frame, ts_generic_t key)
+{
+    if (key->type > TS_TYPE_NONE)
+        return 0;
+
+    struct ts_frame_column *column = &frame->columns[key->type];
+    size_t count = 0;
+
+    switch (key->type)
+    {
+    case TS_TYPE_INTEGER:
+    case TS_TYPE_UNSIGNED:
+        return count_int32((const int32_t *)column->data, column->length, key->data.integer);
+    case TS_TYPE_FLOAT64:
+        return count_float64((const double *)column->data, column->length, key->data.float64);
+    case TS_TYPE_NONE:
+        return column->length;
+    default:
+        for (size_t row = 0; row < column->length; ++row)
+            count += cell_equal(column, key->type, row, key);
+        return count;
+    }
+}
+
+/* Returns a new allocated copy of the least, or the greatest, value of
+ * the numeric column of the type.
+ * */
+static ts_generic_t min_max(ts_frame_t *frame, ts_types type, bool max)
+{
+    if (!IS_NUMERIC(type) || frame->columns[type].length == 0)
+        return NULL;
+
+    struct ts_frame_column *column = &frame->columns[type];
+
+    switch (type)
+    {
+    case TS_TYPE_INTEGER:
+        return ts_new_int(min_max_int32((const int32_t *)column->data, column->length, max));
+    case TS_TYPE_FLOAT64:
+        return ts_new_float64(min_max_float64((const double *)column->data, column->length, max));
+    default:
+        return ts_frame_get(frame, column->positions[min_max_row(column, type, max)]);
+    }
+}
+
+extern ts_generic_t ts_frame_min(ts_frame_t *frame, ts_types type)
+{
+    return min_max(frame, type, false);
+}
+
+extern ts_generic_t ts_frame_max(ts_frame_t *frame, ts_types type)
+{
+    return min_max(frame, type, true);
+}
+
+extern ts_generic_t ts_frame_sum(ts_frame_t *frame, ts_types type)
+{
+    if (!IS_NUMERIC(type))
+        return NULL;
+
+    struct ts_frame_column *column = &frame->columns[type];
+    uint64_t integers = 0;
+    double reals = 0;
+
+    switch (type)
+    {
+    case TS_TYPE_INTEGER:
+        return ts_new_int64(sum_int32((const int32_t *)column->data, column->length));
+    case TS_TYPE_FLOAT64:
+        return ts_new_float64(sum_float64((const double *)column->data, column->length));
+    case TS_TYPE_FLOAT32:
+        for (size_t row = 0; row < column->length; ++row)
+            reals += ((const float *)column->data)[row];
+        return ts_new_float64(reals);
+    case TS_TYPE_UNSIGNED:
+        for (size_t row = 0; row < column->length; ++row)
+            integers += ((const uint32_t *)column->data)[row];
+        return ts_new_uint64(integers);
+    case TS_TYPE_INT64:
+        for (size_t row = 0; row < column->length; ++row)
+            integers += (uint64_t)((const int64_t *)column->data)[row];
+        return ts_new_int64((int64_t)integers);
+    default:
+        for (size_t row = 0; row < column->length; ++row)
+            integers += ((const uint64_t *)column->data)[row];
+        return ts_new_uint64(integers);
+    }
+}
+
+extern ts_frame_t *ts_frame_new(void)
+{
+    ts_frame_t *frame = (ts_frame_t *)calloc(1, sizeof(ts_frame_t));
+
+    if (frame != NULL)
+    {
+        /* Associated functions. */
+        frame->push = &ts_frame_push;
+        frame->get = &ts_frame_get;
+    }
+
+    return frame;
+}
+
+extern void ts_frame_free(ts_frame_t **frame)
+{
+    if (*frame != NULL)
+    {
+        for (int type = 0; type < TS_FRAME_COLUMNS; ++type)
+        {
+            free((*frame)->columns[type].data);
+            free((*frame)->columns[type].positions);
+            free((*frame)->columns[type].chars);
+        }
+
+        free((*frame)->rows);
+        free((*frame)->types);
+        free(*frame);
+        *frame = NULL;
+    }
+
+#ifdef _MAKE_ROBUST_CHECK
+    assert(*frame == NULL);
+#endif
+}
@@ -0,0 +1,233 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * MIT License                                                                       *
+ *                                                                                   *
+ * Copyright (c) 2022-2024 Anaxímeno Brito                                           *
+ *                                                                                   *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy      *
+ * of this software and associated documentation files (the "Software"), to deal     *
+ * in the Software without restriction, including without limitation the rights      *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell         *
+ * copies of the Software, and to permit persons to whom the Software is             *
+ * furnished to do so, subject to the following conditions:                          *
+ *                                                                                   *
+ * The above copyright notice and this permission notice shall be included in all    *
+ * copies or substantial portions of the Software.                                   *
+ *                                                                                   *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR        *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,          *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE       *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER            *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,     *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE     *
+ * SOFTWARE.                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "../include/3s/core.h"
+#include "../include/3s/tree.h"
+#include "../include/3s/frozen_tree.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <assert.h>
+
+#ifdef __GNUC__
+#define PREFETCH(ADDRESS) __builtin_prefetch(ADDRESS)
+#else
+#define PREFETCH(ADDRESS) ((void)(ADDRESS))
+#endif
+
+/* Returns true for the values which fit on the dense key array. */
+#define IS_INTEGER_KEY(VALUE)                                                    \
+    ((VALUE)->type == TS_TYPE_INTEGER || (VALUE)->type == TS_TYPE_UNSIGNED ||    \
+     (VALUE)->type == TS_TYPE_INT64 ||                                           \
+     ((VALUE)->type == TS_TYPE_UINT64 && (VALUE)->data.uinteger64 <= INT64_MAX))
+
+/* Returns the value of an integer typed generic as a key. */
+static int64_t integer_key(ts_generic_t value)
+{
+    switch (value->type)
+    {
+    case TS_TYPE_INTEGER:
+        return value->data.integer;
+    case TS_TYPE_UNSIGNED:
+        return value->data.uinteger;
+    case TS_TYPE_INT64:
+        return value->data.integer64;
+    default:
+        return (int64_t)value->data.uinteger64;
+    }
+}
+
+/* Fills the Eytzinger array from the sorted values given by the cursor. The
+ * in order walk of the implicit tree rooted on k visits the array positions
+ * in sorted order. The recursion is bounded by the depth of the implicit tree.
+ * */
+static void fill_eytzinger(ts_frozen_tree_t *frozen, ts_tree_cursor_t *cursor, size_t k)
+{
+    if (k <= frozen->length)
+    {
+        fill_eytzinger(frozen, cursor, 2 * k);
+
+        ts_generic_t value = ts_tree_cursor_value(cursor);
+
+#ifdef _MAKE_ROBUST_CHECK
+        assert(value != NULL);
+#endif
+
+        frozen->values[k] = *value;
+        if (frozen->keys != NULL)
+            frozen->keys[k] = integer_key(value);
+
+        ts_tree_cursor_next(cursor);
+        fill_eytzinger(frozen, cursor, 2 * k + 1);
+    }
+}
+
+/* Returns the position, on the Eytzinger array, of the first value not
+ * less than the key, or zero if there's none. The descent has no branches
+ * besides the loop itself: the comparison result picks the next child.
+ * */
+static size_t layer_lower_bound(ts_frozen_tree_t *frozen, ts_generic_t key)
+{
+    const size_t length = frozen->length;
+    size_t k = 1;
+
+    if (frozen->keys != NULL && IS_INTEGER_KEY(key))
+    {
+        const int64_t *keys = frozen->keys;
+        const int64_t x = integer_key(key);
+
+        while (k <= length)
+        {
+            /* A cache line holds the keys of the descendants three levels down. */
+            PREFETCH(keys + 8 * k);
+            k = 2 * k + (keys[k] < x);
+        }
+    }
+    else
+    {
+        const struct ts_generic_t *values = frozen->values;
+
+        while (k <= length)
+        {
+            PREFETCH(values + 4 * k);
+            k = 2 * k + (ts_generic_t_cmp((ts_generic_t)&values[k], key) == TS_LESS);
+        }
+    }
+
+    /* Climb back to the last node where the search went left, by
+     * dropping the trailing right turns and then the left one.
+     * */
+#ifdef __GNUC__
+    k >>= __builtin_ffsll(~(long long)k);
+#else
+    while (k & 1)
+        k >>= 1;
+    k >>= 1;
+#endif
+
+    return k;
+}
+
+/* Returns the layer, of the chain of frozen side trees, whose values
+ * can be compared with the key.
+ * */
+static ts_frozen_tree_t *layer_of_key(ts_frozen_tree_t *frozen, ts_generic_t key)
+{
+    for (; frozen != NULL; frozen = frozen->next)
+        if (frozen->length > 0 && ts_generic_t_cmp(&frozen->values[1], key) != TS_DIFFERENT)
+            return frozen;
+    return NULL;
+}
+
+extern ts_generic_t ts_frozen_tree_lower_bound(ts_frozen_tree_t *frozen, ts_generic_t key)
+{
+    ts_frozen_tree_t *layer = key != NULL ? layer_of_key(frozen, key) : NULL;
+    const size_t k = layer != NULL ? layer_lower_bound(layer, key) : 0;
+
+    return k > 0 ? &layer->values[k] : NULL;
+}
+
+extern bool ts_frozen_tree_contains(ts_frozen_tree_t *frozen, ts_generic_t key)
+{
+    ts_generic_t found = ts_frozen_tree_lower_bound(frozen, key);
+    return found != NULL && ts_generic_t_cmp(found, key) == TS_EQUAL;
+}
+
+/* Freezes the values of the tree, without its side trees. */
+static ts_frozen_tree_t *freeze_layer(ts_tree_t *tree)
+{
+    ts_frozen_tree_t *frozen = (ts_frozen_tree_t *)malloc(sizeof(ts_frozen_tree_t));
+
+    if (frozen != NULL)
+    {
+        bool integers_only = tree->size > 0;
+        ts_tree_cursor_t cursor = ts_tree_cursor(tree);
+
+        for (size_t i = 0; i < tree->size; ++i, ts_tree_cursor_next(&cursor))
+            integers_only = integers_only && IS_INTEGER_KEY(ts_tree_cursor_value(&cursor));
+
+        frozen->length = tree->size;
+        frozen->next = NULL;
+        frozen->values = (struct ts_generic_t *)malloc((tree->size + 1) * sizeof(struct ts_generic_t));
+        frozen->keys = integers_only ? (int64_t *)malloc((tree->size + 1) * sizeof(int64_t)) : NULL;
+
+        frozen->lower_bound = &ts_frozen_tree_lower_bound;
+        frozen->contains = &ts_frozen_tree_contains;
+
+        if (frozen->values == NULL || (integers_only && frozen->keys == NULL))
+        {
+            ts_frozen_tree_free(&frozen);
+            return NULL;
+        }
+
+        ts_tree_cursor_first(&cursor);
+        fill_eytzinger(frozen, &cursor, 1);
+    }
+
+    return frozen;
+}
+
+extern ts_frozen_tree_t *ts_tree_freeze(ts_tree_t *tree)
+{
+    ts_frozen_tree_t *frozen = NULL;
+    ts_frozen_tree_t **link = &frozen;
+
+    if (tree == NULL)
+        return NULL;
+
+    /* Empty side trees, left behind by removals, are skipped. */
+    for (ts_tree_t *layer = tree; layer != NULL; layer = layer->next)
+    {
+        if (layer->size == 0 && layer != tree)
+            continue;
+
+        if ((*link = freeze_layer(layer)) == NULL)
+        {
+            ts_frozen_tree_free(&frozen);
+            return NULL;
+        }
+
+        link = &(*link)->next;
+    }
+
+    return frozen;
+}
+
+extern void ts_frozen_tree_free(ts_frozen_tree_t **frozen)
+{
+    while (*frozen != NULL)
+    {
+        ts_frozen_tree_t *next = (*frozen)->next;
+
+        free((*frozen)->values);
+        free((*frozen)->keys);
+        free(*frozen);
+        *frozen = next;
+    }
+
+#ifdef _MAKE_ROBUST_CHECK
+    assert(*frozen == NULL);
+#endif
+}
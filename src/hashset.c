@@ -0,0 +1,168 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * MIT License                                                                       *
+ *                                                                                   *
+ * Copyright (c) 2022-2024 Anaxímeno Brito                                           *
+ *                                                                                   *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy      *
+ * of this software and associated documentation files (the "Software"), to deal     *
+ * in the Software without restriction, including without limitation the rights      *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell         *
+ * copies of the Software, and to permit persons to whom the Software is             *
+ * furnished to do so, subject to the following conditions:                          *
+ *                                                                                   *
+ * The above copyright notice and this permission notice shall be included in all    *
+ * copies or substantial portions of the Software.                                   *
+ *                                                                                   *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR        *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,          *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE       *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER            *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,     *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE     *
+ * SOFTWARE.                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#include "../include/3s/core.h"
+#include "../include/3s/hashtable.h"
+#include "../include/3s/hashset.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+
+extern bool ts_hashset_add(ts_hashset_t *set, ts_generic_t value)
+{
+    return ts_hashtable_put(set->table, value, NULL);
+}
+
+extern bool ts_hashset_contains(ts_hashset_t *set, ts_generic_t value)
+{
+    return ts_hashtable_contains(set->table, value);
+}
+
+extern bool ts_hashset_remove(ts_hashset_t *set, ts_generic_t value)
+{
+    return ts_hashtable_remove(set->table, value);
+}
+
+extern size_t ts_hashset_length(ts_hashset_t *set)
+{
+    return set->table->length;
+}
+
+extern bool ts_hashset_reserve(ts_hashset_t *set, size_t length)
+{
+    return ts_hashtable_reserve(set->table, length);
+}
+
+/* Adds to the result copies of the members of the source for which the
+ * presence on the filter is as wanted, or all of them without a filter.
+ * Returns false if a copy could not be allocated.
+ * */
+static bool copy_members(ts_hashset_t *result, ts_hashset_t *source, ts_hashset_t *filter, bool wanted)
+{
+    ts_hashtable_iter_t iter = ts_hashset_iter(source);
+
+    while (ts_hashset_iter_next(&iter))
+    {
+        if (filter == NULL || ts_hashset_contains(filter, iter.key) == wanted)
+        {
+            ts_generic_t copy = ts_generic_t_copy(iter.key);
+
+            if (copy == NULL)
+                return false;
+            ts_hashset_add(result, copy);
+        }
+    }
+
+    return true;
+}
+
+/* Returns a new owning set sized for the given number of members. */
+static ts_hashset_t *presized(size_t length)
+{
+    ts_hashset_t *result = ts_hashset_new(true);
+
+    if (result != NULL && !ts_hashset_reserve(result, length))
+        ts_hashset_free(&result);
+
+    return result;
+}
+
+extern ts_hashset_t *ts_hashset_union(ts_hashset_t *set1, ts_hashset_t *set2)
+{
+    ts_hashset_t *result = presized(ts_hashset_length(set1) + ts_hashset_length(set2));
+
+    if (result != NULL && !(copy_members(result, set1, NULL, true) && copy_members(result, set2, set1, false)))
+        ts_hashset_free(&result);
+
+    return result;
+}
+
+extern ts_hashset_t *ts_hashset_intersect(ts_hashset_t *set1, ts_hashset_t *set2)
+{
+    ts_hashset_t *smaller = ts_hashset_length(set1) <= ts_hashset_length(set2) ? set1 : set2;
+    ts_hashset_t *larger = smaller == set1 ? set2 : set1;
+    ts_hashset_t *result = presized(ts_hashset_length(smaller));
+
+    if (result != NULL && !copy_members(result, smaller, larger, true))
+        ts_hashset_free(&result);
+
+    return result;
+}
+
+extern ts_hashset_t *ts_hashset_difference(ts_hashset_t *set1, ts_hashset_t *set2)
+{
+    ts_hashset_t *result = presized(ts_hashset_length(set1));
+
+    if (result != NULL && !copy_members(result, set1, set2, false))
+        ts_hashset_free(&result);
+
+    return result;
+}
+
+extern ts_hashtable_iter_t ts_hashset_iter(ts_hashset_t *set)
+{
+    return ts_hashtable_iter(set->table);
+}
+
+extern bool ts_hashset_iter_next(ts_hashtable_iter_t *iter)
+{
+    return ts_hashtable_iter_next(iter);
+}
+
+extern ts_hashset_t *ts_hashset_new(bool owner)
+{
+    ts_hashset_t *set = (ts_hashset_t *)malloc(sizeof(ts_hashset_t));
+
+    if (set != NULL)
+    {
+        set->table = ts_hashtable_new(TS_HASHTABLE_DEFAULT_LOAD, owner);
+
+        if (set->table == NULL)
+        {
+            free(set);
+            return NULL;
+        }
+
+        /* Associated functions. */
+        set->add = &ts_hashset_add;
+        set->contains = &ts_hashset_contains;
+        set->remove = &ts_hashset_remove;
+    }
+
+    return set;
+}
+
+extern void ts_hashset_free(ts_hashset_t **set)
+{
+    if (*set != NULL)
+    {
+        ts_hashtable_free(&(*set)->table);
+        free(*set);
+        *set = NULL;
+    }
+
+#ifdef _MAKE_ROBUST_CHECK
+    assert(*set == NULL);
+#endif
+}
@@ -0,0 +1,454 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * MIT License                                                                       *
+ *                                                                                   *
+ * Copyright (c) 2022-2024 Anaxímeno Brito                                           *
+ *                                                                                   *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy      *
+ * of this software and associated documentation files (the "Software"), to deal     *
+ * in the Software without restriction, including without limitation the rights      *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell         *
+ * copies of the Software, and to permit persons to whom the Software is             *
+ * furnished to do so, subject to the following conditions:                          *
+ *                                                                                   *
+ * The above copyright notice and this permission notice shall be included in all    *
+ * copies or substantial portions of the Software.                                   *
+ *                                                                                   *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR        *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,          *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE       *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER            *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,     *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE     *
+ * SOFTWARE.                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#include "../include/3s/core.h"
+#include "../include/3s/hashtable.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include <assert.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/* Control byte of a slot never used. */
+#define CTRL_EMPTY 0x00
+/* Control byte of a slot whose key was removed. */
+#define CTRL_DELETED 0x01
+/* Returned when no slot holds the key. */
+#define NOT_FOUND SIZE_MAX
+
+#define H2(HASH) ((uint8_t)(0x80 | ((HASH) & 0x7F)))
+#define IS_FULL(CTRL) (((CTRL) & 0x80) != 0)
+#define IS_MIGRATING(TABLE) ((TABLE)->old.capacity != 0)
+
+/* Returns a mask with the bit i set if the control byte i of the
+ * group is equal to the given one.
+ * */
+static uint32_t match_byte(const uint8_t *group, uint8_t byte)
+{
+#ifdef __SSE2__
+    const __m128i ctrl = _mm_loadu_si128((const __m128i *)group);
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)byte)));
+#else
+    uint32_t mask = 0;
+    for (int i = 0; i < TS_HASHTABLE_GROUP_WIDTH; ++i)
+        mask |= (uint32_t)(group[i] == byte) << i;
+    return mask;
+#endif
+}
+
+/* Returns a mask with the bit i set if the slot i of the group is
+ * empty or deleted, the only control bytes without the high bit set.
+ * */
+static uint32_t match_free(const uint8_t *group)
+{
+#ifdef __SSE2__
+    return ~(uint32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)group)) & 0xFFFF;
+#else
+    uint32_t mask = 0;
+    for (int i = 0; i < TS_HASHTABLE_GROUP_WIDTH; ++i)
+        mask |= (uint32_t)(!IS_FULL(group[i])) << i;
+    return mask;
+#endif
+}
+
+/* Returns the smallest capacity keeping the given number of keys under
+ * the load factor, always leaving an empty slot to end the probes.
+ * */
+static size_t capacity_for(size_t length, double max_load)
+{
+    size_t capacity = TS_HASHTABLE_GROUP_WIDTH;
+
+    while ((double)length > capacity * max_load || length >= capacity)
+        capacity *= 2;
+
+    return capacity;
+}
+
+static bool store_init(struct ts_hashtable_store *store, size_t capacity)
+{
+    store->ctrl = (uint8_t *)calloc(capacity, sizeof(uint8_t));
+    store->slots = (struct ts_hashtable_slot *)malloc(capacity * sizeof(struct ts_hashtable_slot));
+
+    if (store->ctrl == NULL || store->slots == NULL)
+    {
+        free(store->ctrl);
+        free(store->slots);
+        return false;
+    }
+
+    store->capacity = capacity;
+    store->tombstones = 0;
+    return true;
+}
+
+/* Frees the arrays of the store, and the entries too when asked. */
+static void store_release(struct ts_hashtable_store *store, bool entries)
+{
+    for (size_t i = 0; entries && i < store->capacity; ++i)
+    {
+        if (IS_FULL(store->ctrl[i]))
+        {
+            ts_generic_t_free(store->slots[i].key);
+            ts_generic_t_free(store->slots[i].value);
+        }
+    }
+
+    free(store->ctrl);
+    free(store->slots);
+    store->ctrl = NULL;
+    store->slots = NULL;
+    store->capacity = 0;
+    store->tombstones = 0;
+}
+
+/* Returns the index of the slot holding the key, or NOT_FOUND. Groups
+ * are probed with triangular steps, which visit all of them when their
+ * number is a power of two, until one with an empty slot.
+ * */
+static size_t find_slot(const struct ts_hashtable_store *store, ts_generic_t key, uint64_t hash)
+{
+    if (store->capacity == 0)
+        return NOT_FOUND;
+
+    const size_t groups_mask = store->capacity / TS_HASHTABLE_GROUP_WIDTH - 1;
+    size_t group = (size_t)(hash >> 7) & groups_mask;
+
+    for (size_t step = 1; step <= groups_mask + 1; ++step)
+    {
+        const uint8_t *ctrl = store->ctrl + group * TS_HASHTABLE_GROUP_WIDTH;
+        uint32_t mask = match_byte(ctrl, H2(hash));
+
+        while (mask != 0)
+        {
+            const size_t index = group * TS_HASHTABLE_GROUP_WIDTH + __builtin_ctz(mask);
+
+            if (ts_generic_t_cmp(store->slots[index].key, key) == TS_EQUAL)
+                return index;
+            mask &= mask - 1;
+        }
+
+        if (match_byte(ctrl, CTRL_EMPTY) != 0)
+            break;
+
+        group = (group + step) & groups_mask;
+    }
+
+    return NOT_FOUND;
+}
+
+/* Looks for the key on the table store and then on the old one, setting
+ * the store where it was found.
+ * */
+static size_t find_entry(ts_hashtable_t *table, ts_generic_t key, uint64_t hash,
+                         struct ts_hashtable_store **store)
+{
+    size_t index = find_slot(&table->store, key, hash);
+    *store = &table->store;
+
+    if (index == NOT_FOUND && IS_MIGRATING(table))
+    {
+        index = find_slot(&table->old, key, hash);
+        *store = &table->old;
+    }
+
+    return index;
+}
+
+/* Returns the index of the first empty or deleted slot on the probe
+ * sequence of the hash.
+ * */
+static size_t find_free(const struct ts_hashtable_store *store, uint64_t hash)
+{
+    const size_t groups_mask = store->capacity / TS_HASHTABLE_GROUP_WIDTH - 1;
+    size_t group = (size_t)(hash >> 7) & groups_mask;
+    uint32_t mask;
+
+    for (size_t step = 1; (mask = match_free(store->ctrl + group * TS_HASHTABLE_GROUP_WIDTH)) == 0; ++step)
+        group = (group + step) & groups_mask;
+
+    return group * TS_HASHTABLE_GROUP_WIDTH + __builtin_ctz(mask);
+}
+
+/* Stores the entry on a free slot, which must exist. */
+static void store_insert(struct ts_hashtable_store *store, ts_generic_t key, ts_generic_t value, uint64_t hash)
+{
+    const size_t index = find_free(store, hash);
+
+    if (store->ctrl[index] == CTRL_DELETED)
+        store->tombstones--;
+
+    store->ctrl[index] = H2(hash);
+    store->slots[index].key = key;
+    store->slots[index].value = value;
+}
+
+/* Moves up to the given number of slots from the old store to the table
+ * store, releasing the old one once all were moved.
+ * */
+static void migrate(ts_hashtable_t *table, size_t slots)
+{
+    struct ts_hashtable_store *old = &table->old;
+    const size_t end = old->capacity - table->migrated > slots ? table->migrated + slots : old->capacity;
+
+    for (size_t i = table->migrated; i < end; ++i)
+    {
+        if (IS_FULL(old->ctrl[i]))
+        {
+            store_insert(&table->store, old->slots[i].key, old->slots[i].value,
+                         ts_generic_t_hash(old->slots[i].key));
+            // still probed by the lookups of keys not moved yet
+            old->ctrl[i] = CTRL_DELETED;
+        }
+    }
+
+    table->migrated = end;
+
+    if (end == old->capacity)
+        store_release(old, false);
+}
+
+/* Moves all the entries to a new store of the given capacity, dropping
+ * the tombstones. Incremental tables keep the current store as the old
+ * one, to be moved later. Returns false if the memory could not be
+ * allocated.
+ * */
+static bool resize(ts_hashtable_t *table, size_t capacity, bool incremental)
+{
+    struct ts_hashtable_store store;
+
+    if (IS_MIGRATING(table))
+        migrate(table, SIZE_MAX);
+
+    if (!store_init(&store, capacity))
+        return false;
+
+    table->old = table->store;
+    table->store = store;
+    table->migrated = 0;
+
+    if (!incremental)
+        migrate(table, SIZE_MAX);
+
+    return true;
+}
+
+/* Returns true if one more key can be stored without going over the
+ * load factor, resizing the table when needed.
+ * */
+static bool make_room(ts_hashtable_t *table)
+{
+    struct ts_hashtable_store *store = &table->store;
+    // entries still on the old store count too, as they will be moved
+    const size_t used = table->length + store->tombstones + 1;
+
+    if (store->capacity != 0 && (double)used <= store->capacity * table->max_load)
+        return true;
+
+    // the new store is left at most half loaded, which keeps the same
+    // capacity when the tombstones are what fills the table, and leaves
+    // incremental resizes room to finish before the next one
+    size_t capacity = capacity_for(2 * table->length, table->max_load);
+
+    if (capacity < store->capacity)
+        capacity = store->capacity;
+
+    return resize(table, capacity, table->incremental) || used < store->capacity;
+}
+
+extern bool ts_hashtable_put(ts_hashtable_t *table, ts_generic_t key, ts_generic_t value)
+{
+    const uint64_t hash = ts_generic_t_hash(key);
+    struct ts_hashtable_store *store;
+
+    if (IS_MIGRATING(table))
+        migrate(table, TS_HASHTABLE_MIGRATE_STEP);
+
+    const size_t index = find_entry(table, key, hash, &store);
+
+    if (index != NOT_FOUND)
+    {
+        struct ts_hashtable_slot *slot = &store->slots[index];
+
+        if (table->owner)
+        {
+            if (slot->value != value)
+                ts_generic_t_free(slot->value);
+            if (slot->key != key)
+                ts_generic_t_free(key);
+        }
+
+        slot->value = value;
+        return false;
+    }
+
+    if (!make_room(table))
+    {
+        if (table->owner)
+        {
+            ts_generic_t_free(key);
+            ts_generic_t_free(value);
+        }
+        return false;
+    }
+
+    store_insert(&table->store, key, value, hash);
+    table->length++;
+    return true;
+}
+
+extern ts_generic_t ts_hashtable_get(ts_hashtable_t *table, ts_generic_t key)
+{
+    struct ts_hashtable_store *store;
+    const size_t index = find_entry(table, key, ts_generic_t_hash(key), &store);
+
+    return index != NOT_FOUND ? store->slots[index].value : NULL;
+}
+
+extern bool ts_hashtable_contains(ts_hashtable_t *table, ts_generic_t key)
+{
+    struct ts_hashtable_store *store;
+    return find_entry(table, key, ts_generic_t_hash(key), &store) != NOT_FOUND;
+}
+
+extern bool ts_hashtable_remove(ts_hashtable_t *table, ts_generic_t key)
+{
+    struct ts_hashtable_store *store;
+
+    if (IS_MIGRATING(table))
+        migrate(table, TS_HASHTABLE_MIGRATE_STEP);
+
+    const size_t index = find_entry(table, key, ts_generic_t_hash(key), &store);
+
+    if (index == NOT_FOUND)
+        return false;
+
+    // probes stop on groups with an empty slot, so the slot can be
+    // emptied instead of deleted if its group already has one
+    if (match_byte(store->ctrl + (index & ~(size_t)(TS_HASHTABLE_GROUP_WIDTH - 1)), CTRL_EMPTY) != 0)
+        store->ctrl[index] = CTRL_EMPTY;
+    else
+    {
+        store->ctrl[index] = CTRL_DELETED;
+        store->tombstones++;
+    }
+
+    if (table->owner)
+    {
+        ts_generic_t_free(store->slots[index].key);
+        ts_generic_t_free(store->slots[index].value);
+    }
+
+    table->length--;
+    return true;
+}
+
+extern bool ts_hashtable_reserve(ts_hashtable_t *table, size_t length)
+{
+    const size_t capacity = capacity_for(length, table->max_load);
+
+    if (IS_MIGRATING(table))
+        migrate(table, SIZE_MAX);
+
+    return capacity <= table->store.capacity || resize(table, capacity, false);
+}
+
+extern ts_hashtable_iter_t ts_hashtable_iter(ts_hashtable_t *table)
+{
+    ts_hashtable_iter_t iter = {.table = table, .index = 0, .key = NULL, .value = NULL};
+    return iter;
+}
+
+extern bool ts_hashtable_iter_next(ts_hashtable_iter_t *iter)
+{
+    const struct ts_hashtable_store *current = &iter->table->store;
+    const struct ts_hashtable_store *old = &iter->table->old;
+
+    // the slots of the old store come after the ones of the current store
+    while (iter->index < current->capacity + old->capacity)
+    {
+        const size_t index = iter->index++;
+        const struct ts_hashtable_store *store = index < current->capacity ? current : old;
+        const size_t slot = index < current->capacity ? index : index - current->capacity;
+
+        if (IS_FULL(store->ctrl[slot]))
+        {
+            iter->key = store->slots[slot].key;
+            iter->value = store->slots[slot].value;
+            return true;
+        }
+    }
+
+    iter->key = NULL;
+    iter->value = NULL;
+    return false;
+}
+
+static ts_hashtable_t *hashtable_new(double max_load, bool owner, bool incremental)
+{
+    ts_hashtable_t *table = (ts_hashtable_t *)calloc(1, sizeof(ts_hashtable_t));
+
+    if (table != NULL)
+    {
+        table->max_load = max_load > 0 && max_load < 1 ? max_load : TS_HASHTABLE_DEFAULT_LOAD;
+        table->owner = owner;
+        table->incremental = incremental;
+
+        /* Associated functions. */
+        table->put = &ts_hashtable_put;
+        table->get = &ts_hashtable_get;
+        table->contains = &ts_hashtable_contains;
+        table->remove = &ts_hashtable_remove;
+    }
+
+    return table;
+}
+
+extern ts_hashtable_t *ts_hashtable_new(double max_load, bool owner)
+{
+    return hashtable_new(max_load, owner, false);
+}
+
+extern ts_hashtable_t *ts_hashtable_new_incremental(double max_load, bool owner)
+{
+    return hashtable_new(max_load, owner, true);
+}
+
+extern void ts_hashtable_free(ts_hashtable_t **table)
+{
+    if (*table != NULL)
+    {
+        store_release(&(*table)->store, (*table)->owner);
+        store_release(&(*table)->old, (*table)->owner);
+        free(*table);
+        *table = NULL;
+    }
+
+#ifdef _MAKE_ROBUST_CHECK
+    assert(*table == NULL);
+#endif
+}
@@ -0,0 +1,251 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * MIT License                                                                       *
+ *                                                                                   *
+ * Copyright (c) 2022-2024 Anaxímeno Brito                                           *
+ *                                                                                   *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy      *
+ * of this software and associated documentation files (the "Software"), to deal     *
+ * in the Software without restriction, including without limitation the rights      *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell         *
+ * copies of the Software, and to permit persons to whom the Software is             *
+ * furnished to do so, subject to the following conditions:                          *
+ *                                                                                   *
+ * The above copyright notice and this permission notice shall be included in all    *
+ * copies or substantial portions of the Software.                                   *
+ *                                                                                   *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR        *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,          *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE       *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER            *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,     *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE     *
+ * SOFTWARE.                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#include "../include/3s/core.h"
+#include "../include/3s/arena.h"
+#include "../include/3s/intern.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <pthread.h>
+
+#define MIN_CAPACITY 16
+
+static struct ts_intern_string *header_of(const char *interned)
+{
+    return (struct ts_intern_string *)(interned - offsetof(struct ts_intern_string, chars));
+}
+
+/* Returns the slot holding the characters, or the empty slot where they
+ * would go. The pool must have slots.
+ * */
+static struct ts_intern_string **find_slot(ts_intern_t *pool, const char *chars, size_t length, uint64_t hash)
+{
+    const size_t mask = pool->capacity - 1;
+
+    for (size_t i = (size_t)hash & mask;; i = (i + 1) & mask)
+    {
+        struct ts_intern_string *string = pool->slots[i];
+
+        if (string == NULL ||
+            (string->hash == hash && string->length == length && memcmp(string->chars, chars, length) == 0))
+            return &pool->slots[i];
+    }
+}
+
+/* Makes room for the given number of strings, at three quarters of the
+ * slots at most.
+ * */
+static bool reserve(ts_intern_t *pool, size_t length)
+{
+    size_t capacity = pool->capacity != 0 ? pool->capacity : MIN_CAPACITY;
+
+    while (capacity / 4 * 3 < length)
+        capacity *= 2;
+
+    if (capacity == pool->capacity)
+        return true;
+
+    struct ts_intern_string **slots = (struct ts_intern_string **)calloc(capacity, sizeof(*slots));
+
+    if (slots == NULL)
+        return false;
+
+    struct ts_intern_string **old = pool->slots;
+    const size_t old_capacity = pool->capacity;
+
+    pool->slots = slots;
+    pool->capacity = capacity;
+
+    for (size_t i = 0; i < old_capacity; ++i)
+    {
+        if (old[i] != NULL)
+            *find_slot(pool, old[i]->chars, old[i]->length, old[i]->hash) = old[i];
+    }
+
+    free(old);
+    return true;
+}
+
+/* Interns the characters, with the lock taken. */
+static const char *intern_locked(ts_intern_t *pool, const char *chars, size_t length)
+{
+    const uint64_t hash = ts_hash_bytes(chars, length);
+
+    if (!reserve(pool, pool->length + 1))
+        return NULL;
+
+    struct ts_intern_string **slot = find_slot(pool, chars, length, hash);
+
+    if (*slot != NULL)
+        return (*slot)->chars;
+
+    const size_t size = sizeof(struct ts_intern_string) + length + 1;
+    struct ts_intern_string *string = (struct ts_intern_string *)(pool->arena != NULL
+                                                                      ? ts_arena_alloc(pool->arena, size)
+                                                                      : malloc(size));
+
+    if (string == NULL)
+        return NULL;
+
+    string->hash = hash;
+    string->length = length;
+    memcpy(string->chars, chars, length);
+    string->chars[length] = '\0';
+
+    *slot = string;
+    pool->length++;
+    return string->chars;
+}
+
+extern const char *ts_intern(ts_intern_t *pool, const char *string)
+{
+    return ts_intern_n(pool, string, strlen(string));
+}
+
+extern const char *ts_intern_n(ts_intern_t *pool, const char *chars, size_t length)
+{
+    pthread_mutex_lock(&pool->lock);
+    const char *interned = intern_locked(pool, chars, length);
+    pthread_mutex_unlock(&pool->lock);
+
+    return interned;
+}
+
+extern bool ts_intern_many(ts_intern_t *pool, const char **strings, size_t length, const char **out)
+{
+    bool interned = true;
+
+    pthread_mutex_lock(&pool->lock);
+
+    // sized for all of them being new, so the pool grows at most once
+    reserve(pool, pool->length + length);
+
+    for (size_t i = 0; i < length; ++i)
+    {
+        out[i] = intern_locked(pool, strings[i], strlen(strings[i]));
+        interned &= out[i] != NULL;
+    }
+
+    pthread_mutex_unlock(&pool->lock);
+    return interned;
+}
+
+extern const char *ts_intern_lookup(ts_intern_t *pool, const char *string)
+{
+    const size_t length = strlen(string);
+    const uint64_t hash = ts_hash_bytes(string, length);
+    const char *interned = NULL;
+
+    pthread_mutex_lock(&pool->lock);
+
+    if (pool->capacity != 0)
+    {
+        struct ts_intern_string *found = *find_slot(pool, string, length, hash);
+        interned = found != NULL ? found->chars : NULL;
+    }
+
+    pthread_mutex_unlock(&pool->lock);
+    return interned;
+}
+
+extern ts_generic_t ts_intern_value(ts_intern_t *pool, const char *string)
+{
+    const char *interned = ts_intern(pool, string);
+
+    // the handle is never written through, string values just are not const
+    return interned != NULL ? ts_new_string((char *)interned) : NULL;
+}
+
+extern size_t ts_intern_length(const char *interned)
+{
+    return header_of(interned)->length;
+}
+
+extern uint64_t ts_intern_hash(const char *interned)
+{
+    return header_of(interned)->hash;
+}
+
+extern size_t ts_intern_count(ts_intern_t *pool)
+{
+    pthread_mutex_lock(&pool->lock);
+    const size_t length = pool->length;
+    pthread_mutex_unlock(&pool->lock);
+
+    return length;
+}
+
+extern ts_intern_t *ts_intern_new(bool arena)
+{
+    ts_intern_t *pool = (ts_intern_t *)malloc(sizeof(ts_intern_t));
+
+    if (pool != NULL)
+    {
+        pool->slots = NULL;
+        pool->capacity = 0;
+        pool->length = 0;
+        pool->arena = NULL;
+
+        if (arena && (pool->arena = ts_arena_new(0)) == NULL)
+        {
+            free(pool);
+            return NULL;
+        }
+
+        pthread_mutex_init(&pool->lock, NULL);
+
+        /* Associated functions. */
+        pool->intern = &ts_intern;
+    }
+
+    return pool;
+}
+
+extern void ts_intern_free(ts_intern_t **pool)
+{
+    if (*pool != NULL)
+    {
+        // an arena releases all the strings at once
+        if ((*pool)->arena != NULL)
+            ts_arena_free(&(*pool)->arena);
+        else
+        {
+            for (size_t i = 0; i < (*pool)->capacity; ++i)
+                free((*pool)->slots[i]);
+        }
+
+        pthread_mutex_destroy(&(*pool)->lock);
+        free((*pool)->slots);
+        free(*pool);
+        *pool = NULL;
+    }
+
+#ifdef _MAKE_ROBUST_CHECK
+    assert(*pool == NULL);
+#endif
+}
@@ -0,0 +1,313 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * MIT License                                                                       *
+ *                                                                                   *
+ * Copyright (c) 2022-2024 Anaxímeno Brito                                           *
+ *                                                                                   *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy      *
+ * of this software and associated documentation files (the "Software"), to deal     *
+ * in the Software without restriction, including without limitation the rights      *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell         *
+ * copies of the Software, and to permit persons to whom the Software is             *
+ * furnished to do so, subject to the following conditions:                          *
+ *                                                                                   *
+ * The above copyright notice and this permission notice shall be included in all    *
+ * copies or substantial portions of the Software.                                   *
+ *                                                                                   *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR        *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,          *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE       *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER            *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,     *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE     *
+ * SOFTWARE.                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#include "../include/3s/core.h"
+#include "../include/3s/llist.h"
+#include "../include/3s/tree.h"
+#include "../include/3s/hashtable.h"
+#include "../include/3s/iter.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+// -- Sources
+
+static ts_generic_t next_forward(ts_iter_t *iter)
+{
+    struct ts_linked_node *node = iter->state.list.node;
+
+    if (node == NULL)
+        return NULL;
+
+    iter->state.list.node = node->next;
+    return node->value;
+}
+
+static ts_generic_t next_backward(ts_iter_t *iter)
+{
+    struct ts_linked_node *node = iter->state.list.node;
+
+    if (node == NULL)
+        return NULL;
+
+    iter->state.list.node = node->prev;
+    return node->value;
+}
+
+static ts_generic_t next_in_tree(ts_iter_t *iter)
+{
+    ts_tree_cursor_t *cursor = &iter->state.tree.cursor;
+
+    // the cursor starts on the first value
+    if (iter->state.tree.started && !ts_tree_cursor_next(cursor))
+        return NULL;
+
+    iter->state.tree.started = true;
+    return ts_tree_cursor_value(cursor);
+}
+
+static ts_generic_t next_in_table(ts_iter_t *iter)
+{
+    ts_hashtable_iter_t *cursor = &iter->state.table.cursor;
+
+    if (!ts_hashtable_iter_next(cursor))
+        return NULL;
+
+    return iter->state.table.values ? cursor->value : cursor->key;
+}
+
+/* Returns an iterator walking the nodes from the given one. */
+static ts_iter_t iter_nodes(struct ts_linked_node *node, bool backward)
+{
+    ts_iter_t iter = {.next = backward ? &next_backward : &next_forward};
+
+    iter.state.list.node = node;
+    return iter;
+}
+
+extern ts_iter_t ts_iter_list(ts_list_t *list)
+{
+    return iter_nodes(list != NULL ? list->head : NULL, false);
+}
+
+extern ts_iter_t ts_iter_stack(ts_stack_t *stack)
+{
+    // the top of the stack is the tail of its list
+    return iter_nodes(stack != NULL && stack->list != NULL ? stack->list->tail : NULL, true);
+}
+
+extern ts_iter_t ts_iter_queue(ts_queue_t *queue)
+{
+    return iter_nodes(queue != NULL && queue->list != NULL ? queue->list->head : NULL, false);
+}
+
+extern ts_iter_t ts_iter_tree(ts_tree_t *tree)
+{
+    ts_iter_t iter = {.next = &next_in_tree};
+
+    iter.state.tree.cursor = ts_tree_cursor(tree);
+    iter.state.tree.started = false;
+
+    // an empty tree leaves the cursor out of it
+    if (ts_tree_cursor_value(&iter.state.tree.cursor) == NULL)
+        iter = iter_nodes(NULL, false);
+
+    return iter;
+}
+
+/* Returns an iterator over the keys or the values of the table. */
+static ts_iter_t iter_table(ts_hashtable_t *table, bool values)
+{
+    if (table == NULL)
+        return iter_nodes(NULL, false);
+
+    ts_iter_t iter = {.next = &next_in_table};
+
+    iter.state.table.cursor = ts_hashtable_iter(table);
+    iter.state.table.values = values;
+    return iter;
+}
+
+extern ts_iter_t ts_iter_keys(ts_hashtable_t *table)
+{
+    return iter_table(table, false);
+}
+
+extern ts_iter_t ts_iter_values(ts_hashtable_t *table)
+{
+    return iter_table(table, true);
+}
+
+// -- Adapters
+
+static ts_generic_t next_mapped(ts_iter_t *iter)
+{
+    ts_generic_t value = iter->state.adapter.source->next(iter->state.adapter.source);
+
+    if (value == NULL)
+        return NULL;
+
+    return iter->state.adapter.fn.map(value, &iter->out, iter->state.adapter.ctx);
+}
+
+static ts_generic_t next_filtered(ts_iter_t *iter)
+{
+    ts_iter_t *source = iter->state.adapter.source;
+    ts_generic_t value;
+
+    while ((value = source->next(source)) != NULL)
+        if (iter->state.adapter.fn.filter(value, iter->state.adapter.ctx))
+            return value;
+
+    return NULL;
+}
+
+static ts_generic_t next_taken(ts_iter_t *iter)
+{
+    if (iter->state.adapter.count == 0)
+        return NULL;
+
+    iter->state.adapter.count -= 1;
+    return iter->state.adapter.source->next(iter->state.adapter.source);
+}
+
+static ts_generic_t next_skipped(ts_iter_t *iter)
+{
+    ts_iter_t *source = iter->state.adapter.source;
+
+    // the values are skipped on the first pull
+    for (; iter->state.adapter.count > 0; --iter->state.adapter.count)
+        if (source->next(source) == NULL)
+        {
+            iter->state.adapter.count = 0;
+            return NULL;
+        }
+
+    return source->next(source);
+}
+
+static ts_generic_t next_zipped(ts_iter_t *iter)
+{
+    ts_generic_t first = iter->state.adapter.source->next(iter->state.adapter.source);
+
+    if (first == NULL)
+        return NULL;
+
+    ts_generic_t second = iter->state.adapter.other->next(iter->state.adapter.other);
+
+    if (second == NULL)
+        return NULL;
+
+    return iter->state.adapter.fn.zip(first, second, &iter->out, iter->state.adapter.ctx);
+}
+
+/* Returns an adapter of the source, pulling values with next. */
+static ts_iter_t iter_adapter(ts_iter_t *source, ts_generic_t (*next)(ts_iter_t *), void *ctx)
+{
+    ts_iter_t iter = {.next = next};
+
+    iter.state.adapter.source = source;
+    iter.state.adapter.other = NULL;
+    iter.state.adapter.ctx = ctx;
+    iter.state.adapter.count = 0;
+
+    // map and zip functions only set the type and the data
+    iter.out.type = TS_TYPE_NONE;
+    iter.out.repr = &ts_generic_t_repr;
+    iter.out.display = &ts_generic_t_display;
+    iter.out.compare = &ts_generic_t_cmp;
+    return iter;
+}
+
+extern ts_iter_t ts_iter_map(ts_iter_t *source, ts_iter_map_fn fn, void *ctx)
+{
+    ts_iter_t iter = iter_adapter(source, &next_mapped, ctx);
+
+    iter.state.adapter.fn.map = fn;
+    return iter;
+}
+
+extern ts_iter_t ts_iter_filter(ts_iter_t *source, ts_iter_filter_fn fn, void *ctx)
+{
+    ts_iter_t iter = iter_adapter(source, &next_filtered, ctx);
+
+    iter.state.adapter.fn.filter = fn;
+    return iter;
+}
+
+extern ts_iter_t ts_iter_take(ts_iter_t *source, size_t count)
+{
+    ts_iter_t iter = iter_adapter(source, &next_taken, NULL);
+
+    iter.state.adapter.count = count;
+    return iter;
+}
+
+extern ts_iter_t ts_iter_skip(ts_iter_t *source, size_t count)
+{
+    ts_iter_t iter = iter_adapter(source, &next_skipped, NULL);
+
+    iter.state.adapter.count = count;
+    return iter;
+}
+
+extern ts_iter_t ts_iter_zip(ts_iter_t *first, ts_iter_t *second, ts_iter_zip_fn fn, void *ctx)
+{
+    ts_iter_t iter = iter_adapter(first, &next_zipped, ctx);
+
+    iter.state.adapter.other = second;
+    iter.state.adapter.fn.zip = fn;
+    return iter;
+}
+
+// -- Terminals
+
+extern ts_generic_t ts_iter_next(ts_iter_t *iter)
+{
+    return iter->next(iter);
+}
+
+extern size_t ts_iter_count(ts_iter_t *iter)
+{
+    size_t count = 0;
+
+    while (iter->next(iter) != NULL)
+        count++;
+
+    return count;
+}
+
+extern size_t ts_iter_foreach(ts_iter_t *iter, ts_iter_visit_fn fn, void *ctx)
+{
+    ts_generic_t value;
+    size_t count = 0;
+
+    for (; (value = iter->next(iter)) != NULL; ++count)
+        fn(value, ctx);
+
+    return count;
+}
+
+extern ts_list_t *ts_iter_collect(ts_iter_t *iter)
+{
+    ts_list_t *list = ts_new_list();
+    ts_generic_t value;
+
+    while (list != NULL && (value = iter->next(iter)) != NULL)
+    {
+        const unsigned length = list->length;
+        ts_generic_t copy = ts_generic_t_copy(value);
+
+        if (copy != NULL)
+            ts_list_append_back(list, copy);
+
+        // either the copy or its node could not be allocated
+        if (list->length == length)
+        {
+            ts_generic_t_free(copy);
+            ts_list_free(&list);
+        }
+    }
+
+    return list;
+}
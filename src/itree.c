@@ -0,0 +1,383 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * MIT License                                                                       *
+ *                                                                                   *
+ * Copyright (c) 2022-2024 Anaxímeno Brito                                           *
+ *                                                                                   *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy      *
+ * of this software and associated documentation files (the "Software"), to deal     *
+ * in the Software without restriction, including without limitation the rights      *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell         *
+ * copies of the Software, and to permit persons to whom the Software is             *
+ * furnished to do so, subject to the following conditions:                          *
+ *                                                                                   *
+ * The above copyright notice and this permission notice shall be included in all    *
+ * copies or substantial portions of the Software.                                   *
+ *                                                                                   *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR        *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,          *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE       *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER            *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,     *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE     *
+ * SOFTWARE.                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#include "../include/3s/core.h"
+#include "../include/3s/itree.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <assert.h>
+
+_Static_assert(sizeof(struct ts_itree_node) == 16 + sizeof(union ts_data_type),
+               "index tree nodes should only hold three links, the type, the height and the value");
+
+#define NODE(TREE, INDEX) (&(TREE)->nodes[(INDEX)])
+#define HEIGHT(TREE, INDEX) ((INDEX) != TS_ITREE_NIL ? NODE(TREE, INDEX)->height : 0)
+#define MAX(A, B) ((A) > (B) ? (A) : (B))
+
+/* Compares the value with the one stored inline on the node. */
+static int node_cmp(ts_itree_t *tree, ts_generic_t value, uint32_t index)
+{
+    struct ts_generic_t stored = {.data = NODE(tree, index)->data, .type = NODE(tree, index)->type};
+    return ts_generic_t_class_cmp(value, &stored);
+}
+
+/* Frees what the value stored inline on the node owns. */
+static void release_value(ts_itree_t *tree, uint32_t index)
+{
+    struct ts_generic_t stored = {.data = NODE(tree, index)->data, .type = NODE(tree, index)->type};
+    ts_generic_t_release(&stored);
+}
+
+/* Returns the index of the node holding a value equal to the given one,
+ * or TS_ITREE_NIL.
+ * */
+static uint32_t find_node(ts_itree_t *tree, ts_generic_t value)
+{
+    uint32_t index = tree->root;
+
+    while (index != TS_ITREE_NIL)
+    {
+        const int cmp = node_cmp(tree, value, index);
+
+        if (cmp == TS_EQUAL)
+            break;
+        index = cmp == TS_LESS ? NODE(tree, index)->left : NODE(tree, index)->right;
+    }
+
+    return index;
+}
+
+/* Points the link of the parent that referenced old_child to new_child. */
+static void replace_child(ts_itree_t *tree, uint32_t parent, uint32_t old_child, uint32_t new_child)
+{
+    if (parent == TS_ITREE_NIL)
+        tree->root = new_child;
+    else if (NODE(tree, parent)->left == old_child)
+        NODE(tree, parent)->left = new_child;
+    else
+        NODE(tree, parent)->right = new_child;
+}
+
+static void update_height(ts_itree_t *tree, uint32_t index)
+{
+    struct ts_itree_node *node = NODE(tree, index);
+    node->height = MAX(HEIGHT(tree, node->left), HEIGHT(tree, node->right)) + 1;
+}
+
+/* Rotates the subtree rooted on the index, returning its new root. */
+static uint32_t rotate_left(ts_itree_t *tree, uint32_t index)
+{
+    struct ts_itree_node *node = NODE(tree, index);
+    const uint32_t pivot = node->right;
+
+    node->right = NODE(tree, pivot)->left;
+    if (node->right != TS_ITREE_NIL)
+        NODE(tree, node->right)->parent = index;
+
+    NODE(tree, pivot)->parent = node->parent;
+    replace_child(tree, node->parent, index, pivot);
+
+    NODE(tree, pivot)->left = index;
+    node->parent = pivot;
+
+    update_height(tree, index);
+    update_height(tree, pivot);
+    return pivot;
+}
+
+/* Rotates the subtree rooted on the index, returning its new root. */
+static uint32_t rotate_right(ts_itree_t *tree, uint32_t index)
+{
+    struct ts_itree_node *node = NODE(tree, index);
+    const uint32_t pivot = node->left;
+
+    node->left = NODE(tree, pivot)->right;
+    if (node->left != TS_ITREE_NIL)
+        NODE(tree, node->left)->parent = index;
+
+    NODE(tree, pivot)->parent = node->parent;
+    replace_child(tree, node->parent, index, pivot);
+
+    NODE(tree, pivot)->right = index;
+    node->parent = pivot;
+
+    update_height(tree, index);
+    update_height(tree, pivot);
+    return pivot;
+}
+
+/* Restores the AVL property from the node at the index up to the root. */
+static void rebalance(ts_itree_t *tree, uint32_t index)
+{
+    while (index != TS_ITREE_NIL)
+    {
+        struct ts_itree_node *node = NODE(tree, index);
+        const int balance = HEIGHT(tree, node->left) - HEIGHT(tree, node->right);
+
+        if (balance > 1)
+        {
+            if (HEIGHT(tree, NODE(tree, node->left)->left) < HEIGHT(tree, NODE(tree, node->left)->right))
+                rotate_left(tree, node->left);
+            index = rotate_right(tree, index);
+        }
+        else if (balance < -1)
+        {
+            if (HEIGHT(tree, NODE(tree, node->right)->right) < HEIGHT(tree, NODE(tree, node->right)->left))
+                rotate_right(tree, node->right);
+            index = rotate_left(tree, index);
+        }
+        else
+            update_height(tree, index);
+
+        index = NODE(tree, index)->parent;
+    }
+}
+
+/* Moves the last node of the array to the slot at the index, keeping
+ * the array dense after a node is unlinked.
+ * */
+static void fill_hole(ts_itree_t *tree, uint32_t hole)
+{
+    const uint32_t last = (uint32_t)(tree->length - 1);
+
+    if (hole != last)
+    {
+        struct ts_itree_node *node = NODE(tree, hole);
+
+        *node = *NODE(tree, last);
+        replace_child(tree, node->parent, last, hole);
+        if (node->left != TS_ITREE_NIL)
+            NODE(tree, node->left)->parent = hole;
+        if (node->right != TS_ITREE_NIL)
+            NODE(tree, node->right)->parent = hole;
+    }
+
+    tree->length--;
+}
+
+extern bool ts_itree_reserve(ts_itree_t *tree, size_t capacity)
+{
+    if (capacity <= tree->capacity)
+        return true;
+    if (capacity > TS_ITREE_MAX_LENGTH)
+        return false;
+
+    struct ts_itree_node *nodes = (struct ts_itree_node *)realloc(tree->nodes, capacity * sizeof(struct ts_itree_node));
+
+    if (nodes == NULL)
+        return false;
+
+    tree->nodes = nodes;
+    tree->capacity = capacity;
+    return true;
+}
+
+extern bool ts_itree_add(ts_itree_t *tree, ts_generic_t value)
+{
+    uint32_t parent = TS_ITREE_NIL;
+    uint32_t index = tree->root;
+    int cmp = TS_EQUAL;
+
+    while (index != TS_ITREE_NIL)
+    {
+        cmp = node_cmp(tree, value, index);
+
+        if (cmp == TS_EQUAL)
+        {
+            ts_generic_t_free(value);
+            return false;
+        }
+
+        parent = index;
+        index = cmp == TS_LESS ? NODE(tree, index)->left : NODE(tree, index)->right;
+    }
+
+    if (tree->length == tree->capacity)
+    {
+        size_t capacity = tree->capacity != 0 ? tree->capacity * 2 : 16;
+
+        if (capacity > TS_ITREE_MAX_LENGTH)
+            capacity = TS_ITREE_MAX_LENGTH;
+
+        if (!ts_itree_reserve(tree, capacity) || tree->length == tree->capacity)
+        {
+            ts_generic_t_free(value);
+            return false;
+        }
+    }
+
+    index = (uint32_t)tree->length++;
+
+    struct ts_itree_node *node = NODE(tree, index);
+    node->parent = parent;
+    node->left = TS_ITREE_NIL;
+    node->right = TS_ITREE_NIL;
+    node->type = (uint8_t)value->type;
+    node->height = 1;
+    node->data = value->data;
+    /* What the value owns moved to the node. */
+    free(value);
+
+    if (parent == TS_ITREE_NIL)
+        tree->root = index;
+    else if (cmp == TS_LESS)
+        NODE(tree, parent)->left = index;
+    else
+        NODE(tree, parent)->right = index;
+
+    rebalance(tree, parent);
+    return true;
+}
+
+extern bool ts_itree_contains(ts_itree_t *tree, ts_generic_t value)
+{
+    return find_node(tree, value) != TS_ITREE_NIL;
+}
+
+extern bool ts_itree_remove(ts_itree_t *tree, ts_generic_t value)
+{
+    uint32_t index = find_node(tree, value);
+
+    if (index == TS_ITREE_NIL)
+        return false;
+
+    struct ts_itree_node *node = NODE(tree, index);
+    release_value(tree, index);
+
+    // with two children, the successor value takes its place and the
+    // successor node, which has no left child, is the one unlinked
+    if (node->left != TS_ITREE_NIL && node->right != TS_ITREE_NIL)
+    {
+        uint32_t successor = node->right;
+
+        while (NODE(tree, successor)->left != TS_ITREE_NIL)
+            successor = NODE(tree, successor)->left;
+
+        node->type = NODE(tree, successor)->type;
+        node->data = NODE(tree, successor)->data;
+        index = successor;
+        node = NODE(tree, index);
+    }
+
+    const uint32_t child = node->left != TS_ITREE_NIL ? node->left : node->right;
+    const uint32_t parent = node->parent;
+
+    if (child != TS_ITREE_NIL)
+        NODE(tree, child)->parent = parent;
+    replace_child(tree, parent, index, child);
+
+    rebalance(tree, parent);
+    fill_hole(tree, index);
+    return true;
+}
+
+extern uint32_t ts_itree_first(ts_itree_t *tree)
+{
+    uint32_t index = tree->root;
+
+    while (index != TS_ITREE_NIL && NODE(tree, index)->left != TS_ITREE_NIL)
+        index = NODE(tree, index)->left;
+
+    return index;
+}
+
+extern uint32_t ts_itree_next(ts_itree_t *tree, uint32_t index)
+{
+#ifdef _MAKE_ROBUST_CHECK
+    assert(index < tree->length);
+#endif
+
+    if (NODE(tree, index)->right != TS_ITREE_NIL)
+    {
+        index = NODE(tree, index)->right;
+        while (NODE(tree, index)->left != TS_ITREE_NIL)
+            index = NODE(tree, index)->left;
+        return index;
+    }
+
+    uint32_t parent = NODE(tree, index)->parent;
+
+    while (parent != TS_ITREE_NIL && NODE(tree, parent)->right == index)
+    {
+        index = parent;
+        parent = NODE(tree, index)->parent;
+    }
+
+    return parent;
+}
+
+extern struct ts_generic_t ts_itree_value_at(ts_itree_t *tree, uint32_t index)
+{
+#ifdef _MAKE_ROBUST_CHECK
+    assert(index < tree->length);
+#endif
+
+    struct ts_generic_t value = {
+        .data = NODE(tree, index)->data,
+        .type = NODE(tree, index)->type,
+        .repr = &ts_generic_t_repr,
+        .display = &ts_generic_t_display,
+        .compare = &ts_generic_t_cmp,
+    };
+
+    return value;
+}
+
+extern ts_itree_t *ts_itree_new(void)
+{
+    ts_itree_t *tree = (ts_itree_t *)malloc(sizeof(ts_itree_t));
+
+    if (tree != NULL)
+    {
+        tree->nodes = NULL;
+        tree->length = 0;
+        tree->capacity = 0;
+        tree->root = TS_ITREE_NIL;
+
+        /* Associated functions. */
+        tree->add = &ts_itree_add;
+        tree->contains = &ts_itree_contains;
+        tree->remove = &ts_itree_remove;
+    }
+
+    return tree;
+}
+
+extern void ts_itree_free(ts_itree_t **tree)
+{
+    if (*tree != NULL)
+    {
+        for (size_t i = 0; i < (*tree)->length; ++i)
+            release_value(*tree, (uint32_t)i);
+
+        free((*tree)->nodes);
+        free(*tree);
+        *tree = NULL;
+    }
+
+#ifdef _MAKE_ROBUST_CHECK
+    assert(*tree == NULL);
+#endif
+}
@@ -24,6 +24,8 @@
 
 #include "../include/3s/core.h"
 #include "../include/3s/llist.h"
+#include "../include/3s/hashset.h"
+#include "../include/3s/pool.h"
 
 #include <stdlib.h>
 #include <stdio.h>
@@ -248,7 +250,7 @@ extern void ts_list_remove_at_index(ts_list_t *list, unsigned index)
             node->next = NULL;
             node->prev = NULL;
 
-            free(node->value);
+            ts_generic_t_free(node->value);
             free(node);
 
             node = NULL;
@@ -275,6 +277,277 @@ extern void ts_list_remove_value(ts_list_t *list, ts_generic_t value)
 #endif
 }
 
+/* Removes the values equal to an earlier one, keeping the first
+ * occurrences in order. Runs in linear time, with a hash set sized for
+ * the whole list up front, and leaves the list as it is when the memory
+ * for the set could not be allocated.
+ * */
+extern void ts_list_dedup(ts_list_t *list)
+{
+    // the set only borrows the values, which stay owned by the list
+    ts_hashset_t *seen = list != NULL ? ts_hashset_new(false) : NULL;
+
+    if (seen == NULL || !ts_hashset_reserve(seen, list->length))
+    {
+        ts_hashset_free(&seen);
+        return;
+    }
+
+    ts_linked_node node = list->head;
+
+    while (node != NULL)
+    {
+        ts_linked_node next = node->next;
+
+        // the set has room for the whole list, so only duplicates fail
+        if (!ts_hashset_add(seen, node->value))
+        {
+            if (node->prev != NULL)
+                node->prev->next = node->next;
+            if (node->next != NULL)
+                node->next->prev = node->prev;
+            if (node == list->tail)
+                list->tail = node->prev;
+
+            ts_generic_t_free(node->value);
+            free(node);
+            list->length -= 1;
+        }
+
+        node = next;
+    }
+
+    ts_hashset_free(&seen);
+}
+
+/* The nodes a chunk of a filtered list kept, linked together. */
+struct list_run
+{
+    ts_linked_node head;
+    ts_linked_node tail;
+    size_t length;
+};
+
+/* A bulk operation over the chunks of a list. */
+struct list_bulk
+{
+    /* The first node of each chunk. */
+    ts_linked_node *firsts;
+    size_t chunks;
+    /* The number of values of the list. */
+    size_t length;
+    ts_list_map_fn map;
+    ts_list_filter_fn keep;
+    ts_list_reduce_fn reduce;
+    void *ctx;
+    /* The nodes kept by each chunk, when filtering. */
+    struct list_run *runs;
+};
+
+/* Returns the number of values of the chunk. */
+static size_t chunk_length(struct list_bulk *bulk, size_t chunk)
+{
+    return (chunk + 1) * bulk->length / bulk->chunks - chunk * bulk->length / bulk->chunks;
+}
+
+/* Splits the list in chunks, walking it once to find their first nodes.
+ * Small lists, lists without a pool, and lists whose chunks could not be
+ * allocated make one chunk starting at first.
+ * */
+static void split_chunks(ts_list_t *list, ts_pool_t *pool, struct list_bulk *bulk, ts_linked_node *first)
+{
+    size_t chunks = pool != NULL ? ts_pool_threads(pool) * TS_LIST_CHUNKS_PER_THREAD : 1;
+
+    if (chunks > list->length / TS_LIST_MIN_CHUNK)
+        chunks = list->length / TS_LIST_MIN_CHUNK;
+
+    bulk->length = list->length;
+    bulk->firsts = chunks > 1 ? (ts_linked_node *)malloc(chunks * sizeof(ts_linked_node)) : NULL;
+    bulk->chunks = bulk->firsts != NULL ? chunks : 1;
+
+    if (bulk->firsts == NULL)
+    {
+        *first = list->head;
+        bulk->firsts = first;
+        return;
+    }
+
+    ts_linked_node node = list->head;
+
+    for (size_t chunk = 0; chunk < bulk->chunks; ++chunk)
+    {
+        bulk->firsts[chunk] = node;
+
+        for (size_t i = chunk_length(bulk, chunk); i > 0; --i)
+            node = node->next;
+    }
+}
+
+/* Runs the chunks in parallel on the pool, when there are several. */
+static void run_chunks(ts_pool_t *pool, struct list_bulk *bulk, ts_pool_for_fn fn, ts_linked_node *first)
+{
+    if (bulk->chunks > 1)
+        pool->parallel_for(pool, 0, bulk->chunks, 1, fn, bulk);
+    else
+        fn(0, 1, bulk);
+
+    if (bulk->firsts != first)
+        free(bulk->firsts);
+}
+
+static void map_chunks(size_t begin, size_t end, void *ctx)
+{
+    struct list_bulk *bulk = (struct list_bulk *)ctx;
+
+    for (size_t chunk = begin; chunk < end; ++chunk)
+    {
+        ts_linked_node node = bulk->firsts[chunk];
+
+        for (size_t i = chunk_length(bulk, chunk); i > 0; --i, node = node->next)
+        {
+            ts_generic_t value = bulk->map(node->value, bulk->ctx);
+
+            if (value != node->value)
+                ts_generic_t_free(node->value);
+            node->value = value;
+        }
+    }
+}
+
+extern void ts_list_map(ts_list_t *list, ts_pool_t *pool, ts_list_map_fn map, void *ctx)
+{
+    struct list_bulk bulk = {.map = map, .ctx = ctx};
+    ts_linked_node first;
+
+    if (list == NULL || list->length == 0)
+        return;
+
+    split_chunks(list, pool, &bulk, &first);
+    run_chunks(pool, &bulk, &map_chunks, &first);
+}
+
+static void filter_chunks(size_t begin, size_t end, void *ctx)
+{
+    struct list_bulk *bulk = (struct list_bulk *)ctx;
+
+    for (size_t chunk = begin; chunk < end; ++chunk)
+    {
+        struct list_run *run = &bulk->runs[chunk];
+        ts_linked_node node = bulk->firsts[chunk];
+
+        *run = (struct list_run){.head = NULL, .tail = NULL, .length = 0};
+
+        // the last node links to the next chunk, left alone until stitched
+        for (size_t i = chunk_length(bulk, chunk); i > 0; --i)
+        {
+            ts_linked_node next = i > 1 ? node->next : NULL;
+
+            if (bulk->keep(node->value, bulk->ctx))
+            {
+                node->prev = run->tail;
+                if (run->tail != NULL)
+                    run->tail->next = node;
+                else
+                    run->head = node;
+                run->tail = node;
+                run->length += 1;
+            }
+            else
+            {
+                ts_generic_t_free(node->value);
+                free(node);
+            }
+
+            node = next;
+        }
+    }
+}
+
+extern void ts_list_filter(ts_list_t *list, ts_pool_t *pool, ts_list_filter_fn keep, void *ctx)
+{
+    struct list_bulk bulk = {.keep = keep, .ctx = ctx};
+    struct list_run run;
+    ts_linked_node first;
+
+    if (list == NULL || list->length == 0)
+        return;
+
+    split_chunks(list, pool, &bulk, &first);
+    bulk.runs = bulk.chunks > 1 ? (struct list_run *)malloc(bulk.chunks * sizeof(struct list_run)) : &run;
+
+    if (bulk.runs == NULL)
+    {
+        // filters the list in one chunk instead
+        free(bulk.firsts);
+        bulk.firsts = &first;
+        bulk.chunks = 1;
+        first = list->head;
+        bulk.runs = &run;
+    }
+
+    const size_t chunks = bulk.chunks;
+    run_chunks(pool, &bulk, &filter_chunks, &first);
+
+    list->head = NULL;
+    list->tail = NULL;
+    list->length = 0;
+
+    for (size_t chunk = 0; chunk < chunks; ++chunk)
+    {
+        struct list_run *kept = &bulk.runs[chunk];
+
+        if (kept->head == NULL)
+            continue;
+
+        kept->head->prev = list->tail;
+        if (list->tail != NULL)
+            list->tail->next = kept->head;
+        else
+            list->head = kept->head;
+        list->tail = kept->tail;
+        list->length += kept->length;
+    }
+
+    if (list->tail != NULL)
+        list->tail->next = NULL;
+
+    if (bulk.runs != &run)
+        free(bulk.runs);
+}
+
+static void reduce_chunks(size_t begin, size_t end, void *result, void *ctx)
+{
+    struct list_bulk *bulk = (struct list_bulk *)ctx;
+
+    for (size_t chunk = begin; chunk < end; ++chunk)
+    {
+        ts_linked_node node = bulk->firsts[chunk];
+
+        for (size_t i = chunk_length(bulk, chunk); i > 0; --i, node = node->next)
+            bulk->reduce(node->value, result, bulk->ctx);
+    }
+}
+
+extern void ts_list_reduce(ts_list_t *list, ts_pool_t *pool, void *result, size_t result_size,
+                           ts_list_reduce_fn reduce, ts_pool_join_fn combine, void *ctx)
+{
+    struct list_bulk bulk = {.reduce = reduce, .ctx = ctx};
+    ts_linked_node first;
+
+    if (list == NULL || list->length == 0)
+        return;
+
+    split_chunks(list, pool, &bulk, &first);
+
+    if (bulk.chunks > 1)
+        pool->parallel_reduce(pool, 0, bulk.chunks, 1, result, result_size, &reduce_chunks, combine, &bulk);
+    else
+        reduce_chunks(0, 1, result, &bulk);
+
+    if (bulk.firsts != &first)
+        free(bulk.firsts);
+}
+
 /* Returns the string representation of a list. */
 extern char *ts_list_repr(ts_list_t *list)
     TS_LIST_REPR_ALGORITHM(
@@ -319,19 +592,19 @@ extern ts_list_t *ts_new_list(void)
         return NULL;
 }
 
-/* Used to free the nodes of a linked list recursivelly. */
+/* Used to free the nodes of a linked list, one after the other so long
+ * lists do not overflow the stack.
+ * */
 static void list_node_free(ts_linked_node *node)
 {
-    if (*node != NULL)
+    while (*node != NULL)
     {
-        if ((*node)->next != NULL)
-            list_node_free(&(*node)->next);
+        ts_linked_node next = (*node)->next;
 
-        if ((*node)->value != NULL)
-            free((*node)->value);
+        ts_generic_t_free((*node)->value);
 
         free(*node);
-        *node = NULL;
+        *node = next;
     }
 #ifdef _MAKE_ROBUST_CHECK
     assert(*node == NULL);
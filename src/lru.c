@@ -0,0 +1,321 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * MIT License                                                                       *
+ *                                                                                   *
+ * Copyright (c) 2022-2024 Anaxímeno Brito                                           *
+ *                                                                                   *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy      *
+ * of this software and associated documentation files (the "Software"), to deal     *
+ * in the Software without restriction, including without limitation the rights      *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell         *
+ * copies of the Software, and to permit persons to whom the Software is             *
+ * furnished to do so, subject to the following conditions:                          *
+ *                                                                                   *
+ * The above copyright notice and this permission notice shall be included in all    *
+ * copies or substantial portions of the Software.                                   *
+ *                                                                                   *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR        *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,          *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE       *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER            *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,     *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE     *
+ * SOFTWARE.                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#include "../include/3s/core.h"
+#include "../include/3s/llist.h"
+#include "../include/3s/hashtable.h"
+#include "../include/3s/lru.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <assert.h>
+
+static struct ts_lru_entry *entry_of(struct ts_linked_node *node)
+{
+    return (struct ts_lru_entry *)node;
+}
+
+/* Returns the entry of the key, or NULL. */
+static struct ts_lru_entry *lookup(ts_lru_t *lru, ts_generic_t key)
+{
+    ts_generic_t handle = ts_hashtable_get(lru->table, key);
+    return handle != NULL ? (struct ts_lru_entry *)handle->data.pointer : NULL;
+}
+
+static void unlink_entry(ts_lru_t *lru, struct ts_lru_entry *entry)
+{
+    struct ts_lru_segment *segment = &lru->segments[entry->segment];
+    struct ts_linked_node *node = &entry->node;
+
+    if (node->prev != NULL)
+        node->prev->next = node->next;
+    else
+        segment->head = node->next;
+
+    if (node->next != NULL)
+        node->next->prev = node->prev;
+    else
+        segment->tail = node->prev;
+
+    segment->length--;
+    segment->weight -= entry->weight;
+}
+
+/* Links the entry at the head of the segment, as its most recently used. */
+static void link_entry(ts_lru_t *lru, struct ts_lru_entry *entry, int segment_index)
+{
+    struct ts_lru_segment *segment = &lru->segments[segment_index];
+    struct ts_linked_node *node = &entry->node;
+
+    node->prev = NULL;
+    node->next = segment->head;
+
+    if (segment->head != NULL)
+        segment->head->prev = node;
+    else
+        segment->tail = node;
+
+    segment->head = node;
+    segment->length++;
+    segment->weight += entry->weight;
+    entry->segment = segment_index;
+}
+
+/* Sends the oldest protected entries back on probation until the
+ * protected segment fits its share of the capacity.
+ * */
+static void rebalance(ts_lru_t *lru)
+{
+    struct ts_lru_segment *protected_segment = &lru->segments[TS_LRU_PROTECTED];
+
+    while (protected_segment->weight > lru->protected_capacity && protected_segment->length > 1)
+    {
+        struct ts_lru_entry *oldest = entry_of(protected_segment->tail);
+
+        unlink_entry(lru, oldest);
+        link_entry(lru, oldest, TS_LRU_PROBATION);
+    }
+}
+
+/* Links back the unlinked entry as the most recently used, protecting it
+ * if the cache is segmented.
+ * */
+static void touch(ts_lru_t *lru, struct ts_lru_entry *entry)
+{
+    link_entry(lru, entry, lru->segmented ? TS_LRU_PROTECTED : TS_LRU_PROBATION);
+
+    if (lru->segmented)
+        rebalance(lru);
+}
+
+static void drop(ts_lru_t *lru, struct ts_lru_entry *entry)
+{
+    ts_hashtable_remove(lru->table, entry->key);
+    unlink_entry(lru, entry);
+
+    ts_generic_t_free(entry->key);
+    ts_generic_t_free(entry->node.value);
+    free(entry);
+}
+
+/* Evicts the least recently used entries, probation first, until the
+ * weights fit in the capacity. The kept entry is never evicted.
+ * */
+static void evict(ts_lru_t *lru, struct ts_lru_entry *keep)
+{
+    while (ts_lru_weight(lru) > lru->capacity && ts_lru_length(lru) > 1)
+    {
+        struct ts_linked_node *oldest = lru->segments[TS_LRU_PROBATION].tail;
+
+        if (oldest == NULL || oldest == &keep->node)
+            oldest = lru->segments[TS_LRU_PROTECTED].tail;
+
+        struct ts_lru_entry *victim = entry_of(oldest);
+
+        if (lru->on_evict != NULL)
+            lru->on_evict(victim->key, victim->node.value, lru->evict_ctx);
+
+        drop(lru, victim);
+    }
+}
+
+static size_t weigh(ts_lru_t *lru, ts_generic_t key, ts_generic_t value)
+{
+    return lru->weigh != NULL ? lru->weigh(key, value) : 1;
+}
+
+extern ts_generic_t ts_lru_get(ts_lru_t *lru, ts_generic_t key)
+{
+    struct ts_lru_entry *entry = lookup(lru, key);
+
+    if (entry == NULL)
+        return NULL;
+
+    unlink_entry(lru, entry);
+    touch(lru, entry);
+    return entry->node.value;
+}
+
+extern ts_generic_t ts_lru_peek(ts_lru_t *lru, ts_generic_t key)
+{
+    struct ts_lru_entry *entry = lookup(lru, key);
+    return entry != NULL ? entry->node.value : NULL;
+}
+
+extern bool ts_lru_put(ts_lru_t *lru, ts_generic_t key, ts_generic_t value)
+{
+    struct ts_lru_entry *entry = lookup(lru, key);
+
+    if (entry != NULL)
+    {
+        unlink_entry(lru, entry);
+        ts_generic_t_free(key);
+        ts_generic_t_free(entry->node.value);
+
+        entry->node.value = value;
+        entry->weight = weigh(lru, entry->key, value);
+
+        touch(lru, entry);
+        evict(lru, entry);
+        return false;
+    }
+
+    entry = (struct ts_lru_entry *)malloc(sizeof(struct ts_lru_entry));
+
+    if (entry == NULL)
+        goto return_error;
+
+    memset(&entry->handle, 0, sizeof(entry->handle));
+    entry->handle.type = TS_TYPE_POINTER;
+    entry->handle.data.pointer = entry;
+    entry->node.value = value;
+    entry->key = key;
+    entry->weight = weigh(lru, key, value);
+
+    // the key is known to be new, so this only fails to allocate
+    if (!ts_hashtable_put(lru->table, key, &entry->handle))
+    {
+        free(entry);
+        goto return_error;
+    }
+
+    link_entry(lru, entry, TS_LRU_PROBATION);
+    evict(lru, entry);
+    return true;
+
+return_error:
+    ts_generic_t_free(key);
+    ts_generic_t_free(value);
+    return false;
+}
+
+extern bool ts_lru_remove(ts_lru_t *lru, ts_generic_t key)
+{
+    struct ts_lru_entry *entry = lookup(lru, key);
+
+    if (entry == NULL)
+        return false;
+
+    drop(lru, entry);
+    return true;
+}
+
+extern size_t ts_lru_length(ts_lru_t *lru)
+{
+    return lru->segments[TS_LRU_PROBATION].length + lru->segments[TS_LRU_PROTECTED].length;
+}
+
+extern size_t ts_lru_weight(ts_lru_t *lru)
+{
+    return lru->segments[TS_LRU_PROBATION].weight + lru->segments[TS_LRU_PROTECTED].weight;
+}
+
+static size_t value_bytes(ts_generic_t value)
+{
+    if (value == NULL)
+        return 0;
+
+    if (value->type == TS_TYPE_STRING && value->data.string != NULL)
+        return sizeof(struct ts_generic_t) + strlen(value->data.string) + 1;
+
+    // short owned strings and bytes fit in the value
+    if ((value->type == TS_TYPE_OWNED_STRING || value->type == TS_TYPE_BYTES) &&
+        ts_generic_t_length(value) > TS_STRING_INLINE_CAPACITY)
+        return sizeof(struct ts_generic_t) + ts_generic_t_length(value) + 1;
+
+    return sizeof(struct ts_generic_t);
+}
+
+extern size_t ts_lru_weigh_bytes(ts_generic_t key, ts_generic_t value)
+{
+    return value_bytes(key) + value_bytes(value);
+}
+
+extern void ts_lru_on_evict(ts_lru_t *lru, ts_lru_evict_fn on_evict, void *ctx)
+{
+    lru->on_evict = on_evict;
+    lru->evict_ctx = ctx;
+}
+
+extern ts_lru_t *ts_lru_new(size_t capacity, ts_lru_weigh_fn weigh, bool segmented)
+{
+    ts_lru_t *lru = (ts_lru_t *)malloc(sizeof(ts_lru_t));
+
+    if (lru != NULL)
+    {
+        // the table only points at the entries, which the cache frees
+        lru->table = ts_hashtable_new(TS_HASHTABLE_DEFAULT_LOAD, false);
+
+        if (lru->table == NULL)
+        {
+            free(lru);
+            return NULL;
+        }
+
+        memset(lru->segments, 0, sizeof(lru->segments));
+        lru->capacity = capacity;
+        lru->protected_capacity = capacity / 5 * TS_LRU_PROTECTED_FIFTHS +
+                                  capacity % 5 * TS_LRU_PROTECTED_FIFTHS / 5;
+        lru->segmented = segmented;
+        lru->weigh = weigh;
+        lru->on_evict = NULL;
+        lru->evict_ctx = NULL;
+
+        /* Associated functions. */
+        lru->get = &ts_lru_get;
+        lru->put = &ts_lru_put;
+        lru->remove = &ts_lru_remove;
+    }
+
+    return lru;
+}
+
+extern void ts_lru_free(ts_lru_t **lru)
+{
+    if (*lru != NULL)
+    {
+        for (int i = 0; i < 2; ++i)
+        {
+            struct ts_linked_node *node = (*lru)->segments[i].head;
+
+            while (node != NULL)
+            {
+                struct ts_lru_entry *entry = entry_of(node);
+                node = node->next;
+
+                ts_generic_t_free(entry->key);
+                ts_generic_t_free(entry->node.value);
+                free(entry);
+            }
+        }
+
+        ts_hashtable_free(&(*lru)->table);
+        free(*lru);
+        *lru = NULL;
+    }
+
+#ifdef _MAKE_ROBUST_CHECK
+    assert(*lru == NULL);
+#endif
+}
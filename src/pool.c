@@ -0,0 +1,392 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * MIT License                                                                       *
+ *                                                                                   *
+ * Copyright (c) 2022-2024 Anaxímeno Brito                                           *
+ *                                                                                   *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy      *
+ * of this software and associated documentation files (the "Software"), to deal     *
+ * in the Software without restriction, including without limitation the rights      *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell         *
+ * copies of the Software, and to permit persons to whom the Software is             *
+ * furnished to do so, subject to the following conditions:                          *
+ *                                                                                   *
+ * The above copyright notice and this permission notice shall be included in all    *
+ * copies or substantial portions of the Software.                                   *
+ *                                                                                   *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR        *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,          *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE       *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER            *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,     *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE     *
+ * SOFTWARE.                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#include "../include/3s/pool.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <assert.h>
+
+/* A parallel call, shared by its tasks. */
+struct ts_pool_job
+{
+    size_t grain;
+    ts_pool_for_fn fn;
+    ts_pool_map_fn map;
+    ts_pool_join_fn join;
+    void *ctx;
+    /* The identity the partial results start from. */
+    const void *identity;
+    size_t result_size;
+};
+
+/* The worker run by this thread, if any. */
+static _Thread_local struct ts_pool_worker *current = NULL;
+
+// -- Deques
+
+static bool push_task(struct ts_pool_worker *worker, struct ts_pool_task *task)
+{
+    struct ts_pool_deque *deque = &worker->deque;
+    bool pushed = false;
+
+    pthread_mutex_lock(&deque->lock);
+    if (deque->bottom - deque->top < TS_POOL_DEQUE_CAPACITY)
+    {
+        deque->tasks[deque->bottom++ % TS_POOL_DEQUE_CAPACITY] = task;
+        pushed = true;
+    }
+    pthread_mutex_unlock(&deque->lock);
+
+    return pushed;
+}
+
+/* Takes back the newest task of the worker, or NULL if it was stolen. */
+static struct ts_pool_task *pop_task(struct ts_pool_worker *worker)
+{
+    struct ts_pool_deque *deque = &worker->deque;
+    struct ts_pool_task *task = NULL;
+
+    pthread_mutex_lock(&deque->lock);
+    if (deque->bottom != deque->top)
+        task = deque->tasks[--deque->bottom % TS_POOL_DEQUE_CAPACITY];
+    pthread_mutex_unlock(&deque->lock);
+
+    return task;
+}
+
+/* Takes the oldest task of the victim, the one of the largest range. */
+static struct ts_pool_task *steal_task(struct ts_pool_worker *victim)
+{
+    struct ts_pool_deque *deque = &victim->deque;
+    struct ts_pool_task *task = NULL;
+
+    pthread_mutex_lock(&deque->lock);
+    if (deque->bottom != deque->top)
+        task = deque->tasks[deque->top++ % TS_POOL_DEQUE_CAPACITY];
+    pthread_mutex_unlock(&deque->lock);
+
+    return task;
+}
+
+// -- Running
+
+static void run_task(struct ts_pool_worker *worker, struct ts_pool_task *task);
+
+/* Steals a task from another worker and runs it, or lets other threads
+ * run if there is none. Returns true if a task ran.
+ * */
+static bool help(struct ts_pool_worker *worker)
+{
+    ts_pool_t *pool = worker->pool;
+
+    // xorshift, only used to spread the thieves
+    worker->seed ^= worker->seed << 13;
+    worker->seed ^= worker->seed >> 7;
+    worker->seed ^= worker->seed << 17;
+
+    for (size_t i = 0; i < pool->threads; ++i)
+    {
+        struct ts_pool_worker *victim = &pool->workers[(worker->seed + i) % pool->threads];
+        struct ts_pool_task *task = victim != worker ? steal_task(victim) : NULL;
+
+        if (task != NULL)
+        {
+            run_task(worker, task);
+            return true;
+        }
+    }
+
+    sched_yield();
+    return false;
+}
+
+/* Runs the range, forking its right half while it is larger than the
+ * grain, and joining the result of that half after its left half.
+ * */
+static void run_range(struct ts_pool_worker *worker, struct ts_pool_job *job,
+                      size_t begin, size_t end, void *result)
+{
+    if (end - begin <= job->grain)
+    {
+        if (job->map != NULL)
+            job->map(begin, end, result, job->ctx);
+        else
+            job->fn(begin, end, job->ctx);
+        return;
+    }
+
+    alignas(max_align_t) unsigned char inline_result[TS_POOL_INLINE_RESULT];
+    const size_t middle = begin + (end - begin) / 2;
+    struct ts_pool_task task = {.begin = middle, .end = end, .job = job, .result = NULL};
+
+    atomic_init(&task.done, false);
+
+    if (job->map != NULL)
+    {
+        task.result = job->result_size <= TS_POOL_INLINE_RESULT ? inline_result : malloc(job->result_size);
+
+        if (task.result == NULL)
+        {
+            // maps the whole range at once instead
+            job->map(begin, end, result, job->ctx);
+            return;
+        }
+
+        memcpy(task.result, job->identity, job->result_size);
+    }
+
+    const bool pushed = push_task(worker, &task);
+
+    run_range(worker, job, begin, middle, result);
+
+    // newer tasks are all joined by now, so the newest is this one unless stolen
+    if (!pushed || pop_task(worker) == &task)
+        run_range(worker, job, middle, end, task.result);
+    else
+        while (!atomic_load_explicit(&task.done, memory_order_acquire))
+            help(worker);
+
+    if (job->map != NULL)
+    {
+        job->join(result, task.result, job->ctx);
+
+        if (task.result != inline_result)
+            free(task.result);
+    }
+}
+
+static void run_task(struct ts_pool_worker *worker, struct ts_pool_task *task)
+{
+    run_range(worker, task->job, task->begin, task->end, task->result);
+    atomic_store_explicit(&task->done, true, memory_order_release);
+}
+
+/* Runs the job on the calling thread, as the first worker when it is not
+ * one of the pool already.
+ * */
+static void run_job(ts_pool_t *pool, struct ts_pool_job *job, size_t begin, size_t end, void *result)
+{
+    if (job->grain == 0)
+        job->grain = 1;
+
+    if (begin >= end)
+        return;
+
+    // nested calls go on with the worker of the thread
+    if (current != NULL && current->pool == pool)
+    {
+        run_range(current, job, begin, end, result);
+        return;
+    }
+
+    struct ts_pool_worker *outer = current;
+
+    pthread_mutex_lock(&pool->call);
+    current = &pool->workers[0];
+
+    if (pool->started > 0)
+    {
+        pthread_mutex_lock(&pool->lock);
+        atomic_store(&pool->running, true);
+        pthread_cond_broadcast(&pool->wake);
+        pthread_mutex_unlock(&pool->lock);
+    }
+
+    run_range(current, job, begin, end, result);
+
+    atomic_store(&pool->running, false);
+    current = outer;
+    pthread_mutex_unlock(&pool->call);
+}
+
+/* Runs the worker of a started thread, which sleeps between the parallel
+ * calls and looks for tasks during them.
+ * */
+static void *work(void *arg)
+{
+    struct ts_pool_worker *worker = (struct ts_pool_worker *)arg;
+    ts_pool_t *pool = worker->pool;
+
+    current = worker;
+
+    pthread_mutex_lock(&pool->lock);
+    while (!pool->stop)
+    {
+        if (!atomic_load(&pool->running))
+        {
+            pthread_cond_wait(&pool->wake, &pool->lock);
+            continue;
+        }
+
+        pthread_mutex_unlock(&pool->lock);
+        while (atomic_load(&pool->running))
+            help(worker);
+        pthread_mutex_lock(&pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+// -- Pools
+
+extern void ts_pool_parallel_for(ts_pool_t *pool, size_t begin, size_t end, size_t grain,
+                                 ts_pool_for_fn fn, void *ctx)
+{
+    struct ts_pool_job job = {.grain = grain, .fn = fn, .ctx = ctx};
+
+    run_job(pool, &job, begin, end, NULL);
+}
+
+extern void ts_pool_parallel_reduce(ts_pool_t *pool, size_t begin, size_t end, size_t grain,
+                                    void *result, size_t result_size,
+                                    ts_pool_map_fn map, ts_pool_join_fn join, void *ctx)
+{
+    // the result changes as soon as its first part is mapped
+    void *identity = malloc(result_size != 0 ? result_size : 1);
+
+    if (identity == NULL)
+    {
+        if (begin < end)
+            map(begin, end, result, ctx);
+        return;
+    }
+
+    memcpy(identity, result, result_size);
+
+    struct ts_pool_job job = {
+        .grain = grain,
+        .map = map,
+        .join = join,
+        .ctx = ctx,
+        .identity = identity,
+        .result_size = result_size,
+    };
+
+    run_job(pool, &job, begin, end, result);
+    free(identity);
+}
+
+extern size_t ts_pool_threads(ts_pool_t *pool)
+{
+    return pool->threads;
+}
+
+extern ts_pool_t *ts_pool_new(size_t threads)
+{
+    if (threads == 0)
+    {
+        const long processors = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = processors > 0 ? (size_t)processors : 1;
+    }
+
+    ts_pool_t *pool = (ts_pool_t *)malloc(sizeof(ts_pool_t));
+
+    if (pool == NULL)
+        return NULL;
+
+    pool->threads = threads;
+    pool->workers = (struct ts_pool_worker *)aligned_alloc(TS_CACHE_LINE_SIZE,
+                                                           threads * sizeof(struct ts_pool_worker));
+    pool->ids = (pthread_t *)malloc(threads * sizeof(pthread_t));
+    pool->started = 0;
+    pool->stop = false;
+    atomic_init(&pool->running, false);
+
+    if (pool->workers == NULL || pool->ids == NULL)
+    {
+        free(pool->workers);
+        free(pool->ids);
+        free(pool);
+        return NULL;
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    pthread_mutex_init(&pool->call, NULL);
+
+    for (size_t i = 0; i < threads; ++i)
+    {
+        struct ts_pool_worker *worker = &pool->workers[i];
+
+        pthread_mutex_init(&worker->deque.lock, NULL);
+        worker->deque.top = 0;
+        worker->deque.bottom = 0;
+        worker->pool = pool;
+        worker->seed = 0x9E3779B97F4A7C15u * (i + 1);
+    }
+
+    // the first worker is the calling thread
+    for (size_t i = 1; i < threads; ++i)
+    {
+        if (pthread_create(&pool->ids[pool->started], NULL, &work, &pool->workers[i]) != 0)
+        {
+            ts_pool_free(&pool);
+            return NULL;
+        }
+        pool->started++;
+    }
+
+    /* Associated functions. */
+    pool->parallel_for = &ts_pool_parallel_for;
+    pool->parallel_reduce = &ts_pool_parallel_reduce;
+
+    return pool;
+}
+
+extern void ts_pool_free(ts_pool_t **pool)
+{
+    if (*pool != NULL)
+    {
+        pthread_mutex_lock(&(*pool)->lock);
+        (*pool)->stop = true;
+        pthread_cond_broadcast(&(*pool)->wake);
+        pthread_mutex_unlock(&(*pool)->lock);
+
+        for (size_t i = 0; i < (*pool)->started; ++i)
+            pthread_join((*pool)->ids[i], NULL);
+
+        for (size_t i = 0; i < (*pool)->threads; ++i)
+            pthread_mutex_destroy(&(*pool)->workers[i].deque.lock);
+
+        pthread_mutex_destroy(&(*pool)->call);
+        pthread_cond_destroy(&(*pool)->wake);
+        pthread_mutex_destroy(&(*pool)->lock);
+        free((*pool)->ids);
+        free((*pool)->workers);
+        free(*pool);
+        *pool = NULL;
+    }
+
+#ifdef _MAKE_ROBUST_CHECK
+    assert(*pool == NULL);
+#endif
+}
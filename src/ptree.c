@@ -0,0 +1,441 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * MIT License                                                                       *
+ *                                                                                   *
+ * Copyright (c) 2022-2024 Anaxímeno Brito                                           *
+ *                                                                                   *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy      *
+ * of this software and associated documentation files (the "Software"), to deal     *
+ * in the Software without restriction, including without limitation the rights      *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell         *
+ * copies of the Software, and to permit persons to whom the Software is             *
+ * furnished to do so, subject to the following conditions:                          *
+ *                                                                                   *
+ * The above copyright notice and this permission notice shall be included in all    *
+ * copies or substantial portions of the Software.                                   *
+ *                                                                                   *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR        *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,          *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE       *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER            *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,     *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE     *
+ * SOFTWARE.                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "../include/3s/core.h"
+#include "../include/3s/ptree.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <assert.h>
+
+typedef struct ts_ptree_node *ts_ptree_node;
+typedef struct ts_ptree_value *ts_ptree_value;
+
+#define HEIGHT(NODE) ((NODE) != NULL ? (NODE)->height : 0)
+#define MAX(A, B) ((A) > (B) ? (A) : (B))
+
+/* Takes one more reference to the node, returning it. */
+static ts_ptree_node node_retain(ts_ptree_node node)
+{
+    if (node != NULL)
+        atomic_fetch_add_explicit(&node->refs, 1, memory_order_relaxed);
+    return node;
+}
+
+/* Takes one more reference to the value, returning it. */
+static ts_ptree_value value_retain(ts_ptree_value value)
+{
+    atomic_fetch_add_explicit(&value->refs, 1, memory_order_relaxed);
+    return value;
+}
+
+static void value_release(ts_ptree_value value)
+{
+    if (atomic_fetch_sub_explicit(&value->refs, 1, memory_order_acq_rel) == 1)
+    {
+        ts_generic_t_release(&value->value);
+        free(value);
+    }
+}
+
+/* Drops one reference to the node, freeing it and releasing its children
+ * when it was the last one. The recursion is bounded by the tree height.
+ * */
+static void node_release(ts_ptree_node node)
+{
+    if (node != NULL && atomic_fetch_sub_explicit(&node->refs, 1, memory_order_acq_rel) == 1)
+    {
+        node_release(node->left);
+        node_release(node->right);
+        value_release(node->value);
+        free(node);
+    }
+}
+
+/* Creates a node owning the given references to its children and value.
+ * If the allocation fails, or failed is already set by the creation of
+ * another node of the same change, the references are dropped, failed is
+ * set and NULL returned. An empty subtree is also NULL, so callers tell
+ * them apart by failed.
+ * */
+static ts_ptree_node node_new(ts_ptree_node left, ts_ptree_value value, ts_ptree_node right, bool *failed)
+{
+    ts_ptree_node node = !*failed ? (ts_ptree_node)malloc(sizeof(struct ts_ptree_node)) : NULL;
+
+    if (node == NULL)
+    {
+        node_release(left);
+        node_release(right);
+        value_release(value);
+        *failed = true;
+        return NULL;
+    }
+
+    node->left = left;
+    node->right = right;
+    node->value = value;
+    node->height = MAX(HEIGHT(left), HEIGHT(right)) + 1;
+    atomic_init(&node->refs, 1);
+
+    return node;
+}
+
+/* Creates a node from the given references, rotating when the heights of
+ * the children differ by more than one. Rotations copy the nodes they move.
+ * Once failed is set, the references are dropped and NULL returned.
+ * */
+static ts_ptree_node node_balanced(ts_ptree_node left, ts_ptree_value value, ts_ptree_node right, bool *failed)
+{
+    ts_ptree_node balanced = NULL;
+
+    if (*failed)
+        balanced = node_new(left, value, right, failed);
+    else if (HEIGHT(left) > HEIGHT(right) + 1)
+    {
+        if (HEIGHT(left->left) >= HEIGHT(left->right))
+            balanced = node_new(node_retain(left->left), value_retain(left->value),
+                                node_new(node_retain(left->right), value, right, failed), failed);
+        else
+            balanced = node_new(node_new(node_retain(left->left), value_retain(left->value),
+                                         node_retain(left->right->left), failed),
+                                value_retain(left->right->value),
+                                node_new(node_retain(left->right->right), value, right, failed), failed);
+        node_release(left);
+    }
+    else if (HEIGHT(right) > HEIGHT(left) + 1)
+    {
+        if (HEIGHT(right->right) >= HEIGHT(right->left))
+            balanced = node_new(node_new(left, value, node_retain(right->left), failed),
+                                value_retain(right->value), node_retain(right->right), failed);
+        else
+            balanced = node_new(node_new(left, value, node_retain(right->left->left), failed),
+                                value_retain(right->left->value),
+                                node_new(node_retain(right->left->right), value_retain(right->value),
+                                         node_retain(right->right), failed), failed);
+        node_release(right);
+    }
+    else
+        balanced = node_new(left, value, right, failed);
+
+    return balanced;
+}
+
+/* Returns a reference to a copy of the subtree holding the value. If an
+ * equal value was already there, a reference to the same subtree is
+ * returned and added is set to false. If a node could not be allocated,
+ * failed is set and NULL returned, the nodes copied so far released.
+ * */
+static ts_ptree_node insert_value(ts_ptree_node node, ts_ptree_value value, bool *added, bool *failed)
+{
+    if (node == NULL)
+    {
+        *added = true;
+        return node_new(NULL, value_retain(value), NULL, failed);
+    }
+
+    const int cmp = ts_generic_t_class_cmp(&value->value, &node->value->value);
+
+    if (cmp == TS_LESS)
+    {
+        ts_ptree_node left = insert_value(node->left, value, added, failed);
+        if (*added)
+            return node_balanced(left, value_retain(node->value), node_retain(node->right), failed);
+        node_release(left);
+    }
+    else if (cmp == TS_GREATER)
+    {
+        ts_ptree_node right = insert_value(node->right, value, added, failed);
+        if (*added)
+            return node_balanced(node_retain(node->left), value_retain(node->value), right, failed);
+        node_release(right);
+    }
+
+    *added = false;
+    return node_retain(node);
+}
+
+/* Returns a reference to a copy of the subtree without its least value,
+ * which is stored on least. On allocation failure, see insert_value.
+ * */
+static ts_ptree_node remove_least(ts_ptree_node node, ts_ptree_value *least, bool *failed)
+{
+    if (node->left == NULL)
+    {
+        *least = value_retain(node->value);
+        return node_retain(node->right);
+    }
+
+    ts_ptree_node left = remove_least(node->left, least, failed);
+    return node_balanced(left, value_retain(node->value), node_retain(node->right), failed);
+}
+
+/* Returns a reference to a copy of the subtree without the value. If
+ * there's no such value, a reference to the same subtree is returned
+ * and removed is set to false. On allocation failure, see insert_value.
+ * */
+static ts_ptree_node remove_value(ts_ptree_node node, ts_generic_t value, bool *removed, bool *failed)
+{
+    if (node == NULL)
+    {
+        *removed = false;
+        return NULL;
+    }
+
+    const int cmp = ts_generic_t_class_cmp(value, &node->value->value);
+
+    if (cmp == TS_LESS)
+    {
+        ts_ptree_node left = remove_value(node->left, value, removed, failed);
+        if (*removed)
+            return node_balanced(left, value_retain(node->value), node_retain(node->right), failed);
+        node_release(left);
+    }
+    else if (cmp == TS_GREATER)
+    {
+        ts_ptree_node right = remove_value(node->right, value, removed, failed);
+        if (*removed)
+            return node_balanced(node_retain(node->left), value_retain(node->value), right, failed);
+        node_release(right);
+    }
+    else
+    {
+        *removed = true;
+
+        if (node->left == NULL)
+            return node_retain(node->right);
+        if (node->right == NULL)
+            return node_retain(node->left);
+
+        ts_ptree_value least = NULL;
+        ts_ptree_node right = remove_least(node->right, &least, failed);
+        return node_balanced(node_retain(node->left), least, right, failed);
+    }
+
+    return node_retain(node);
+}
+
+static ts_ptree_snapshot_t *snapshot_new(ts_ptree_node root, size_t length)
+{
+    ts_ptree_snapshot_t *snapshot = (ts_ptree_snapshot_t *)malloc(sizeof(ts_ptree_snapshot_t));
+
+    if (snapshot != NULL)
+    {
+        snapshot->root = root;
+        snapshot->length = length;
+        atomic_init(&snapshot->refs, 1);
+    }
+
+    return snapshot;
+}
+
+/* Makes a new version, holding the given root reference, the current one. */
+static bool publish_version(ts_ptree_t *tree, ts_ptree_node root, size_t length)
+{
+    ts_ptree_snapshot_t *version = snapshot_new(root, length);
+
+    if (version == NULL)
+    {
+        node_release(root);
+        return false;
+    }
+
+    pthread_mutex_lock(&tree->version_lock);
+    ts_ptree_snapshot_t *previous = tree->current;
+    tree->current = version;
+    pthread_mutex_unlock(&tree->version_lock);
+
+    ts_ptree_snapshot_release(&previous);
+    return true;
+}
+
+extern bool ts_ptree_add(ts_ptree_t *tree, ts_generic_t value)
+{
+    ts_ptree_value cell = (ts_ptree_value)malloc(sizeof(struct ts_ptree_value));
+    bool added = false, failed = false;
+
+    if (cell != NULL)
+    {
+        cell->value = *value;
+        atomic_init(&cell->refs, 1);
+
+        pthread_mutex_lock(&tree->writer_lock);
+
+        /* Only writers replace the current version, so it can be
+         * read without the version lock while holding the writer one.
+         * */
+        ts_ptree_snapshot_t *current = tree->current;
+        ts_ptree_node root = insert_value(current->root, cell, &added, &failed);
+
+        /* A failed copy was already released, and the version is kept. */
+        if (added)
+            added = !failed && publish_version(tree, root, current->length + 1);
+        else
+            node_release(root);
+
+        pthread_mutex_unlock(&tree->writer_lock);
+
+        value_release(cell);
+
+        /* What the value owns moved to the cell. */
+        free(value);
+    }
+    else
+        ts_generic_t_free(value);
+
+    return added;
+}
+
+extern bool ts_ptree_remove(ts_ptree_t *tree, ts_generic_t value)
+{
+    bool removed = false, failed = false;
+
+    pthread_mutex_lock(&tree->writer_lock);
+
+    ts_ptree_snapshot_t *current = tree->current;
+    ts_ptree_node root = remove_value(current->root, value, &removed, &failed);
+
+    if (removed)
+        removed = !failed && publish_version(tree, root, current->length - 1);
+    else
+        node_release(root);
+
+    pthread_mutex_unlock(&tree->writer_lock);
+
+    return removed;
+}
+
+extern ts_ptree_snapshot_t *ts_ptree_snapshot(ts_ptree_t *tree)
+{
+    pthread_mutex_lock(&tree->version_lock);
+    ts_ptree_snapshot_t *snapshot = tree->current;
+    atomic_fetch_add_explicit(&snapshot->refs, 1, memory_order_relaxed);
+    pthread_mutex_unlock(&tree->version_lock);
+
+    return snapshot;
+}
+
+extern void ts_ptree_snapshot_release(ts_ptree_snapshot_t **snapshot)
+{
+    if (*snapshot != NULL)
+    {
+        if (atomic_fetch_sub_explicit(&(*snapshot)->refs, 1, memory_order_acq_rel) == 1)
+        {
+            node_release((*snapshot)->root);
+            free(*snapshot);
+        }
+
+        *snapshot = NULL;
+    }
+}
+
+extern ts_generic_t ts_ptree_snapshot_find(ts_ptree_snapshot_t *snapshot, ts_generic_t value)
+{
+    ts_ptree_node node = snapshot->root;
+
+    while (node != NULL)
+    {
+        const int cmp = ts_generic_t_class_cmp(value, &node->value->value);
+
+        if (cmp == TS_EQUAL)
+            return &node->value->value;
+        node = cmp == TS_LESS ? node->left : node->right;
+    }
+
+    return NULL;
+}
+
+/* Pushes the node and its left spine to the stack of the iterator. */
+static void iter_push_left(ts_ptree_iter_t *iter, ts_ptree_node node)
+{
+    for (; node != NULL; node = node->left)
+    {
+#ifdef _MAKE_ROBUST_CHECK
+        assert(iter->depth < TS_PTREE_MAX_HEIGHT);
+#endif
+        iter->stack[iter->depth++] = node;
+    }
+}
+
+extern ts_generic_t ts_ptree_iter_next(ts_ptree_iter_t *iter)
+{
+    if (iter->depth == 0)
+        return NULL;
+
+    ts_ptree_node node = iter->stack[--iter->depth];
+    iter_push_left(iter, node->right);
+
+    return &node->value->value;
+}
+
+extern ts_ptree_iter_t ts_ptree_iter(ts_ptree_snapshot_t *snapshot)
+{
+    ts_ptree_iter_t iter = {.depth = 0, .next = &ts_ptree_iter_next};
+    iter_push_left(&iter, snapshot->root);
+    return iter;
+}
+
+extern ts_ptree_t *ts_ptree_new(void)
+{
+    ts_ptree_t *tree = (ts_ptree_t *)malloc(sizeof(ts_ptree_t));
+
+    if (tree != NULL)
+    {
+        tree->current = snapshot_new(NULL, 0);
+
+        if (tree->current == NULL)
+        {
+            free(tree);
+            return NULL;
+        }
+
+        pthread_mutex_init(&tree->writer_lock, NULL);
+        pthread_mutex_init(&tree->version_lock, NULL);
+
+        /* Associated functions. */
+        tree->add = &ts_ptree_add;
+        tree->remove = &ts_ptree_remove;
+        tree->snapshot = &ts_ptree_snapshot;
+    }
+
+    return tree;
+}
+
+extern void ts_ptree_free(ts_ptree_t **tree)
+{
+    if (*tree != NULL)
+    {
+        ts_ptree_snapshot_release(&(*tree)->current);
+        pthread_mutex_destroy(&(*tree)->writer_lock);
+        pthread_mutex_destroy(&(*tree)->version_lock);
+        free(*tree);
+        *tree = NULL;
+    }
+
+#ifdef _MAKE_ROBUST_CHECK
+    assert(*tree == NULL);
+#endif
+}
@@ -74,6 +74,8 @@ extern ts_generic_t ts_queue_dequeue(ts_queue_t *queue)
 
             /* Copy bytes from the value dequeued to the one that will be returned. */
             memcpy(value, dequeued, sizeof(struct ts_generic_t));
+            /* What the value owns moved with it, and must not be freed with the node. */
+            dequeued->type = TS_TYPE_NONE;
 
             queue->list->remove_at_index(queue->list, 0);
             queue->size -= 1;
@@ -0,0 +1,609 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * MIT License                                                                       *
+ *                                                                                   *
+ * Copyright (c) 2022-2024 Anaxímeno Brito                                           *
+ *                                                                                   *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy      *
+ * of this software and associated documentation files (the "Software"), to deal     *
+ * in the Software without restriction, including without limitation the rights      *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell         *
+ * copies of the Software, and to permit persons to whom the Software is             *
+ * furnished to do so, subject to the following conditions:                          *
+ *                                                                                   *
+ * The above copyright notice and this permission notice shall be included in all    *
+ * copies or substantial portions of the Software.                                   *
+ *                                                                                   *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR        *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,          *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE       *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER            *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,     *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE     *
+ * SOFTWARE.                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#include "../include/3s/core.h"
+#include "../include/3s/pool.h"
+#include "../include/3s/sort.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+/* Runs shorter than this are sorted by insertion. */
+#define INSERTION_RUN 16
+
+/* The number of type classes, see ts_type_class. */
+#define CLASSES (TS_CLASS_BYTES + 1)
+
+/* A number with its key, see ts_generic_t_encode_key, split in the 64 bits
+ * compared first and the 24 bits after.
+ * */
+struct number_item
+{
+    uint64_t high;
+    uint32_t low;
+    ts_generic_t value;
+};
+
+/* A string or bytes, with their characters. */
+struct text_item
+{
+    const uint8_t *chars;
+    size_t length;
+    ts_generic_t value;
+};
+
+/* A range of text items left to sort, whose first bytes are all equal. */
+struct text_range
+{
+    size_t begin;
+    size_t end;
+    size_t depth;
+};
+
+/* -- Merge sort */
+
+static void insertion_sort(ts_generic_t *values, size_t length)
+{
+    for (size_t i = 1; i < length; ++i)
+    {
+        ts_generic_t value = values[i];
+        size_t j = i;
+
+        for (; j > 0 && ts_generic_t_class_cmp(values[j - 1], value) == TS_GREATER; --j)
+            values[j] = values[j - 1];
+
+        values[j] = value;
+    }
+}
+
+/* Sorts the values with the buffer, of the same length. Runs are sorted by
+ * insertion, then merged bottom up, back and forth between the arrays.
+ * */
+static void merge_sort(ts_generic_t *values, ts_generic_t *buffer, size_t length)
+{
+    ts_generic_t *from = values;
+    ts_generic_t *to = buffer;
+
+    for (size_t begin = 0; begin < length; begin += INSERTION_RUN)
+        insertion_sort(values + begin, length - begin < INSERTION_RUN ? length - begin : INSERTION_RUN);
+
+    for (size_t width = INSERTION_RUN; width < length; width *= 2)
+    {
+        for (size_t begin = 0; begin < length; begin += 2 * width)
+        {
+            const size_t middle = begin + width < length ? begin + width : length;
+            const size_t end = begin + 2 * width < length ? begin + 2 * width : length;
+            size_t i = begin, j = middle, k = begin;
+
+            // taking from the left run on ties keeps the sort stable
+            while (i < middle && j < end)
+                to[k++] = ts_generic_t_class_cmp(from[j], from[i]) == TS_LESS ? from[j++] : from[i++];
+            while (i < middle)
+                to[k++] = from[i++];
+            while (j < end)
+                to[k++] = from[j++];
+        }
+
+        ts_generic_t *swap = from;
+        from = to;
+        to = swap;
+    }
+
+    if (from != values)
+        memcpy(values, from, length * sizeof(ts_generic_t));
+}
+
+extern bool ts_sort_values_merge(ts_generic_t *values, size_t length)
+{
+    if (length <= INSERTION_RUN)
+    {
+        insertion_sort(values, length);
+        return true;
+    }
+
+    ts_generic_t *buffer = (ts_generic_t *)malloc(length * sizeof(ts_generic_t));
+
+    if (buffer == NULL)
+        return false;
+
+    merge_sort(values, buffer, length);
+    free(buffer);
+    return true;
+}
+
+/* -- Radix sort of numbers */
+
+static void number_key(struct number_item *item, ts_generic_t value)
+{
+    uint8_t key[TS_NUMBER_KEY_SIZE];
+
+    ts_generic_t_encode_key(value, key);
+
+    // the first byte is the class, the same for all the numbers
+    item->high = 0;
+    for (int i = 1; i < 9; ++i)
+        item->high = item->high << 8 | key[i];
+    item->low = (uint32_t)key[9] << 16 | (uint32_t)key[10] << 8 | key[11];
+    item->value = value;
+}
+
+/* Returns the byte of the key sorted on the given pass, the least
+ * significant first.
+ * */
+static unsigned number_byte(const struct number_item *item, int pass)
+{
+    return pass < 3 ? (item->low >> (8 * pass)) & 0xFF : (unsigned)(item->high >> (8 * (pass - 3))) & 0xFF;
+}
+
+/* Sorts the numbers a byte of their key at a time, the least significant
+ * first. The counts of all the passes are taken at once, and passes where
+ * all the keys share the byte are skipped.
+ * */
+static void radix_sort_numbers(struct number_item *items, struct number_item *buffer, size_t length)
+{
+    enum { PASSES = TS_NUMBER_KEY_SIZE - 1 };
+    size_t counts[PASSES][256] = {{0}};
+    struct number_item *from = items;
+    struct number_item *to = buffer;
+
+    for (size_t i = 0; i < length; ++i)
+        for (int pass = 0; pass < PASSES; ++pass)
+            counts[pass][number_byte(&items[i], pass)]++;
+
+    for (int pass = 0; pass < PASSES; ++pass)
+    {
+        size_t offset = 0;
+
+        if (counts[pass][number_byte(&items[0], pass)] == length)
+            continue;
+
+        for (int byte = 0; byte < 256; ++byte)
+        {
+            const size_t count = counts[pass][byte];
+            counts[pass][byte] = offset;
+            offset += count;
+        }
+
+        for (size_t i = 0; i < length; ++i)
+            to[counts[pass][number_byte(&from[i], pass)]++] = from[i];
+
+        struct number_item *swap = from;
+        from = to;
+        to = swap;
+    }
+
+    if (from != items)
+        memcpy(items, from, length * sizeof(struct number_item));
+}
+
+static bool sort_numbers(ts_generic_t *values, size_t length)
+{
+    struct number_item *items = (struct number_item *)malloc(2 * length * sizeof(struct number_item));
+
+    if (items == NULL)
+        return false;
+
+    for (size_t i = 0; i < length; ++i)
+        number_key(&items[i], values[i]);
+
+    radix_sort_numbers(items, items + length, length);
+
+    for (size_t i = 0; i < length; ++i)
+        values[i] = items[i].value;
+
+    free(items);
+    return true;
+}
+
+/* -- Radix sort of strings and bytes */
+
+/* Compares the items from the given depth, where they start to differ. */
+static int text_cmp(const struct text_item *item1, const struct text_item *item2, size_t depth)
+{
+    const size_t length1 = item1->length - depth;
+    const size_t length2 = item2->length - depth;
+    const int cmp = memcmp(item1->chars + depth, item2->chars + depth, length1 < length2 ? length1 : length2);
+
+    if (cmp != 0)
+        return cmp < 0 ? TS_LESS : TS_GREATER;
+    return length1 < length2 ? TS_LESS : length1 > length2 ? TS_GREATER : TS_EQUAL;
+}
+
+static void text_insertion_sort(struct text_item *items, size_t length, size_t depth)
+{
+    for (size_t i = 1; i < length; ++i)
+    {
+        struct text_item item = items[i];
+        size_t j = i;
+
+        for (; j > 0 && text_cmp(&items[j - 1], &item, depth) == TS_GREATER; --j)
+            items[j] = items[j - 1];
+
+        items[j] = item;
+    }
+}
+
+/* Sorts the items a byte at a time, the most significant first, items
+ * ending before the byte going first. The ranges left to sort are kept on
+ * a stack, so long common prefixes do not recurse. Small ranges are sorted
+ * by insertion.
+ * */
+static bool radix_sort_texts(struct text_item *items, struct text_item *buffer, size_t length)
+{
+    size_t capacity = 64, top = 0;
+    struct text_range *stack = (struct text_range *)malloc(capacity * sizeof(struct text_range));
+
+    if (stack == NULL)
+        return false;
+
+    stack[top++] = (struct text_range){.begin = 0, .end = length, .depth = 0};
+
+    while (top > 0)
+    {
+        const struct text_range range = stack[--top];
+        struct text_item *part = items + range.begin;
+        const size_t part_length = range.end - range.begin;
+        size_t counts[257] = {0};
+        size_t offsets[257];
+
+        if (part_length < TS_SORT_RADIX_THRESHOLD)
+        {
+            text_insertion_sort(part, part_length, range.depth);
+            continue;
+        }
+
+        // bucket zero holds the items ending here
+        for (size_t i = 0; i < part_length; ++i)
+            counts[part[i].length > range.depth ? 1 + part[i].chars[range.depth] : 0]++;
+
+        offsets[0] = 0;
+        for (int bucket = 1; bucket < 257; ++bucket)
+            offsets[bucket] = offsets[bucket - 1] + counts[bucket - 1];
+
+        for (size_t i = 0; i < part_length; ++i)
+            buffer[offsets[part[i].length > range.depth ? 1 + part[i].chars[range.depth] : 0]++] = part[i];
+
+        memcpy(part, buffer, part_length * sizeof(struct text_item));
+
+        for (int bucket = 1; bucket < 257; ++bucket)
+        {
+            if (counts[bucket] < 2)
+                continue;
+
+            if (top == capacity)
+            {
+                struct text_range *grown = (struct text_range *)realloc(stack, 2 * capacity * sizeof(struct text_range));
+
+                if (grown == NULL)
+                {
+                    // finishes the range by comparisons instead
+                    text_insertion_sort(part, part_length, range.depth);
+                    break;
+                }
+
+                stack = grown;
+                capacity *= 2;
+            }
+
+            stack[top++] = (struct text_range){
+                .begin = range.begin + offsets[bucket] - counts[bucket],
+                .end = range.begin + offsets[bucket],
+                .depth = range.depth + 1,
+            };
+        }
+    }
+
+    free(stack);
+    return true;
+}
+
+static bool sort_texts(ts_generic_t *values, size_t length)
+{
+    struct text_item *items = (struct text_item *)malloc(2 * length * sizeof(struct text_item));
+
+    if (items == NULL)
+        return false;
+
+    for (size_t i = 0; i < length; ++i)
+    {
+        ts_generic_t value = values[i];
+
+        // a character is the string of its character, or the empty string
+        if (value->type == TS_TYPE_CHARACTER)
+        {
+            items[i].chars = (const uint8_t *)&value->data.character;
+            items[i].length = value->data.character != '\0';
+        }
+        else
+        {
+            items[i].chars = (const uint8_t *)ts_generic_t_chars(value);
+            items[i].length = ts_generic_t_length(value);
+        }
+        items[i].value = value;
+    }
+
+    const bool sorted = radix_sort_texts(items, items + length, length);
+
+    for (size_t i = 0; sorted && i < length; ++i)
+        values[i] = items[i].value;
+
+    free(items);
+    return sorted;
+}
+
+/* -- Sorting by class */
+
+extern bool ts_sort_values(ts_generic_t *values, size_t length)
+{
+    if (length < TS_SORT_RADIX_THRESHOLD)
+        return ts_sort_values_merge(values, length);
+
+    ts_generic_t *split = (ts_generic_t *)malloc(length * sizeof(ts_generic_t));
+    size_t counts[CLASSES] = {0};
+    size_t offsets[CLASSES];
+
+    if (split == NULL)
+        return false;
+
+    for (size_t i = 0; i < length; ++i)
+        counts[ts_generic_t_type_class(values[i])]++;
+
+    offsets[0] = 0;
+    for (int class = 1; class < CLASSES; ++class)
+        offsets[class] = offsets[class - 1] + counts[class - 1];
+
+    for (size_t i = 0; i < length; ++i)
+        split[offsets[ts_generic_t_type_class(values[i])]++] = values[i];
+
+    // the classes are sorted apart, on the split copy
+    bool sorted = true;
+    for (int class = 0; sorted && class < CLASSES; ++class)
+    {
+        ts_generic_t *begin = split + offsets[class] - counts[class];
+
+        if (counts[class] < TS_SORT_RADIX_THRESHOLD)
+            sorted = ts_sort_values_merge(begin, counts[class]);
+        else if (class == TS_CLASS_NUMERIC)
+            sorted = sort_numbers(begin, counts[class]);
+        else if (class == TS_CLASS_TEXT || class == TS_CLASS_BYTES)
+            sorted = sort_texts(begin, counts[class]);
+        else
+            sorted = ts_sort_values_merge(begin, counts[class]);
+    }
+
+    if (sorted)
+        memcpy(values, split, length * sizeof(ts_generic_t));
+
+    free(split);
+    return sorted;
+}
+
+/* -- Parallel sample sort */
+
+/* The state shared by the tasks of a parallel sort. */
+struct parallel_sort
+{
+    ts_generic_t *values;
+    ts_generic_t *buffer;
+    size_t length;
+    /* The number of parts of the values, and of buckets. */
+    size_t parts;
+    bool stable;
+
+    /* parts - 1 sorted splitters, bucket b taking the values from
+     * splitters[b - 1] and below splitters[b]. */
+    ts_generic_t *splitters;
+
+    /* The bucket of each value. */
+    uint32_t *buckets;
+
+    /* parts x parts counts, then offsets, of the values of a part going to
+     * each bucket. */
+    size_t *counts;
+
+    /* The start of each bucket in the buffer, and its end. */
+    size_t *starts;
+
+    atomic_bool failed;
+};
+
+/* Returns the index of the first splitter for which cmp is true. */
+static size_t first_splitter(struct parallel_sort *sort, ts_generic_t value, int stop)
+{
+    size_t low = 0, high = sort->parts - 1;
+
+    while (low < high)
+    {
+        const size_t middle = low + (high - low) / 2;
+        const int cmp = ts_generic_t_class_cmp(value, sort->splitters[middle]);
+
+        if (cmp == TS_LESS || cmp == stop)
+            high = middle;
+        else
+            low = middle + 1;
+    }
+
+    return low;
+}
+
+/* Gives the values of the parts their buckets, and counts them. */
+static void classify_parts(size_t first, size_t last, void *ctx)
+{
+    struct parallel_sort *sort = (struct parallel_sort *)ctx;
+
+    for (size_t part = first; part < last; ++part)
+    {
+        size_t *counts = sort->counts + part * sort->parts;
+        const size_t begin = part * sort->length / sort->parts;
+        const size_t end = (part + 1) * sort->length / sort->parts;
+
+        for (size_t i = begin; i < end; ++i)
+        {
+            // the first splitter greater than the value
+            size_t bucket = first_splitter(sort, sort->values[i], TS_LESS);
+
+            if (!sort->stable)
+            {
+                // spreads the values equal to splitters over their buckets
+                const size_t equal = first_splitter(sort, sort->values[i], TS_EQUAL);
+                bucket = equal + i % (bucket - equal + 1);
+            }
+
+            sort->buckets[i] = (uint32_t)bucket;
+            counts[bucket]++;
+        }
+    }
+}
+
+/* Moves the values of the parts into their buckets, in order. */
+static void scatter_parts(size_t first, size_t last, void *ctx)
+{
+    struct parallel_sort *sort = (struct parallel_sort *)ctx;
+
+    for (size_t part = first; part < last; ++part)
+    {
+        size_t *offsets = sort->counts + part * sort->parts;
+        const size_t begin = part * sort->length / sort->parts;
+        const size_t end = (part + 1) * sort->length / sort->parts;
+
+        for (size_t i = begin; i < end; ++i)
+            sort->buffer[offsets[sort->buckets[i]]++] = sort->values[i];
+    }
+}
+
+static void sort_buckets(size_t first, size_t last, void *ctx)
+{
+    struct parallel_sort *sort = (struct parallel_sort *)ctx;
+
+    for (size_t bucket = first; bucket < last; ++bucket)
+    {
+        const size_t begin = sort->starts[bucket];
+        const size_t end = sort->starts[bucket + 1];
+
+        if (!ts_sort_values(sort->buffer + begin, end - begin))
+            atomic_store(&sort->failed, true);
+    }
+}
+
+/* Picks the splitters from a regular sample of the values. */
+static bool pick_splitters(struct parallel_sort *sort)
+{
+    const size_t samples = sort->parts * TS_SORT_OVERSAMPLING;
+    ts_generic_t *sample = (ts_generic_t *)malloc(samples * sizeof(ts_generic_t));
+
+    if (sample == NULL)
+        return false;
+
+    for (size_t i = 0; i < samples; ++i)
+        sample[i] = sort->values[(2 * i + 1) * sort->length / (2 * samples)];
+
+    if (!ts_sort_values(sample, samples))
+    {
+        free(sample);
+        return false;
+    }
+
+    for (size_t i = 1; i < sort->parts; ++i)
+        sort->splitters[i - 1] = sample[i * TS_SORT_OVERSAMPLING];
+
+    free(sample);
+    return true;
+}
+
+/* Turns the counts into the offsets in the buffer where each part puts
+ * its values of each bucket, bucket by bucket, part by part.
+ * */
+static void count_offsets(struct parallel_sort *sort)
+{
+    size_t offset = 0;
+
+    for (size_t bucket = 0; bucket < sort->parts; ++bucket)
+    {
+        sort->starts[bucket] = offset;
+
+        for (size_t part = 0; part < sort->parts; ++part)
+        {
+            size_t *count = &sort->counts[part * sort->parts + bucket];
+            const size_t length = *count;
+
+            *count = offset;
+            offset += length;
+        }
+    }
+
+    sort->starts[sort->parts] = offset;
+}
+
+extern bool ts_sort_values_parallel(ts_pool_t *pool, ts_generic_t *values, size_t length, bool stable)
+{
+    const size_t threads = pool != NULL ? ts_pool_threads(pool) : 1;
+    size_t parts = threads * TS_SORT_PARTS_PER_THREAD;
+
+    // each part gets at least a threshold of values
+    if (parts > length / TS_SORT_PARALLEL_THRESHOLD)
+        parts = length / TS_SORT_PARALLEL_THRESHOLD;
+
+    if (threads == 1 || parts <= 1)
+        return ts_sort_values(values, length);
+
+    struct parallel_sort sort = {
+        .values = values,
+        .length = length,
+        .parts = parts,
+        .stable = stable,
+        .buffer = (ts_generic_t *)malloc(length * sizeof(ts_generic_t)),
+        .splitters = (ts_generic_t *)malloc((parts - 1) * sizeof(ts_generic_t)),
+        .buckets = (uint32_t *)malloc(length * sizeof(uint32_t)),
+        .counts = (size_t *)calloc(parts * parts, sizeof(size_t)),
+        .starts = (size_t *)malloc((parts + 1) * sizeof(size_t)),
+    };
+
+    atomic_init(&sort.failed, sort.buffer == NULL || sort.splitters == NULL || sort.buckets == NULL ||
+                                  sort.counts == NULL || sort.starts == NULL);
+
+    if (!atomic_load(&sort.failed) && pick_splitters(&sort))
+    {
+        pool->parallel_for(pool, 0, parts, 1, &classify_parts, &sort);
+        count_offsets(&sort);
+        pool->parallel_for(pool, 0, parts, 1, &scatter_parts, &sort);
+        pool->parallel_for(pool, 0, parts, 1, &sort_buckets, &sort);
+    }
+    else
+    {
+        atomic_store(&sort.failed, true);
+    }
+
+    // the values are only written once all the buckets are sorted
+    if (!atomic_load(&sort.failed))
+        memcpy(values, sort.buffer, length * sizeof(ts_generic_t));
+
+    free(sort.starts);
+    free(sort.counts);
+    free(sort.buckets);
+    free(sort.splitters);
+    free(sort.buffer);
+    return !atomic_load(&sort.failed);
+}
@@ -77,6 +77,8 @@ extern ts_generic_t ts_stack_pop(ts_stack_t *stack)
 
             /* Copy bytes from the value popped to the one that will be returned. */
             memcpy(value, popped, sizeof(struct ts_generic_t));
+            /* What the value owns moved with it, and must not be freed with the node. */
+            popped->type = TS_TYPE_NONE;
 
             stack->list->remove_at_index(stack->list, stack->top);
             stack->size -= 1;
@@ -26,6 +26,7 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <stdbool.h>
 #include <assert.h>
 
@@ -43,58 +44,965 @@ static ts_tree_node ts_tree_node_new(void)
         node->value = NULL;
         node->position = TS_TREE_NODE_ROOT;
         node->depth = 0;
+        node->size = 1;
     }
 
     return node;
 }
 
+/* Returns the left most node of the subtree. */
+static ts_tree_node leftmost_node(ts_tree_node node)
+{
+    if (node != NULL)
+        while (node->left != NULL)
+            node = node->left;
+    return node;
+}
+
+/* Returns the right most node of the subtree. */
+static ts_tree_node rightmost_node(ts_tree_node node)
+{
+    if (node != NULL)
+        while (node->right != NULL)
+            node = node->right;
+    return node;
+}
+
+/* Returns the in order successor of the node, using the parent pointers. */
+static ts_tree_node successor_node(ts_tree_node node)
+{
+    if (node->right != NULL)
+        return leftmost_node(node->right);
+
+    while (node->parent != NULL && node == node->parent->right)
+        node = node->parent;
+
+    return node->parent;
+}
+
+/* Returns the in order predecessor of the node, using the parent pointers. */
+static ts_tree_node predecessor_node(ts_tree_node node)
+{
+    if (node->left != NULL)
+        return rightmost_node(node->left);
+
+    while (node->parent != NULL && node == node->parent->left)
+        node = node->parent;
+
+    return node->parent;
+}
+
+/* Returns the tree, from the chain of side trees, whose values can be
+ * compared with the given one. NULL is returned if there's none.
+ * */
+static ts_tree_t *tree_of_value(ts_tree_t *tree, ts_generic_t value)
+{
+    for (; tree != NULL; tree = tree->next)
+        if (tree->root != NULL && ts_generic_t_cmp(value, tree->root->value) != TS_DIFFERENT)
+            return tree;
+    return NULL;
+}
+
+/* Comparator used to sort arrays of values with qsort. */
+static int sort_values_cmp(const void *value1, const void *value2)
+{
+    return ts_generic_t_class_cmp(*(ts_generic_t *)value1, *(ts_generic_t *)value2);
+}
+
+/* Returns the size of the subtree, zero for empty subtrees. */
+#define SUBTREE_SIZE(NODE) ((NODE) != NULL ? (NODE)->size : 0)
+
+/* Adds delta to the subtree sizes of the node and all its ancestors. */
+static void update_sizes_upwards(ts_tree_node node, int delta)
+{
+    for (; node != NULL; node = node->parent)
+        node->size += delta;
+}
+
+/* Returns the link, on the parent or on the tree, pointing to the node. */
+static ts_tree_node *link_to_node(ts_tree_t *tree, ts_tree_node node)
+{
+    if (node->parent == NULL)
+        return &tree->root;
+    return node->parent->left == node ? &node->parent->left : &node->parent->right;
+}
+
+/* Creates the side tree of the given one, with the same settings. */
+static ts_tree_t *new_side_tree(ts_tree_t *tree)
+{
+    if (tree->order_statistics)
+        return ts_tree_new_order_statistic(tree->on_dup_value_strat);
+    return ts_tree_new(tree->on_dup_value_strat);
+}
+
+/* Frees the node, unless it lives in the node block of the tree. */
+static void release_node(ts_tree_t *tree, ts_tree_node node)
+{
+    if (node < tree->node_block || node >= tree->node_block + tree->node_block_length)
+        free(node);
+}
+
+/* Makes room on the depth counts of the tree for the given depth.
+ * Returns false if the memory could not be allocated.
+ * */
+static bool reserve_depth(ts_tree_t *tree, size_t depth)
+{
+    if (depth < tree->depth_counts_capacity)
+        return true;
+
+    size_t capacity = tree->depth_counts_capacity > 0 ? tree->depth_counts_capacity : 16;
+    while (capacity <= depth)
+        capacity *= 2;
+
+    size_t *counts = (size_t *)realloc(tree->depth_counts, capacity * sizeof(size_t));
+
+    if (counts == NULL)
+        return false;
+
+    memset(counts + tree->depth_counts_capacity, 0, (capacity - tree->depth_counts_capacity) * sizeof(size_t));
+    tree->depth_counts = counts;
+    tree->depth_counts_capacity = capacity;
+    return true;
+}
+
+/* Lowers the full depth of the tree down to the deepest depth that
+ * still has nodes.
+ * */
+static void trim_full_depth(ts_tree_t *tree)
+{
+    while (tree->full_depth > 0 && tree->depth_counts[tree->full_depth] == 0)
+        tree->full_depth -= 1;
+}
+
+/* Inserts the value below the given root node, walking down the tree
+ * iteratively until an empty link is found.
+ * */
 static int insert_value_in_btree(ts_tree_t *tree, ts_tree_node *root, ts_generic_t value,
                                  ts_tree_node_position position, ts_tree_node parent)
 {
-#define DEPTH(PARENT_NODE) (PARENT_NODE != NULL ? PARENT_NODE->depth + 1 : 0)
-#define REP(TREE, STRAT) (TREE.on_dup_value_strat == STRAT)
+#define REP(TREE, STRAT) (TREE->on_dup_value_strat == STRAT)
 
-    if (*root == NULL)
+    ts_tree_node *link = root;
+    size_t depth = 0;
+
+    for (; *link != NULL; ++depth)
     {
-        ts_tree_node node = ts_tree_node_new();
+        const int cmp = ts_generic_t_cmp(value, (*link)->value);
+
+        parent = *link;
 
-        if (node != NULL)
+        if (cmp == TS_LESS || (cmp == TS_EQUAL && REP(tree, TS_TREE_APPEND_LEFT)))
+        {
+            link = &parent->left;
+            position = TS_TREE_NODE_LEFT;
+        }
+        else if (cmp == TS_GREATER || (cmp == TS_EQUAL && REP(tree, TS_TREE_APPEND_RIGHT)))
+        {
+            link = &parent->right;
+            position = TS_TREE_NODE_RIGTH;
+        }
+        else if (cmp == TS_DIFFERENT)
         {
-            node->parent = parent;
-            node->position = position;
-            node->value = value;
-            node->depth = DEPTH(parent);
-            *root = node;
+            /* Add to another tree, creating it if needed. */
+            if (tree->next == NULL)
+                tree->next = new_side_tree(tree);
+            if (tree->next == NULL)
+                goto return_error;
+            return ts_tree_add(tree->next, value);
         }
         else
+            // IGNORE
             goto return_error;
+    }
+
+    if (!reserve_depth(tree, depth))
+        goto return_error;
+
+    ts_tree_node node = ts_tree_node_new();
+
+    if (node == NULL)
+        goto return_error;
+
+    node->parent = parent;
+    node->position = parent != NULL ? position : TS_TREE_NODE_ROOT;
+    node->value = value;
+    node->depth = depth;
+    *link = node;
+
+    tree->size += 1;
+    tree->depth_counts[depth] += 1;
+    if (depth > tree->full_depth)
+        tree->full_depth = depth;
+    if (tree->order_statistics)
+        update_sizes_upwards(parent, 1);
+
+    return (int)depth;
+
+return_error:
+    return TS_TREE_VALUE_NOT_ADDED;
+}
+
+extern int ts_tree_add(ts_tree_t *tree, ts_generic_t value)
+{
+    if (tree == NULL || value == NULL)
+        return TS_TREE_VALUE_NOT_ADDED;
+
+    ts_tree_t *owner = tree_of_value(tree, value);
+
+    if (owner == NULL)
+    {
+        /* Use the first empty tree of the chain, or append a new one. */
+        for (owner = tree; owner->root != NULL; owner = owner->next)
+            if (owner->next == NULL && (owner->next = new_side_tree(owner)) == NULL)
+                return TS_TREE_VALUE_NOT_ADDED;
+
+        owner->type_of_value = value->type;
+    }
+
+    return insert_value_in_btree(owner, &owner->root, value, TS_TREE_NODE_ROOT, NULL);
+}
+
+/* Returns the first node found holding a value equal to the given one. */
+static ts_tree_node find_node(ts_tree_t *tree, ts_generic_t value)
+{
+    ts_tree_node node = tree != NULL ? tree->root : NULL;
+
+    while (node != NULL)
+    {
+        const int cmp = ts_generic_t_cmp(value, node->value);
+
+        if (cmp == TS_EQUAL)
+            return node;
+        node = cmp == TS_LESS ? node->left : node->right;
+    }
+
+    return NULL;
+}
+
+extern int ts_tree_search(ts_tree_t *tree, ts_generic_t value)
+{
+    ts_tree_t *owner = tree != NULL && value != NULL ? tree_of_value(tree, value) : NULL;
+    ts_tree_node node = find_node(owner, value);
+
+    return node != NULL ? (int)node->depth : TS_TREE_VALUE_NOT_ADDED;
+}
+
+/* Function called for each node visited by walk_tree. */
+typedef void (*node_visit_fn)(ts_tree_node node, void *ctx);
+
+static void walk_tree(ts_tree_node root, ts_tree_printing_order order, node_visit_fn visit, void *ctx);
+
+static void depth_update_visit(ts_tree_node node, void *ctx)
+{
+    ts_tree_t *tree = (ts_tree_t *)ctx;
+
+    tree->depth_counts[node->depth] -= 1;
+    node->depth = node->parent != NULL ? node->parent->depth + 1 : 0;
+    tree->depth_counts[node->depth] += 1;
+}
+
+/* Recomputes the depths of the subtree from the depth of its parent.
+ * The new depths must not be deeper than the full depth of the tree.
+ * */
+static void update_depths(ts_tree_t *tree, ts_tree_node subtree)
+{
+    walk_tree(subtree, TS_TREE_PRE_ORDER, &depth_update_visit, tree);
+    trim_full_depth(tree);
+}
+
+/* Removes the node, which must have at most one child, from the tree.
+ * The child takes the place of the removed node.
+ * */
+static void splice_node(ts_tree_t *tree, ts_tree_node node)
+{
+    ts_tree_node child = node->left != NULL ? node->left : node->right;
+
+#ifdef _MAKE_ROBUST_CHECK
+    assert(node->left == NULL || node->right == NULL);
+#endif
 
-        return node->depth;
+    *link_to_node(tree, node) = child;
+
+    if (tree->order_statistics)
+        update_sizes_upwards(node->parent, -1);
+
+    if (child != NULL)
+    {
+        child->parent = node->parent;
+        child->position = node->position;
     }
+
+    tree->depth_counts[node->depth] -= 1;
+    release_node(tree, node);
+    tree->size -= 1;
+
+    /* The whole subtree of the child moves up one level. */
+    if (child != NULL)
+        update_depths(tree, child);
     else
+        trim_full_depth(tree);
+}
+
+/* Removes the value held by the node from the tree, returning it. */
+static ts_generic_t remove_node(ts_tree_t *tree, ts_tree_node node)
+{
+    ts_generic_t value = node->value;
+
+    if (node->left != NULL && node->right != NULL)
     {
-        const cmp = ts_generic_t_cmp(value, (*root)->value);
+        /* Take the value of the successor, which has no left child. */
+        ts_tree_node successor = leftmost_node(node->right);
+        node->value = successor->value;
+        node = successor;
+    }
 
-        if (cmp == TS_LESS || (cmp == TS_EQUAL && tree->on_dup_value_strat == TS_TREE_APPEND_LEFT))
-            return insert_value_in_btree(tree, &(*root)->left, value, TS_TREE_NODE_LEFT, *root);
-        else if (cmp == TS_GREATER || (cmp == TS_EQUAL && tree->on_dup_value_strat == TS_TREE_APPEND_RIGHT))
-            return insert_value_in_btree(tree, &(*root)->right, value, TS_TREE_NODE_RIGTH, *root);
-        else if (cmp == TS_DIFFERENT)
-            return ts_tree_add(tree->next, value); // Add to another tree
+    splice_node(tree, node);
+    return value;
+}
+
+extern void ts_tree_remove(ts_tree_t *tree, ts_generic_t value)
+{
+    ts_tree_t *owner = tree != NULL && value != NULL ? tree_of_value(tree, value) : NULL;
+    ts_tree_node node = NULL;
+    ts_generic_t held = NULL;
+
+    while ((node = find_node(owner, value)) != NULL)
+    {
+        ts_generic_t removed = remove_node(owner, node);
+
+        // the given value may be one of the stored ones, it is still
+        // compared against until the last repetition is gone
+        if (removed == value)
+            held = removed;
         else
-            // IGNORE
-            ;
+            ts_generic_t_free(removed);
     }
 
-return_error:
-    return TS_TREE_VALUE_NOT_ADDED;
+#ifdef _MAKE_ROBUST_CHECK
+    assert(ts_tree_search(tree, value) == TS_TREE_VALUE_NOT_ADDED);
+#endif
+
+    ts_generic_t_free(held);
 }
 
-extern int ts_tree_add(ts_tree_t *tree, ts_generic_t value)
+/* Rotates the subtree to the left, the right child takes the place of the node. */
+static void rotate_left(ts_tree_t *tree, ts_tree_node node)
+{
+    ts_tree_node pivot = node->right;
+
+    *link_to_node(tree, node) = pivot;
+    pivot->parent = node->parent;
+    pivot->position = node->position;
+
+    node->right = pivot->left;
+    if (node->right != NULL)
+    {
+        node->right->parent = node;
+        node->right->position = TS_TREE_NODE_RIGTH;
+    }
+
+    pivot->left = node;
+    node->parent = pivot;
+    node->position = TS_TREE_NODE_LEFT;
+
+    if (tree->order_statistics)
+    {
+        pivot->size = node->size;
+        node->size = SUBTREE_SIZE(node->left) + SUBTREE_SIZE(node->right) + 1;
+    }
+}
+
+/* Rotates the subtree to the right, the left child takes the place of the node. */
+static void rotate_right(ts_tree_t *tree, ts_tree_node node)
+{
+    ts_tree_node pivot = node->left;
+
+    *link_to_node(tree, node) = pivot;
+    pivot->parent = node->parent;
+    pivot->position = node->position;
+
+    node->left = pivot->right;
+    if (node->left != NULL)
+    {
+        node->left->parent = node;
+        node->left->position = TS_TREE_NODE_LEFT;
+    }
+
+    pivot->right = node;
+    node->parent = pivot;
+    node->position = TS_TREE_NODE_RIGTH;
+
+    if (tree->order_statistics)
+    {
+        pivot->size = node->size;
+        node->size = SUBTREE_SIZE(node->left) + SUBTREE_SIZE(node->right) + 1;
+    }
+}
+
+/* Makes count left rotations along the right spine of the tree. */
+static void compress_vine(ts_tree_t *tree, size_t count)
+{
+    ts_tree_node node = tree->root;
+
+    for (size_t i = 0; i < count && node != NULL && node->right != NULL; ++i)
+    {
+        rotate_left(tree, node);
+        node = node->parent->right;
+    }
+}
+
+extern void ts_tree_balance(ts_tree_t *tree)
+{
+    /* Day-Stout-Warren: turn the tree into a right leaning vine, then
+     * fold the vine back into a complete tree, only using rotations.
+     * */
+    for (; tree != NULL; tree = tree->next)
+    {
+        ts_tree_node node = tree->root;
+        size_t count = 0;
+
+        while (node != NULL)
+        {
+            if (node->left != NULL)
+            {
+                rotate_right(tree, node);
+                node = node->parent;
+            }
+            else
+            {
+                count += 1;
+                node = node->right;
+            }
+        }
+
+        size_t leaves = 1;
+        while (leaves <= count + 1)
+            leaves *= 2;
+        leaves = leaves / 2 - 1;
+
+        compress_vine(tree, count - leaves);
+        while (leaves > 1)
+        {
+            leaves /= 2;
+            compress_vine(tree, leaves);
+        }
+
+        /* A complete tree is never deeper than the tree it came from. */
+        update_depths(tree, tree->root);
+    }
+}
+
+extern ts_generic_t ts_tree_select(ts_tree_t *tree, size_t k)
+{
+    for (; tree != NULL; tree = tree->next)
+    {
+        if (k >= tree->size)
+        {
+            k -= tree->size;
+            continue;
+        }
+
+        ts_tree_node node = tree->root;
+
+        if (tree->order_statistics)
+        {
+            while (node != NULL)
+            {
+                const size_t left_size = SUBTREE_SIZE(node->left);
+
+                if (k == left_size)
+                    break;
+                else if (k < left_size)
+                    node = node->left;
+                else
+                {
+                    k -= left_size + 1;
+                    node = node->right;
+                }
+            }
+        }
+        else
+        {
+            for (node = leftmost_node(node); k > 0 && node != NULL; --k)
+                node = successor_node(node);
+        }
+
+        return node != NULL ? node->value : NULL;
+    }
+
+    return NULL;
+}
+
+extern size_t ts_tree_rank(ts_tree_t *tree, ts_generic_t value)
+{
+    ts_tree_t *owner = tree != NULL && value != NULL ? tree_of_value(tree, value) : NULL;
+    size_t rank = 0;
+
+    /* Values on the trees before the owner all come first. */
+    for (; tree != owner; tree = tree->next)
+        rank += tree->size;
+
+    if (owner == NULL)
+        return rank;
+
+    if (owner->order_statistics)
+    {
+        ts_tree_node node = owner->root;
+
+        while (node != NULL)
+        {
+            if (ts_generic_t_cmp(node->value, value) == TS_LESS)
+            {
+                rank += SUBTREE_SIZE(node->left) + 1;
+                node = node->right;
+            }
+            else
+                node = node->left;
+        }
+    }
+    else
+    {
+        ts_tree_node node = leftmost_node(owner->root);
+
+        for (; node != NULL && ts_generic_t_cmp(node->value, value) == TS_LESS; node = successor_node(node))
+            rank += 1;
+    }
+
+    return rank;
+}
+
+/* Moves the cursor to the first node of the first non empty tree,
+ * starting the search on the given tree of the chain.
+ * */
+static bool cursor_enter_forward(ts_tree_cursor_t *cursor, ts_tree_t *tree)
+{
+    for (; tree != NULL; tree = tree->next)
+    {
+        if (tree->root != NULL)
+        {
+            cursor->current = tree;
+            cursor->node = leftmost_node(tree->root);
+            return true;
+        }
+    }
+
+    cursor->current = NULL;
+    cursor->node = NULL;
+    return false;
+}
+
+extern bool ts_tree_cursor_first(ts_tree_cursor_t *cursor)
+{
+    return cursor_enter_forward(cursor, cursor->tree);
+}
+
+extern bool ts_tree_cursor_last(ts_tree_cursor_t *cursor)
+{
+    ts_tree_t *last = NULL;
+
+    for (ts_tree_t *tree = cursor->tree; tree != NULL; tree = tree->next)
+        if (tree->root != NULL)
+            last = tree;
+
+    cursor->current = last;
+    cursor->node = last != NULL ? rightmost_node(last->root) : NULL;
+    return cursor->node != NULL;
+}
+
+extern bool ts_tree_cursor_seek(ts_tree_cursor_t *cursor, ts_generic_t key)
+{
+    ts_tree_t *owner = key != NULL ? tree_of_value(cursor->tree, key) : NULL;
+    ts_tree_node node = owner != NULL ? owner->root : NULL;
+    ts_tree_node found = NULL;
+
+    /* Lower bound: the left most node not less than the key. */
+    while (node != NULL)
+    {
+        if (ts_generic_t_cmp(node->value, key) != TS_LESS)
+        {
+            found = node;
+            node = node->left;
+        }
+        else
+            node = node->right;
+    }
+
+    if (found != NULL)
+    {
+        cursor->current = owner;
+        cursor->node = found;
+        return true;
+    }
+
+    cursor->current = NULL;
+    cursor->node = NULL;
+    return false;
+}
+
+extern bool ts_tree_cursor_next(ts_tree_cursor_t *cursor)
+{
+    if (cursor->node == NULL)
+        return false;
+
+    cursor->node = successor_node(cursor->node);
+
+    if (cursor->node == NULL)
+        return cursor_enter_forward(cursor, cursor->current->next);
+    return true;
+}
+
+extern bool ts_tree_cursor_prev(ts_tree_cursor_t *cursor)
+{
+    if (cursor->node == NULL)
+        return false;
+
+    cursor->node = predecessor_node(cursor->node);
+
+    if (cursor->node == NULL)
+    {
+        /* Continue on the closest non empty tree before the current one. */
+        ts_tree_t *previous = NULL;
+
+        for (ts_tree_t *tree = cursor->tree; tree != cursor->current; tree = tree->next)
+            if (tree->root != NULL)
+                previous = tree;
+
+        cursor->current = previous;
+        cursor->node = previous != NULL ? rightmost_node(previous->root) : NULL;
+    }
+
+    return cursor->node != NULL;
+}
+
+extern ts_generic_t ts_tree_cursor_value(ts_tree_cursor_t *cursor)
+{
+    return cursor->node != NULL ? cursor->node->value : NULL;
+}
+
+extern ts_tree_cursor_t ts_tree_cursor(ts_tree_t *tree)
+{
+    ts_tree_cursor_t cursor = {
+        .tree = tree,
+        .current = NULL,
+        .node = NULL,
+        .seek = &ts_tree_cursor_seek,
+        .next = &ts_tree_cursor_next,
+        .prev = &ts_tree_cursor_prev,
+        .value = &ts_tree_cursor_value,
+    };
+
+    ts_tree_cursor_first(&cursor);
+    return cursor;
+}
+
+extern size_t ts_tree_range(ts_tree_t *tree, ts_generic_t lo, ts_generic_t hi,
+                            ts_tree_visit_fn callback, void *ctx)
+{
+    ts_tree_cursor_t cursor = ts_tree_cursor(tree);
+    size_t visited = 0;
+
+    if (tree == NULL || lo == NULL || hi == NULL || !ts_tree_cursor_seek(&cursor, lo))
+        return 0;
+
+    do
+    {
+        ts_tree_t *owner = cursor.current;
+        ts_generic_t value = cursor.node->value;
+        const int cmp = ts_generic_t_cmp(value, hi);
+
+        if (cmp == TS_GREATER || cmp == TS_DIFFERENT)
+            break;
+
+        callback(value, ctx);
+        visited += 1;
+
+        /* Values of a side tree are not comparable with the range. */
+        if (!ts_tree_cursor_next(&cursor) || cursor.current != owner)
+            break;
+    } while (true);
+
+    return visited;
+}
+
+/* Walks the nodes of the tree in the given order. The traversal is made
+ * iteratively, using the parent pointers to climb back up the tree.
+ * */
+static void walk_tree(ts_tree_node root, ts_tree_printing_order order, node_visit_fn visit, void *ctx)
+{
+    ts_tree_node node = root;
+    ts_tree_node from = root != NULL ? root->parent : NULL;
+
+    while (node != NULL && node != root->parent)
+    {
+        ts_tree_node next = NULL;
+
+        if (from == node->parent)
+        {
+            /* Arrived from above. */
+            if (order == TS_TREE_PRE_ORDER)
+                visit(node, ctx);
+
+            if (node->left != NULL)
+                next = node->left;
+            else
+                from = node->left;
+        }
+
+        if (next == NULL && from == node->left)
+        {
+            /* Done with the left subtree. */
+            if (order == TS_TREE_IN_ORDER)
+                visit(node, ctx);
+
+            if (node->right != NULL)
+                next = node->right;
+            else
+                from = node->right;
+        }
+
+        if (next == NULL && from == node->right)
+        {
+            /* Done with the right subtree. */
+            if (order == TS_TREE_POST_ORDER)
+                visit(node, ctx);
+
+            next = node->parent;
+        }
+
+        from = node;
+        node = next;
+    }
+}
+
+/* Buffer used to build the string representation of a tree. */
+struct repr_buffer
+{
+    char *data;
+    size_t length;
+    size_t capacity;
+    bool failed;
+};
+
+static void repr_buffer_append(struct repr_buffer *buffer, const char *str)
+{
+    const size_t size = strlen(str);
+
+    if (buffer->failed)
+        return;
+
+    if (buffer->length + size + 1 > buffer->capacity)
+    {
+        size_t capacity = buffer->capacity > 0 ? buffer->capacity : TS_MAX_REPR_STR_BUF_SIZE;
+
+        while (buffer->length + size + 1 > capacity)
+            capacity *= 2;
+
+        char *data = realloc(buffer->data, capacity);
+
+        if (data == NULL)
+        {
+            buffer->failed = true;
+            return;
+        }
+
+        buffer->data = data;
+        buffer->capacity = capacity;
+    }
+
+    memcpy(buffer->data + buffer->length, str, size + 1);
+    buffer->length += size;
+}
+
+static void repr_visit(ts_tree_node node, void *ctx)
+{
+    struct repr_buffer *buffer = (struct repr_buffer *)ctx;
+    char *value_repr = node->value->repr(node->value);
+
+    /* The buffer always begins with the prefix. */
+    if (buffer->length > 1)
+        repr_buffer_append(buffer, ", ");
+
+    if (value_repr != NULL)
+    {
+        repr_buffer_append(buffer, value_repr);
+        free(value_repr);
+    }
+    else
+        buffer->failed = true;
+}
+
+extern char *ts_tree_repr(ts_tree_t *tree, ts_tree_printing_order order)
+{
+    struct repr_buffer buffer = {.data = NULL, .length = 0, .capacity = 0, .failed = false};
+
+    repr_buffer_append(&buffer, "{");
+
+    for (; tree != NULL; tree = tree->next)
+        walk_tree(tree->root, order, &repr_visit, &buffer);
+
+    repr_buffer_append(&buffer, "}");
+
+    if (buffer.failed)
+    {
+        free(buffer.data);
+        return NULL;
+    }
+
+    return realloc(buffer.data, buffer.length + 1);
+}
+
+extern void ts_tree_display(ts_tree_t *tree, ts_tree_printing_order order)
 {
-    if (tree->root == NULL && value != NULL)
-        tree->type_of_value = value->type;
-    return insert_value_in_btree(tree, &tree->root, value, TS_TREE_NODE_LEFT, NULL);
+    char *repr = ts_tree_repr(tree, order);
+    printf("%s", repr);
+    free(repr);
+}
+
+/* Links the nodes of the node block of the tree between lo and hi
+ * (exclusive), which already hold their values in order, as a balanced
+ * subtree.
+ * */
+static ts_tree_node link_balanced(ts_tree_t *tree, size_t lo, size_t hi, ts_tree_node parent,
+                                  ts_tree_node_position position)
+{
+    if (lo >= hi)
+        return NULL;
+
+    const size_t mid = lo + (hi - lo) / 2;
+    ts_tree_node node = &tree->node_block[mid];
+
+    node->parent = parent;
+    node->position = position;
+    node->depth = parent != NULL ? parent->depth + 1 : 0;
+    node->size = hi - lo;
+
+    tree->depth_counts[node->depth] += 1;
+    if (node->depth > tree->full_depth)
+        tree->full_depth = node->depth;
+
+    /* The recursion is bounded by the depth of the balanced tree. */
+    node->left = link_balanced(tree, lo, mid, node, TS_TREE_NODE_LEFT);
+    node->right = link_balanced(tree, mid + 1, hi, node, TS_TREE_NODE_RIGTH);
+
+    return node;
+}
+
+/* Splits the values into runs of comparable values, storing where each run
+ * ends. Returns the number of runs, or zero if the values are not sorted.
+ * */
+static size_t split_sorted_runs(ts_generic_t *values, size_t n, size_t *run_ends)
+{
+    size_t runs = 0;
+
+    for (size_t begin = 0; begin < n; begin = run_ends[runs++])
+    {
+        size_t end = begin + 1;
+
+        /* A type class can only appear in one run. */
+        for (size_t run = 0; run < runs; ++run)
+            if (ts_generic_t_cmp(values[begin], values[run > 0 ? run_ends[run - 1] : 0]) != TS_DIFFERENT)
+                return 0;
+
+        for (; end < n; ++end)
+        {
+            const int cmp = ts_generic_t_cmp(values[end - 1], values[end]);
+
+            if (cmp == TS_DIFFERENT)
+                break;
+            else if (cmp == TS_GREATER)
+                return 0;
+        }
+
+        run_ends[runs] = end;
+    }
+
+    return runs;
+}
+
+extern ts_tree_t *ts_tree_from_sorted(ts_generic_t *values, size_t n,
+                                      ts_tree_on_dup_value_strategy on_dup_value_strat)
+{
+    /* There can't be more runs than types, as each one holds a type class. */
+    size_t run_ends[TS_TYPE_NONE + 1];
+    ts_tree_t *trees[TS_TYPE_NONE + 1] = {NULL};
+    const size_t runs = split_sorted_runs(values, n, run_ends);
+
+    if (runs == 0 && n > 0)
+        return NULL;
+
+    /* Allocate everything first, so the values are untouched on failure. */
+    for (size_t run = 0; run < (runs > 0 ? runs : 1); ++run)
+    {
+        const size_t begin = run > 0 ? run_ends[run - 1] : 0;
+        const size_t length = runs > 0 ? run_ends[run] - begin : 0;
+
+        /* The balanced tree of length nodes is floor(log2(length)) deep. */
+        size_t depth = 0;
+        for (size_t span = length; span > 1; span /= 2)
+            depth += 1;
+
+        trees[run] = ts_tree_new(on_dup_value_strat);
+
+        if (trees[run] != NULL && length > 0)
+        {
+            trees[run]->node_block = (ts_tree_node)malloc(length * sizeof(struct ts_tree_node));
+            trees[run]->node_block_length = length;
+        }
+
+        if (trees[run] == NULL || (length > 0 && (trees[run]->node_block == NULL || !reserve_depth(trees[run], depth))))
+        {
+            /* The failed tree is not linked to the chain yet. */
+            ts_tree_free(&trees[run]);
+            ts_tree_free(&trees[0]);
+            return NULL;
+        }
+
+        if (run > 0)
+            trees[run - 1]->next = trees[run];
+    }
+
+    for (size_t run = 0; run < runs; ++run)
+    {
+        ts_tree_t *tree = trees[run];
+        ts_generic_t *run_values = values + (run > 0 ? run_ends[run - 1] : 0);
+        size_t length = tree->node_block_length;
+
+        /* The values are placed on the node block first, in the order they
+         * will have on the tree, and then linked from the middle outwards.
+         * */
+        size_t kept = 0;
+        for (size_t i = 0; i < length; ++i)
+        {
+            if (on_dup_value_strat == TS_TREE_IGNORE && kept > 0 &&
+                ts_generic_t_cmp(tree->node_block[kept - 1].value, run_values[i]) == TS_EQUAL)
+                ts_generic_t_free(run_values[i]);
+            else
+                tree->node_block[kept++].value = run_values[i];
+        }
+
+        tree->type_of_value = run_values[0]->type;
+        tree->size = kept;
+        tree->root = link_balanced(tree, 0, kept, NULL, TS_TREE_NODE_ROOT);
+    }
+
+    return trees[0];
+}
+
+extern ts_tree_t *ts_tree_from_unsorted(ts_generic_t *values, size_t n,
+                                        ts_tree_on_dup_value_strategy on_dup_value_strat)
+{
+    ts_generic_t *sorted = (ts_generic_t *)malloc((n > 0 ? n : 1) * sizeof(ts_generic_t));
+    ts_tree_t *tree = NULL;
+
+    if (sorted != NULL)
+    {
+        memcpy(sorted, values, n * sizeof(ts_generic_t));
+        qsort(sorted, n, sizeof(ts_generic_t), &sort_values_cmp);
+        tree = ts_tree_from_sorted(sorted, n, on_dup_value_strat);
+        free(sorted);
+    }
+
+    return tree;
 }
 
 extern ts_tree_t *ts_tree_new(ts_tree_on_dup_value_strategy on_dup_value_strat)
@@ -104,48 +1012,93 @@ extern ts_tree_t *ts_tree_new(ts_tree_on_dup_value_strategy on_dup_value_strat)
     if (tree != NULL)
     {
         tree->root = NULL;
+        tree->next = NULL;
         tree->on_dup_value_strat = on_dup_value_strat;
+        tree->full_depth = 0;
+        tree->depth_counts = NULL;
+        tree->depth_counts_capacity = 0;
+        tree->size = 0;
+        tree->type_of_value = TS_TYPE_NONE;
+        tree->order_statistics = false;
+        tree->node_block = NULL;
+        tree->node_block_length = 0;
+
+        /* Associated functions. */
         tree->add = &ts_tree_add;
+        tree->search = &ts_tree_search;
+        tree->remove = &ts_tree_remove;
+        tree->repr = &ts_tree_repr;
+        tree->display = &ts_tree_display;
+        tree->balance = &ts_tree_balance;
     }
 
     return tree;
 }
 
-static void ts_tree_node_free(ts_tree_node *node)
+extern ts_tree_t *ts_tree_new_order_statistic(ts_tree_on_dup_value_strategy on_dup_value_strat)
 {
-    if (*node != NULL)
-    {
-        ts_tree_node_free(&(*node)->left);
-        ts_tree_node_free(&(*node)->right);
+    ts_tree_t *tree = ts_tree_new(on_dup_value_strat);
+
+    if (tree != NULL)
+        tree->order_statistics = true;
+
+    return tree;
+}
+
+/* Frees the nodes of the subtree iteratively, climbing back through
+ * the parent pointers after freeing each leaf.
+ * */
+static void ts_tree_node_free(ts_tree_t *tree, ts_tree_node *root)
+{
+    ts_tree_node node = *root;
+    ts_tree_node stop = node != NULL ? node->parent : NULL;
 
-        if ((*node)->value != NULL)
+    while (node != NULL && node != stop)
+    {
+        if (node->left != NULL)
+            node = node->left;
+        else if (node->right != NULL)
+            node = node->right;
+        else
         {
-            free((*node)->value);
-            (*node)->value = NULL;
-        }
+            ts_tree_node parent = node->parent;
 
-        free(*node);
-        *node = NULL;
+            if (parent != NULL)
+            {
+                if (parent->left == node)
+                    parent->left = NULL;
+                else
+                    parent->right = NULL;
+            }
+
+            ts_generic_t_free(node->value);
+            node->value = NULL;
+
+            release_node(tree, node);
+            node = parent;
+        }
     }
 
+    *root = NULL;
+
 #ifdef _MAKE_ROBUST_CHECK
-    assert(node == NULL);
+    assert(*root == NULL);
 #endif
 }
 
 extern void ts_tree_free(ts_tree_t **tree)
 {
-    if (*tree != NULL)
+    /* The chain of side trees is freed iteratively as well. */
+    while (*tree != NULL)
     {
-        if ((*tree)->next != NULL)
-        {
-            ts_tree_free(&(*tree)->next);
-        }
+        ts_tree_t *next = (*tree)->next;
 
-        ts_tree_node_free(&(*tree)->root);
+        ts_tree_node_free(*tree, &(*tree)->root);
 
+        free((*tree)->node_block);
+        free((*tree)->depth_counts);
         free(*tree);
-        *tree = NULL;
+        *tree = next;
     }
 
 #ifdef _MAKE_ROBUST_CHECK
@@ -0,0 +1,252 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * MIT License                                                                       *
+ *                                                                                   *
+ * Copyright (c) 2022-2024 Anaxímeno Brito                                           *
+ *                                                                                   *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy      *
+ * of this software and associated documentation files (the "Software"), to deal     *
+ * in the Software without restriction, including without limitation the rights      *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell         *
+ * copies of the Software, and to permit persons to whom the Software is             *
+ * furnished to do so, subject to the following conditions:                          *
+ *                                                                                   *
+ * The above copyright notice and this permission notice shall be included in all    *
+ * copies or substantial portions of the Software.                                   *
+ *                                                                                   *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR        *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,          *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE       *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER            *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,     *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE     *
+ * SOFTWARE.                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#include "../include/3s/core.h"
+#include "../include/3s/llist.h"
+#include "../include/3s/pool.h"
+#include "../include/3s/sort.h"
+#include "../include/3s/vector.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <assert.h>
+
+/* Makes room for one more value, doubling the capacity. */
+static bool grow(ts_vector_t *vector)
+{
+    if (vector->length < vector->capacity)
+        return true;
+
+    return ts_vector_reserve(vector, vector->capacity != 0 ? 2 * vector->capacity : TS_VECTOR_INITIAL_CAPACITY);
+}
+
+extern bool ts_vector_push(ts_vector_t *vector, ts_generic_t value)
+{
+    return ts_vector_insert(vector, vector->length, value);
+}
+
+extern bool ts_vector_pop(ts_vector_t *vector, struct ts_generic_t *out)
+{
+    if (vector->length == 0)
+        return false;
+
+    vector->length -= 1;
+
+    if (out != NULL)
+        *out = vector->values[vector->length];
+    else
+        ts_generic_t_release(&vector->values[vector->length]);
+
+    return true;
+}
+
+extern ts_generic_t ts_vector_get(ts_vector_t *vector, size_t index)
+{
+    return index < vector->length ? &vector->values[index] : NULL;
+}
+
+extern bool ts_vector_insert(ts_vector_t *vector, size_t index, ts_generic_t value)
+{
+    if (!grow(vector))
+        return false;
+
+    if (index > vector->length)
+        index = vector->length;
+
+    memmove(&vector->values[index + 1], &vector->values[index],
+            (vector->length - index) * sizeof(struct ts_generic_t));
+
+    // the value's storage moves with it, only its shell is freed
+    vector->values[index] = *value;
+    vector->length += 1;
+    free(value);
+
+    return true;
+}
+
+extern bool ts_vector_erase(ts_vector_t *vector, size_t index)
+{
+    if (index >= vector->length)
+        return false;
+
+    ts_generic_t_release(&vector->values[index]);
+    memmove(&vector->values[index], &vector->values[index + 1],
+            (vector->length - index - 1) * sizeof(struct ts_generic_t));
+    vector->length -= 1;
+
+    return true;
+}
+
+extern bool ts_vector_reserve(ts_vector_t *vector, size_t capacity)
+{
+    if (capacity <= vector->capacity)
+        return true;
+
+    struct ts_generic_t *values = (struct ts_generic_t *)realloc(vector->values,
+                                                                 capacity * sizeof(struct ts_generic_t));
+
+    if (values == NULL)
+        return false;
+
+    vector->values = values;
+    vector->capacity = capacity;
+    return true;
+}
+
+extern size_t ts_vector_length(ts_vector_t *vector)
+{
+    return vector->length;
+}
+
+extern bool ts_vector_binary_search(ts_vector_t *vector, ts_generic_t key, size_t *index)
+{
+    size_t low = 0, high = vector->length;
+
+    while (low < high)
+    {
+        const size_t middle = low + (high - low) / 2;
+
+        if (ts_generic_t_class_cmp(&vector->values[middle], key) == TS_LESS)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    *index = low;
+    return low < vector->length && ts_generic_t_class_cmp(&vector->values[low], key) == TS_EQUAL;
+}
+
+extern bool ts_vector_sort(ts_vector_t *vector, ts_pool_t *pool, bool stable)
+{
+    if (vector->length < 2)
+        return true;
+
+    // the values are sorted by pointer, then moved once to their places
+    ts_generic_t *order = (ts_generic_t *)malloc(vector->length * sizeof(ts_generic_t));
+    struct ts_generic_t *values = (struct ts_generic_t *)malloc(vector->capacity * sizeof(struct ts_generic_t));
+
+    if (order == NULL || values == NULL)
+    {
+        free(values);
+        free(order);
+        return false;
+    }
+
+    for (size_t i = 0; i < vector->length; ++i)
+        order[i] = &vector->values[i];
+
+    if (!ts_sort_values_parallel(pool, order, vector->length, stable))
+    {
+        free(values);
+        free(order);
+        return false;
+    }
+
+    for (size_t i = 0; i < vector->length; ++i)
+        values[i] = *order[i];
+
+    free(vector->values);
+    vector->values = values;
+    free(order);
+    return true;
+}
+
+extern ts_vector_t *ts_vector_from_list(ts_list_t *list)
+{
+    ts_vector_t *vector = ts_vector_new(list != NULL ? list->length : 0);
+
+    if (vector == NULL || list == NULL)
+        return vector;
+
+    for (struct ts_linked_node *node = list->head; vector != NULL && node != NULL; node = node->next)
+        if (!ts_generic_t_copy_to(&vector->values[vector->length++], node->value))
+            ts_vector_free(&vector);
+
+    return vector;
+}
+
+extern ts_list_t *ts_vector_to_list(ts_vector_t *vector)
+{
+    ts_list_t *list = ts_new_list();
+
+    for (size_t i = 0; list != NULL && i < vector->length; ++i)
+    {
+        const unsigned length = list->length;
+        ts_generic_t copy = ts_generic_t_copy(&vector->values[i]);
+
+        if (copy != NULL)
+            ts_list_append_back(list, copy);
+
+        // either the copy or its node could not be allocated
+        if (list->length == length)
+        {
+            ts_generic_t_free(copy);
+            ts_list_free(&list);
+        }
+    }
+
+    return list;
+}
+
+extern ts_vector_t *ts_vector_new(size_t capacity)
+{
+    ts_vector_t *vector = (ts_vector_t *)malloc(sizeof(ts_vector_t));
+
+    if (vector != NULL)
+    {
+        vector->values = NULL;
+        vector->length = 0;
+        vector->capacity = 0;
+
+        if (!ts_vector_reserve(vector, capacity))
+        {
+            free(vector);
+            return NULL;
+        }
+
+        /* Associated functions. */
+        vector->push = &ts_vector_push;
+        vector->pop = &ts_vector_pop;
+        vector->get = &ts_vector_get;
+    }
+
+    return vector;
+}
+
+extern void ts_vector_free(ts_vector_t **vector)
+{
+    if (*vector != NULL)
+    {
+        for (size_t i = 0; i < (*vector)->length; ++i)
+            ts_generic_t_release(&(*vector)->values[i]);
+
+        free((*vector)->values);
+        free(*vector);
+        *vector = NULL;
+    }
+
+#ifdef _MAKE_ROBUST_CHECK
+    assert(*vector == NULL);
+#endif
+}
@@ -0,0 +1,104 @@
+#include "../tinytest/tinytest.h"
+#include "../include/3s/3s.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// -- Helpers
+
+static void concat_visit(const char *key, size_t length, ts_generic_t value, void *ctx)
+{
+    (void)value;
+    strncat((char *)ctx, key, length);
+    strcat((char *)ctx, ",");
+}
+
+// -- Testing insertion and search
+
+void test_art_add_search(void)
+{
+    ts_art_t *art = ts_art_new();
+    const char *keys[] = {"romane", "romanus", "romulus", "rubens", "ruber", "rubicon", "rubicundus", "r", ""};
+
+    for (int32_t i = 0; i < 9; ++i)
+        ASSERT_EQ(true, art->add(art, keys[i], strlen(keys[i]), ts_new_int(i)));
+    ASSERT_EQ(false, art->add(art, "ruber", 5, ts_new_int(42)));
+    ASSERT_EQ((size_t)9, art->length);
+
+    for (int32_t i = 0; i < 9; ++i)
+        ASSERT_EQ(i, art->search(art, keys[i], strlen(keys[i]))->data.integer);
+    ASSERT_EQ(NULL, art->search(art, "rom", 3));
+    ASSERT_EQ(NULL, art->search(art, "rubiconx", 8));
+
+    ts_art_free(&art);
+    ASSERT_EQ(NULL, art);
+}
+
+void test_art_grow_shrink(void)
+{
+    ts_art_t *art = ts_art_new();
+    char key[2] = {0};
+
+    /* One node goes through all the kinds, up and down. */
+    for (int i = 0; i < 256; ++i)
+    {
+        key[1] = (char)i;
+        art->add(art, key, 2, ts_new_int(i));
+    }
+    key[1] = (char)200;
+    ASSERT_EQ(200, art->search(art, key, 2)->data.integer);
+
+    for (int i = 0; i < 255; ++i)
+    {
+        key[1] = (char)i;
+        ASSERT_EQ(true, art->remove(art, key, 2));
+    }
+    ASSERT_EQ(false, art->remove(art, key, 2));
+    key[1] = (char)255;
+    ASSERT_EQ(255, art->search(art, key, 2)->data.integer);
+    ASSERT_EQ((size_t)1, art->length);
+
+    ts_art_free(&art);
+}
+
+// -- Testing ordered iteration
+
+void test_art_iter_prefix(void)
+{
+    ts_art_t *art = ts_art_new();
+    const char *keys[] = {"banana", "apple", "band", "bandana", "ban", "cherry", "applesauce-with-a-long-path"};
+    char seen[128] = {0};
+
+    for (int32_t i = 0; i < 7; ++i)
+        art->add(art, keys[i], strlen(keys[i]), ts_new_int(i));
+
+    ASSERT_EQ((size_t)7, ts_art_iter(art, &concat_visit, seen));
+    ASSERT_STR_EQ("apple,applesauce-with-a-long-path,ban,banana,band,bandana,cherry,", seen);
+
+    seen[0] = '\0';
+    ASSERT_EQ((size_t)3, ts_art_prefix(art, "band", 4, &concat_visit, seen) + ts_art_prefix(art, "banan", 5, &concat_visit, seen));
+    ASSERT_STR_EQ("band,bandana,banana,", seen);
+
+    seen[0] = '\0';
+    ASSERT_EQ((size_t)1, ts_art_prefix(art, "applesauce-with", 15, &concat_visit, seen));
+    ASSERT_EQ((size_t)0, ts_art_prefix(art, "applesauce-without", 18, &concat_visit, seen));
+    ASSERT_EQ((size_t)0, ts_art_prefix(art, "d", 1, &concat_visit, seen));
+
+    ASSERT_EQ(true, art->remove(art, "ban", 3));
+    seen[0] = '\0';
+    ts_art_prefix(art, "ba", 2, &concat_visit, seen);
+    ASSERT_STR_EQ("banana,band,bandana,", seen);
+
+    ts_art_free(&art);
+}
+
+int main()
+{
+    RUN(test_art_add_search);
+    RUN(test_art_grow_shrink);
+
+    RUN(test_art_iter_prefix);
+
+    return TEST_REPORT();
+}
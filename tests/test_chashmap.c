@@ -0,0 +1,95 @@
+#include "../tinytest/tinytest.h"
+#include "../include/3s/3s.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#define WORKERS 4
+#define KEYS 5000
+
+// -- Helpers
+
+static ts_generic_t square(ts_generic_t key, void *ctx)
+{
+    atomic_fetch_add((atomic_int *)ctx, 1);
+    return ts_new_int(key->data.integer * key->data.integer);
+}
+
+static void *compute_values(void *arg)
+{
+    ts_chashmap_t *map = ((void **)arg)[0];
+    atomic_int *computed = ((void **)arg)[1];
+    struct ts_generic_t out;
+
+    /* Every worker asks for every key. */
+    for (int32_t i = 0; i < KEYS; ++i)
+        ts_chashmap_compute_if_absent(map, ts_new_int(i), &square, computed, &out);
+
+    return NULL;
+}
+
+// -- Testing single threaded use
+
+void test_chashmap_operations(void)
+{
+    ts_chashmap_t *map = ts_chashmap_new(3);
+    ts_generic_t key = ts_new_int(1);
+    struct ts_generic_t out;
+    atomic_int computed = 0;
+
+    ASSERT_EQ((size_t)4, map->shards_length);
+    ASSERT_EQ(true, map->put(map, ts_new_int(1), ts_new_string("one")));
+    ASSERT_EQ(true, map->get(map, key, &out));
+    ASSERT_STR_EQ("one", out.data.string);
+
+    ASSERT_EQ(false, ts_chashmap_get_or_insert(map, ts_new_float64(1.0), ts_new_string("uno"), &out));
+    ASSERT_STR_EQ("one", out.data.string);
+    ASSERT_EQ(true, ts_chashmap_get_or_insert(map, ts_new_int(2), ts_new_string("two"), &out));
+    ASSERT_STR_EQ("two", out.data.string);
+
+    ASSERT_EQ(true, ts_chashmap_compute_if_absent(map, ts_new_int(3), &square, &computed, &out));
+    ASSERT_EQ(false, ts_chashmap_compute_if_absent(map, ts_new_int(3), &square, &computed, &out));
+    ASSERT_EQ(9, out.data.integer);
+    ASSERT_EQ(1, computed);
+    ASSERT_EQ((size_t)3, ts_chashmap_length(map));
+
+    ASSERT_EQ(true, map->remove(map, key));
+    ASSERT_EQ(false, map->get(map, key, &out));
+    ASSERT_EQ(false, map->remove(map, key));
+
+    free(key);
+    ts_chashmap_free(&map);
+    ASSERT_EQ(NULL, map);
+}
+
+// -- Testing concurrent use
+
+void test_chashmap_concurrent_compute(void)
+{
+    ts_chashmap_t *map = ts_chashmap_new(0);
+    pthread_t workers[WORKERS];
+    void *args[2] = {map, NULL};
+    atomic_int computed = 0;
+
+    args[1] = &computed;
+    for (int i = 0; i < WORKERS; ++i)
+        pthread_create(&workers[i], NULL, &compute_values, args);
+
+    for (int i = 0; i < WORKERS; ++i)
+        pthread_join(workers[i], NULL);
+
+    ASSERT_EQ(KEYS, computed);
+    ASSERT_EQ((size_t)KEYS, ts_chashmap_length(map));
+
+    ts_chashmap_free(&map);
+}
+
+int main()
+{
+    RUN(test_chashmap_operations);
+    RUN(test_chashmap_concurrent_compute);
+
+    return TEST_REPORT();
+}
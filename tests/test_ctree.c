@@ -0,0 +1,214 @@
+#include "../tinytest/tinytest.h"
+#include "../include/3s/3s.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#define WRITERS 4
+#define VALUES_PER_WRITER 5000
+
+// -- Helpers
+
+static void *add_values(void *arg)
+{
+    ts_ctree_t *tree = ((void **)arg)[0];
+    const int32_t first = (int32_t)(intptr_t)((void **)arg)[1];
+
+    for (int32_t i = first; i < WRITERS * VALUES_PER_WRITER; i += WRITERS)
+        tree->add(tree, ts_new_int(i));
+
+    return NULL;
+}
+
+/* Adds growing keys while removing the old ones, so the tree keeps being
+ * rebuilt, and stops the readers when done.
+ * */
+static void *slide_window(void *arg)
+{
+    ts_ctree_t *tree = ((void **)arg)[0];
+    atomic_bool *done = ((void **)arg)[1];
+    struct ts_generic_t key = {.type = TS_TYPE_INTEGER};
+
+    for (int32_t i = 0; i < WRITERS * VALUES_PER_WRITER; ++i)
+    {
+        tree->add(tree, ts_new_int(i));
+        key.data.integer = i - 100;
+        tree->remove(tree, &key);
+    }
+
+    atomic_store(done, true);
+    return NULL;
+}
+
+/* Looks for a value that is never removed, counting the misses. */
+static void *read_kept(void *arg)
+{
+    ts_ctree_t *tree = ((void **)arg)[0];
+    atomic_bool *done = ((void **)arg)[1];
+    struct ts_generic_t key = {.type = TS_TYPE_INTEGER, .data.integer = -1000};
+    size_t misses = 0;
+
+    while (!atomic_load(done))
+        misses += !tree->contains(tree, &key);
+
+    return (void *)misses;
+}
+
+/* Returns the number of nodes on the longest path from the node down. */
+static size_t height(struct ts_ctree_node *node)
+{
+    if (node == NULL)
+        return 0;
+
+    const size_t left = height(atomic_load(&node->left));
+    const size_t right = height(atomic_load(&node->right));
+
+    return 1 + (left > right ? left : right);
+}
+
+// -- Testing single threaded use
+
+void test_ctree_add_remove(void)
+{
+    ts_ctree_t *tree = ts_ctree_new();
+    ts_generic_t duplicated = ts_new_float64(1.0);
+    ts_generic_t key = ts_new_int(1);
+
+    ASSERT_EQ(true, tree->add(tree, ts_new_int(1)));
+    ASSERT_EQ(true, tree->add(tree, ts_new_string("one")));
+    ASSERT_EQ(false, tree->add(tree, duplicated));
+    ASSERT_EQ((size_t)2, ts_ctree_length(tree));
+
+    ASSERT_EQ(true, tree->remove(tree, key));
+    ASSERT_EQ(false, tree->contains(tree, key));
+    ASSERT_EQ(false, tree->remove(tree, key));
+
+    /* Removed nodes are brought back. */
+    ASSERT_EQ(true, tree->add(tree, duplicated));
+    ASSERT_EQ(true, tree->contains(tree, key));
+    ASSERT_EQ((size_t)2, ts_ctree_length(tree));
+
+    free(key);
+    ts_ctree_free(&tree);
+}
+
+void test_ctree_sorted_keys(void)
+{
+    ts_ctree_t *tree = ts_ctree_new();
+    struct ts_generic_t key = {.type = TS_TYPE_INTEGER};
+    size_t found = 0;
+
+    for (int32_t i = 0; i < WRITERS * VALUES_PER_WRITER; ++i)
+        tree->add(tree, ts_new_int(i));
+
+    /* The depth stays below log(n) in base 4 / 3, 34 for 20000 nodes. */
+    ASSERT_EQ(true, height(atomic_load(&tree->root)) <= 35);
+
+    for (key.data.integer = 0; key.data.integer < WRITERS * VALUES_PER_WRITER; ++key.data.integer)
+        found += tree->contains(tree, &key);
+
+    ASSERT_EQ((size_t)(WRITERS * VALUES_PER_WRITER), found);
+    ts_ctree_free(&tree);
+}
+
+void test_ctree_removed_nodes(void)
+{
+    ts_ctree_t *tree = ts_ctree_new();
+    struct ts_generic_t key = {.type = TS_TYPE_INTEGER};
+    size_t most_nodes = 0;
+
+    /* A window of 100 values slides over distinct keys. */
+    for (int32_t i = 0; i < WRITERS * VALUES_PER_WRITER; ++i)
+    {
+        tree->add(tree, ts_new_int(i));
+        key.data.integer = i - 100;
+        tree->remove(tree, &key);
+
+        if (atomic_load(&tree->nodes) > most_nodes)
+            most_nodes = atomic_load(&tree->nodes);
+    }
+
+    ASSERT_EQ((size_t)100, ts_ctree_length(tree));
+    ASSERT_EQ(true, most_nodes <= 2 * 100 + TS_CTREE_MIN_COMPACTION);
+
+    key.data.integer = WRITERS * VALUES_PER_WRITER - 100;
+    ASSERT_EQ(true, tree->contains(tree, &key));
+    key.data.integer -= 1;
+    ASSERT_EQ(false, tree->contains(tree, &key));
+
+    /* Values left out by a rebuild can be added again. */
+    ASSERT_EQ(true, tree->add(tree, ts_new_int(0)));
+    ASSERT_EQ((size_t)101, ts_ctree_length(tree));
+
+    ts_ctree_free(&tree);
+}
+
+// -- Testing concurrent use
+
+void test_ctree_concurrent_add(void)
+{
+    ts_ctree_t *tree = ts_ctree_new();
+    pthread_t writers[WRITERS];
+    void *args[WRITERS][2];
+    struct ts_generic_t key = {.type = TS_TYPE_INTEGER};
+    size_t found = 0;
+
+    for (intptr_t i = 0; i < WRITERS; ++i)
+    {
+        args[i][0] = tree;
+        args[i][1] = (void *)i;
+        pthread_create(&writers[i], NULL, &add_values, args[i]);
+    }
+
+    for (int i = 0; i < WRITERS; ++i)
+        pthread_join(writers[i], NULL);
+
+    for (key.data.integer = 0; key.data.integer < WRITERS * VALUES_PER_WRITER; ++key.data.integer)
+        found += tree->contains(tree, &key);
+
+    ASSERT_EQ((size_t)(WRITERS * VALUES_PER_WRITER), found);
+    ASSERT_EQ((size_t)(WRITERS * VALUES_PER_WRITER), ts_ctree_length(tree));
+
+    ts_ctree_free(&tree);
+}
+
+void test_ctree_concurrent_rebuild(void)
+{
+    ts_ctree_t *tree = ts_ctree_new();
+    pthread_t threads[WRITERS];
+    atomic_bool done = false;
+    void *args[2] = {tree, &done};
+    size_t misses = 0;
+
+    tree->add(tree, ts_new_int(-1000));
+
+    pthread_create(&threads[0], NULL, &slide_window, args);
+    for (int i = 1; i < WRITERS; ++i)
+        pthread_create(&threads[i], NULL, &read_kept, args);
+
+    pthread_join(threads[0], NULL);
+    for (int i = 1; i < WRITERS; ++i)
+    {
+        void *result = NULL;
+        pthread_join(threads[i], &result);
+        misses += (size_t)result;
+    }
+
+    ASSERT_EQ((size_t)0, misses);
+    ASSERT_EQ((size_t)101, ts_ctree_length(tree));
+
+    ts_ctree_free(&tree);
+}
+
+int main()
+{
+    RUN(test_ctree_add_remove);
+    RUN(test_ctree_sorted_keys);
+    RUN(test_ctree_removed_nodes);
+    RUN(test_ctree_concurrent_add);
+    RUN(test_ctree_concurrent_rebuild);
+
+    return TEST_REPORT();
+}
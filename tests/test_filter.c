@@ -0,0 +1,188 @@
+#include "../tinytest/tinytest.h"
+#include "../include/3s/3s.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// -- Helpers
+
+/* Counts the values of [from, to) the filter claims to hold. */
+static size_t bloom_hits(ts_bloom_t *bloom, int32_t from, int32_t to)
+{
+    size_t hits = 0;
+
+    for (int32_t i = from; i < to; ++i)
+    {
+        ts_generic_t value = ts_new_int(i);
+        hits += bloom->contains(bloom, value);
+        free(value);
+    }
+
+    return hits;
+}
+
+static size_t cuckoo_hits(ts_cuckoo_t *cuckoo, int32_t from, int32_t to)
+{
+    size_t hits = 0;
+
+    for (int32_t i = from; i < to; ++i)
+    {
+        ts_generic_t value = ts_new_int(i);
+        hits += cuckoo->contains(cuckoo, value);
+        free(value);
+    }
+
+    return hits;
+}
+
+// -- Testing Bloom filters
+
+void test_bloom_membership(void)
+{
+    ts_bloom_t *bloom = ts_bloom_new(10000, 0.01);
+
+    for (int32_t i = 0; i < 10000; ++i)
+    {
+        ts_generic_t value = ts_new_int(i);
+        bloom->add(bloom, value);
+        free(value);
+    }
+
+    ASSERT_EQ((size_t)10000, bloom_hits(bloom, 0, 10000));
+
+    // a few times the target, a blocked filter trades some accuracy for speed
+    ASSERT_EQ(true, bloom_hits(bloom, 10000, 110000) < 3000);
+
+    ts_bloom_free(&bloom);
+    ASSERT_EQ(NULL, bloom);
+}
+
+void test_bloom_serialize(void)
+{
+    ts_bloom_t *bloom = ts_bloom_new(1000, 0.01);
+    ts_generic_t value = ts_new_string("3s");
+
+    bloom->add(bloom, value);
+
+    size_t length = ts_bloom_serialized_size(bloom);
+    uint8_t *buffer = malloc(length);
+    ASSERT_EQ(length, ts_bloom_serialize(bloom, buffer));
+
+    ts_bloom_t *copy = ts_bloom_deserialize(buffer, length);
+    ASSERT_EQ(true, copy->contains(copy, value));
+    ASSERT_EQ(bloom->hashes, copy->hashes);
+    ASSERT_EQ(NULL, ts_bloom_deserialize(buffer, length - 1));
+
+    buffer[0] = 'X';
+    ASSERT_EQ(NULL, ts_bloom_deserialize(buffer, length));
+
+    free(value);
+    free(buffer);
+    ts_bloom_free(&copy);
+    ts_bloom_free(&bloom);
+}
+
+// -- Testing cuckoo filters
+
+void test_cuckoo_membership(void)
+{
+    ts_cuckoo_t *cuckoo = ts_cuckoo_new(10000, 0.01);
+
+    for (int32_t i = 0; i < 10000; ++i)
+    {
+        ts_generic_t value = ts_new_int(i);
+        ASSERT_EQ(true, cuckoo->add(cuckoo, value));
+        free(value);
+    }
+
+    ASSERT_EQ((size_t)10000, cuckoo->length);
+    ASSERT_EQ((size_t)10000, cuckoo_hits(cuckoo, 0, 10000));
+    ASSERT_EQ(true, cuckoo_hits(cuckoo, 10000, 110000) < 2000);
+
+    for (int32_t i = 0; i < 10000; i += 2)
+    {
+        ts_generic_t value = ts_new_int(i);
+        ASSERT_EQ(true, cuckoo->remove(cuckoo, value));
+        free(value);
+    }
+
+    ASSERT_EQ((size_t)5000, cuckoo->length);
+
+    size_t remaining = 0;
+    for (int32_t i = 1; i < 10000; i += 2)
+    {
+        ts_generic_t value = ts_new_int(i);
+        remaining += cuckoo->contains(cuckoo, value);
+        free(value);
+    }
+    ASSERT_EQ((size_t)5000, remaining);
+
+    ts_cuckoo_free(&cuckoo);
+    ASSERT_EQ(NULL, cuckoo);
+}
+
+void test_cuckoo_full(void)
+{
+    ts_cuckoo_t *cuckoo = ts_cuckoo_new(16, 0.01);
+    int32_t added = 0;
+    ts_generic_t value;
+
+    for (;; ++added)
+    {
+        value = ts_new_int(added);
+        bool ok = cuckoo->add(cuckoo, value);
+        free(value);
+
+        if (!ok)
+            break;
+    }
+
+    // nothing added is ever lost, even the last one left aside
+    ASSERT_EQ((size_t)added, cuckoo->length);
+    ASSERT_EQ((size_t)added, cuckoo_hits(cuckoo, 0, added));
+
+    value = ts_new_int(0);
+    ASSERT_EQ(true, cuckoo->remove(cuckoo, value));
+    ASSERT_EQ(true, cuckoo->add(cuckoo, value));
+    free(value);
+
+    ts_cuckoo_free(&cuckoo);
+}
+
+void test_cuckoo_serialize(void)
+{
+    ts_cuckoo_t *cuckoo = ts_cuckoo_new(1000, 0.001);
+    ts_generic_t value = ts_new_string("3s");
+
+    cuckoo->add(cuckoo, value);
+
+    size_t length = ts_cuckoo_serialized_size(cuckoo);
+    uint8_t *buffer = malloc(length);
+    ASSERT_EQ(length, ts_cuckoo_serialize(cuckoo, buffer));
+
+    ts_cuckoo_t *copy = ts_cuckoo_deserialize(buffer, length);
+    ASSERT_EQ(true, copy->contains(copy, value));
+    ASSERT_EQ((size_t)1, copy->length);
+    ASSERT_EQ(cuckoo->fingerprint_bits, copy->fingerprint_bits);
+    ASSERT_EQ(NULL, ts_cuckoo_deserialize(buffer, length - 2));
+
+    ASSERT_EQ(true, copy->remove(copy, value));
+    ASSERT_EQ(false, copy->contains(copy, value));
+
+    free(value);
+    free(buffer);
+    ts_cuckoo_free(&copy);
+    ts_cuckoo_free(&cuckoo);
+}
+
+int main()
+{
+    RUN(test_bloom_membership);
+    RUN(test_bloom_serialize);
+
+    RUN(test_cuckoo_membership);
+    RUN(test_cuckoo_full);
+    RUN(test_cuckoo_serialize);
+
+    return TEST_REPORT();
+}
@@ -0,0 +1,204 @@
+#include "../tinytest/tinytest.h"
+#include "../include/3s/3s.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// -- Helpers
+
+/* Pushes the value and frees it, as the frame keeps a copy. */
+static void push(ts_frame_t *frame, ts_generic_t value)
+{
+    ASSERT_EQ(true, frame->push(frame, value));
+    ts_generic_t_free(value);
+}
+
+/* Returns the numeric member of the value as a double. */
+static double number(ts_generic_t value)
+{
+    double result = value->type == TS_TYPE_INTEGER ? value->data.integer
+                    : value->type == TS_TYPE_INT64 ? (double)value->data.integer64
+                                                   : value->data.float64;
+
+    ts_generic_t_free(value);
+    return result;
+}
+
+// -- Testing frames
+
+void test_frame_push_get(void)
+{
+    ts_frame_t *frame = ts_frame_new();
+    ts_generic_t value;
+    char chars[64];
+
+    memset(chars, 'x', sizeof(chars));
+
+    push(frame, ts_new_int(-1));
+    push(frame, ts_new_owned_string("a"));
+    push(frame, ts_new_float64(2.5));
+    push(frame, ts_new_owned_string_n(chars, sizeof(chars)));
+    push(frame, ts_new_bytes("\0b", 2));
+    push(frame, ts_new_string("c"));
+    push(frame, ts_new_none());
+    push(frame, ts_new_int(3));
+
+    ASSERT_EQ((size_t)8, ts_frame_length(frame));
+    ASSERT_EQ((size_t)2, frame->columns[TS_TYPE_INTEGER].length);
+    ASSERT_EQ((size_t)2, frame->columns[TS_TYPE_OWNED_STRING].length);
+
+    value = frame->get(frame, 0);
+    ASSERT_EQ(-1, value->data.integer);
+    ts_generic_t_free(value);
+
+    value = frame->get(frame, 1);
+    ASSERT_STR_EQ("a", ts_generic_t_chars(value));
+    ts_generic_t_free(value);
+
+    value = frame->get(frame, 2);
+    ASSERT_EQ(true, value->data.float64 == 2.5);
+    ts_generic_t_free(value);
+
+    value = frame->get(frame, 3);
+    ASSERT_EQ((size_t)64, ts_generic_t_length(value));
+    ASSERT_EQ(0, memcmp(chars, ts_generic_t_chars(value), sizeof(chars)));
+    ts_generic_t_free(value);
+
+    value = frame->get(frame, 4);
+    ASSERT_EQ(TS_TYPE_BYTES, value->type);
+    ASSERT_EQ((size_t)2, ts_generic_t_length(value));
+    ASSERT_EQ('b', ts_generic_t_chars(value)[1]);
+    ts_generic_t_free(value);
+
+    value = frame->get(frame, 5);
+    ASSERT_STR_EQ("c", value->data.string);
+    ts_generic_t_free(value);
+
+    value = frame->get(frame, 6);
+    ASSERT_EQ(TS_TYPE_NONE, value->type);
+    ts_generic_t_free(value);
+
+    value = frame->get(frame, 7);
+    ASSERT_EQ(3, value->data.integer);
+    ts_generic_t_free(value);
+
+    ASSERT_EQ(true, frame->get(frame, 8) == NULL);
+
+    ts_frame_free(&frame);
+    ASSERT_EQ(true, frame == NULL);
+}
+
+void test_frame_find_count(void)
+{
+    ts_frame_t *frame = ts_frame_new();
+    ts_generic_t key;
+
+    // lengths that are not multiples of the vector widths check the tails
+    for (int32_t i = 0; i < 103; ++i)
+    {
+        push(frame, ts_new_int(i % 10));
+        push(frame, ts_new_float64(i % 7 == 6 ? NAN : i % 7));
+        push(frame, ts_new_uint(i));
+    }
+    push(frame, ts_new_owned_string("needle"));
+    push(frame, ts_new_float32(1.5f));
+
+    key = ts_new_int(9);
+    ASSERT_EQ((size_t)27, ts_frame_find(frame, key));
+    ASSERT_EQ((size_t)10, ts_frame_count(frame, key));
+    ts_generic_t_free(key);
+
+    key = ts_new_int(10);
+    ASSERT_EQ(TS_FRAME_NOT_FOUND, ts_frame_find(frame, key));
+    ASSERT_EQ((size_t)0, ts_frame_count(frame, key));
+    ts_generic_t_free(key);
+
+    // integers are not found among the unsigned
+    key = ts_new_uint(102);
+    ASSERT_EQ((size_t)308, ts_frame_find(frame, key));
+    ASSERT_EQ((size_t)1, ts_frame_count(frame, key));
+    ts_generic_t_free(key);
+
+    key = ts_new_float64(3);
+    ASSERT_EQ((size_t)10, ts_frame_find(frame, key));
+    ASSERT_EQ((size_t)15, ts_frame_count(frame, key));
+    ts_generic_t_free(key);
+
+    key = ts_new_float64(NAN);
+    ASSERT_EQ((size_t)19, ts_frame_find(frame, key));
+    ASSERT_EQ((size_t)14, ts_frame_count(frame, key));
+    ts_generic_t_free(key);
+
+    key = ts_new_owned_string("needle");
+    ASSERT_EQ((size_t)309, ts_frame_find(frame, key));
+    ASSERT_EQ((size_t)1, ts_frame_count(frame, key));
+    ts_generic_t_free(key);
+
+    key = ts_new_float32(1.5f);
+    ASSERT_EQ((size_t)310, ts_frame_find(frame, key));
+    ts_generic_t_free(key);
+
+    ts_frame_free(&frame);
+}
+
+void test_frame_aggregates(void)
+{
+    ts_frame_t *frame = ts_frame_new();
+    int32_t min = INT32_MAX, max = INT32_MIN;
+    int64_t sum = 0;
+
+    ASSERT_EQ(true, ts_frame_min(frame, TS_TYPE_INTEGER) == NULL);
+    ASSERT_EQ(true, ts_frame_sum(frame, TS_TYPE_STRING) == NULL);
+    ASSERT_EQ(0.0, number(ts_frame_sum(frame, TS_TYPE_FLOAT64)));
+
+    srand(42);
+    for (int i = 0; i < 1001; ++i)
+    {
+        int32_t value = rand() - RAND_MAX / 2;
+
+        min = value < min ? value : min;
+        max = value > max ? value : max;
+        sum += value;
+
+        push(frame, ts_new_int(value));
+        push(frame, ts_new_float64(i - 500.25));
+        push(frame, ts_new_int64((int64_t)value * 1000));
+    }
+
+    ASSERT_EQ((double)min, number(ts_frame_min(frame, TS_TYPE_INTEGER)));
+    ASSERT_EQ((double)max, number(ts_frame_max(frame, TS_TYPE_INTEGER)));
+    ASSERT_EQ((double)sum, number(ts_frame_sum(frame, TS_TYPE_INTEGER)));
+
+    ASSERT_EQ(-500.25, number(ts_frame_min(frame, TS_TYPE_FLOAT64)));
+    ASSERT_EQ(499.75, number(ts_frame_max(frame, TS_TYPE_FLOAT64)));
+    ASSERT_EQ(-250.25, number(ts_frame_sum(frame, TS_TYPE_FLOAT64)));
+
+    ASSERT_EQ((double)min * 1000, number(ts_frame_min(frame, TS_TYPE_INT64)));
+    ASSERT_EQ((double)max * 1000, number(ts_frame_max(frame, TS_TYPE_INT64)));
+    ASSERT_EQ((double)sum * 1000, number(ts_frame_sum(frame, TS_TYPE_INT64)));
+
+    // NaN is the greatest number
+    push(frame, ts_new_float64(NAN));
+    ASSERT_EQ(-500.25, number(ts_frame_min(frame, TS_TYPE_FLOAT64)));
+    ASSERT_EQ(true, isnan(number(ts_frame_max(frame, TS_TYPE_FLOAT64))));
+
+    ts_frame_free(&frame);
+
+    frame = ts_frame_new();
+    push(frame, ts_new_float64(NAN));
+    push(frame, ts_new_float64(NAN));
+    push(frame, ts_new_float64(NAN));
+    ASSERT_EQ(true, isnan(number(ts_frame_min(frame, TS_TYPE_FLOAT64))));
+    ts_frame_free(&frame);
+}
+
+int main()
+{
+    RUN(test_frame_push_get);
+    RUN(test_frame_find_count);
+    RUN(test_frame_aggregates);
+
+    return TEST_REPORT();
+}
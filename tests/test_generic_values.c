@@ -2,6 +2,7 @@
 #include "../include/3s/3s.h"
 
 #include <stdint.h>
+#include <string.h>
 
 // -- Testing value creation
 
@@ -40,6 +41,33 @@ void test_value_string_creation(void)
     ASSERT_EQ(value->type, TS_TYPE_STRING);
 }
 
+void test_value_owned_string_creation(void)
+{
+    ts_generic_t short_value = ts_new_owned_string("inline");
+    ts_generic_t long_value = ts_new_owned_string("a string too long to fit inline");
+    ts_generic_t copy = ts_generic_t_copy(long_value);
+
+    ASSERT_EQ(short_value->type, TS_TYPE_OWNED_STRING);
+    ASSERT_STR_EQ(ts_generic_t_chars(short_value), "inline");
+    ASSERT_EQ((size_t)6, ts_generic_t_length(short_value));
+    ASSERT_EQ(ts_generic_t_chars(short_value), short_value->data.owned.inline_chars);
+
+    ASSERT_STR_EQ(ts_generic_t_chars(long_value), "a string too long to fit inline");
+    ASSERT_EQ((size_t)31, ts_generic_t_length(long_value));
+    ASSERT_EQ(false, ts_generic_t_chars(copy) == ts_generic_t_chars(long_value));
+    ASSERT_STR_EQ(ts_generic_t_chars(copy), ts_generic_t_chars(long_value));
+
+    ts_arena_t *arena = ts_arena_new(0);
+    ts_generic_t on_arena = ts_new_owned_string_in(arena, "a string too long to fit inline", 31);
+    ASSERT_EQ(TS_EQUAL, ts_generic_t_cmp(on_arena, long_value));
+    ts_generic_t_free(on_arena);
+    ts_arena_free(&arena);
+
+    ts_generic_t_free(short_value);
+    ts_generic_t_free(long_value);
+    ts_generic_t_free(copy);
+}
+
 void test_value_pointer_creation(void)
 {
     ts_generic_t value = ts_new_pointer((void *)3);
@@ -68,6 +96,39 @@ void test_value_int_repr(void)
     ASSERT_STR_EQ(value->repr(value), "3");
 }
 
+void test_value_list_repr(void)
+{
+    char chars[101], expected[512];
+    uint8_t bytes[60];
+    ts_list_t *list = ts_new_list();
+
+    memset(chars, 'x', 100);
+    chars[100] = '\0';
+    memset(bytes, 0xab, sizeof(bytes));
+
+    char *repr = ts_list_repr(list);
+    ASSERT_STR_EQ("[]", repr);
+    free(repr);
+
+    ts_list_append_back(list, ts_new_owned_string(chars));
+    ts_list_append_back(list, ts_new_bytes(bytes, sizeof(bytes)));
+    ts_list_append_back(list, ts_new_int(7));
+
+    // the string and the hex of the bytes are far longer than the repr of a number
+    strcpy(expected, "['");
+    strcat(expected, chars);
+    strcat(expected, "', b'");
+    for (size_t i = 0; i < sizeof(bytes); ++i)
+        strcat(expected, "ab");
+    strcat(expected, "', 7]");
+
+    repr = ts_list_repr(list);
+    ASSERT_STR_EQ(expected, repr);
+    free(repr);
+
+    ts_list_free(&list);
+}
+
 // -- Testing comparation
 
 void test_value_int_comparation(void)
@@ -124,6 +185,8 @@ void test_value_string_comparation(void)
 
     ASSERT_EQ(TS_GREATER, value1->compare(value1, ts_new_char('a')));
     ASSERT_EQ(TS_EQUAL, value1->compare(value1, ts_new_string("test string")));
+    ASSERT_EQ(TS_LESS, value1->compare(value1, ts_new_string("test strz")));
+    ASSERT_EQ(TS_GREATER, value1->compare(value1, ts_new_string("test")));
     ASSERT_EQ(TS_LESS, value1->compare(value1, ts_new_char('z')));
     ASSERT_EQ(TS_DIFFERENT, value1->compare(value1, ts_new_pointer(0)));
     ASSERT_EQ(TS_DIFFERENT, value1->compare(value1, ts_new_float32(1)));
@@ -131,6 +194,175 @@ void test_value_string_comparation(void)
     ASSERT_EQ(TS_DIFFERENT, value1->compare(value1, ts_new_int(3)));
 }
 
+void test_value_owned_string_comparation(void)
+{
+    ts_generic_t values[] = {ts_new_owned_string_n("ab\0c", 4), ts_new_owned_string_n("ab\0d", 4),
+                             ts_new_owned_string("ab"), ts_new_string("ab"), ts_new_char('a'),
+                             ts_new_owned_string("a"), ts_new_int(1)};
+
+    // the lengths are compared once the characters are
+    ASSERT_EQ(TS_LESS, ts_generic_t_cmp(values[0], values[1]));
+    ASSERT_EQ(TS_GREATER, ts_generic_t_cmp(values[0], values[2]));
+    ASSERT_EQ(TS_EQUAL, ts_generic_t_cmp(values[2], values[3]));
+    ASSERT_EQ(TS_EQUAL, ts_generic_t_cmp(values[3], values[2]));
+    ASSERT_EQ(TS_LESS, ts_generic_t_cmp(values[4], values[2]));
+    ASSERT_EQ(TS_EQUAL, ts_generic_t_cmp(values[4], values[5]));
+    ASSERT_EQ(TS_DIFFERENT, ts_generic_t_cmp(values[5], values[6]));
+
+    ASSERT_EQ(ts_generic_t_hash(values[2]), ts_generic_t_hash(values[3]));
+    ASSERT_EQ(ts_generic_t_hash(values[4]), ts_generic_t_hash(values[5]));
+
+    char *repr = ts_generic_t_repr(values[2]);
+    ASSERT_STR_EQ("'ab'", repr);
+    free(repr);
+
+    for (int i = 0; i < 7; ++i)
+        ts_generic_t_free(values[i]);
+}
+
+void test_value_high_character_comparation(void)
+{
+    ts_generic_t values[] = {ts_new_char('\xe9'), ts_new_string("\xe9xyz"), ts_new_owned_string("\xe9xyz"),
+                             ts_new_char('a'), ts_new_string("a"), ts_new_owned_string("a")};
+
+    // characters compare as unsigned, like the characters of strings do
+    for (int i = 0; i < 3; ++i)
+        for (int j = 3; j < 6; ++j)
+        {
+            ASSERT_EQ(TS_GREATER, ts_generic_t_cmp(values[i], values[j]));
+            ASSERT_EQ(TS_LESS, ts_generic_t_cmp(values[j], values[i]));
+        }
+
+    ASSERT_EQ(TS_LESS, ts_generic_t_cmp(values[0], values[1]));
+    ASSERT_EQ(TS_LESS, ts_generic_t_cmp(values[0], values[2]));
+    ASSERT_EQ(TS_EQUAL, ts_generic_t_cmp(values[1], values[2]));
+
+    for (int i = 0; i < 6; ++i)
+        ts_generic_t_free(values[i]);
+}
+
+void test_value_int64_comparation(void)
+{
+    // both round to the same double
+    ts_generic_t big = ts_new_int64(((int64_t)1 << 53) + 1);
+    ts_generic_t rounded = ts_new_float64((double)(((int64_t)1 << 53) + 1));
+    ts_generic_t values[] = {ts_new_int64(INT64_MIN), ts_new_int(-1), ts_new_float64(-0.5), ts_new_uint64(0),
+                             ts_new_float32(0.5f), ts_new_uint(1), ts_new_int64(INT64_MAX),
+                             ts_new_uint64(UINT64_MAX), ts_new_float64(1e30), ts_new_float64(0.0 / 0.0)};
+
+    ASSERT_EQ(TS_GREATER, big->compare(big, rounded));
+    ASSERT_EQ(TS_LESS, rounded->compare(rounded, big));
+    ASSERT_EQ(false, ts_generic_t_hash(big) == ts_generic_t_hash(rounded));
+
+    for (int i = 0; i < 10; ++i)
+    {
+        ASSERT_EQ(TS_EQUAL, ts_generic_t_cmp(values[i], values[i]));
+        for (int j = i + 1; j < 10; ++j)
+        {
+            ASSERT_EQ(TS_LESS, ts_generic_t_cmp(values[i], values[j]));
+            ASSERT_EQ(TS_GREATER, ts_generic_t_cmp(values[j], values[i]));
+        }
+    }
+
+    ts_generic_t one = ts_new_uint64(1);
+    ASSERT_EQ(TS_EQUAL, ts_generic_t_cmp(one, values[5]));
+    ASSERT_EQ(ts_generic_t_hash(one), ts_generic_t_hash(values[5]));
+    ASSERT_EQ(TS_DIFFERENT, ts_generic_t_cmp(one, ts_new_bool(true)));
+
+    char *repr = ts_generic_t_repr(values[7]);
+    ASSERT_STR_EQ("18446744073709551615", repr);
+    free(repr);
+
+    for (int i = 0; i < 10; ++i)
+        free(values[i]);
+    free(one);
+    free(big);
+    free(rounded);
+}
+
+void test_value_bool_and_bytes(void)
+{
+    ts_generic_t yes = ts_new_bool(true);
+    ts_generic_t no = ts_new_bool(false);
+    ts_generic_t bytes = ts_new_bytes("\x00\xff", 2);
+    ts_generic_t longer = ts_new_bytes("\x00\xff\x01", 3);
+    ts_generic_t text = ts_new_owned_string_n("\x00\xff", 2);
+
+    ASSERT_EQ(TS_GREATER, ts_generic_t_cmp(yes, no));
+    ASSERT_EQ(TS_CLASS_BOOL, ts_generic_t_type_class(yes));
+    ASSERT_EQ(TS_LESS, ts_generic_t_cmp(bytes, longer));
+    ASSERT_EQ(TS_DIFFERENT, ts_generic_t_cmp(bytes, text));
+    ASSERT_EQ(TS_DIFFERENT, ts_generic_t_cmp(text, bytes));
+
+    char *repr = ts_generic_t_repr(longer);
+    ASSERT_STR_EQ("b'00ff01'", repr);
+    free(repr);
+    repr = ts_generic_t_repr(no);
+    ASSERT_STR_EQ("false", repr);
+    free(repr);
+
+    free(yes);
+    free(no);
+    ts_generic_t_free(bytes);
+    ts_generic_t_free(longer);
+    ts_generic_t_free(text);
+}
+
+// -- Testing key encoding
+
+static int key_cmp(ts_generic_t value1, ts_generic_t value2)
+{
+    uint8_t key1[64], key2[64];
+    const size_t size1 = ts_generic_t_encode_key(value1, key1);
+    const size_t size2 = ts_generic_t_encode_key(value2, key2);
+    const int cmp = memcmp(key1, key2, size1 < size2 ? size1 : size2);
+
+    if (cmp != 0)
+        return cmp < 0 ? TS_LESS : TS_GREATER;
+    return size1 < size2 ? TS_LESS : size1 > size2 ? TS_GREATER : TS_EQUAL;
+}
+
+void test_value_encode_key(void)
+{
+    ts_generic_t values[] = {
+        ts_new_float64(-1.0 / 0.0), ts_new_int64(INT64_MIN), ts_new_float64(-1e-310), ts_new_int(-3),
+        ts_new_float32(-2.5f), ts_new_float64(-0.0), ts_new_uint(0), ts_new_float64(5e-324), ts_new_float32(0.75f),
+        ts_new_int(1), ts_new_float64(1.0), ts_new_uint64(((uint64_t)1 << 53) + 1), ts_new_float64(1e300),
+        ts_new_uint64(UINT64_MAX), ts_new_float64(1.0 / 0.0), ts_new_float64(0.0 / 0.0),
+        ts_new_char('\0'), ts_new_string(""), ts_new_owned_string_n("a\0", 2), ts_new_char('a'),
+        ts_new_string("a"), ts_new_string("ab"), ts_new_owned_string("b"), ts_new_pointer((void *)1),
+        ts_new_pointer((void *)256), ts_new_bool(false), ts_new_bool(true), ts_new_bytes("", 0),
+        ts_new_bytes("\0", 1), ts_new_bytes("\x01", 1), ts_new_none(), ts_new_char('\xe9'),
+        ts_new_string("\xe9xyz"), ts_new_owned_string("\xe9xyz"), ts_new_string("a\xff"), ts_new_bytes("\x80", 1),
+        ts_new_bytes("\x7f\xff", 2)};
+    const int length = sizeof(values) / sizeof(values[0]);
+
+    for (int i = 0; i < length; ++i)
+        for (int j = 0; j < length; ++j)
+            ASSERT_EQ(ts_generic_t_class_cmp(values[i], values[j]), key_cmp(values[i], values[j]));
+
+    ASSERT_EQ((size_t)TS_NUMBER_KEY_SIZE, ts_generic_t_encode_key(values[0], NULL));
+    ASSERT_EQ((size_t)6, ts_generic_t_encode_key(values[18], NULL));
+
+    for (int i = 0; i < length; ++i)
+        ts_generic_t_free(values[i]);
+}
+
+void test_value_hash(void)
+{
+    ts_generic_t values[] = {ts_new_int(3), ts_new_uint(3), ts_new_float32(3), ts_new_float64(3),
+                             ts_new_string("x"), ts_new_char('x'), ts_new_float64(-0.0), ts_new_int(0)};
+
+    ASSERT_EQ(ts_generic_t_hash(values[0]), ts_generic_t_hash(values[1]));
+    ASSERT_EQ(ts_generic_t_hash(values[0]), ts_generic_t_hash(values[2]));
+    ASSERT_EQ(ts_generic_t_hash(values[0]), ts_generic_t_hash(values[3]));
+    ASSERT_EQ(ts_generic_t_hash(values[4]), ts_generic_t_hash(values[5]));
+    ASSERT_EQ(ts_generic_t_hash(values[6]), ts_generic_t_hash(values[7]));
+    ASSERT_EQ(false, ts_generic_t_hash(values[0]) == ts_generic_t_hash(values[7]));
+
+    for (int i = 0; i < 8; ++i)
+        free(values[i]);
+}
 
 int main()
 {
@@ -139,17 +371,27 @@ int main()
     RUN(test_value_float32_creation);
     RUN(test_value_float64_creation);
     RUN(test_value_string_creation);
+    RUN(test_value_owned_string_creation);
     RUN(test_value_pointer_creation);
     RUN(test_value_char_creation);
     RUN(test_value_none_creation);
 
     RUN(test_value_int_repr);
+    RUN(test_value_list_repr);
 
     RUN(test_value_int_comparation);
     RUN(test_value_uint_comparation);
     RUN(test_value_float32_comparation);
     RUN(test_value_float64_comparation);
     RUN(test_value_string_comparation);
+    RUN(test_value_owned_string_comparation);
+    RUN(test_value_high_character_comparation);
+    RUN(test_value_int64_comparation);
+    RUN(test_value_bool_and_bytes);
+
+    RUN(test_value_encode_key);
+
+    RUN(test_value_hash);
 
     return TEST_REPORT();
 }
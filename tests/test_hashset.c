@@ -0,0 +1,108 @@
+#include "../tinytest/tinytest.h"
+#include "../include/3s/3s.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// -- Helpers
+
+static ts_hashset_t *range_set(int32_t from, int32_t to)
+{
+    ts_hashset_t *set = ts_hashset_new(true);
+
+    for (int32_t i = from; i < to; ++i)
+        set->add(set, ts_new_int(i));
+
+    return set;
+}
+
+static int32_t sum_members(ts_hashset_t *set)
+{
+    ts_hashtable_iter_t iter = ts_hashset_iter(set);
+    int32_t sum = 0;
+
+    while (ts_hashset_iter_next(&iter))
+        sum += iter.key->data.integer;
+
+    return sum;
+}
+
+// -- Testing membership
+
+void test_hashset_add_contains(void)
+{
+    ts_hashset_t *set = ts_hashset_new(true);
+    ts_generic_t value = ts_new_float64(2.0);
+
+    ASSERT_EQ(true, set->add(set, ts_new_int(2)));
+    ASSERT_EQ(false, set->add(set, ts_new_uint(2)));
+    ASSERT_EQ(true, set->add(set, ts_new_string("two")));
+    ASSERT_EQ((size_t)2, ts_hashset_length(set));
+
+    ASSERT_EQ(true, set->contains(set, value));
+    ASSERT_EQ(true, set->remove(set, value));
+    ASSERT_EQ(false, set->contains(set, value));
+
+    free(value);
+    ts_hashset_free(&set);
+    ASSERT_EQ(NULL, set);
+}
+
+// -- Testing set algebra
+
+void test_hashset_algebra(void)
+{
+    ts_hashset_t *set1 = range_set(0, 100);
+    ts_hashset_t *set2 = range_set(50, 300);
+
+    ts_hashset_t *result = ts_hashset_union(set1, set2);
+    ASSERT_EQ((size_t)300, ts_hashset_length(result));
+    ASSERT_EQ(299 * 300 / 2, sum_members(result));
+    ts_hashset_free(&result);
+
+    result = ts_hashset_intersect(set1, set2);
+    ASSERT_EQ((size_t)50, ts_hashset_length(result));
+    ASSERT_EQ(99 * 100 / 2 - 49 * 50 / 2, sum_members(result));
+    ts_hashset_free(&result);
+
+    result = ts_hashset_difference(set1, set2);
+    ASSERT_EQ((size_t)50, ts_hashset_length(result));
+    ASSERT_EQ(49 * 50 / 2, sum_members(result));
+    ts_hashset_free(&result);
+
+    ts_hashset_free(&set1);
+    ts_hashset_free(&set2);
+}
+
+// -- Testing list deduplication
+
+void test_list_dedup(void)
+{
+    ts_list_t *list = ts_new_list();
+    const int32_t values[] = {3, 1, 3, 2, 1, 1, 4, 2};
+
+    for (int i = 0; i < 8; ++i)
+        ts_list_append_back(list, ts_new_int(values[i]));
+    ts_list_append_back(list, ts_new_float64(4.0));
+
+    ts_list_dedup(list);
+
+    char *repr = ts_list_repr(list);
+    ASSERT_STR_EQ("[3, 1, 2, 4]", repr);
+    ASSERT_EQ(4, list->tail->value->data.integer);
+    ASSERT_EQ((unsigned)4, list->length);
+
+    free(repr);
+    ts_list_free(&list);
+}
+
+int main()
+{
+    RUN(test_hashset_add_contains);
+
+    RUN(test_hashset_algebra);
+
+    RUN(test_list_dedup);
+
+    return TEST_REPORT();
+}
@@ -0,0 +1,128 @@
+#include "../tinytest/tinytest.h"
+#include "../include/3s/3s.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// -- Testing insertion and lookup
+
+void test_hashtable_put_get(void)
+{
+    ts_hashtable_t *table = ts_hashtable_new(TS_HASHTABLE_DEFAULT_LOAD, true);
+    ts_generic_t key = ts_new_int(0);
+
+    for (int32_t i = 0; i < 1000; ++i)
+        ASSERT_EQ(true, table->put(table, ts_new_int(i), ts_new_int(i * i)));
+    ASSERT_EQ(false, table->put(table, ts_new_float64(12.0), ts_new_int(-1)));
+    ASSERT_EQ((size_t)1000, table->length);
+
+    key->data.integer = 999;
+    ASSERT_EQ(999 * 999, table->get(table, key)->data.integer);
+    key->data.integer = 12;
+    ASSERT_EQ(-1, table->get(table, key)->data.integer);
+    key->data.integer = 1000;
+    ASSERT_EQ(NULL, table->get(table, key));
+    ASSERT_EQ(false, table->contains(table, key));
+
+    free(key);
+    ts_hashtable_free(&table);
+    ASSERT_EQ(NULL, table);
+}
+
+void test_hashtable_mixed_keys(void)
+{
+    ts_hashtable_t *table = ts_hashtable_new(0.5, true);
+    ts_generic_t key = ts_new_char('a');
+
+    table->put(table, ts_new_string("a"), ts_new_int(1));
+    table->put(table, ts_new_uint(7), ts_new_int(2));
+    table->put(table, ts_new_none(), ts_new_int(3));
+
+    ASSERT_EQ(1, table->get(table, key)->data.integer);
+    free(key);
+    key = ts_new_float32(7.0f);
+    ASSERT_EQ(2, table->get(table, key)->data.integer);
+    free(key);
+    key = ts_new_none();
+    ASSERT_EQ(3, table->get(table, key)->data.integer);
+
+    free(key);
+    ts_hashtable_free(&table);
+}
+
+// -- Testing removal and iteration
+
+void test_hashtable_remove_iter(void)
+{
+    ts_hashtable_t *table = ts_hashtable_new(TS_HASHTABLE_DEFAULT_LOAD, true);
+    ts_generic_t key = ts_new_int(0);
+    int32_t sum = 0;
+
+    ASSERT_EQ(true, ts_hashtable_reserve(table, 500));
+    const size_t capacity = table->store.capacity;
+
+    for (int32_t i = 0; i < 500; ++i)
+        table->put(table, ts_new_int(i), ts_new_int(i));
+    ASSERT_EQ(capacity, table->store.capacity);
+
+    for (int32_t i = 0; i < 500; i += 2)
+    {
+        key->data.integer = i;
+        ASSERT_EQ(true, table->remove(table, key));
+    }
+    ASSERT_EQ(false, table->remove(table, key));
+    ASSERT_EQ((size_t)250, table->length);
+
+    ts_hashtable_iter_t iter = ts_hashtable_iter(table);
+    while (ts_hashtable_iter_next(&iter))
+        sum += iter.value->data.integer;
+    ASSERT_EQ(250 * 250, sum);
+
+    free(key);
+    ts_hashtable_free(&table);
+}
+
+void test_hashtable_incremental(void)
+{
+    ts_hashtable_t *table = ts_hashtable_new_incremental(TS_HASHTABLE_DEFAULT_LOAD, true);
+    ts_generic_t key = ts_new_int(0);
+    size_t entries = 0;
+    bool migrated = false;
+
+    for (int32_t i = 0; i < 5000; ++i)
+    {
+        table->put(table, ts_new_int(i), ts_new_int(i));
+        migrated |= table->old.capacity != 0;
+    }
+    ASSERT_EQ(true, migrated);
+
+    /* Entries are found and removed wherever they are. */
+    for (int32_t i = 0; i < 5000; i += 3)
+    {
+        key->data.integer = i;
+        ASSERT_EQ(i, table->get(table, key)->data.integer);
+        ASSERT_EQ(true, table->remove(table, key));
+    }
+    ASSERT_EQ(false, table->contains(table, key));
+
+    ts_hashtable_iter_t iter = ts_hashtable_iter(table);
+    while (ts_hashtable_iter_next(&iter))
+        entries++;
+    ASSERT_EQ(table->length, entries);
+    ASSERT_EQ((size_t)3333, entries);
+
+    free(key);
+    ts_hashtable_free(&table);
+}
+
+int main()
+{
+    RUN(test_hashtable_put_get);
+    RUN(test_hashtable_mixed_keys);
+
+    RUN(test_hashtable_remove_iter);
+
+    RUN(test_hashtable_incremental);
+
+    return TEST_REPORT();
+}
@@ -0,0 +1,135 @@
+#include "../tinytest/tinytest.h"
+#include "../include/3s/3s.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#define THREADS 4
+#define WORDS 1000
+
+// -- Helpers
+
+struct intern_job
+{
+    ts_intern_t *pool;
+    const char *handles[WORDS];
+};
+
+static void *intern_words(void *arg)
+{
+    struct intern_job *job = (struct intern_job *)arg;
+    char word[16];
+
+    for (int i = 0; i < WORDS; ++i)
+    {
+        snprintf(word, sizeof(word), "word%d", i);
+        job->handles[i] = ts_intern(job->pool, word);
+    }
+
+    return NULL;
+}
+
+// -- Testing arenas
+
+void test_arena_alloc(void)
+{
+    ts_arena_t *arena = ts_arena_new(256);
+
+    char *small = ts_arena_alloc(arena, 3);
+    char *next = ts_arena_alloc(arena, 5);
+    ASSERT_EQ((uintptr_t)0, (uintptr_t)small % TS_ARENA_ALIGNMENT);
+    ASSERT_EQ((uintptr_t)0, (uintptr_t)next % TS_ARENA_ALIGNMENT);
+    ASSERT_EQ(small + TS_ARENA_ALIGNMENT, next);
+
+    // large requests do not waste the current chunk
+    char *large = ts_arena_alloc(arena, 1000);
+    memset(large, 1, 1000);
+    ASSERT_EQ(next + TS_ARENA_ALIGNMENT, (char *)ts_arena_alloc(arena, 1));
+
+    ASSERT_STR_EQ("3s", ts_arena_strndup(arena, "3s lib", 2));
+
+    ts_arena_reset(arena);
+    ASSERT_EQ((size_t)0, arena->allocated);
+    ASSERT_EQ(small, (char *)ts_arena_alloc(arena, 3));
+
+    ts_arena_free(&arena);
+    ASSERT_EQ(NULL, arena);
+}
+
+// -- Testing interning
+
+void test_intern_canonical(void)
+{
+    ts_intern_t *pool = ts_intern_new(false);
+    char buffer[] = "three";
+
+    const char *interned = pool->intern(pool, "three");
+    ASSERT_EQ(interned, ts_intern(pool, buffer));
+    ASSERT_EQ(interned, ts_intern_n(pool, "threes", 5));
+    ASSERT_EQ(true, interned != ts_intern(pool, "four"));
+    ASSERT_EQ((size_t)2, ts_intern_count(pool));
+
+    ASSERT_EQ((size_t)5, ts_intern_length(interned));
+    ts_generic_t value = ts_intern_value(pool, "three");
+    ASSERT_EQ(ts_generic_t_hash(value), ts_intern_hash(interned));
+    ASSERT_EQ(interned, value->data.string);
+
+    ASSERT_EQ(NULL, ts_intern_lookup(pool, "five"));
+    ASSERT_EQ(interned, ts_intern_lookup(pool, "three"));
+
+    free(value);
+    ts_intern_free(&pool);
+    ASSERT_EQ(NULL, pool);
+}
+
+void test_intern_many(void)
+{
+    ts_intern_t *pool = ts_intern_new(true);
+    const char *words[] = {"a", "b", "a", "", "b"};
+    const char *handles[5];
+
+    ASSERT_EQ(true, ts_intern_many(pool, words, 5, handles));
+    ASSERT_EQ((size_t)3, ts_intern_count(pool));
+    ASSERT_EQ(handles[0], handles[2]);
+    ASSERT_EQ(handles[1], handles[4]);
+    ASSERT_STR_EQ("", handles[3]);
+
+    ts_intern_free(&pool);
+}
+
+void test_intern_threads(void)
+{
+    ts_intern_t *pool = ts_intern_new(true);
+    struct intern_job jobs[THREADS];
+    pthread_t threads[THREADS];
+
+    for (int i = 0; i < THREADS; ++i)
+    {
+        jobs[i].pool = pool;
+        pthread_create(&threads[i], NULL, &intern_words, &jobs[i]);
+    }
+
+    for (int i = 0; i < THREADS; ++i)
+        pthread_join(threads[i], NULL);
+
+    ASSERT_EQ((size_t)WORDS, ts_intern_count(pool));
+
+    for (int i = 1; i < THREADS; ++i)
+        ASSERT_EQ(0, memcmp(jobs[0].handles, jobs[i].handles, sizeof(jobs[0].handles)));
+
+    ts_intern_free(&pool);
+}
+
+int main()
+{
+    RUN(test_arena_alloc);
+
+    RUN(test_intern_canonical);
+    RUN(test_intern_many);
+    RUN(test_intern_threads);
+
+    return TEST_REPORT();
+}
@@ -0,0 +1,167 @@
+#include "../tinytest/tinytest.h"
+#include "../include/3s/3s.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// -- Helpers
+
+static bool is_even(ts_generic_t value, void *ctx)
+{
+    (void)ctx;
+    return value->data.integer % 2 == 0;
+}
+
+static ts_generic_t square(ts_generic_t value, struct ts_generic_t *out, void *ctx)
+{
+    (void)ctx;
+    out->type = TS_TYPE_INTEGER;
+    out->data.integer = value->data.integer * value->data.integer;
+    return out;
+}
+
+static ts_generic_t add(ts_generic_t first, ts_generic_t second, struct ts_generic_t *out, void *ctx)
+{
+    (void)ctx;
+    out->type = TS_TYPE_INTEGER;
+    out->data.integer = first->data.integer + second->data.integer;
+    return out;
+}
+
+static void sum(ts_generic_t value, void *ctx)
+{
+    *(int32_t *)ctx += value->data.integer;
+}
+
+static ts_list_t *new_int_list(int32_t length)
+{
+    ts_list_t *list = ts_new_list();
+
+    for (int32_t i = 0; i < length; ++i)
+        ts_list_append_back(list, ts_new_int(i));
+
+    return list;
+}
+
+// -- Testing sources
+
+void test_iter_sources(void)
+{
+    ts_list_t *list = new_int_list(5);
+    ts_stack_t *stack = ts_new_stack();
+    ts_queue_t *queue = ts_new_queue();
+    ts_tree_t *tree = ts_tree_new(TS_TREE_IGNORE);
+    ts_hashtable_t *table = ts_hashtable_new(TS_HASHTABLE_DEFAULT_LOAD, true);
+    const int32_t values[] = {3, 1, 4, 5, 9, 2, 6};
+    int32_t total = 0;
+
+    for (size_t i = 0; i < 7; ++i)
+    {
+        stack->push(stack, ts_new_int(values[i]));
+        queue->enqueue(queue, ts_new_int(values[i]));
+        tree->add(tree, ts_new_int(values[i]));
+        table->put(table, ts_new_int(values[i]), ts_new_int(10 * values[i]));
+    }
+
+    ts_iter_t iter = ts_iter_list(list);
+    ASSERT_EQ(0, ts_iter_next(&iter)->data.integer);
+    ASSERT_EQ((size_t)4, ts_iter_count(&iter));
+    ASSERT_EQ(true, ts_iter_next(&iter) == NULL);
+
+    // the top of the stack first, the front of the queue first
+    iter = ts_iter_stack(stack);
+    ASSERT_EQ(6, ts_iter_next(&iter)->data.integer);
+    iter = ts_iter_queue(queue);
+    ASSERT_EQ(3, ts_iter_next(&iter)->data.integer);
+    ASSERT_EQ(1, ts_iter_next(&iter)->data.integer);
+
+    iter = ts_iter_tree(tree);
+    for (int32_t previous = 0, i = 0; i < 7; ++i)
+    {
+        const int32_t value = ts_iter_next(&iter)->data.integer;
+        ASSERT_EQ(true, value > previous);
+        previous = value;
+    }
+    ASSERT_EQ(true, ts_iter_next(&iter) == NULL);
+
+    iter = ts_iter_values(table);
+    ASSERT_EQ((size_t)7, ts_iter_foreach(&iter, &sum, &total));
+    ASSERT_EQ(300, total);
+
+    iter = ts_iter_keys(table);
+    ASSERT_EQ((size_t)7, ts_iter_count(&iter));
+
+    ts_tree_t *empty = ts_tree_new(TS_TREE_IGNORE);
+    iter = ts_iter_tree(empty);
+    ASSERT_EQ((size_t)0, ts_iter_count(&iter));
+
+    ts_tree_free(&empty);
+    ts_hashtable_free(&table);
+    ts_tree_free(&tree);
+    ts_queue_free(&queue);
+    ts_stack_free(&stack);
+    ts_list_free(&list);
+}
+
+// -- Testing adapters
+
+void test_iter_pipeline(void)
+{
+    ts_list_t *list = new_int_list(100);
+
+    // the squares of the even values from 10, five of them
+    ts_iter_t values = ts_iter_list(list);
+    ts_iter_t skipped = ts_iter_skip(&values, 10);
+    ts_iter_t evens = ts_iter_filter(&skipped, &is_even, NULL);
+    ts_iter_t squares = ts_iter_map(&evens, &square, NULL);
+    ts_iter_t taken = ts_iter_take(&squares, 5);
+
+    ts_list_t *collected = ts_iter_collect(&taken);
+    char *repr = ts_list_repr(collected);
+    ASSERT_STR_EQ("[100, 144, 196, 256, 324]", repr);
+    free(repr);
+
+    // the list was only pulled up to the last value taken
+    ASSERT_EQ(100u, list->length);
+    ASSERT_EQ(19, ts_iter_next(&values)->data.integer);
+
+    ts_list_free(&collected);
+    ts_list_free(&list);
+}
+
+void test_iter_zip(void)
+{
+    ts_list_t *list = new_int_list(10);
+    ts_queue_t *queue = ts_new_queue();
+
+    for (int32_t i = 0; i < 3; ++i)
+        queue->enqueue(queue, ts_new_int(100 * i));
+
+    // stops with the shortest
+    ts_iter_t first = ts_iter_list(list);
+    ts_iter_t second = ts_iter_queue(queue);
+    ts_iter_t zipped = ts_iter_zip(&first, &second, &add, NULL);
+    int32_t total = 0;
+
+    ASSERT_EQ((size_t)3, ts_iter_foreach(&zipped, &sum, &total));
+    ASSERT_EQ(303, total);
+
+    // skipping past the end
+    ts_iter_t values = ts_iter_list(list);
+    ts_iter_t skipped = ts_iter_skip(&values, 20);
+    ASSERT_EQ((size_t)0, ts_iter_count(&skipped));
+
+    ts_queue_free(&queue);
+    ts_list_free(&list);
+}
+
+int main()
+{
+    RUN(test_iter_sources);
+
+    RUN(test_iter_pipeline);
+    RUN(test_iter_zip);
+
+    return TEST_REPORT();
+}
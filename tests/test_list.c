@@ -0,0 +1,121 @@
+#include "../tinytest/tinytest.h"
+#include "../include/3s/3s.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// -- Helpers
+
+static void add_sums(void *result, const void *other, void *ctx)
+{
+    (void)ctx;
+    *(uint64_t *)result += *(const uint64_t *)other;
+}
+
+static ts_generic_t double_int(ts_generic_t value, void *ctx)
+{
+    (void)ctx;
+    if (value->data.integer % 2 == 0)
+        return ts_new_int(2 * value->data.integer);
+    value->data.integer *= 2;
+    return value;
+}
+
+static bool multiple_of(ts_generic_t value, void *ctx)
+{
+    return value->data.integer % *(int32_t *)ctx == 0;
+}
+
+static void sum_value(ts_generic_t value, void *result, void *ctx)
+{
+    (void)ctx;
+    *(uint64_t *)result += (uint64_t)value->data.integer;
+}
+
+static ts_list_t *new_int_list(int32_t length)
+{
+    ts_list_t *list = ts_new_list();
+
+    for (int32_t i = 0; i < length; ++i)
+        ts_list_append_back(list, ts_new_int(i));
+
+    return list;
+}
+
+/* Checks the links of the list both ways against its length. */
+static bool linked(ts_list_t *list)
+{
+    size_t forward = 0, backward = 0;
+
+    for (struct ts_linked_node *node = list->head; node != NULL; node = node->next)
+        forward += node->next != NULL ? node->next->prev == node : node == list->tail;
+    for (struct ts_linked_node *node = list->tail; node != NULL; node = node->prev)
+        backward++;
+
+    return forward == list->length && backward == list->length;
+}
+
+// -- Testing list bulk operations
+
+void test_list_map_reduce(void)
+{
+    ts_pool_t *pool = ts_pool_new(4);
+    ts_list_t *list = new_int_list(100000);
+    uint64_t sum = 0;
+
+    // some values are replaced, others changed in place
+    ts_list_map(list, pool, &double_int, NULL);
+    ASSERT_EQ(19998, ts_list_get_value(list, 9999)->data.integer);
+
+    ts_list_reduce(list, pool, &sum, sizeof(sum), &sum_value, &add_sums, NULL);
+    ASSERT_EQ((uint64_t)99999 * 100000, sum);
+
+    // without a pool, on the calling thread
+    sum = 0;
+    ts_list_reduce(list, NULL, &sum, sizeof(sum), &sum_value, &add_sums, NULL);
+    ASSERT_EQ((uint64_t)99999 * 100000, sum);
+
+    ts_list_free(&list);
+    ts_pool_free(&pool);
+}
+
+void test_list_filter(void)
+{
+    ts_pool_t *pool = ts_pool_new(3);
+    ts_list_t *list = new_int_list(50000);
+    struct ts_linked_node *kept = list->head->next->next->next;
+    int32_t three = 3, none = 7 * 50000;
+
+    ts_list_filter(list, pool, &multiple_of, &three);
+    ASSERT_EQ(16667u, list->length);
+    ASSERT_EQ(true, linked(list));
+    ASSERT_EQ(49998, list->tail->value->data.integer);
+
+    // the nodes kept are the same
+    ASSERT_EQ(true, kept == list->head->next);
+
+    ASSERT_EQ(3, kept->value->data.integer);
+    ASSERT_EQ(6, kept->next->value->data.integer);
+
+    ts_list_filter(list, pool, &multiple_of, &none);
+    ASSERT_EQ(1u, list->length);
+    ASSERT_EQ(true, linked(list));
+
+    ts_list_free(&list);
+
+    list = new_int_list(10);
+    ts_list_filter(list, NULL, &multiple_of, &none);
+    ASSERT_EQ(1u, list->length);
+    ASSERT_EQ(true, list->head == list->tail);
+
+    ts_list_free(&list);
+    ts_pool_free(&pool);
+}
+
+int main()
+{
+    RUN(test_list_map_reduce);
+    RUN(test_list_filter);
+
+    return TEST_REPORT();
+}
@@ -0,0 +1,161 @@
+#include "../tinytest/tinytest.h"
+#include "../include/3s/3s.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// -- Helpers
+
+static void put_int(ts_lru_t *lru, int32_t key)
+{
+    lru->put(lru, ts_new_int(key), ts_new_int(key * 10));
+}
+
+static bool cached(ts_lru_t *lru, int32_t key)
+{
+    ts_generic_t value = ts_new_int(key);
+    bool found = ts_lru_peek(lru, value) != NULL;
+
+    free(value);
+    return found;
+}
+
+static int32_t get_int(ts_lru_t *lru, int32_t key)
+{
+    ts_generic_t value = ts_new_int(key);
+    ts_generic_t found = lru->get(lru, value);
+
+    free(value);
+    return found != NULL ? found->data.integer : -1;
+}
+
+static void count_evictions(ts_generic_t key, ts_generic_t value, void *ctx)
+{
+    (void)value;
+    *(int32_t *)ctx += key->data.integer;
+}
+
+// -- Testing plain caches
+
+void test_lru_eviction(void)
+{
+    ts_lru_t *lru = ts_lru_new(3, NULL, false);
+    int32_t evicted = 0;
+
+    ts_lru_on_evict(lru, &count_evictions, &evicted);
+
+    put_int(lru, 1);
+    put_int(lru, 2);
+    put_int(lru, 3);
+    ASSERT_EQ(10, get_int(lru, 1));
+
+    // 2 is now the least recently used
+    put_int(lru, 4);
+    ASSERT_EQ(false, cached(lru, 2));
+    ASSERT_EQ(true, cached(lru, 1));
+    ASSERT_EQ(2, evicted);
+    ASSERT_EQ((size_t)3, ts_lru_length(lru));
+
+    // replacing a value uses the entry
+    ASSERT_EQ(false, lru->put(lru, ts_new_int(3), ts_new_int(33)));
+    put_int(lru, 5);
+    ASSERT_EQ(false, cached(lru, 1));
+    ASSERT_EQ(33, get_int(lru, 3));
+
+    ts_generic_t key = ts_new_int(3);
+    ASSERT_EQ(true, lru->remove(lru, key));
+    ASSERT_EQ(false, lru->remove(lru, key));
+    ASSERT_EQ(3, evicted);
+    free(key);
+
+    ts_lru_free(&lru);
+    ASSERT_EQ(NULL, lru);
+}
+
+void test_lru_bytes(void)
+{
+    const size_t entry = 2 * sizeof(struct ts_generic_t);
+    ts_lru_t *lru = ts_lru_new(3 * entry, &ts_lru_weigh_bytes, false);
+
+    lru->put(lru, ts_new_int(1), ts_new_int(1));
+    lru->put(lru, ts_new_int(2), ts_new_int(2));
+    ASSERT_EQ(2 * entry, ts_lru_weight(lru));
+
+    // the string takes the room of both
+    char text[512] = {0};
+    memset(text, 'x', 2 * entry);
+    lru->put(lru, ts_new_int(3), ts_new_owned_string(text));
+    ASSERT_EQ(3 * entry + 1, ts_lru_weight(lru));
+    ASSERT_EQ((size_t)1, ts_lru_length(lru));
+    ASSERT_EQ(true, cached(lru, 3));
+
+    ts_lru_free(&lru);
+}
+
+// -- Testing segmented caches
+
+void test_lru_scan_resistance(void)
+{
+    ts_lru_t *plain = ts_lru_new(10, NULL, false);
+    ts_lru_t *segmented = ts_lru_new(10, NULL, true);
+
+    for (int32_t i = 0; i < 5; ++i)
+    {
+        put_int(plain, i);
+        put_int(segmented, i);
+        get_int(plain, i);
+        get_int(segmented, i);
+    }
+
+    // a scan of values used once
+    for (int32_t i = 100; i < 200; ++i)
+    {
+        put_int(plain, i);
+        put_int(segmented, i);
+    }
+
+    for (int32_t i = 0; i < 5; ++i)
+    {
+        ASSERT_EQ(false, cached(plain, i));
+        ASSERT_EQ(true, cached(segmented, i));
+    }
+
+    ASSERT_EQ((size_t)10, ts_lru_length(segmented));
+    ASSERT_EQ((size_t)5, segmented->segments[TS_LRU_PROTECTED].length);
+
+    ts_lru_free(&plain);
+    ts_lru_free(&segmented);
+}
+
+void test_lru_protected_share(void)
+{
+    ts_lru_t *lru = ts_lru_new(10, NULL, true);
+
+    for (int32_t i = 0; i < 10; ++i)
+    {
+        put_int(lru, i);
+        get_int(lru, i);
+    }
+
+    // the oldest protected entries went back on probation
+    ASSERT_EQ((size_t)8, lru->segments[TS_LRU_PROTECTED].length);
+    ASSERT_EQ((size_t)2, lru->segments[TS_LRU_PROBATION].length);
+
+    put_int(lru, 10);
+    ASSERT_EQ(false, cached(lru, 0));
+    ASSERT_EQ(true, cached(lru, 9));
+
+    ts_lru_free(&lru);
+}
+
+int main()
+{
+    RUN(test_lru_eviction);
+    RUN(test_lru_bytes);
+
+    RUN(test_lru_scan_resistance);
+    RUN(test_lru_protected_share);
+
+    return TEST_REPORT();
+}
@@ -0,0 +1,150 @@
+#include "../tinytest/tinytest.h"
+#include "../include/3s/3s.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// -- Helpers
+
+static void square(size_t begin, size_t end, void *ctx)
+{
+    uint64_t *squares = (uint64_t *)ctx;
+
+    for (size_t i = begin; i < end; ++i)
+        squares[i] = (uint64_t)i * i;
+}
+
+static void sum_indexes(size_t begin, size_t end, void *result, void *ctx)
+{
+    (void)ctx;
+    for (size_t i = begin; i < end; ++i)
+        *(uint64_t *)result += i;
+}
+
+static void add_sums(void *result, const void *other, void *ctx)
+{
+    (void)ctx;
+    *(uint64_t *)result += *(const uint64_t *)other;
+}
+
+static void sum_inverses(size_t begin, size_t end, void *result, void *ctx)
+{
+    (void)ctx;
+    for (size_t i = begin; i < end; ++i)
+        *(double *)result += 1.0 / (double)(i + 1);
+}
+
+static void add_reals(void *result, const void *other, void *ctx)
+{
+    (void)ctx;
+    *(double *)result += *(const double *)other;
+}
+
+/* Keeps the order in which the parts are joined. */
+static void concat_parts(size_t begin, size_t end, void *result, void *ctx)
+{
+    (void)ctx;
+    char *chars = (char *)result;
+    for (size_t i = begin; i < end; ++i)
+        chars[strlen(chars)] = (char)('a' + i);
+}
+
+static void concat(void *result, const void *other, void *ctx)
+{
+    (void)ctx;
+    strcat((char *)result, (const char *)other);
+}
+
+/* Runs a parallel for inside each part of another one. */
+static void nested_rows(size_t begin, size_t end, void *ctx)
+{
+    ts_pool_t *pool = ((ts_pool_t **)ctx)[0];
+    uint64_t *squares = ((uint64_t **)ctx)[1];
+
+    for (size_t row = begin; row < end; ++row)
+        pool->parallel_for(pool, 0, 100, 7, &square, squares + row * 100);
+}
+
+// -- Testing pools
+
+void test_pool_parallel_for(void)
+{
+    ts_pool_t *pool = ts_pool_new(4);
+    uint64_t *squares = calloc(100000, sizeof(uint64_t));
+
+    ASSERT_EQ((size_t)4, ts_pool_threads(pool));
+
+    pool->parallel_for(pool, 0, 100000, 64, &square, squares);
+    for (size_t i = 0; i < 100000; i += 997)
+        ASSERT_EQ((uint64_t)i * i, squares[i]);
+    ASSERT_EQ((uint64_t)99999 * 99999, squares[99999]);
+
+    // an empty range does nothing, a zero grain is a grain of one
+    pool->parallel_for(pool, 10, 10, 64, &square, NULL);
+    pool->parallel_for(pool, 0, 3, 0, &square, squares);
+
+    ts_pool_free(&pool);
+    ASSERT_EQ(true, pool == NULL);
+    free(squares);
+}
+
+void test_pool_nested(void)
+{
+    ts_pool_t *pool = ts_pool_new(3);
+    uint64_t *squares = calloc(100 * 100, sizeof(uint64_t));
+    void *ctx[] = {pool, squares};
+
+    pool->parallel_for(pool, 0, 100, 1, &nested_rows, ctx);
+    ASSERT_EQ((uint64_t)99 * 99, squares[99 * 100 + 99]);
+    ASSERT_EQ((uint64_t)42 * 42, squares[7 * 100 + 42]);
+
+    ts_pool_free(&pool);
+    free(squares);
+}
+
+void test_pool_parallel_reduce(void)
+{
+    ts_pool_t *pool = ts_pool_new(4);
+    uint64_t sum = 0;
+
+    pool->parallel_reduce(pool, 0, 1000000, 1000, &sum, sizeof(sum), &sum_indexes, &add_sums, NULL);
+    ASSERT_EQ((uint64_t)999999 * 1000000 / 2, sum);
+
+    // the identity is what the result holds on call
+    sum = 5;
+    pool->parallel_reduce(pool, 0, 0, 1000, &sum, sizeof(sum), &sum_indexes, &add_sums, NULL);
+    ASSERT_EQ((uint64_t)5, sum);
+
+    // parts are joined from left to right
+    char chars[27] = {0};
+    pool->parallel_reduce(pool, 0, 26, 3, chars, sizeof(chars), &concat_parts, &concat, NULL);
+    ASSERT_STR_EQ("abcdefghijklmnopqrstuvwxyz", chars);
+
+    ts_pool_free(&pool);
+}
+
+void test_pool_deterministic(void)
+{
+    ts_pool_t *single = ts_pool_new(1);
+    ts_pool_t *many = ts_pool_new(5);
+    double sum_single = 0, sum_many = 0;
+
+    // the same parts joined the same way, so the same rounding
+    single->parallel_reduce(single, 0, 1000000, 777, &sum_single, sizeof(double), &sum_inverses, &add_reals, NULL);
+    many->parallel_reduce(many, 0, 1000000, 777, &sum_many, sizeof(double), &sum_inverses, &add_reals, NULL);
+    ASSERT_EQ(0, memcmp(&sum_single, &sum_many, sizeof(double)));
+
+    ts_pool_free(&many);
+    ts_pool_free(&single);
+}
+
+int main()
+{
+    RUN(test_pool_parallel_for);
+    RUN(test_pool_nested);
+    RUN(test_pool_parallel_reduce);
+    RUN(test_pool_deterministic);
+
+    return TEST_REPORT();
+}
@@ -0,0 +1,135 @@
+#include "../tinytest/tinytest.h"
+#include "../include/3s/3s.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// -- Helpers
+
+/* Returns true if the snapshot holds, in order, the integers from first
+ * to last (exclusive) going by step, and nothing else.
+ * */
+static bool holds_range(ts_ptree_snapshot_t *snapshot, int32_t first, int32_t last, int32_t step)
+{
+    ts_ptree_iter_t iter = ts_ptree_iter(snapshot);
+    ts_generic_t value = NULL;
+    int32_t expected = first;
+
+    while ((value = iter.next(&iter)) != NULL)
+    {
+        if (expected >= last || value->data.integer != expected)
+            return false;
+        expected += step;
+    }
+
+    return expected >= last;
+}
+
+// -- Testing changes
+
+void test_ptree_add_remove(void)
+{
+    ts_ptree_t *tree = ts_ptree_new();
+    ts_generic_t key = ts_new_int(3);
+
+    for (int32_t i = 9; i >= 0; --i)
+        ASSERT_EQ(true, tree->add(tree, ts_new_int(i)));
+
+    ASSERT_EQ(false, tree->add(tree, ts_new_int(3)));
+    ASSERT_EQ(false, tree->add(tree, ts_new_float64(3.0)));
+    ASSERT_EQ((size_t)10, tree->current->length);
+
+    ASSERT_EQ(true, tree->remove(tree, key));
+    ASSERT_EQ(false, tree->remove(tree, key));
+    ASSERT_EQ((size_t)9, tree->current->length);
+
+    ASSERT_EQ(true, tree->add(tree, ts_new_string("three")));
+    ASSERT_EQ((size_t)10, tree->current->length);
+
+    ts_ptree_snapshot_t *snapshot = tree->snapshot(tree);
+    ASSERT_EQ(true, ts_ptree_snapshot_find(snapshot, key) == NULL);
+    key->data.integer = 4;
+    ASSERT_EQ(4, ts_ptree_snapshot_find(snapshot, key)->data.integer);
+    ts_ptree_snapshot_release(&snapshot);
+    ASSERT_EQ(true, snapshot == NULL);
+
+    free(key);
+    ts_ptree_free(&tree);
+    ASSERT_EQ(true, tree == NULL);
+}
+
+// -- Testing snapshots
+
+void test_ptree_snapshot_versions(void)
+{
+    ts_ptree_t *tree = ts_ptree_new();
+    struct ts_generic_t key = {.type = TS_TYPE_INTEGER};
+
+    for (int32_t i = 0; i < 100; ++i)
+        tree->add(tree, ts_new_int(i));
+
+    ts_ptree_snapshot_t *before = tree->snapshot(tree);
+
+    for (key.data.integer = 0; key.data.integer < 100; key.data.integer += 2)
+        ASSERT_EQ(true, tree->remove(tree, &key));
+    for (int32_t i = 101; i < 200; i += 2)
+        ASSERT_EQ(true, tree->add(tree, ts_new_int(i)));
+
+    ts_ptree_snapshot_t *after = tree->snapshot(tree);
+
+    /* The older snapshot is not changed by the later adds and removes. */
+    ASSERT_EQ((size_t)100, before->length);
+    ASSERT_EQ(true, holds_range(before, 0, 100, 1));
+    ASSERT_EQ((size_t)100, after->length);
+    ASSERT_EQ(true, holds_range(after, 1, 200, 2));
+
+    key.data.integer = 50;
+    ASSERT_EQ(50, ts_ptree_snapshot_find(before, &key)->data.integer);
+    ASSERT_EQ(true, ts_ptree_snapshot_find(after, &key) == NULL);
+
+    ts_ptree_snapshot_release(&before);
+    ts_ptree_snapshot_release(&after);
+    ts_ptree_free(&tree);
+}
+
+void test_ptree_snapshot_release(void)
+{
+    ts_ptree_t *tree = ts_ptree_new();
+    ts_generic_t key = ts_new_int(0);
+
+    for (int32_t i = 0; i < 15; ++i)
+        tree->add(tree, ts_new_int(i));
+
+    ts_ptree_snapshot_t *before = tree->snapshot(tree);
+    struct ts_ptree_node *shared = before->root->right;
+
+    /* Removing from the left copies that path only. */
+    tree->remove(tree, key);
+    ASSERT_EQ(shared, tree->current->root->right);
+    ASSERT_EQ((size_t)2, atomic_load(&shared->refs));
+    ASSERT_EQ((size_t)2, atomic_load(&before->root->value->refs));
+
+    ts_ptree_snapshot_release(&before);
+    ASSERT_EQ((size_t)1, atomic_load(&shared->refs));
+    ASSERT_EQ((size_t)1, atomic_load(&tree->current->root->value->refs));
+
+    /* Snapshots outlive the tree, and the last release frees the nodes
+     * and values left, which the leak checker verifies.
+     * */
+    ts_ptree_snapshot_t *last = tree->snapshot(tree);
+    ts_ptree_free(&tree);
+    ASSERT_EQ((size_t)14, last->length);
+    ASSERT_EQ(true, holds_range(last, 1, 15, 1));
+    ts_ptree_snapshot_release(&last);
+
+    free(key);
+}
+
+int main()
+{
+    RUN(test_ptree_add_remove);
+    RUN(test_ptree_snapshot_versions);
+    RUN(test_ptree_snapshot_release);
+
+    return TEST_REPORT();
+}
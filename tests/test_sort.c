@@ -0,0 +1,263 @@
+#include "../tinytest/tinytest.h"
+#include "../include/3s/3s.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// -- Helpers
+
+static void free_values(ts_generic_t *values, size_t length)
+{
+    for (size_t i = 0; i < length; ++i)
+        ts_generic_t_free(values[i]);
+}
+
+static bool sorted(ts_generic_t *values, size_t length)
+{
+    for (size_t i = 1; i < length; ++i)
+        if (ts_generic_t_class_cmp(values[i - 1], values[i]) == TS_GREATER)
+            return false;
+    return true;
+}
+
+/* Makes a value of any class from the random number. */
+static ts_generic_t random_value(uint32_t r)
+{
+    char chars[8];
+    const size_t length = r / 16 % 8;
+
+    for (size_t i = 0; i < length; ++i)
+        chars[i] = "ab\0z"[(r >> (2 * i + 7)) % 4];
+
+    switch (r % 16)
+    {
+    case 0:
+    case 1:
+        return ts_new_int((int32_t)(r >> 4) % 100 - 50);
+    case 2:
+        return ts_new_uint(r >> 20);
+    case 3:
+        return ts_new_float64((double)((int32_t)(r >> 4) % 200 - 100) / 4);
+    case 4:
+        return ts_new_float32((float)(r >> 12) / 8);
+    case 5:
+        return ts_new_int64(-(int64_t)(r >> 4) * 1000000007);
+    case 6:
+        return ts_new_uint64((uint64_t)r << 32);
+    case 7:
+        return ts_new_float64(r % 64 == 7 ? NAN : -0.0);
+    case 8:
+    case 9:
+        return ts_new_owned_string_n(chars, length);
+    case 10:
+        return ts_new_char(chars[0]);
+    case 11:
+        return ts_new_bytes(chars, length);
+    case 12:
+        return ts_new_bool(r & 32);
+    case 13:
+        return ts_new_pointer((void *)(uintptr_t)(r >> 8));
+    default:
+        return ts_new_none();
+    }
+}
+
+// -- Testing sorting
+
+void test_sort_small(void)
+{
+    ts_generic_t values[] = {
+        ts_new_owned_string("b"),
+        ts_new_int(3),
+        ts_new_none(),
+        ts_new_float64(-1.5),
+        ts_new_owned_string("a"),
+        ts_new_bool(true),
+    };
+
+    ASSERT_EQ(true, ts_sort_values(values, 6));
+    ASSERT_EQ(TS_TYPE_NONE, values[0]->type);
+    ASSERT_EQ(-1.5, values[1]->data.float64);
+    ASSERT_EQ(3, values[2]->data.integer);
+    ASSERT_STR_EQ("a", ts_generic_t_chars(values[3]));
+    ASSERT_STR_EQ("b", ts_generic_t_chars(values[4]));
+    ASSERT_EQ(TS_TYPE_BOOL, values[5]->type);
+
+    ASSERT_EQ(true, ts_sort_values(values, 0));
+
+    free_values(values, 6);
+}
+
+void test_sort_numbers(void)
+{
+    enum { LENGTH = 1000 };
+    ts_generic_t values[LENGTH];
+
+    // the same numbers of different types, in reverse
+    for (size_t i = 0; i < LENGTH; ++i)
+    {
+        const int32_t number = (int32_t)(LENGTH - 1 - i) / 2 - 200;
+
+        if (i % 2 == 0)
+            values[i] = ts_new_int64(number);
+        else
+            values[i] = ts_new_float64(number);
+    }
+
+    ASSERT_EQ(true, ts_sort_values(values, LENGTH));
+    ASSERT_EQ(true, sorted(values, LENGTH));
+
+    // equal numbers keep their order, the integer first here
+    for (size_t i = 0; i + 1 < LENGTH; i += 2)
+    {
+        ASSERT_EQ(TS_TYPE_INT64, values[i]->type);
+        ASSERT_EQ(TS_TYPE_FLOAT64, values[i + 1]->type);
+    }
+
+    free_values(values, LENGTH);
+}
+
+void test_sort_strings(void)
+{
+    enum { LENGTH = 500 };
+    ts_generic_t values[LENGTH];
+    char chars[64];
+
+    // long common prefixes, and prefixes of each other
+    for (size_t i = 0; i < LENGTH; ++i)
+    {
+        memset(chars, 'x', sizeof(chars));
+        const size_t length = 40 + (i * 7919) % 20;
+        values[i] = ts_new_owned_string_n(chars, length);
+    }
+
+    ASSERT_EQ(true, ts_sort_values(values, LENGTH));
+    ASSERT_EQ(true, sorted(values, LENGTH));
+    ASSERT_EQ((size_t)40, ts_generic_t_length(values[0]));
+    ASSERT_EQ((size_t)59, ts_generic_t_length(values[LENGTH - 1]));
+
+    free_values(values, LENGTH);
+}
+
+void test_sort_mixed(void)
+{
+    enum { LENGTH = 5000 };
+    ts_generic_t *values = malloc(LENGTH * sizeof(ts_generic_t));
+    ts_generic_t *expected = malloc(LENGTH * sizeof(ts_generic_t));
+    uint32_t r = 12345;
+
+    for (size_t i = 0; i < LENGTH; ++i)
+    {
+        r = r * 1103515245 + 12345;
+        values[i] = random_value(r);
+    }
+    memcpy(expected, values, LENGTH * sizeof(ts_generic_t));
+
+    // both sorts are stable, so they put the same values in the same places
+    ASSERT_EQ(true, ts_sort_values(values, LENGTH));
+    ASSERT_EQ(true, ts_sort_values_merge(expected, LENGTH));
+    ASSERT_EQ(true, sorted(values, LENGTH));
+    ASSERT_EQ(0, memcmp(expected, values, LENGTH * sizeof(ts_generic_t)));
+
+    free_values(values, LENGTH);
+    free(expected);
+    free(values);
+}
+
+void test_sort_high_characters(void)
+{
+    enum { LENGTH = 200 };
+    ts_generic_t values[LENGTH], expected[LENGTH];
+    const char *strings[] = {"\xe9", "a", "\xe9a", "a\xe9", "\x80", "\x7f"};
+
+    // characters and strings of both signs of char, borrowed and owned
+    for (size_t i = 0; i < LENGTH; ++i)
+    {
+        const char *chars = strings[(i * 7) % 6];
+
+        if (i % 3 == 0)
+            values[i] = ts_new_char(chars[0]);
+        else if (i % 3 == 1)
+            values[i] = ts_new_string((char *)chars);
+        else
+            values[i] = ts_new_owned_string(chars);
+    }
+    memcpy(expected, values, sizeof(values));
+
+    ASSERT_EQ(true, ts_sort_values(values, LENGTH));
+    ASSERT_EQ(true, ts_sort_values_merge(expected, LENGTH));
+    ASSERT_EQ(true, sorted(values, LENGTH));
+    ASSERT_EQ(0, memcmp(expected, values, sizeof(values)));
+    ASSERT_STR_EQ("a", ts_generic_t_chars(values[0]));
+
+    free_values(values, LENGTH);
+}
+
+void test_sort_parallel(void)
+{
+    const size_t length = 4 * TS_SORT_PARALLEL_THRESHOLD;
+    ts_generic_t *values = malloc(length * sizeof(ts_generic_t));
+    ts_generic_t *expected = malloc(length * sizeof(ts_generic_t));
+    uint32_t r = 54321;
+
+    for (size_t i = 0; i < length; ++i)
+    {
+        r = r * 1103515245 + 12345;
+        values[i] = random_value(r);
+    }
+    memcpy(expected, values, length * sizeof(ts_generic_t));
+    ASSERT_EQ(true, ts_sort_values(expected, length));
+
+    // stable, so the same as the sequential sort
+    ts_pool_t *pool = ts_pool_new(4);
+    ASSERT_EQ(true, ts_sort_values_parallel(pool, values, length, true));
+    ASSERT_EQ(0, memcmp(expected, values, length * sizeof(ts_generic_t)));
+
+    // not stable, so only the order is checked
+    for (size_t i = 0; i < length; ++i)
+        values[i] = expected[length - 1 - i];
+    ASSERT_EQ(true, ts_sort_values_parallel(pool, values, length, false));
+    ASSERT_EQ(true, sorted(values, length));
+
+    ts_pool_free(&pool);
+    free_values(values, length);
+    free(expected);
+    free(values);
+}
+
+void test_sort_parallel_duplicates(void)
+{
+    const size_t length = 3 * TS_SORT_PARALLEL_THRESHOLD;
+    ts_generic_t *values = malloc(length * sizeof(ts_generic_t));
+
+    // mostly one value, so most splitters are equal
+    for (size_t i = 0; i < length; ++i)
+        values[i] = ts_new_int(i % 100 == 0 ? (int32_t)(length - i) : 7);
+
+    ts_pool_t *pool = ts_pool_new(3);
+    ASSERT_EQ(true, ts_sort_values_parallel(pool, values, length, false));
+    ASSERT_EQ(true, sorted(values, length));
+
+    // fewer values than the threshold run on the calling thread
+    ASSERT_EQ(true, ts_sort_values_parallel(pool, values, 100, true));
+
+    ts_pool_free(&pool);
+    free_values(values, length);
+    free(values);
+}
+
+int main()
+{
+    RUN(test_sort_small);
+    RUN(test_sort_numbers);
+    RUN(test_sort_strings);
+    RUN(test_sort_mixed);
+    RUN(test_sort_high_characters);
+
+    RUN(test_sort_parallel);
+    RUN(test_sort_parallel_duplicates);
+
+    return TEST_REPORT();
+}
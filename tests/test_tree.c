@@ -0,0 +1,582 @@
+#include "../tinytest/tinytest.h"
+#include "../include/3s/3s.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// -- Helpers
+
+static void sum_visit(ts_generic_t value, void *ctx)
+{
+    *(int32_t *)ctx += value->data.integer;
+}
+
+/* Returns the depth of the most deep node of the subtree, checking the
+ * stored depths on the way. Returns -1 when one of them is wrong.
+ * */
+static int tree_check_depths(struct ts_tree_node *node, size_t depth)
+{
+    if (node == NULL)
+        return (int)depth - 1;
+    if (node->depth != depth)
+        return -1;
+
+    const int left = tree_check_depths(node->left, depth + 1);
+    const int right = tree_check_depths(node->right, depth + 1);
+
+    if (left < 0 || right < 0)
+        return -1;
+    return left > right ? left : right;
+}
+
+/* Returns true if the stored depths and the full depth of the tree are right. */
+static bool tree_depths_hold(ts_tree_t *tree)
+{
+    if (tree->root == NULL)
+        return tree->full_depth == 0;
+    return tree_check_depths(tree->root, 0) == (int)tree->full_depth;
+}
+
+/* Returns the height of the index subtree, checking its links, heights,
+ * balance and order on the way. Returns -1 when one of them is wrong.
+ * */
+static int itree_check(ts_itree_t *tree, uint32_t index, uint32_t parent)
+{
+    if (index == TS_ITREE_NIL)
+        return 0;
+
+    struct ts_itree_node *node = &tree->nodes[index];
+
+    if (index >= tree->length || node->parent != parent)
+        return -1;
+
+    const int left = itree_check(tree, node->left, index);
+    const int right = itree_check(tree, node->right, index);
+
+    if (left < 0 || right < 0 || left - right > 1 || right - left > 1)
+        return -1;
+    if (node->height != (left > right ? left : right) + 1)
+        return -1;
+
+    return node->height;
+}
+
+/* Returns true if the in order walk of the index tree gives the integers
+ * whose flag is set, and the tree is well formed.
+ * */
+static bool itree_holds(ts_itree_t *tree, const bool *present, int32_t length)
+{
+    uint32_t index = ts_itree_first(tree);
+    size_t count = 0;
+
+    if (itree_check(tree, tree->root, TS_ITREE_NIL) < 0)
+        return false;
+
+    for (int32_t i = 0; i < length; ++i)
+    {
+        if (!present[i])
+            continue;
+        if (index == TS_ITREE_NIL || ts_itree_value_at(tree, index).data.integer != i)
+            return false;
+        index = ts_itree_next(tree, index);
+        count += 1;
+    }
+
+    return index == TS_ITREE_NIL && count == tree->length;
+}
+
+// -- Testing insertion
+
+void test_tree_add_depth(void)
+{
+    ts_tree_t *tree = ts_tree_new(TS_TREE_IGNORE);
+
+    ASSERT_EQ(0, tree->add(tree, ts_new_int(5)));
+    ASSERT_EQ(1, tree->add(tree, ts_new_int(3)));
+    ASSERT_EQ(1, tree->add(tree, ts_new_int(8)));
+    ASSERT_EQ(2, tree->add(tree, ts_new_int(4)));
+    ASSERT_EQ(TS_TREE_VALUE_NOT_ADDED, tree->add(tree, ts_new_int(4)));
+    ASSERT_EQ((size_t)4, tree->size);
+    ASSERT_EQ((size_t)2, tree->full_depth);
+
+    ts_tree_free(&tree);
+}
+
+void test_tree_add_deep(void)
+{
+    ts_tree_t *tree = ts_tree_new(TS_TREE_APPEND_RIGHT);
+
+    /* Sorted input degenerates into a list, which must not overflow the stack. */
+    for (int32_t i = 0; i < 10000; ++i)
+        tree->add(tree, ts_new_int(i));
+
+    ASSERT_EQ((size_t)9999, tree->full_depth);
+    ts_tree_free(&tree);
+    ASSERT_EQ(NULL, tree);
+}
+
+void test_tree_side_tree(void)
+{
+    ts_tree_t *tree = ts_tree_new(TS_TREE_IGNORE);
+
+    tree->add(tree, ts_new_int(1));
+    ASSERT_EQ(0, tree->add(tree, ts_new_string("one")));
+    ASSERT_EQ(0, tree->search(tree, ts_new_string("one")));
+    ASSERT_EQ(TS_TYPE_STRING, tree->next->type_of_value);
+
+    ts_tree_free(&tree);
+}
+
+// -- Testing removal and balancing
+
+void test_tree_remove(void)
+{
+    ts_tree_t *tree = ts_tree_new(TS_TREE_APPEND_RIGHT);
+    ts_generic_t value = ts_new_int(3);
+
+    tree->add(tree, ts_new_int(3));
+    tree->add(tree, ts_new_int(1));
+    tree->add(tree, ts_new_int(3));
+    tree->add(tree, ts_new_int(5));
+
+    tree->remove(tree, value);
+    ASSERT_EQ(TS_TREE_VALUE_NOT_ADDED, tree->search(tree, value));
+    ASSERT_EQ((size_t)2, tree->size);
+    ASSERT_STR_EQ("{1, 5}", tree->repr(tree, TS_TREE_IN_ORDER));
+
+    free(value);
+    ts_tree_free(&tree);
+}
+
+void test_tree_remove_stored(void)
+{
+    ts_tree_t *tree = ts_tree_new(TS_TREE_APPEND_RIGHT);
+    int32_t values[] = {3, 1, 3, 5, 4, 3};
+
+    for (int i = 0; i < 6; ++i)
+        tree->add(tree, ts_new_int(values[i]));
+
+    /* The root holds the first 3, the repetitions still have to be found. */
+    tree->remove(tree, tree->root->value);
+    ASSERT_EQ((size_t)3, tree->size);
+    ASSERT_STR_EQ("{1, 4, 5}", tree->repr(tree, TS_TREE_IN_ORDER));
+
+    ts_tree_cursor_t cursor = ts_tree_cursor(tree);
+    ASSERT_EQ(true, cursor.next(&cursor));
+    tree->remove(tree, cursor.value(&cursor));
+    ASSERT_EQ((size_t)2, tree->size);
+    ASSERT_STR_EQ("{1, 5}", tree->repr(tree, TS_TREE_IN_ORDER));
+
+    ts_tree_free(&tree);
+}
+
+void test_tree_balance(void)
+{
+    ts_tree_t *tree = ts_tree_new(TS_TREE_IGNORE);
+
+    for (int32_t i = 0; i < 127; ++i)
+        tree->add(tree, ts_new_int(i));
+
+    ASSERT_EQ((size_t)126, tree->full_depth);
+    tree->balance(tree);
+    ASSERT_EQ((size_t)6, tree->full_depth);
+    ASSERT_EQ(true, tree_depths_hold(tree));
+    ASSERT_EQ(63, tree->root->value->data.integer);
+
+    ts_tree_free(&tree);
+}
+
+void test_tree_remove_depth(void)
+{
+    ts_tree_t *tree = ts_tree_new(TS_TREE_IGNORE);
+
+    for (int32_t i = 0; i < 127; ++i)
+        tree->add(tree, ts_new_int(i));
+    tree->balance(tree);
+
+    /* Removing the greatest values empties the right subtree of the root. */
+    for (int32_t i = 126; i > 63; --i)
+    {
+        ts_generic_t value = ts_new_int(i);
+        tree->remove(tree, value);
+        free(value);
+    }
+
+    ASSERT_EQ((size_t)6, tree->full_depth);
+    ASSERT_EQ(true, tree_depths_hold(tree));
+
+    /* The left child of the root takes its place, one level up. */
+    ts_generic_t value = ts_new_int(63);
+    tree->remove(tree, value);
+    free(value);
+
+    ASSERT_EQ((size_t)5, tree->full_depth);
+    ASSERT_EQ(true, tree_depths_hold(tree));
+    ASSERT_EQ(0, tree->search(tree, tree->root->value));
+    ASSERT_EQ(6, tree->add(tree, ts_new_int(100)));
+    ASSERT_EQ((size_t)6, tree->full_depth);
+
+    /* Removing values with two children splices their successors. */
+    for (int32_t i = 0; i < 63; i += 3)
+    {
+        value = ts_new_int(i);
+        tree->remove(tree, value);
+        free(value);
+        ASSERT_EQ(true, tree_depths_hold(tree));
+    }
+
+    ts_tree_free(&tree);
+}
+
+// -- Testing order statistics
+
+void test_tree_select_and_rank(void)
+{
+    ts_tree_t *tree = ts_tree_new_order_statistic(TS_TREE_APPEND_RIGHT);
+    ts_generic_t value = ts_new_int(40);
+
+    for (int32_t i = 99; i >= 0; --i)
+        tree->add(tree, ts_new_int(i));
+
+    tree->balance(tree);
+    ASSERT_EQ((size_t)100, tree->root->size);
+    ASSERT_EQ(25, ts_tree_select(tree, 25)->data.integer);
+    ASSERT_EQ((size_t)40, ts_tree_rank(tree, value));
+
+    tree->remove(tree, value);
+    ASSERT_EQ(41, ts_tree_select(tree, 40)->data.integer);
+    ASSERT_EQ((size_t)40, ts_tree_rank(tree, value));
+    ASSERT_EQ(NULL, ts_tree_select(tree, 99));
+
+    free(value);
+    ts_tree_free(&tree);
+}
+
+// -- Testing bulk building
+
+void test_tree_from_sorted(void)
+{
+    ts_generic_t values[] = {
+        ts_new_int(1), ts_new_int(2), ts_new_int(2), ts_new_float32(3.5),
+        ts_new_uint(4), ts_new_int(5), ts_new_int(6), ts_new_string("seven")};
+
+    ts_tree_t *tree = ts_tree_from_sorted(values, 8, TS_TREE_IGNORE);
+
+    ASSERT_EQ((size_t)6, tree->size);
+    ASSERT_EQ((size_t)2, tree->full_depth);
+    ASSERT_EQ(true, tree_depths_hold(tree));
+    ASSERT_EQ(TS_TREE_NODE_ROOT, tree->root->position);
+    ASSERT_EQ(tree->root, tree->root->left->parent);
+    ASSERT_EQ((size_t)1, tree->next->size);
+    ASSERT_STR_EQ("{1, 2, 3.500000, 4, 5, 6, 'seven'}", tree->repr(tree, TS_TREE_IN_ORDER));
+
+    ts_tree_free(&tree);
+}
+
+void test_tree_from_unsorted(void)
+{
+    ts_generic_t values[] = {ts_new_int(3), ts_new_string("b"), ts_new_int(1), ts_new_char('a'), ts_new_int(2)};
+    ts_tree_t *tree = ts_tree_from_unsorted(values, 5, TS_TREE_IGNORE);
+
+    ASSERT_EQ(NULL, ts_tree_from_sorted(values, 5, TS_TREE_IGNORE));
+    ASSERT_STR_EQ("{1, 2, 3, 'a', 'b'}", tree->repr(tree, TS_TREE_IN_ORDER));
+    ASSERT_EQ(0, tree->search(tree, values[4]));
+
+    ts_tree_free(&tree);
+}
+
+// -- Testing frozen trees
+
+void test_tree_freeze(void)
+{
+    ts_tree_t *tree = ts_tree_new(TS_TREE_IGNORE);
+    ts_generic_t key = ts_new_int(41);
+
+    for (int32_t i = 0; i < 100; i += 2)
+        tree->add(tree, ts_new_int(i));
+    tree->add(tree, ts_new_string("side"));
+
+    ts_frozen_tree_t *frozen = ts_tree_freeze(tree);
+    ts_tree_free(&tree);
+
+    ASSERT_EQ((size_t)50, frozen->length);
+    ASSERT_EQ(true, frozen->keys != NULL);
+    ASSERT_EQ(42, frozen->lower_bound(frozen, key)->data.integer);
+    ASSERT_EQ(false, frozen->contains(frozen, key));
+    key->data.integer = 98;
+    ASSERT_EQ(true, frozen->contains(frozen, key));
+    key->data.integer = 99;
+    ASSERT_EQ(NULL, frozen->lower_bound(frozen, key));
+    ASSERT_STR_EQ("side", frozen->next->values[1].data.string);
+
+    free(key);
+    ts_frozen_tree_free(&frozen);
+}
+
+void test_tree_freeze_int64(void)
+{
+    ts_tree_t *tree = ts_tree_new(TS_TREE_IGNORE);
+    ts_generic_t key = ts_new_uint64(((uint64_t)1 << 40) + 1);
+
+    for (int64_t i = 0; i < 10; ++i)
+        tree->add(tree, ts_new_int64(((int64_t)1 << 40) + i));
+    tree->add(tree, ts_new_int(-1));
+
+    ts_frozen_tree_t *frozen = ts_tree_freeze(tree);
+
+    // 64 bits integers use the dense keys too
+    ASSERT_EQ(true, frozen->keys != NULL);
+    ASSERT_EQ(true, frozen->contains(frozen, key));
+    key->data.uinteger64 = UINT64_MAX;
+    ASSERT_EQ(NULL, frozen->lower_bound(frozen, key));
+
+    free(key);
+    ts_frozen_tree_free(&frozen);
+    ts_tree_free(&tree);
+}
+
+// -- Testing representation
+
+void test_tree_repr(void)
+{
+    ts_tree_t *tree = ts_tree_new(TS_TREE_IGNORE);
+
+    tree->add(tree, ts_new_int(2));
+    tree->add(tree, ts_new_int(1));
+    tree->add(tree, ts_new_int(3));
+
+    ASSERT_STR_EQ("{1, 2, 3}", tree->repr(tree, TS_TREE_IN_ORDER));
+    ASSERT_STR_EQ("{2, 1, 3}", tree->repr(tree, TS_TREE_PRE_ORDER));
+    ASSERT_STR_EQ("{1, 3, 2}", tree->repr(tree, TS_TREE_POST_ORDER));
+
+    ts_tree_free(&tree);
+}
+
+// -- Testing cursors and ranges
+
+void test_tree_cursor(void)
+{
+    ts_tree_t *tree = ts_tree_new(TS_TREE_IGNORE);
+    int32_t values[] = {50, 20, 70, 10, 30, 60, 80};
+
+    for (int i = 0; i < 7; ++i)
+        tree->add(tree, ts_new_int(values[i]));
+
+    ts_tree_cursor_t cursor = ts_tree_cursor(tree);
+    ASSERT_EQ(10, cursor.value(&cursor)->data.integer);
+
+    ts_generic_t key = ts_new_int(55);
+    ASSERT_EQ(true, cursor.seek(&cursor, key));
+    ASSERT_EQ(60, cursor.value(&cursor)->data.integer);
+    ASSERT_EQ(true, cursor.next(&cursor));
+    ASSERT_EQ(70, cursor.value(&cursor)->data.integer);
+    ASSERT_EQ(true, cursor.prev(&cursor));
+    ASSERT_EQ(true, cursor.prev(&cursor));
+    ASSERT_EQ(50, cursor.value(&cursor)->data.integer);
+    free(key);
+
+    ts_tree_cursor_last(&cursor);
+    ASSERT_EQ(80, cursor.value(&cursor)->data.integer);
+    ASSERT_EQ(false, cursor.next(&cursor));
+    ASSERT_EQ(NULL, cursor.value(&cursor));
+
+    ts_tree_free(&tree);
+}
+
+void test_tree_range(void)
+{
+    ts_tree_t *tree = ts_tree_new(TS_TREE_IGNORE);
+    ts_generic_t lo = ts_new_int(20);
+    ts_generic_t hi = ts_new_float64(60.5);
+    int32_t sum = 0;
+
+    for (int32_t i = 0; i < 100; i += 10)
+        tree->add(tree, ts_new_int(i));
+
+    ASSERT_EQ((size_t)5, ts_tree_range(tree, lo, hi, &sum_visit, &sum));
+    ASSERT_EQ(20 + 30 + 40 + 50 + 60, sum);
+
+    free(lo);
+    free(hi);
+    ts_tree_free(&tree);
+}
+
+// -- Testing index trees
+
+void test_itree_add_remove(void)
+{
+    ts_itree_t *tree = ts_itree_new();
+    ts_generic_t key = ts_new_int(0);
+    int32_t expected = 0;
+
+    for (int32_t i = 0; i < 1000; ++i)
+        ASSERT_EQ(true, tree->add(tree, ts_new_int((i * 37) % 1000)));
+    ASSERT_EQ(false, tree->add(tree, ts_new_int(37)));
+    ASSERT_EQ(true, tree->add(tree, ts_new_string("side")));
+    ASSERT_EQ((size_t)1001, tree->length);
+
+    for (int32_t i = 0; i < 1000; i += 2)
+    {
+        key->data.integer = i;
+        ASSERT_EQ(true, tree->remove(tree, key));
+    }
+    ASSERT_EQ(false, tree->remove(tree, key));
+    ASSERT_EQ((size_t)501, tree->length);
+
+    uint32_t index = ts_itree_first(tree);
+    for (expected = 1; expected < 1000; expected += 2)
+    {
+        ASSERT_EQ(expected, ts_itree_value_at(tree, index).data.integer);
+        index = ts_itree_next(tree, index);
+    }
+    ASSERT_STR_EQ("side", ts_itree_value_at(tree, index).data.string);
+    ASSERT_EQ(TS_ITREE_NIL, ts_itree_next(tree, index));
+
+    key->data.integer = 999;
+    ASSERT_EQ(true, tree->contains(tree, key));
+    key->data.integer = 998;
+    ASSERT_EQ(false, tree->contains(tree, key));
+
+    free(key);
+    ts_itree_free(&tree);
+    ASSERT_EQ(NULL, tree);
+}
+
+void test_itree_reserve(void)
+{
+    ts_itree_t *tree = ts_itree_new();
+
+    ASSERT_EQ(true, ts_itree_reserve(tree, 100));
+    ASSERT_EQ((size_t)100, tree->capacity);
+    ASSERT_EQ(true, ts_itree_reserve(tree, 10));
+    ASSERT_EQ((size_t)100, tree->capacity);
+    ASSERT_EQ(false, ts_itree_reserve(tree, TS_ITREE_MAX_LENGTH + 1));
+
+    struct ts_itree_node *nodes = tree->nodes;
+
+    /* No growth up to the reserved capacity. */
+    for (int32_t i = 0; i < 100; ++i)
+        tree->add(tree, ts_new_int(i));
+    ASSERT_EQ(nodes, tree->nodes);
+    ASSERT_EQ((size_t)100, tree->capacity);
+
+    for (int32_t i = 100; i < 1000; ++i)
+        tree->add(tree, ts_new_int(i));
+    ASSERT_EQ(true, tree->capacity >= 1000);
+    ASSERT_EQ((size_t)1000, tree->length);
+
+    bool present[1000];
+    for (int i = 0; i < 1000; ++i)
+        present[i] = true;
+    ASSERT_EQ(true, itree_holds(tree, present, 1000));
+
+    ts_itree_free(&tree);
+}
+
+void test_itree_compaction(void)
+{
+    ts_itree_t *tree = ts_itree_new();
+    struct ts_generic_t key = {.type = TS_TYPE_INTEGER};
+    bool present[2000] = {false};
+    bool well_formed = true;
+    char chars[64];
+
+    /* Long owned strings, stored out of line, move with their nodes. */
+    memset(chars, 'x', sizeof(chars));
+    for (int i = 0; i < 8; ++i)
+    {
+        chars[0] = (char)('a' + i);
+        tree->add(tree, ts_new_owned_string_n(chars, sizeof(chars)));
+    }
+
+    /* Interleaves adds and removes, so removals fill holes from all over
+     * the array, checking the tree after each round.
+     * */
+    for (int round = 0; round < 20; ++round)
+    {
+        for (int32_t i = 0; i < 200; ++i)
+        {
+            const int32_t value = (round * 997 + i * 7919) % 2000;
+
+            if (!present[value])
+                ASSERT_EQ(true, tree->add(tree, ts_new_int(value)));
+            present[value] = true;
+        }
+
+        for (int32_t i = 0; i < 150; ++i)
+        {
+            key.data.integer = (round * 613 + i * 1327) % 2000;
+            ASSERT_EQ(present[key.data.integer], tree->remove(tree, &key));
+            present[key.data.integer] = false;
+        }
+
+        well_formed = well_formed && itree_check(tree, tree->root, TS_ITREE_NIL) > 0;
+    }
+
+    ASSERT_EQ(true, well_formed);
+
+    /* The walk gives the integers left, then the strings. */
+    uint32_t index = ts_itree_first(tree);
+    bool in_order = true;
+
+    for (int32_t i = 0; i < 2000; ++i)
+    {
+        if (present[i])
+        {
+            in_order = in_order && ts_itree_value_at(tree, index).data.integer == i;
+            index = ts_itree_next(tree, index);
+        }
+    }
+
+    for (int i = 0; i < 8; ++i)
+    {
+        struct ts_generic_t value = ts_itree_value_at(tree, index);
+
+        in_order = in_order && ts_generic_t_length(&value) == sizeof(chars) && ts_generic_t_chars(&value)[0] == 'a' + i;
+        index = ts_itree_next(tree, index);
+    }
+
+    ASSERT_EQ(true, in_order);
+    ASSERT_EQ(TS_ITREE_NIL, index);
+
+    /* Removing every integer leaves the strings, at the front of the array. */
+    for (key.data.integer = 0; key.data.integer < 2000; ++key.data.integer)
+        if (present[key.data.integer])
+            tree->remove(tree, &key);
+    ASSERT_EQ((size_t)8, tree->length);
+    ASSERT_EQ(true, itree_check(tree, tree->root, TS_ITREE_NIL) > 0);
+
+    ts_itree_free(&tree);
+}
+
+int main()
+{
+    RUN(test_tree_add_depth);
+    RUN(test_tree_add_deep);
+    RUN(test_tree_side_tree);
+
+    RUN(test_tree_remove);
+    RUN(test_tree_remove_stored);
+    RUN(test_tree_balance);
+    RUN(test_tree_remove_depth);
+
+    RUN(test_tree_select_and_rank);
+
+    RUN(test_tree_from_sorted);
+    RUN(test_tree_from_unsorted);
+
+    RUN(test_tree_freeze);
+    RUN(test_tree_freeze_int64);
+
+    RUN(test_tree_repr);
+
+    RUN(test_tree_cursor);
+    RUN(test_tree_range);
+
+    RUN(test_itree_add_remove);
+    RUN(test_itree_reserve);
+    RUN(test_itree_compaction);
+
+    return TEST_REPORT();
+}
@@ -0,0 +1,123 @@
+#include "../tinytest/tinytest.h"
+#include "../include/3s/3s.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// -- Testing vectors
+
+void test_vector_push_pop(void)
+{
+    ts_vector_t *vector = ts_vector_new(0);
+    struct ts_generic_t popped;
+
+    for (int32_t i = 0; i < 100; ++i)
+        ASSERT_EQ(true, vector->push(vector, ts_new_int(i)));
+
+    ASSERT_EQ((size_t)100, ts_vector_length(vector));
+    ASSERT_EQ(true, vector->capacity >= 100);
+    ASSERT_EQ(42, vector->get(vector, 42)->data.integer);
+    ASSERT_EQ(true, vector->get(vector, 100) == NULL);
+
+    ASSERT_EQ(true, vector->pop(vector, &popped));
+    ASSERT_EQ(99, popped.data.integer);
+    ASSERT_EQ(true, vector->pop(vector, NULL));
+    ASSERT_EQ((size_t)98, ts_vector_length(vector));
+
+    ts_vector_free(&vector);
+    ASSERT_EQ(true, vector == NULL);
+
+    vector = ts_vector_new(4);
+    ASSERT_EQ(false, vector->pop(vector, &popped));
+    ts_vector_free(&vector);
+}
+
+void test_vector_insert_erase(void)
+{
+    ts_vector_t *vector = ts_vector_new(2);
+    char chars[64];
+
+    memset(chars, 'x', sizeof(chars));
+
+    // long strings move in and out with their characters
+    ts_vector_push(vector, ts_new_owned_string_n(chars, sizeof(chars)));
+    ts_vector_insert(vector, 0, ts_new_int(1));
+    ts_vector_insert(vector, 1, ts_new_owned_string("b"));
+    ts_vector_insert(vector, 100, ts_new_int(3));
+
+    ASSERT_EQ((size_t)4, ts_vector_length(vector));
+    ASSERT_EQ(1, ts_vector_get(vector, 0)->data.integer);
+    ASSERT_STR_EQ("b", ts_generic_t_chars(ts_vector_get(vector, 1)));
+    ASSERT_EQ((size_t)64, ts_generic_t_length(ts_vector_get(vector, 2)));
+    ASSERT_EQ(3, ts_vector_get(vector, 3)->data.integer);
+
+    ASSERT_EQ(true, ts_vector_erase(vector, 1));
+    ASSERT_EQ(false, ts_vector_erase(vector, 3));
+    ASSERT_EQ((size_t)64, ts_generic_t_length(ts_vector_get(vector, 1)));
+
+    ASSERT_EQ(true, ts_vector_reserve(vector, 1000));
+    ASSERT_EQ((size_t)1000, vector->capacity);
+    ASSERT_EQ(3, ts_vector_get(vector, 2)->data.integer);
+
+    ts_vector_free(&vector);
+}
+
+void test_vector_sort_search(void)
+{
+    ts_vector_t *vector = ts_vector_new(0);
+    ts_pool_t *pool = ts_pool_new(2);
+    size_t index;
+
+    for (int32_t i = 0; i < 1000; ++i)
+        ts_vector_push(vector, ts_new_int((i * 7919) % 1000 * 2));
+    ts_vector_push(vector, ts_new_owned_string("text"));
+
+    ASSERT_EQ(true, ts_vector_sort(vector, pool, true));
+    ASSERT_EQ(0, ts_vector_get(vector, 0)->data.integer);
+    ASSERT_EQ(1998, ts_vector_get(vector, 999)->data.integer);
+    ASSERT_EQ(TS_TYPE_OWNED_STRING, ts_vector_get(vector, 1000)->type);
+
+    ts_generic_t key = ts_new_float64(42.0);
+    ASSERT_EQ(true, ts_vector_binary_search(vector, key, &index));
+    ASSERT_EQ((size_t)21, index);
+    key->data.float64 = 43.0;
+    ASSERT_EQ(false, ts_vector_binary_search(vector, key, &index));
+    ASSERT_EQ((size_t)22, index);
+    free(key);
+
+    ts_pool_free(&pool);
+    ts_vector_free(&vector);
+}
+
+void test_vector_list(void)
+{
+    ts_list_t *list = ts_new_list();
+
+    for (int32_t i = 0; i < 10; ++i)
+        ts_list_append_back(list, ts_new_int(i));
+
+    ts_vector_t *vector = ts_vector_from_list(list);
+    ASSERT_EQ((size_t)10, ts_vector_length(vector));
+    ASSERT_EQ(7, ts_vector_get(vector, 7)->data.integer);
+
+    ts_vector_erase(vector, 0);
+    ts_list_t *back = ts_vector_to_list(vector);
+    char *repr = ts_list_repr(back);
+    ASSERT_STR_EQ("[1, 2, 3, 4, 5, 6, 7, 8, 9]", repr);
+    free(repr);
+
+    ts_list_free(&back);
+    ts_vector_free(&vector);
+    ts_list_free(&list);
+}
+
+int main()
+{
+    RUN(test_vector_push_pop);
+    RUN(test_vector_insert_erase);
+    RUN(test_vector_sort_search);
+    RUN(test_vector_list);
+
+    return TEST_REPORT();
+}